@@ -31,6 +31,18 @@
  *  \ingroup blender
  */
 
+/** \defgroup obj Wavefront OBJ
+ *  \ingroup blender
+ */
+
+/** \defgroup ply Stanford PLY
+ *  \ingroup blender
+ */
+
+/** \defgroup stl STL
+ *  \ingroup blender
+ */
+
 /** \defgroup blt BlenTranslation
  *  \ingroup blender
  */
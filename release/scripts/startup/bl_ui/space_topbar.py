@@ -441,6 +441,15 @@ class TOPBAR_MT_file_import(Menu):
                                  text="Collada (Default) (.dae)")
         if bpy.app.build_options.alembic:
             self.layout.operator("wm.alembic_import", text="Alembic (.abc)")
+        if bpy.app.build_options.usd:
+            self.layout.operator(
+                "wm.usd_import", text="Universal Scene Description (.usd, .usdc, .usda)")
+        if bpy.app.build_options.io_wavefront_obj:
+            self.layout.operator("wm.obj_import", text="Wavefront (.obj) (experimental)")
+        if bpy.app.build_options.io_stl:
+            self.layout.operator("wm.stl_import", text="STL (.stl) (experimental)")
+        if bpy.app.build_options.io_ply:
+            self.layout.operator("wm.ply_import", text="Stanford (.ply) (experimental)")
 
 
 class TOPBAR_MT_file_export(Menu):
@@ -457,6 +466,12 @@ class TOPBAR_MT_file_export(Menu):
         if bpy.app.build_options.usd:
             self.layout.operator(
                 "wm.usd_export", text="Universal Scene Description (.usd, .usdc, .usda)")
+        if bpy.app.build_options.io_wavefront_obj:
+            self.layout.operator("wm.obj_export", text="Wavefront (.obj) (experimental)")
+        if bpy.app.build_options.io_stl:
+            self.layout.operator("wm.stl_export", text="STL (.stl) (experimental)")
+        if bpy.app.build_options.io_ply:
+            self.layout.operator("wm.ply_export", text="Stanford (.ply) (experimental)")
 
 
 class TOPBAR_MT_file_external_data(Menu):
@@ -625,6 +625,11 @@ class USERPREF_PT_system_memory(SystemPanel, CenterAlignMixIn, Panel):
 
         layout.separator()
 
+        col = layout.column()
+        col.prop(system, "packed_data_memory_limit")
+
+        layout.separator()
+
         col = layout.column()
         col.prop(system, "texture_time_out", text="Texture Time Out")
         col.prop(system, "texture_collection_rate", text="Garbage Collection Rate")
@@ -1398,6 +1403,7 @@ class USERPREF_PT_saveload_blend(SaveLoadPanel, CenterAlignMixIn, Panel):
         col.prop(paths, "use_relative_paths")
         col.prop(paths, "use_file_compression")
         col.prop(paths, "use_load_ui")
+        col.prop(paths, "use_defer_packed_data")
 
         col = layout.column(heading="Text Files")
         col.prop(paths, "use_tabs_as_spaces")
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <memory>
 #include <mutex>
 
 #include "FN_cpp_type.hh"
@@ -23,8 +24,10 @@
 
 #include "BKE_attribute.h"
 
+#include "BLI_array.hh"
 #include "BLI_color.hh"
 #include "BLI_float3.hh"
+#include "BLI_map.hh"
 
 namespace blender::bke {
 
@@ -100,6 +103,10 @@ class ReadAttribute {
   /* Get a span that contains all attribute values. */
   fn::GSpan get_span() const;
 
+  /* Get a virtual span that contains all attribute values. Other than #get_span, this does not
+   * have to create a temporary array when all elements have the same value. */
+  virtual fn::GVSpan get_virtual_span() const;
+
  protected:
   /* r_value is expected to be uninitialized. */
   virtual void get_internal(const int64_t index, void *r_value) const = 0;
@@ -216,6 +223,11 @@ template<typename T> class TypedReadAttribute {
   {
     return attribute_->get_span().template typed<T>();
   }
+
+  fn::VSpan<T> get_virtual_span() const
+  {
+    return attribute_->get_virtual_span().template typed<T>();
+  }
 };
 
 /* This provides type safe access to an attribute. */
@@ -264,6 +276,119 @@ template<typename T> class TypedWriteAttribute {
   }
 };
 
+/**
+ * Stores attributes that have been interpolated to a different domain, so that they don't have to
+ * be computed again when they are read multiple times, e.g. by different nodes. The geometry
+ * component that owns the cache has to clear it whenever the geometry or its attributes change.
+ */
+class AttributeDomainCache {
+ public:
+  /* Attribute values that are owned by the cache. Readers keep the array alive, even when the
+   * cache is cleared in the mean time. */
+  class CachedArray {
+   private:
+    const CPPType &type_;
+    void *data_;
+    int64_t size_;
+
+   public:
+    CachedArray(const CPPType &type, const int64_t size);
+    ~CachedArray();
+    CachedArray(const CachedArray &other) = delete;
+    CachedArray &operator=(const CachedArray &other) = delete;
+
+    fn::GSpan span() const
+    {
+      return fn::GSpan(type_, data_, size_);
+    }
+
+    fn::GMutableSpan span()
+    {
+      return fn::GMutableSpan(type_, data_, size_);
+    }
+  };
+
+  /* For every vertex, the indices of the adjacent elements in another domain. */
+  struct VertexAdjacency {
+    Array<int> offsets;
+    Array<int> indices;
+
+    Span<int> operator[](const int64_t vertex_index) const
+    {
+      const int start = offsets[vertex_index];
+      return indices.as_span().slice(start, offsets[vertex_index + 1] - start);
+    }
+  };
+
+ private:
+  std::mutex arrays_mutex_;
+  Map<std::pair<std::string, int>, std::shared_ptr<const CachedArray>> arrays_;
+
+  std::mutex adjacency_mutex_;
+  Map<int, std::unique_ptr<VertexAdjacency>> vertex_adjacencies_;
+
+ public:
+  /**
+   * Get the attribute with the given name on the given domain from the cache, or compute it when
+   * it does not exist yet. The compute function may return null, which is not cached.
+   */
+  template<typename ComputeFn>
+  std::shared_ptr<const CachedArray> lookup_or_compute(const StringRef attribute_name,
+                                                       const AttributeDomain domain,
+                                                       const ComputeFn &compute_fn)
+  {
+    const std::pair<std::string, int> key{attribute_name, domain};
+    {
+      std::lock_guard lock{arrays_mutex_};
+      std::shared_ptr<const CachedArray> array = arrays_.lookup_default(key, {});
+      if (array) {
+        return array;
+      }
+    }
+    /* Compute without holding the lock. The compute function runs parallel loops, a thread waiting
+     * for one of their tasks may pick up a task that needs the lock as well. */
+    std::shared_ptr<const CachedArray> array = compute_fn();
+    if (!array) {
+      return array;
+    }
+    std::lock_guard lock{arrays_mutex_};
+    /* Another thread may have computed the same array in the mean time. */
+    return arrays_.lookup_or_add(key, std::move(array));
+  }
+
+  /**
+   * Get the elements of the given domain that are adjacent to every vertex. Those only depend on
+   * the topology, so they can be shared by all attributes.
+   */
+  template<typename ComputeFn>
+  const VertexAdjacency &vertex_adjacency(const AttributeDomain domain,
+                                          const ComputeFn &compute_fn)
+  {
+    std::lock_guard lock{adjacency_mutex_};
+    return *vertex_adjacencies_.lookup_or_add_cb(
+        domain, [&]() { return std::make_unique<VertexAdjacency>(compute_fn()); });
+  }
+
+  /**
+   * Remove the interpolated attributes, but keep the vertex adjacency, because attribute values
+   * can change without changing the topology.
+   */
+  void clear_arrays()
+  {
+    std::lock_guard lock{arrays_mutex_};
+    arrays_.clear();
+  }
+
+  void clear()
+  {
+    this->clear_arrays();
+    {
+      std::lock_guard lock{adjacency_mutex_};
+      vertex_adjacencies_.clear();
+    }
+  }
+};
+
 using BooleanReadAttribute = TypedReadAttribute<bool>;
 using FloatReadAttribute = TypedReadAttribute<float>;
 using Float3ReadAttribute = TypedReadAttribute<float3>;
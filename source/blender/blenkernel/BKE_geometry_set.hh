@@ -118,6 +118,13 @@ class GeometryComponent {
   virtual blender::bke::ReadAttributePtr attribute_try_adapt_domain(
       blender::bke::ReadAttributePtr attribute, const AttributeDomain domain) const;
 
+  /* Same as #attribute_try_adapt_domain, but the component may reuse the result for later
+   * requests of the attribute with the same name on the same domain. */
+  virtual blender::bke::ReadAttributePtr attribute_try_adapt_domain_cached(
+      const blender::StringRef attribute_name,
+      blender::bke::ReadAttributePtr attribute,
+      const AttributeDomain domain) const;
+
   /* Returns true when the attribute has been deleted. */
   virtual bool attribute_try_delete(const blender::StringRef attribute_name);
 
@@ -273,6 +280,11 @@ class MeshComponent : public GeometryComponent {
    * group names are stored on an object. Since we don't have an object here, we copy over the
    * names into this map. */
   blender::Map<std::string, int> vertex_group_names_;
+  /* Attributes that have been interpolated to other domains. */
+  mutable blender::bke::AttributeDomainCache domain_cache_;
+
+  blender::bke::WriteAttributePtr attribute_try_get_for_write_impl(
+      const blender::StringRef attribute_name);
 
  public:
   MeshComponent();
@@ -285,6 +297,8 @@ class MeshComponent : public GeometryComponent {
   Mesh *release();
 
   void copy_vertex_group_names_from_object(const struct Object &object);
+  const blender::Map<std::string, int> &vertex_group_names() const;
+  blender::Map<std::string, int> &vertex_group_names();
 
   const Mesh *get_for_read() const;
   Mesh *get_for_write();
@@ -297,6 +311,12 @@ class MeshComponent : public GeometryComponent {
 
   blender::bke::ReadAttributePtr attribute_try_get_for_read(
       const blender::StringRef attribute_name) const final;
+  blender::bke::ReadAttributePtr attribute_try_adapt_domain(
+      blender::bke::ReadAttributePtr attribute, const AttributeDomain domain) const final;
+  blender::bke::ReadAttributePtr attribute_try_adapt_domain_cached(
+      const blender::StringRef attribute_name,
+      blender::bke::ReadAttributePtr attribute,
+      const AttributeDomain domain) const final;
   blender::bke::WriteAttributePtr attribute_try_get_for_write(
       const blender::StringRef attribute_name) final;
 
@@ -367,6 +387,7 @@ class InstancesComponent : public GeometryComponent {
   GeometryComponent *copy() const override;
 
   void clear();
+  void reserve(int min_capacity);
   void add_instance(Object *object,
                     blender::float3 position,
                     blender::float3 rotation = {0, 0, 0},
@@ -385,8 +406,24 @@ class InstancesComponent : public GeometryComponent {
   blender::Span<blender::float3> rotations() const;
   blender::Span<blender::float3> scales() const;
   blender::MutableSpan<blender::float3> positions();
+  blender::MutableSpan<blender::float3> rotations();
+  blender::MutableSpan<blender::float3> scales();
   int instances_amount() const;
 
+  /* The transforms of the instances are exposed as attributes on the point domain, so that they
+   * can be modified without realizing the instances. */
+  bool attribute_domain_supported(const AttributeDomain domain) const final;
+  bool attribute_domain_with_type_supported(const AttributeDomain domain,
+                                            const CustomDataType data_type) const final;
+  int attribute_domain_size(const AttributeDomain domain) const final;
+  bool attribute_is_builtin(const blender::StringRef attribute_name) const final;
+
+  blender::bke::ReadAttributePtr attribute_try_get_for_read(
+      const blender::StringRef attribute_name) const final;
+  blender::bke::WriteAttributePtr attribute_try_get_for_write(
+      const blender::StringRef attribute_name) final;
+
+  blender::Set<std::string> attribute_names() const final;
   bool is_empty() const final;
 
   static constexpr inline GeometryComponentType static_type = GeometryComponentType::Instances;
@@ -0,0 +1,48 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Instances are kept as references to objects and collections for as long as possible. Most
+ * geometry operations (transforming, changing attributes on the instances themselves) do not need
+ * the instanced geometry. Only operations that work on the actual geometry have to realize the
+ * instances. That is done here.
+ */
+
+#include "BLI_float4x4.hh"
+
+#include "BKE_geometry_set.hh"
+
+namespace blender::bke {
+
+/**
+ * A geometry set together with all the transforms it is instanced with. Grouping the transforms
+ * avoids copying the same geometry for every instance.
+ */
+struct GeometryInstanceGroup {
+  GeometrySet geometry_set;
+  Vector<float4x4> transforms;
+};
+
+Vector<GeometryInstanceGroup> geometry_set_gather_instances(const GeometrySet &geometry_set);
+
+GeometrySet geometry_set_realize_instances(const GeometrySet &geometry_set);
+GeometrySet geometry_set_realize_instance_groups(Span<GeometryInstanceGroup> groups);
+
+}  // namespace blender::bke
@@ -161,6 +161,9 @@ typedef struct Main {
    */
   struct MainIDRelations *relations;
 
+  /** Index of ID names, see `BKE_main_namemap.h`. */
+  struct MainNameMap *name_map;
+
   struct MainLock *lock;
 } Main;
 
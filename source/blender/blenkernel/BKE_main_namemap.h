@@ -0,0 +1,73 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * API to keep an index of the names of the IDs in a Main data-base, used to look up IDs by name
+ * and to generate unique names without going over all IDs of a type.
+ *
+ * The index of a type is built when it is first needed, and is then kept up to date by the
+ * functions adding, renaming and freeing IDs in `BKE_lib_id`. Code that changes the lists of a
+ * Main directly (file reading, linking, relocating...) has to call #BKE_main_namemap_clear.
+ *
+ * \section Function Names
+ *
+ * - `BKE_main_namemap_` Should be used for functions in that file.
+ */
+
+#include "BLI_compiler_attrs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ID;
+struct Main;
+struct MainNameMap;
+
+/**
+ * Numbers of name suffixes below this are re-used once they are free, beyond it new names get
+ * a number higher than all used ones.
+ */
+#define MAIN_NAMEMAP_NUMBERS_IN_USE_MAX 1024
+
+void BKE_main_namemap_destroy(struct MainNameMap **r_name_map) ATTR_NONNULL();
+void BKE_main_namemap_clear(struct Main *bmain) ATTR_NONNULL();
+void BKE_main_namemap_clear_type(struct Main *bmain, const short id_type) ATTR_NONNULL();
+
+void BKE_main_namemap_add_name(struct Main *bmain, struct ID *id) ATTR_NONNULL();
+void BKE_main_namemap_remove_name(struct Main *bmain, struct ID *id, const char *name)
+    ATTR_NONNULL();
+
+bool BKE_main_namemap_contains_name(struct Main *bmain,
+                                    const short id_type,
+                                    const char *name,
+                                    const struct ID *id_ignore) ATTR_WARN_UNUSED_RESULT
+    ATTR_NONNULL(1, 3);
+int BKE_main_namemap_get_unused_number(struct Main *bmain,
+                                       const short id_type,
+                                       const char *base_name,
+                                       const int number_min) ATTR_WARN_UNUSED_RESULT
+    ATTR_NONNULL();
+struct ID *BKE_main_namemap_find_name(struct Main *bmain,
+                                      const short id_type,
+                                      const char *name) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+
+#ifdef __cplusplus
+}
+#endif
@@ -115,6 +115,25 @@ int BKE_packedfile_seek(struct PackedFile *pf, int offset, int whence);
 void BKE_packedfile_rewind(struct PackedFile *pf);
 int BKE_packedfile_read(struct PackedFile *pf, void *data, int size);
 
+/* deferred data */
+bool BKE_packedfile_defer_data(struct PackedFile *pf, const char *filepath, uint64_t file_offset);
+bool BKE_packedfile_data_acquire(struct PackedFile *pf);
+void BKE_packedfile_data_release(struct PackedFile *pf);
+bool BKE_packedfile_data_acquire_pinned(struct PackedFile *pf);
+void BKE_packedfile_deferred_budget_set(size_t budget);
+void BKE_packedfile_deferred_file_overwrite(const char *filepath);
+void BKE_packedfile_deferred_undo_free(void);
+
+/**
+ * #PackedFile.seek of packed files in undo steps that store where their deferred data can be
+ * read from instead of the data itself.
+ */
+#define PACKEDFILE_SEEK_DEFERRED -1
+bool BKE_packedfile_undo_data_read(const void *undo_data,
+                                   size_t undo_data_size,
+                                   void *r_data,
+                                   int size);
+
 /* ID should be not NULL, return 1 if there's a packed file */
 bool BKE_packedfile_id_check(struct ID *id);
 /* ID should be not NULL, throws error when ID is Library */
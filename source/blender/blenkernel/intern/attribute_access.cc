@@ -14,6 +14,7 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <cmath>
 #include <utility>
 
 #include "BKE_attribute_access.hh"
@@ -27,9 +28,11 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_pointcloud_types.h"
 
+#include "BLI_array.hh"
 #include "BLI_color.hh"
 #include "BLI_float2.hh"
 #include "BLI_span.hh"
+#include "BLI_task.hh"
 
 #include "CLG_log.h"
 
@@ -52,6 +55,10 @@ namespace blender::bke {
 /** \name Attribute Accessor implementations
  * \{ */
 
+/* Copying attribute values into or out of a temporary span is done in parallel in chunks of this
+ * many elements. */
+static constexpr int64_t AttributeSpanGrainSize = 4096;
+
 ReadAttribute::~ReadAttribute()
 {
   if (array_is_temporary_ && array_buffer_ != nullptr) {
@@ -74,14 +81,21 @@ fn::GSpan ReadAttribute::get_span() const
   return fn::GSpan(cpp_type_, array_buffer_, size_);
 }
 
+fn::GVSpan ReadAttribute::get_virtual_span() const
+{
+  return this->get_span();
+}
+
 void ReadAttribute::initialize_span() const
 {
   const int element_size = cpp_type_.size();
   array_buffer_ = MEM_mallocN_aligned(size_ * element_size, cpp_type_.alignment(), __func__);
   array_is_temporary_ = true;
-  for (const int i : IndexRange(size_)) {
-    this->get_internal(i, POINTER_OFFSET(array_buffer_, i * element_size));
-  }
+  parallel_for(IndexRange(size_), AttributeSpanGrainSize, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      this->get_internal(i, POINTER_OFFSET(array_buffer_, i * element_size));
+    }
+  });
 }
 
 WriteAttribute::~WriteAttribute()
@@ -131,9 +145,11 @@ void WriteAttribute::apply_span_if_necessary()
   BLI_assert(array_buffer_ != nullptr);
 
   const int element_size = cpp_type_.size();
-  for (const int i : IndexRange(size_)) {
-    this->set_internal(i, POINTER_OFFSET(array_buffer_, i * element_size));
-  }
+  parallel_for(IndexRange(size_), AttributeSpanGrainSize, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      this->set_internal(i, POINTER_OFFSET(array_buffer_, i * element_size));
+    }
+  });
 }
 
 class VertexWeightWriteAttribute final : public WriteAttribute {
@@ -252,6 +268,12 @@ template<typename T> class ArrayReadAttribute final : public ReadAttribute {
     array_buffer_ = const_cast<T *>(data_.data());
     array_is_temporary_ = false;
   }
+
+  fn::GVSpan get_virtual_span() const override
+  {
+    /* Reference the layer directly, without going through the locked span initialization. */
+    return fn::GVSpan(data_);
+  }
 };
 
 template<typename StructT, typename ElemT, typename GetFuncT, typename SetFuncT>
@@ -286,6 +308,29 @@ class DerivedArrayWriteAttribute final : public WriteAttribute {
     const ElemT &typed_value = *reinterpret_cast<const ElemT *>(value);
     set_function_(struct_value, typed_value);
   }
+
+  void initialize_span() override
+  {
+    array_buffer_ = MEM_mallocN_aligned(sizeof(ElemT) * size_, alignof(ElemT), __func__);
+    array_is_temporary_ = true;
+    MutableSpan<ElemT> values{static_cast<ElemT *>(array_buffer_), size_};
+    parallel_for(data_.index_range(), AttributeSpanGrainSize, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        new (&values[i]) ElemT(get_function_(data_[i]));
+      }
+    });
+  }
+
+  void apply_span_if_necessary() override
+  {
+    BLI_assert(array_buffer_ != nullptr);
+    Span<ElemT> values{static_cast<const ElemT *>(array_buffer_), size_};
+    parallel_for(data_.index_range(), AttributeSpanGrainSize, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        set_function_(data_[i], values[i]);
+      }
+    });
+  }
 };
 
 template<typename StructT, typename ElemT, typename GetFuncT>
@@ -308,6 +353,18 @@ class DerivedArrayReadAttribute final : public ReadAttribute {
     const ElemT value = get_function_(struct_value);
     new (r_value) ElemT(value);
   }
+
+  void initialize_span() const override
+  {
+    array_buffer_ = MEM_mallocN_aligned(sizeof(ElemT) * size_, alignof(ElemT), __func__);
+    array_is_temporary_ = true;
+    MutableSpan<ElemT> values{static_cast<ElemT *>(array_buffer_), size_};
+    parallel_for(data_.index_range(), AttributeSpanGrainSize, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        new (&values[i]) ElemT(get_function_(data_[i]));
+      }
+    });
+  }
 };
 
 class ConstantReadAttribute final : public ReadAttribute {
@@ -343,6 +400,11 @@ class ConstantReadAttribute final : public ReadAttribute {
     array_is_temporary_ = true;
     cpp_type_.fill_uninitialized(value_, array_buffer_, size_);
   }
+
+  fn::GVSpan get_virtual_span() const override
+  {
+    return fn::GVSpan::FromSingle(cpp_type_, value_, size_);
+  }
 };
 
 class ConvertedReadAttribute final : public ReadAttribute {
@@ -377,6 +439,137 @@ class ConvertedReadAttribute final : public ReadAttribute {
   }
 };
 
+/**
+ * Reads the values of another attribute on a different domain, whereby every element maps to
+ * exactly one element of the base attribute. Values are only looked up when they are accessed,
+ * a temporary array is only filled when the entire span is requested.
+ */
+template<typename IndexFuncT> class MappedReadAttribute final : public ReadAttribute {
+ private:
+  ReadAttributePtr base_attribute_;
+  IndexFuncT index_function_;
+
+ public:
+  MappedReadAttribute(ReadAttributePtr base_attribute,
+                      const AttributeDomain domain,
+                      const int64_t size,
+                      IndexFuncT index_function)
+      : ReadAttribute(domain, base_attribute->cpp_type(), size),
+        base_attribute_(std::move(base_attribute)),
+        index_function_(std::move(index_function))
+  {
+  }
+
+  void get_internal(const int64_t index, void *r_value) const override
+  {
+    base_attribute_->get(index_function_(index), r_value);
+  }
+
+  void initialize_span() const override
+  {
+    const fn::GSpan base_span = base_attribute_->get_span();
+    const int element_size = cpp_type_.size();
+    array_buffer_ = MEM_mallocN_aligned(size_ * element_size, cpp_type_.alignment(), __func__);
+    array_is_temporary_ = true;
+    parallel_for(IndexRange(size_), AttributeSpanGrainSize, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        cpp_type_.copy_to_uninitialized(base_span[index_function_(i)],
+                                        POINTER_OFFSET(array_buffer_, i * element_size));
+      }
+    });
+  }
+};
+
+/* Reads attribute values from an array owned by an #AttributeDomainCache. */
+class CachedArrayReadAttribute final : public ReadAttribute {
+ private:
+  std::shared_ptr<const AttributeDomainCache::CachedArray> array_;
+
+ public:
+  CachedArrayReadAttribute(const AttributeDomain domain,
+                           std::shared_ptr<const AttributeDomainCache::CachedArray> array)
+      : ReadAttribute(domain, array->span().type(), array->span().size()),
+        array_(std::move(array))
+  {
+  }
+
+  void get_internal(const int64_t index, void *r_value) const override
+  {
+    cpp_type_.copy_to_uninitialized(array_->span()[index], r_value);
+  }
+
+  void initialize_span() const override
+  {
+    /* The data will not be modified, so this const_cast is fine. */
+    array_buffer_ = const_cast<void *>(array_->span().data());
+    array_is_temporary_ = false;
+  }
+
+  fn::GVSpan get_virtual_span() const override
+  {
+    return array_->span();
+  }
+};
+
+/**
+ * Forwards to another write attribute and clears an #AttributeDomainCache when values are set,
+ * when the changes are applied and when it is freed. The values may change as long as the
+ * attribute exists, so clearing the cache when it is handed out is not enough.
+ */
+class DomainCacheClearingWriteAttribute final : public WriteAttribute {
+ private:
+  WriteAttributePtr attribute_;
+  AttributeDomainCache &cache_;
+
+ public:
+  DomainCacheClearingWriteAttribute(WriteAttributePtr attribute, AttributeDomainCache &cache)
+      : WriteAttribute(attribute->domain(), attribute->cpp_type(), attribute->size()),
+        attribute_(std::move(attribute)),
+        cache_(cache)
+  {
+  }
+
+  ~DomainCacheClearingWriteAttribute() override
+  {
+    cache_.clear();
+  }
+
+  void get_internal(const int64_t index, void *r_value) const override
+  {
+    attribute_->get(index, r_value);
+  }
+
+  void set_internal(const int64_t index, const void *value) override
+  {
+    attribute_->set(index, value);
+    cache_.clear_arrays();
+  }
+
+  void initialize_span() override
+  {
+    array_buffer_ = attribute_->get_span().data();
+    array_is_temporary_ = false;
+  }
+
+  void apply_span_if_necessary() override
+  {
+    attribute_->apply_span();
+    cache_.clear();
+  }
+};
+
+AttributeDomainCache::CachedArray::CachedArray(const CPPType &type, const int64_t size)
+    : type_(type), size_(size)
+{
+  data_ = MEM_mallocN_aligned(type.size() * size, type.alignment(), __func__);
+}
+
+AttributeDomainCache::CachedArray::~CachedArray()
+{
+  type_.destruct_n(data_, size_);
+  MEM_freeN(data_);
+}
+
 /** \} */
 
 const blender::fn::CPPType *custom_data_type_to_cpp_type(const CustomDataType type)
@@ -578,6 +771,14 @@ ReadAttributePtr GeometryComponent::attribute_try_adapt_domain(ReadAttributePtr
   return {};
 }
 
+ReadAttributePtr GeometryComponent::attribute_try_adapt_domain_cached(
+    const StringRef UNUSED(attribute_name),
+    ReadAttributePtr attribute,
+    const AttributeDomain domain) const
+{
+  return this->attribute_try_adapt_domain(std::move(attribute), domain);
+}
+
 WriteAttributePtr GeometryComponent::attribute_try_get_for_write(
     const StringRef UNUSED(attribute_name))
 {
@@ -642,7 +843,8 @@ ReadAttributePtr GeometryComponent::attribute_try_get_for_read(
   }
 
   if (attribute->domain() != domain) {
-    attribute = this->attribute_try_adapt_domain(std::move(attribute), domain);
+    attribute = this->attribute_try_adapt_domain_cached(
+        attribute_name, std::move(attribute), domain);
     if (!attribute) {
       return {};
     }
@@ -968,7 +1170,349 @@ ReadAttributePtr MeshComponent::attribute_try_get_for_read(const StringRef attri
   return {};
 }
 
+namespace blender::bke {
+
+/* Corner attributes can be read from other domains without computing values that are never
+ * accessed, because every corner maps to exactly one element of the original domain. */
+static ReadAttributePtr try_map_mesh_attribute_to_corners(const Mesh &mesh,
+                                                          ReadAttributePtr attribute)
+{
+  const Span<MLoop> loops{mesh.mloop, mesh.totloop};
+  switch (attribute->domain()) {
+    case ATTR_DOMAIN_POINT: {
+      auto get_vertex = [loops](const int64_t loop_index) { return loops[loop_index].v; };
+      return std::make_unique<MappedReadAttribute<decltype(get_vertex)>>(
+          std::move(attribute), ATTR_DOMAIN_CORNER, loops.size(), get_vertex);
+    }
+    case ATTR_DOMAIN_EDGE: {
+      auto get_edge = [loops](const int64_t loop_index) { return loops[loop_index].e; };
+      return std::make_unique<MappedReadAttribute<decltype(get_edge)>>(
+          std::move(attribute), ATTR_DOMAIN_CORNER, loops.size(), get_edge);
+    }
+    case ATTR_DOMAIN_POLYGON: {
+      Array<int> loop_to_poly(mesh.totloop);
+      for (const int poly_index : IndexRange(mesh.totpoly)) {
+        const MPoly &poly = mesh.mpoly[poly_index];
+        loop_to_poly.as_mutable_span().slice(poly.loopstart, poly.totloop).fill(poly_index);
+      }
+      auto get_poly = [loop_to_poly = std::move(loop_to_poly)](const int64_t loop_index) {
+        return loop_to_poly[loop_index];
+      };
+      return std::make_unique<MappedReadAttribute<decltype(get_poly)>>(
+          std::move(attribute), ATTR_DOMAIN_CORNER, loops.size(), std::move(get_poly));
+    }
+    default:
+      return {};
+  }
+}
+
+/**
+ * Computes the average of multiple attribute values. Integers are rounded, booleans are true when
+ * any of the values is true.
+ */
+template<typename T> class AverageMixer {
+ private:
+  using SumT = std::conditional_t<std::is_same_v<T, int>, int64_t, T>;
+  SumT sum_ = SumT();
+  int count_ = 0;
+
+ public:
+  void mix_in(const T &value)
+  {
+    if constexpr (std::is_same_v<T, bool>) {
+      sum_ = sum_ || value;
+    }
+    else if constexpr (std::is_same_v<T, Color4f>) {
+      sum_.r += value.r;
+      sum_.g += value.g;
+      sum_.b += value.b;
+      sum_.a += value.a;
+    }
+    else {
+      sum_ += value;
+    }
+    count_++;
+  }
+
+  T finish() const
+  {
+    if (count_ == 0) {
+      return T();
+    }
+    if constexpr (std::is_same_v<T, bool>) {
+      return sum_;
+    }
+    else if constexpr (std::is_same_v<T, int>) {
+      return static_cast<int>(std::round(static_cast<double>(sum_) / count_));
+    }
+    else if constexpr (std::is_same_v<T, Color4f>) {
+      const float factor = 1.0f / count_;
+      return Color4f(sum_.r * factor, sum_.g * factor, sum_.b * factor, sum_.a * factor);
+    }
+    else {
+      return sum_ / static_cast<float>(count_);
+    }
+  }
+};
+
+/* Attribute interpolation is cheap per element, so every task should process many elements. */
+static constexpr int64_t InterpolationGrainSize = 2048;
+
+static AttributeDomainCache::VertexAdjacency compute_vertex_adjacency(const Mesh &mesh,
+                                                                       const AttributeDomain domain)
+{
+  /* Calls the function for every pair of a vertex and an adjacent element in the domain. */
+  auto foreach_adjacent_element = [&](const auto &fn) {
+    switch (domain) {
+      case ATTR_DOMAIN_CORNER:
+        for (const int loop_index : IndexRange(mesh.totloop)) {
+          fn(mesh.mloop[loop_index].v, loop_index);
+        }
+        break;
+      case ATTR_DOMAIN_EDGE:
+        for (const int edge_index : IndexRange(mesh.totedge)) {
+          fn(mesh.medge[edge_index].v1, edge_index);
+          fn(mesh.medge[edge_index].v2, edge_index);
+        }
+        break;
+      case ATTR_DOMAIN_POLYGON:
+        for (const int poly_index : IndexRange(mesh.totpoly)) {
+          const MPoly &poly = mesh.mpoly[poly_index];
+          for (const MLoop &loop : Span(mesh.mloop + poly.loopstart, poly.totloop)) {
+            fn(loop.v, poly_index);
+          }
+        }
+        break;
+      default:
+        BLI_assert(false);
+        break;
+    }
+  };
+
+  AttributeDomainCache::VertexAdjacency adjacency;
+  adjacency.offsets.reinitialize(mesh.totvert + 1);
+  adjacency.offsets.fill(0);
+  foreach_adjacent_element(
+      [&](const int vertex_index, const int UNUSED(index)) { adjacency.offsets[vertex_index]++; });
+  int offset = 0;
+  for (int &count_or_offset : adjacency.offsets) {
+    const int count = count_or_offset;
+    count_or_offset = offset;
+    offset += count;
+  }
+
+  adjacency.indices.reinitialize(offset);
+  Array<int> used_counts(mesh.totvert, 0);
+  foreach_adjacent_element([&](const int vertex_index, const int index) {
+    adjacency.indices[adjacency.offsets[vertex_index] + used_counts[vertex_index]++] = index;
+  });
+  return adjacency;
+}
+
+template<typename T>
+static void adapt_mesh_domain_to_point(const AttributeDomainCache::VertexAdjacency &adjacency,
+                                       const Span<T> old_values,
+                                       MutableSpan<T> r_values)
+{
+  parallel_for(r_values.index_range(), InterpolationGrainSize, [&](const IndexRange range) {
+    for (const int64_t vertex_index : range) {
+      AverageMixer<T> mixer;
+      for (const int index : adjacency[vertex_index]) {
+        mixer.mix_in(old_values[index]);
+      }
+      new (&r_values[vertex_index]) T(mixer.finish());
+    }
+  });
+}
+
+template<typename T>
+static void adapt_mesh_domain_point_to_edge(const Mesh &mesh,
+                                            const Span<T> old_values,
+                                            MutableSpan<T> r_values)
+{
+  parallel_for(r_values.index_range(), InterpolationGrainSize, [&](const IndexRange range) {
+    for (const int64_t edge_index : range) {
+      const MEdge &edge = mesh.medge[edge_index];
+      AverageMixer<T> mixer;
+      mixer.mix_in(old_values[edge.v1]);
+      mixer.mix_in(old_values[edge.v2]);
+      new (&r_values[edge_index]) T(mixer.finish());
+    }
+  });
+}
+
+/* Averages the values of all corners of every polygon, or of the vertices used by the corners. */
+template<typename T>
+static void adapt_mesh_domain_to_polygon(const Mesh &mesh,
+                                         const bool use_vertices,
+                                         const Span<T> old_values,
+                                         MutableSpan<T> r_values)
+{
+  parallel_for(r_values.index_range(), InterpolationGrainSize, [&](const IndexRange range) {
+    for (const int64_t poly_index : range) {
+      const MPoly &poly = mesh.mpoly[poly_index];
+      AverageMixer<T> mixer;
+      for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
+        mixer.mix_in(old_values[use_vertices ? mesh.mloop[loop_index].v : loop_index]);
+      }
+      new (&r_values[poly_index]) T(mixer.finish());
+    }
+  });
+}
+
+/**
+ * Interpolate attribute values between domains that are directly adjacent to each other.
+ * Returns false when there is no direct interpolation between the domains.
+ */
+static bool try_adapt_mesh_domain_directly(const Mesh &mesh,
+                                           AttributeDomainCache &cache,
+                                           const AttributeDomain old_domain,
+                                           const AttributeDomain new_domain,
+                                           const fn::GSpan old_values,
+                                           fn::GMutableSpan r_values)
+{
+  const CPPType &type = old_values.type();
+  bool success = false;
+  auto adapt = [&](auto dummy) {
+    using T = decltype(dummy);
+    const Span<T> old_typed = old_values.typed<T>();
+    MutableSpan<T> r_typed = r_values.typed<T>();
+    if (new_domain == ATTR_DOMAIN_POINT &&
+        ELEM(old_domain, ATTR_DOMAIN_CORNER, ATTR_DOMAIN_EDGE, ATTR_DOMAIN_POLYGON)) {
+      const AttributeDomainCache::VertexAdjacency &adjacency = cache.vertex_adjacency(
+          old_domain, [&]() { return compute_vertex_adjacency(mesh, old_domain); });
+      adapt_mesh_domain_to_point(adjacency, old_typed, r_typed);
+      success = true;
+    }
+    else if (old_domain == ATTR_DOMAIN_POINT && new_domain == ATTR_DOMAIN_EDGE) {
+      adapt_mesh_domain_point_to_edge(mesh, old_typed, r_typed);
+      success = true;
+    }
+    else if (ELEM(old_domain, ATTR_DOMAIN_POINT, ATTR_DOMAIN_CORNER) &&
+             new_domain == ATTR_DOMAIN_POLYGON) {
+      adapt_mesh_domain_to_polygon(mesh, old_domain == ATTR_DOMAIN_POINT, old_typed, r_typed);
+      success = true;
+    }
+  };
+
+  if (type.is<float>()) {
+    adapt(float());
+  }
+  else if (type.is<float2>()) {
+    adapt(float2());
+  }
+  else if (type.is<float3>()) {
+    adapt(float3());
+  }
+  else if (type.is<int>()) {
+    adapt(int());
+  }
+  else if (type.is<Color4f>()) {
+    adapt(Color4f());
+  }
+  else if (type.is<bool>()) {
+    adapt(bool());
+  }
+  return success;
+}
+
+/**
+ * Interpolate an attribute to another domain by averaging the values of adjacent elements.
+ * Domains that are not directly adjacent are interpolated through the point domain.
+ */
+static std::shared_ptr<const AttributeDomainCache::CachedArray> interpolate_mesh_attribute(
+    const Mesh &mesh,
+    AttributeDomainCache &cache,
+    const ReadAttribute &attribute,
+    const AttributeDomain new_domain,
+    const int64_t new_domain_size)
+{
+  const CPPType &type = attribute.cpp_type();
+  const AttributeDomain old_domain = attribute.domain();
+  const fn::GSpan old_values = attribute.get_span();
+
+  auto result = std::make_shared<AttributeDomainCache::CachedArray>(type, new_domain_size);
+  if (try_adapt_mesh_domain_directly(
+          mesh, cache, old_domain, new_domain, old_values, result->span())) {
+    return result;
+  }
+  if (old_domain == ATTR_DOMAIN_POINT || new_domain == ATTR_DOMAIN_POINT) {
+    return {};
+  }
+
+  AttributeDomainCache::CachedArray point_values{type, mesh.totvert};
+  if (!try_adapt_mesh_domain_directly(
+          mesh, cache, old_domain, ATTR_DOMAIN_POINT, old_values, point_values.span())) {
+    return {};
+  }
+  if (!try_adapt_mesh_domain_directly(mesh,
+                                      cache,
+                                      ATTR_DOMAIN_POINT,
+                                      new_domain,
+                                      point_values.span(),
+                                      result->span())) {
+    return {};
+  }
+  return result;
+}
+
+}  // namespace blender::bke
+
+ReadAttributePtr MeshComponent::attribute_try_adapt_domain(ReadAttributePtr attribute,
+                                                           const AttributeDomain domain) const
+{
+  if (!attribute) {
+    return {};
+  }
+  if (attribute->domain() == domain) {
+    return attribute;
+  }
+  if (mesh_ == nullptr) {
+    return {};
+  }
+  if (domain == ATTR_DOMAIN_CORNER) {
+    return blender::bke::try_map_mesh_attribute_to_corners(*mesh_, std::move(attribute));
+  }
+  std::shared_ptr<const blender::bke::AttributeDomainCache::CachedArray> array =
+      blender::bke::interpolate_mesh_attribute(
+          *mesh_, domain_cache_, *attribute, domain, this->attribute_domain_size(domain));
+  if (!array) {
+    return {};
+  }
+  return std::make_unique<blender::bke::CachedArrayReadAttribute>(domain, std::move(array));
+}
+
+ReadAttributePtr MeshComponent::attribute_try_adapt_domain_cached(
+    const StringRef attribute_name, ReadAttributePtr attribute, const AttributeDomain domain) const
+{
+  if (!attribute || attribute->domain() == domain || mesh_ == nullptr ||
+      domain == ATTR_DOMAIN_CORNER) {
+    /* Corner attributes are mapped lazily and are not worth caching. */
+    return this->attribute_try_adapt_domain(std::move(attribute), domain);
+  }
+  std::shared_ptr<const blender::bke::AttributeDomainCache::CachedArray> array =
+      domain_cache_.lookup_or_compute(attribute_name, domain, [&]() {
+        return blender::bke::interpolate_mesh_attribute(
+            *mesh_, domain_cache_, *attribute, domain, this->attribute_domain_size(domain));
+      });
+  if (!array) {
+    return {};
+  }
+  return std::make_unique<blender::bke::CachedArrayReadAttribute>(domain, std::move(array));
+}
+
 WriteAttributePtr MeshComponent::attribute_try_get_for_write(const StringRef attribute_name)
+{
+  WriteAttributePtr attribute = this->attribute_try_get_for_write_impl(attribute_name);
+  if (!attribute) {
+    return {};
+  }
+  /* Interpolated values of the attribute are outdated once it changes. */
+  return std::make_unique<blender::bke::DomainCacheClearingWriteAttribute>(std::move(attribute),
+                                                                           domain_cache_);
+}
+
+WriteAttributePtr MeshComponent::attribute_try_get_for_write_impl(const StringRef attribute_name)
 {
   Mesh *mesh = this->get_for_write();
   if (mesh == nullptr) {
@@ -1137,3 +1681,72 @@ Set<std::string> MeshComponent::attribute_names() const
 }
 
 /** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Instances Component
+ * \{ */
+
+bool InstancesComponent::attribute_domain_supported(const AttributeDomain domain) const
+{
+  return domain == ATTR_DOMAIN_POINT;
+}
+
+bool InstancesComponent::attribute_domain_with_type_supported(
+    const AttributeDomain domain, const CustomDataType data_type) const
+{
+  return domain == ATTR_DOMAIN_POINT && data_type == CD_PROP_FLOAT3;
+}
+
+int InstancesComponent::attribute_domain_size(const AttributeDomain domain) const
+{
+  BLI_assert(domain == ATTR_DOMAIN_POINT);
+  UNUSED_VARS_NDEBUG(domain);
+  return this->instances_amount();
+}
+
+bool InstancesComponent::attribute_is_builtin(const StringRef attribute_name) const
+{
+  return attribute_name == "position" || attribute_name == "rotation" ||
+         attribute_name == "scale";
+}
+
+ReadAttributePtr InstancesComponent::attribute_try_get_for_read(
+    const StringRef attribute_name) const
+{
+  using blender::bke::ArrayReadAttribute;
+  if (attribute_name == "position") {
+    return std::make_unique<ArrayReadAttribute<float3>>(ATTR_DOMAIN_POINT, this->positions());
+  }
+  if (attribute_name == "rotation") {
+    return std::make_unique<ArrayReadAttribute<float3>>(ATTR_DOMAIN_POINT, this->rotations());
+  }
+  if (attribute_name == "scale") {
+    return std::make_unique<ArrayReadAttribute<float3>>(ATTR_DOMAIN_POINT, this->scales());
+  }
+  return {};
+}
+
+WriteAttributePtr InstancesComponent::attribute_try_get_for_write(const StringRef attribute_name)
+{
+  using blender::bke::ArrayWriteAttribute;
+  if (attribute_name == "position") {
+    return std::make_unique<ArrayWriteAttribute<float3>>(ATTR_DOMAIN_POINT, this->positions());
+  }
+  if (attribute_name == "rotation") {
+    return std::make_unique<ArrayWriteAttribute<float3>>(ATTR_DOMAIN_POINT, this->rotations());
+  }
+  if (attribute_name == "scale") {
+    return std::make_unique<ArrayWriteAttribute<float3>>(ATTR_DOMAIN_POINT, this->scales());
+  }
+  return {};
+}
+
+Set<std::string> InstancesComponent::attribute_names() const
+{
+  if (this->is_empty()) {
+    return {};
+  }
+  return {"position", "rotation", "scale"};
+}
+
+/** \} */
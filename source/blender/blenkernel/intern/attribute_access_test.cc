@@ -0,0 +1,232 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BKE_attribute_access.hh"
+#include "BKE_geometry_set.hh"
+#include "BKE_idtype.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+class AttributeAccessTest : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    BKE_idtype_init();
+  }
+};
+
+/* A single quad whose corners reference vertices and edges in a shifted order. */
+static Mesh *create_quad_mesh()
+{
+  Mesh *mesh = BKE_mesh_new_nomain(4, 4, 0, 4, 1);
+  for (const int i : IndexRange(4)) {
+    mesh->medge[i].v1 = i;
+    mesh->medge[i].v2 = (i + 1) % 4;
+    mesh->mloop[i].v = (i + 1) % 4;
+    mesh->mloop[i].e = (i + 2) % 4;
+  }
+  mesh->mpoly[0].loopstart = 0;
+  mesh->mpoly[0].totloop = 4;
+  return mesh;
+}
+
+TEST_F(AttributeAccessTest, ZeroCopySpan)
+{
+  MeshComponent mesh_component;
+  mesh_component.replace(create_quad_mesh());
+  GeometryComponent &component = mesh_component;
+  ASSERT_TRUE(component.attribute_try_create("value", ATTR_DOMAIN_POINT, CD_PROP_FLOAT));
+
+  FloatWriteAttribute write_attribute = component.attribute_try_get_for_write("value");
+  MutableSpan<float> write_span = write_attribute.get_span();
+  write_span.fill(2.0f);
+  write_attribute.apply_span();
+
+  ReadAttributePtr attribute = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_POINT, CD_PROP_FLOAT);
+  ASSERT_TRUE(attribute);
+  const fn::GVSpan virtual_span = attribute->get_virtual_span();
+  EXPECT_TRUE(virtual_span.is_full_array());
+  /* Both spans reference the custom data layer directly. */
+  EXPECT_EQ(virtual_span.as_full_array().data(), write_span.data());
+  EXPECT_EQ(attribute->get_span().data(), write_span.data());
+}
+
+TEST_F(AttributeAccessTest, AdaptPointToCorner)
+{
+  MeshComponent mesh_component;
+  mesh_component.replace(create_quad_mesh());
+  GeometryComponent &component = mesh_component;
+  ASSERT_TRUE(component.attribute_try_create("value", ATTR_DOMAIN_POINT, CD_PROP_FLOAT));
+  FloatWriteAttribute write_attribute = component.attribute_try_get_for_write("value");
+  for (const int i : IndexRange(4)) {
+    write_attribute.set(i, i * 10.0f);
+  }
+
+  FloatReadAttribute attribute = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_CORNER, CD_PROP_FLOAT);
+  EXPECT_EQ(attribute.size(), 4);
+  EXPECT_EQ(attribute[0], 10.0f);
+  EXPECT_EQ(attribute[3], 0.0f);
+  Span<float> span = attribute.get_span();
+  EXPECT_EQ(span[1], 20.0f);
+  EXPECT_EQ(span[2], 30.0f);
+}
+
+TEST_F(AttributeAccessTest, AdaptEdgeAndPolygonToCorner)
+{
+  MeshComponent mesh_component;
+  mesh_component.replace(create_quad_mesh());
+  GeometryComponent &component = mesh_component;
+  ASSERT_TRUE(component.attribute_try_create("edge", ATTR_DOMAIN_EDGE, CD_PROP_INT32));
+  ASSERT_TRUE(component.attribute_try_create("poly", ATTR_DOMAIN_POLYGON, CD_PROP_FLOAT3));
+  {
+    WriteAttributePtr edge_attribute = component.attribute_try_get_for_write("edge");
+    MutableSpan<int> edge_values = edge_attribute->get_span().typed<int>();
+    for (const int i : edge_values.index_range()) {
+      edge_values[i] = i + 100;
+    }
+    edge_attribute->apply_span();
+    Float3WriteAttribute poly_attribute = component.attribute_try_get_for_write("poly");
+    poly_attribute.set(0, float3(1.0f, 2.0f, 3.0f));
+  }
+
+  ReadAttributePtr edge_corners = component.attribute_try_get_for_read(
+      "edge", ATTR_DOMAIN_CORNER, CD_PROP_INT32);
+  ASSERT_TRUE(edge_corners);
+  Span<int> edge_corner_values = edge_corners->get_span().typed<int>();
+  EXPECT_EQ(edge_corner_values[0], 102);
+  EXPECT_EQ(edge_corner_values[3], 101);
+
+  Float3ReadAttribute poly_corners = component.attribute_try_get_for_read(
+      "poly", ATTR_DOMAIN_CORNER, CD_PROP_FLOAT3);
+  for (const int i : IndexRange(4)) {
+    EXPECT_EQ(poly_corners[i], float3(1.0f, 2.0f, 3.0f));
+  }
+}
+
+TEST_F(AttributeAccessTest, InterpolateDomains)
+{
+  MeshComponent mesh_component;
+  mesh_component.replace(create_quad_mesh());
+  GeometryComponent &component = mesh_component;
+  ASSERT_TRUE(component.attribute_try_create("value", ATTR_DOMAIN_CORNER, CD_PROP_FLOAT));
+  {
+    FloatWriteAttribute write_attribute = component.attribute_try_get_for_write("value");
+    for (const int i : IndexRange(4)) {
+      write_attribute.set(i, i * 2.0f);
+    }
+  }
+
+  /* Every vertex is used by one corner. */
+  FloatReadAttribute point_values = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_POINT, CD_PROP_FLOAT);
+  EXPECT_EQ(point_values[1], 0.0f);
+  EXPECT_EQ(point_values[0], 6.0f);
+
+  FloatReadAttribute poly_values = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_POLYGON, CD_PROP_FLOAT);
+  EXPECT_EQ(poly_values[0], 3.0f);
+
+  /* Interpolated through the point domain. The first edge uses the vertices 0 and 1. */
+  FloatReadAttribute edge_values = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_EDGE, CD_PROP_FLOAT);
+  EXPECT_EQ(edge_values.size(), 4);
+  EXPECT_EQ(edge_values[0], 3.0f);
+}
+
+TEST_F(AttributeAccessTest, InterpolationCache)
+{
+  MeshComponent mesh_component;
+  mesh_component.replace(create_quad_mesh());
+  GeometryComponent &component = mesh_component;
+  ASSERT_TRUE(component.attribute_try_create("value", ATTR_DOMAIN_POLYGON, CD_PROP_FLOAT));
+  {
+    FloatWriteAttribute write_attribute = component.attribute_try_get_for_write("value");
+    write_attribute.set(0, 5.0f);
+  }
+
+  ReadAttributePtr attribute_a = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_POINT, CD_PROP_FLOAT);
+  ReadAttributePtr attribute_b = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_POINT, CD_PROP_FLOAT);
+  /* The second request reuses the interpolated array. */
+  EXPECT_EQ(attribute_a->get_span().data(), attribute_b->get_span().data());
+
+  {
+    FloatWriteAttribute write_attribute = component.attribute_try_get_for_write("value");
+    write_attribute.set(0, 7.0f);
+  }
+  FloatReadAttribute attribute_c = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_POINT, CD_PROP_FLOAT);
+  EXPECT_EQ(attribute_c[2], 7.0f);
+  /* Readers of the old values are not affected. */
+  EXPECT_EQ(attribute_a->get_span().typed<float>()[2], 5.0f);
+}
+
+TEST_F(AttributeAccessTest, InterpolationCacheWhileWriting)
+{
+  MeshComponent mesh_component;
+  mesh_component.replace(create_quad_mesh());
+  GeometryComponent &component = mesh_component;
+  ASSERT_TRUE(component.attribute_try_create("value", ATTR_DOMAIN_POLYGON, CD_PROP_FLOAT));
+
+  FloatWriteAttribute write_attribute = component.attribute_try_get_for_write("value");
+  write_attribute.set(0, 5.0f);
+  FloatReadAttribute attribute_a = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_POINT, CD_PROP_FLOAT);
+  EXPECT_EQ(attribute_a[2], 5.0f);
+
+  /* Values written after the attribute was handed out are not hidden by the cache. */
+  MutableSpan<float> write_span = write_attribute.get_span();
+  write_span[0] = 7.0f;
+  write_attribute.apply_span();
+  FloatReadAttribute attribute_b = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_POINT, CD_PROP_FLOAT);
+  EXPECT_EQ(attribute_b[2], 7.0f);
+}
+
+TEST_F(AttributeAccessTest, InterpolationCacheWhileSetting)
+{
+  MeshComponent mesh_component;
+  mesh_component.replace(create_quad_mesh());
+  GeometryComponent &component = mesh_component;
+  ASSERT_TRUE(component.attribute_try_create("value", ATTR_DOMAIN_POLYGON, CD_PROP_FLOAT));
+
+  FloatWriteAttribute write_attribute = component.attribute_try_get_for_write("value");
+  write_attribute.set(0, 5.0f);
+  FloatReadAttribute attribute_a = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_POINT, CD_PROP_FLOAT);
+  EXPECT_EQ(attribute_a[2], 5.0f);
+
+  /* Values set one by one are not hidden by the cache either. */
+  write_attribute.set(0, 9.0f);
+  FloatReadAttribute attribute_b = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_POINT, CD_PROP_FLOAT);
+  EXPECT_EQ(attribute_b[2], 9.0f);
+  FloatReadAttribute attribute_c = component.attribute_try_get_for_read(
+      "value", ATTR_DOMAIN_CORNER, CD_PROP_FLOAT);
+  EXPECT_EQ(attribute_c[1], 9.0f);
+}
+
+}  // namespace blender::bke::tests
@@ -50,6 +50,7 @@
 #include "BKE_layer.h"
 #include "BKE_main.h"
 #include "BKE_node.h"
+#include "BKE_packedFile.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
@@ -82,6 +83,8 @@ void BKE_blender_free(void)
   BKE_main_free(G_MAIN);
   G_MAIN = NULL;
 
+  BKE_packedfile_deferred_undo_free();
+
   if (G.log.file != NULL) {
     fclose(G.log.file);
   }
@@ -52,6 +52,7 @@
 #include "BKE_layer.h"
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
+#include "BKE_main_namemap.h"
 #include "BKE_preferences.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
@@ -201,6 +202,9 @@ static void setup_app_data(bContext *C,
     SWAP(ListBase, bmain->wm, bfd->main->wm);
     SWAP(ListBase, bmain->workspaces, bfd->main->workspaces);
     SWAP(ListBase, bmain->screens, bfd->main->screens);
+    /* The name indices refer to IDs that moved to the other Main. */
+    BKE_main_namemap_clear(bmain);
+    BKE_main_namemap_clear(bfd->main);
 
     /* In case of actual new file reading without loading UI, we need to regenerate the session
      * uuid of the UI-related datablocks we are keeping from previous session, otherwise their uuid
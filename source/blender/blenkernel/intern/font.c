@@ -268,7 +268,7 @@ static VFontData *vfont_get_data(VFont *vfont)
       pf = get_builtin_packedfile();
     }
     else {
-      if (vfont->packedfile) {
+      if (vfont->packedfile && BKE_packedfile_data_acquire(vfont->packedfile)) {
         pf = vfont->packedfile;
 
         /* We need to copy a tmp font to memory unless it is already there */
@@ -301,6 +301,9 @@ static VFontData *vfont_get_data(VFont *vfont)
       if (pf != vfont->packedfile) {
         BKE_packedfile_free(pf);
       }
+      else {
+        BKE_packedfile_data_release(pf);
+      }
     }
 
     BLI_rw_mutex_unlock(&vfont_rwlock);
@@ -339,7 +342,7 @@ VFont *BKE_vfont_load(Main *bmain, const char *filepath)
 
       /* if there's a font name, use it for the ID name */
       if (vfd->name[0] != '\0') {
-        BLI_strncpy(vfont->id.name + 2, vfd->name, sizeof(vfont->id.name) - 2);
+        BKE_libblock_rename(bmain, &vfont->id, vfd->name);
       }
       BLI_strncpy(vfont->filepath, filepath, sizeof(vfont->filepath));
 
@@ -283,6 +283,7 @@ GeometryComponent *MeshComponent::copy() const
   if (mesh_ != nullptr) {
     new_component->mesh_ = BKE_mesh_copy_for_eval(mesh_, false);
     new_component->ownership_ = GeometryOwnershipType::Owned;
+    new_component->vertex_group_names_ = blender::Map(vertex_group_names_);
   }
   return new_component;
 }
@@ -297,6 +298,7 @@ void MeshComponent::clear()
     mesh_ = nullptr;
   }
   vertex_group_names_.clear();
+  domain_cache_.clear();
 }
 
 bool MeshComponent::has_mesh() const
@@ -320,6 +322,7 @@ Mesh *MeshComponent::release()
   BLI_assert(this->is_mutable());
   Mesh *mesh = mesh_;
   mesh_ = nullptr;
+  domain_cache_.clear();
   return mesh;
 }
 
@@ -327,6 +330,7 @@ void MeshComponent::copy_vertex_group_names_from_object(const Object &object)
 {
   BLI_assert(this->is_mutable());
   vertex_group_names_.clear();
+  domain_cache_.clear();
   int index = 0;
   LISTBASE_FOREACH (const bDeformGroup *, group, &object.defbase) {
     vertex_group_names_.add(group->name, index);
@@ -334,6 +338,19 @@ void MeshComponent::copy_vertex_group_names_from_object(const Object &object)
   }
 }
 
+const blender::Map<std::string, int> &MeshComponent::vertex_group_names() const
+{
+  return vertex_group_names_;
+}
+
+/* Changing the names changes the attributes of the mesh, so interpolated values are cleared. */
+blender::Map<std::string, int> &MeshComponent::vertex_group_names()
+{
+  BLI_assert(this->is_mutable());
+  domain_cache_.clear();
+  return vertex_group_names_;
+}
+
 /* Get the mesh from this component. This method can be used by multiple threads at the same
  * time. Therefore, the returned mesh should not be modified. No ownership is transferred. */
 const Mesh *MeshComponent::get_for_read() const
@@ -342,10 +359,13 @@ const Mesh *MeshComponent::get_for_read() const
 }
 
 /* Get the mesh from this component. This method can only be used when the component is mutable,
- * i.e. it is not shared. The returned mesh can be modified. No ownership is transferred. */
+ * i.e. it is not shared. The returned mesh can be modified. No ownership is transferred.
+ * Attributes that have been interpolated to other domains are discarded, since the caller might
+ * change the mesh. */
 Mesh *MeshComponent::get_for_write()
 {
   BLI_assert(this->is_mutable());
+  domain_cache_.clear();
   if (ownership_ == GeometryOwnershipType::ReadOnly) {
     mesh_ = BKE_mesh_copy_for_eval(mesh_, false);
     ownership_ = GeometryOwnershipType::Owned;
@@ -472,6 +492,14 @@ void InstancesComponent::clear()
   scales_.clear();
 }
 
+void InstancesComponent::reserve(const int min_capacity)
+{
+  instanced_data_.reserve(min_capacity);
+  positions_.reserve(min_capacity);
+  rotations_.reserve(min_capacity);
+  scales_.reserve(min_capacity);
+}
+
 void InstancesComponent::add_instance(Object *object,
                                       blender::float3 position,
                                       blender::float3 rotation,
@@ -530,6 +558,16 @@ MutableSpan<float3> InstancesComponent::positions()
   return positions_;
 }
 
+MutableSpan<float3> InstancesComponent::rotations()
+{
+  return rotations_;
+}
+
+MutableSpan<float3> InstancesComponent::scales()
+{
+  return scales_;
+}
+
 int InstancesComponent::instances_amount() const
 {
   const int size = instanced_data_.size();
@@ -0,0 +1,503 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "BKE_collection.h"
+#include "BKE_customdata.h"
+#include "BKE_geometry_set_instances.hh"
+#include "BKE_mesh.h"
+#include "BKE_mesh_wrapper.h"
+#include "BKE_modifier.h"
+#include "BKE_pointcloud.h"
+
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.hh"
+
+#include "DNA_collection_types.h"
+#include "DNA_layer_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "MEM_guardedalloc.h"
+
+namespace blender::bke {
+
+/* Same limit as for the recursion of the dupli system. */
+static constexpr int MaxInstanceRecursionDepth = 8;
+
+/* Number of instances that are realized by one task. */
+static constexpr int64_t RealizeGrainSize = 16;
+
+/* -------------------------------------------------------------------- */
+/** \name Gather Instances
+ * \{ */
+
+struct InstanceGroupsBuilder {
+  Vector<GeometryInstanceGroup> groups;
+  /* Instances of the same object share a group, so that its geometry is only referenced once. */
+  Map<const Object *, int64_t> group_index_by_object;
+};
+
+static GeometrySet object_get_geometry_set_for_read(const Object &object)
+{
+  /* Objects evaluated with the modifier stack have a geometry set already. */
+  if (object.runtime.geometry_set_eval != nullptr) {
+    return *object.runtime.geometry_set_eval;
+  }
+
+  GeometrySet geometry_set;
+  if (object.type == OB_MESH) {
+    Mesh *mesh = BKE_modifier_get_evaluated_mesh_from_evaluated_object(
+        const_cast<Object *>(&object), false);
+    if (mesh != nullptr) {
+      BKE_mesh_wrapper_ensure_mdata(mesh);
+      MeshComponent &mesh_component = geometry_set.get_component_for_write<MeshComponent>();
+      mesh_component.replace(mesh, GeometryOwnershipType::ReadOnly);
+      mesh_component.copy_vertex_group_names_from_object(object);
+    }
+  }
+  return geometry_set;
+}
+
+static bool geometry_set_has_realizable_data(const GeometrySet &geometry_set)
+{
+  return geometry_set.has_mesh() || geometry_set.has_pointcloud();
+}
+
+static void gather_instances_recursive(const GeometrySet &geometry_set,
+                                       const float4x4 &transform,
+                                       const int depth,
+                                       InstanceGroupsBuilder &builder);
+
+static void gather_object_instance(const Object &object,
+                                   const float4x4 &transform,
+                                   const int depth,
+                                   InstanceGroupsBuilder &builder)
+{
+  const int64_t group_index = builder.group_index_by_object.lookup_or_add_cb(&object, [&]() {
+    builder.groups.append({object_get_geometry_set_for_read(object), {}});
+    return builder.groups.size() - 1;
+  });
+  GeometryInstanceGroup &group = builder.groups[group_index];
+  if (geometry_set_has_realizable_data(group.geometry_set)) {
+    group.transforms.append(transform);
+  }
+  if (group.geometry_set.has_instances()) {
+    /* Copy the geometry set, because the group might be reallocated while recursing. */
+    const GeometrySet geometry_set = group.geometry_set;
+    gather_instances_recursive(geometry_set, transform, depth + 1, builder);
+  }
+}
+
+static void gather_instances_recursive(const GeometrySet &geometry_set,
+                                       const float4x4 &transform,
+                                       const int depth,
+                                       InstanceGroupsBuilder &builder)
+{
+  const InstancesComponent *component = geometry_set.get_component_for_read<InstancesComponent>();
+  if (component == nullptr || depth > MaxInstanceRecursionDepth) {
+    return;
+  }
+
+  Span<InstancedData> instanced_data = component->instanced_data();
+  Span<float3> positions = component->positions();
+  Span<float3> rotations = component->rotations();
+  Span<float3> scales = component->scales();
+  for (const int i : IndexRange(component->instances_amount())) {
+    float4x4 instance_transform;
+    loc_eul_size_to_mat4(instance_transform.values, positions[i], rotations[i], scales[i]);
+    instance_transform = transform * instance_transform;
+
+    const InstancedData &data = instanced_data[i];
+    if (data.type == INSTANCE_DATA_TYPE_OBJECT) {
+      if (data.data.object != nullptr) {
+        gather_object_instance(*data.data.object, instance_transform, depth, builder);
+      }
+    }
+    else if (data.type == INSTANCE_DATA_TYPE_COLLECTION) {
+      Collection *collection = data.data.collection;
+      if (collection != nullptr) {
+        float4x4 collection_transform;
+        unit_m4(collection_transform.values);
+        sub_v3_v3(collection_transform.values[3], collection->instance_offset);
+        collection_transform = instance_transform * collection_transform;
+
+        FOREACH_COLLECTION_OBJECT_RECURSIVE_BEGIN (collection, object) {
+          gather_object_instance(
+              *object, collection_transform * float4x4(object->obmat), depth, builder);
+        }
+        FOREACH_COLLECTION_OBJECT_RECURSIVE_END;
+      }
+    }
+  }
+}
+
+/**
+ * Find all the geometry that has to be realized for the given geometry set. The mesh and point
+ * cloud components of the returned groups have to be realized with every transform of the group.
+ * Their instances are included in the other groups already.
+ */
+Vector<GeometryInstanceGroup> geometry_set_gather_instances(const GeometrySet &geometry_set)
+{
+  float4x4 identity;
+  unit_m4(identity.values);
+
+  InstanceGroupsBuilder builder;
+  if (geometry_set_has_realizable_data(geometry_set)) {
+    builder.groups.append({geometry_set, {identity}});
+  }
+  gather_instances_recursive(geometry_set, identity, 0, builder);
+
+  Vector<GeometryInstanceGroup> groups;
+  for (GeometryInstanceGroup &group : builder.groups) {
+    if (!group.transforms.is_empty()) {
+      groups.append(std::move(group));
+    }
+  }
+  return groups;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Realize Instances
+ * \{ */
+
+/**
+ * A single instance of a geometry component and where the elements of every domain start in the
+ * realized geometry.
+ */
+struct RealizeTask {
+  int64_t component_index;
+  float4x4 transform;
+  std::array<int, ATTR_DOMAIN_NUM> offsets;
+};
+
+struct RealizeTasks {
+  /* Every component is only stored once, even when it is instanced many times. */
+  Vector<const GeometryComponent *> components;
+  Vector<RealizeTask> tasks;
+  std::array<int, ATTR_DOMAIN_NUM> domain_sizes;
+};
+
+template<typename Component>
+static RealizeTasks gather_realize_tasks(Span<GeometryInstanceGroup> groups)
+{
+  RealizeTasks realize_tasks;
+  realize_tasks.domain_sizes.fill(0);
+  for (const GeometryInstanceGroup &group : groups) {
+    const Component *component = group.geometry_set.get_component_for_read<Component>();
+    if (component == nullptr || component->is_empty()) {
+      continue;
+    }
+    const int64_t component_index = realize_tasks.components.append_and_get_index(component);
+    for (const float4x4 &transform : group.transforms) {
+      RealizeTask task;
+      task.component_index = component_index;
+      task.transform = transform;
+      for (const int domain : IndexRange(ATTR_DOMAIN_NUM)) {
+        task.offsets[domain] = realize_tasks.domain_sizes[domain];
+        if (component->attribute_domain_supported((AttributeDomain)domain)) {
+          realize_tasks.domain_sizes[domain] += component->attribute_domain_size(
+              (AttributeDomain)domain);
+        }
+      }
+      realize_tasks.tasks.append(task);
+    }
+  }
+  return realize_tasks;
+}
+
+static void determine_final_data_type_and_domain(Span<const GeometryComponent *> components,
+                                                 StringRef attribute_name,
+                                                 CustomDataType *r_type,
+                                                 AttributeDomain *r_domain)
+{
+  for (const GeometryComponent *component : components) {
+    ReadAttributePtr attribute = component->attribute_try_get_for_read(attribute_name);
+    if (attribute) {
+      *r_type = cpp_type_to_custom_data_type(attribute->cpp_type());
+      *r_domain = attribute->domain();
+      return;
+    }
+  }
+  BLI_assert(false);
+}
+
+/**
+ * Copy the attributes of all instances into the realized component. The source attributes are
+ * only read once for every component, the copies are done in parallel.
+ */
+static void realize_attributes(const RealizeTasks &realize_tasks,
+                               GeometryComponent &result,
+                               Span<StringRef> ignored_attributes = {})
+{
+  Set<std::string> attribute_names;
+  for (const GeometryComponent *component : realize_tasks.components) {
+    for (const std::string &name : component->attribute_names()) {
+      attribute_names.add(name);
+    }
+  }
+  for (StringRef name : ignored_attributes) {
+    attribute_names.remove(name);
+  }
+
+  for (const std::string &attribute_name : attribute_names) {
+    CustomDataType data_type;
+    AttributeDomain domain;
+    determine_final_data_type_and_domain(
+        realize_tasks.components, attribute_name, &data_type, &domain);
+
+    result.attribute_try_create(attribute_name, domain, data_type);
+    WriteAttributePtr write_attribute = result.attribute_try_get_for_write(attribute_name);
+    if (!write_attribute ||
+        &write_attribute->cpp_type() != custom_data_type_to_cpp_type(data_type) ||
+        write_attribute->domain() != domain) {
+      continue;
+    }
+
+    /* Getting the spans is not thread-safe, so it is done before the parallel loop. */
+    Vector<ReadAttributePtr> read_attributes;
+    Vector<fn::GSpan> src_spans;
+    for (const GeometryComponent *component : realize_tasks.components) {
+      ReadAttributePtr read_attribute = component->attribute_get_for_read(
+          attribute_name, domain, data_type, nullptr);
+      src_spans.append(read_attribute->get_span());
+      read_attributes.append(std::move(read_attribute));
+    }
+
+    const CPPType &cpp_type = write_attribute->cpp_type();
+    fn::GMutableSpan dst_span = write_attribute->get_span();
+    parallel_for(realize_tasks.tasks.index_range(), RealizeGrainSize, [&](IndexRange range) {
+      for (const int64_t task_index : range) {
+        const RealizeTask &task = realize_tasks.tasks[task_index];
+        const fn::GSpan src_span = src_spans[task.component_index];
+        cpp_type.copy_to_initialized_n(
+            src_span.data(), dst_span[task.offsets[domain]], src_span.size());
+      }
+    });
+    write_attribute->apply_span();
+  }
+}
+
+/**
+ * Add the vertex group names of all meshes to the realized component. For every component, the
+ * returned arrays map its vertex group indices to the indices in the realized mesh. Indices
+ * without a name are mapped to -1.
+ */
+static Array<Array<int>> realize_vertex_group_names(const RealizeTasks &realize_tasks,
+                                                    Map<std::string, int> &r_names)
+{
+  Array<Array<int>> group_maps(realize_tasks.components.size());
+  for (const int64_t component_index : realize_tasks.components.index_range()) {
+    const Map<std::string, int> &names =
+        static_cast<const MeshComponent *>(realize_tasks.components[component_index])
+            ->vertex_group_names();
+    int groups_num = 0;
+    for (const int index : names.values()) {
+      groups_num = std::max(groups_num, index + 1);
+    }
+    /* Add the names in the order of their indices, so that the result does not depend on the
+     * order of the map. */
+    Array<const std::string *> names_by_index(groups_num, nullptr);
+    for (Map<std::string, int>::Item item : names.items()) {
+      names_by_index[item.value] = &item.key;
+    }
+    Array<int> &group_map = group_maps[component_index];
+    group_map = Array<int>(groups_num, -1);
+    for (const int index : names_by_index.index_range()) {
+      if (names_by_index[index] != nullptr) {
+        group_map[index] = r_names.lookup_or_add(*names_by_index[index], r_names.size());
+      }
+    }
+  }
+  return group_maps;
+}
+
+static void copy_dvert_with_group_map(const MDeformVert &src,
+                                      Span<int> group_map,
+                                      MDeformVert &dst)
+{
+  auto is_mapped = [&](const MDeformWeight &weight) {
+    return weight.def_nr >= 0 && weight.def_nr < group_map.size() &&
+           group_map[weight.def_nr] != -1;
+  };
+  int totweight = 0;
+  for (const MDeformWeight &weight : Span(src.dw, src.totweight)) {
+    totweight += is_mapped(weight) ? 1 : 0;
+  }
+  dst.flag = src.flag;
+  dst.totweight = totweight;
+  if (totweight == 0) {
+    dst.dw = nullptr;
+    return;
+  }
+  dst.dw = (MDeformWeight *)MEM_malloc_arrayN(totweight, sizeof(MDeformWeight), __func__);
+  int dst_index = 0;
+  for (const MDeformWeight &weight : Span(src.dw, src.totweight)) {
+    if (is_mapped(weight)) {
+      dst.dw[dst_index].def_nr = group_map[weight.def_nr];
+      dst.dw[dst_index].weight = weight.weight;
+      dst_index++;
+    }
+  }
+}
+
+static void realize_meshes(Span<GeometryInstanceGroup> groups, GeometrySet &result)
+{
+  const RealizeTasks realize_tasks = gather_realize_tasks<MeshComponent>(groups);
+  if (realize_tasks.tasks.is_empty()) {
+    return;
+  }
+
+  const Mesh *first_mesh =
+      static_cast<const MeshComponent *>(realize_tasks.components[0])->get_for_read();
+  Mesh *new_mesh = BKE_mesh_new_nomain(realize_tasks.domain_sizes[ATTR_DOMAIN_POINT],
+                                       realize_tasks.domain_sizes[ATTR_DOMAIN_EDGE],
+                                       0,
+                                       realize_tasks.domain_sizes[ATTR_DOMAIN_CORNER],
+                                       realize_tasks.domain_sizes[ATTR_DOMAIN_POLYGON]);
+  BKE_mesh_copy_settings(new_mesh, first_mesh);
+
+  MeshComponent &dst_component = result.get_component_for_write<MeshComponent>();
+  dst_component.replace(new_mesh);
+
+  /* Vertex groups are not copied as attributes, that would add every vertex to every group. */
+  Map<std::string, int> &vertex_group_names = dst_component.vertex_group_names();
+  const Array<Array<int>> vertex_group_maps = realize_vertex_group_names(realize_tasks,
+                                                                         vertex_group_names);
+  if (!vertex_group_names.is_empty()) {
+    new_mesh->dvert = (MDeformVert *)CustomData_add_layer(
+        &new_mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, nullptr, new_mesh->totvert);
+  }
+
+  parallel_for(realize_tasks.tasks.index_range(), RealizeGrainSize, [&](IndexRange range) {
+    for (const int64_t task_index : range) {
+      const RealizeTask &task = realize_tasks.tasks[task_index];
+      const Mesh &mesh =
+          *static_cast<const MeshComponent *>(realize_tasks.components[task.component_index])
+               ->get_for_read();
+      const int vert_offset = task.offsets[ATTR_DOMAIN_POINT];
+      const int edge_offset = task.offsets[ATTR_DOMAIN_EDGE];
+      const int loop_offset = task.offsets[ATTR_DOMAIN_CORNER];
+      const int poly_offset = task.offsets[ATTR_DOMAIN_POLYGON];
+
+      for (const int i : IndexRange(mesh.totvert)) {
+        const MVert &old_vert = mesh.mvert[i];
+        MVert &new_vert = new_mesh->mvert[vert_offset + i];
+        new_vert = old_vert;
+        const float3 new_position = task.transform * float3(old_vert.co);
+        copy_v3_v3(new_vert.co, new_position);
+      }
+      for (const int i : IndexRange(mesh.totedge)) {
+        const MEdge &old_edge = mesh.medge[i];
+        MEdge &new_edge = new_mesh->medge[edge_offset + i];
+        new_edge = old_edge;
+        new_edge.v1 += vert_offset;
+        new_edge.v2 += vert_offset;
+      }
+      for (const int i : IndexRange(mesh.totloop)) {
+        const MLoop &old_loop = mesh.mloop[i];
+        MLoop &new_loop = new_mesh->mloop[loop_offset + i];
+        new_loop = old_loop;
+        new_loop.v += vert_offset;
+        new_loop.e += edge_offset;
+      }
+      for (const int i : IndexRange(mesh.totpoly)) {
+        const MPoly &old_poly = mesh.mpoly[i];
+        MPoly &new_poly = new_mesh->mpoly[poly_offset + i];
+        new_poly = old_poly;
+        new_poly.loopstart += loop_offset;
+      }
+      if (new_mesh->dvert != nullptr && mesh.dvert != nullptr) {
+        const Span<int> group_map = vertex_group_maps[task.component_index];
+        for (const int i : IndexRange(mesh.totvert)) {
+          copy_dvert_with_group_map(mesh.dvert[i], group_map, new_mesh->dvert[vert_offset + i]);
+        }
+      }
+    }
+  });
+
+  /* The position attribute and the vertex groups are handled above already. */
+  Vector<StringRef> ignored_attributes = {"position"};
+  for (StringRef name : vertex_group_names.keys()) {
+    ignored_attributes.append(name);
+  }
+  realize_attributes(realize_tasks, dst_component, ignored_attributes);
+  BKE_mesh_calc_normals(new_mesh);
+}
+
+static void realize_pointclouds(Span<GeometryInstanceGroup> groups, GeometrySet &result)
+{
+  const RealizeTasks realize_tasks = gather_realize_tasks<PointCloudComponent>(groups);
+  if (realize_tasks.tasks.is_empty()) {
+    return;
+  }
+
+  PointCloud *new_pointcloud = BKE_pointcloud_new_nomain(
+      realize_tasks.domain_sizes[ATTR_DOMAIN_POINT]);
+  PointCloudComponent &dst_component = result.get_component_for_write<PointCloudComponent>();
+  dst_component.replace(new_pointcloud);
+
+  realize_attributes(realize_tasks, dst_component);
+
+  /* The positions have been copied with the other attributes, they only have to be transformed. */
+  parallel_for(realize_tasks.tasks.index_range(), RealizeGrainSize, [&](IndexRange range) {
+    for (const int64_t task_index : range) {
+      const RealizeTask &task = realize_tasks.tasks[task_index];
+      const int points_num = realize_tasks.components[task.component_index]->attribute_domain_size(
+          ATTR_DOMAIN_POINT);
+      for (const int i : IndexRange(task.offsets[ATTR_DOMAIN_POINT], points_num)) {
+        const float3 new_position = task.transform * float3(new_pointcloud->co[i]);
+        copy_v3_v3(new_pointcloud->co[i], new_position);
+      }
+    }
+  });
+}
+
+/**
+ * Turn all instances in the geometry set into real geometry. Instances that reference the same
+ * object share its geometry until it is copied into the result in parallel. Geometry sets without
+ * instances are returned unchanged, without copying any data.
+ */
+GeometrySet geometry_set_realize_instances(const GeometrySet &geometry_set)
+{
+  if (!geometry_set.has_instances()) {
+    return geometry_set;
+  }
+
+  const Vector<GeometryInstanceGroup> groups = geometry_set_gather_instances(geometry_set);
+  return geometry_set_realize_instance_groups(groups);
+}
+
+/**
+ * Copy the meshes and point clouds of all groups into a single mesh and point cloud, once for
+ * every transform of a group. Instances of the groups are ignored. Besides realizing instances,
+ * this is used to join geometry sets, with an identity transform for every set.
+ */
+GeometrySet geometry_set_realize_instance_groups(Span<GeometryInstanceGroup> groups)
+{
+  GeometrySet new_geometry_set;
+  realize_meshes(groups, new_geometry_set);
+  realize_pointclouds(groups, new_geometry_set);
+  return new_geometry_set;
+}
+
+/** \} */
+
+}  // namespace blender::bke
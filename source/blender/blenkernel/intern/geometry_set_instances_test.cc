@@ -0,0 +1,149 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BKE_customdata.h"
+#include "BKE_geometry_set_instances.hh"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_pointcloud_types.h"
+
+namespace blender::bke::tests {
+
+class GeometrySetInstancesTest : public testing::Test {
+ protected:
+  Object *object_ = nullptr;
+
+  void SetUp() override
+  {
+    BKE_idtype_init();
+
+    /* An object with a single triangle as evaluated geometry. */
+    Mesh *mesh = BKE_mesh_new_nomain(3, 3, 0, 3, 1);
+    for (const int i : IndexRange(3)) {
+      mesh->mvert[i].co[0] = (float)i;
+      mesh->medge[i].v1 = i;
+      mesh->medge[i].v2 = (i + 1) % 3;
+      mesh->mloop[i].v = i;
+      mesh->mloop[i].e = i;
+    }
+    mesh->mpoly[0].loopstart = 0;
+    mesh->mpoly[0].totloop = 3;
+
+    object_ = static_cast<Object *>(BKE_id_new_nomain(ID_OB, "Instanced"));
+    object_->type = OB_MESH;
+    object_->runtime.geometry_set_eval = new GeometrySet(GeometrySet::create_with_mesh(mesh));
+  }
+
+  void TearDown() override
+  {
+    BKE_geometry_set_free(object_->runtime.geometry_set_eval);
+    object_->runtime.geometry_set_eval = nullptr;
+    BKE_id_free(nullptr, object_);
+  }
+};
+
+TEST_F(GeometrySetInstancesTest, GatherInstancesOfSameObject)
+{
+  GeometrySet geometry_set;
+  InstancesComponent &instances = geometry_set.get_component_for_write<InstancesComponent>();
+  for (const int i : IndexRange(100)) {
+    instances.add_instance(object_, float3(0.0f, (float)i, 0.0f));
+  }
+
+  Vector<GeometryInstanceGroup> groups = geometry_set_gather_instances(geometry_set);
+  EXPECT_EQ(groups.size(), 1);
+  EXPECT_EQ(groups[0].transforms.size(), 100);
+  EXPECT_EQ(groups[0].transforms[10].values[3][1], 10.0f);
+}
+
+TEST_F(GeometrySetInstancesTest, RealizeMeshInstances)
+{
+  GeometrySet geometry_set;
+  InstancesComponent &instances = geometry_set.get_component_for_write<InstancesComponent>();
+  instances.add_instance(object_, float3(0.0f, 0.0f, 1.0f));
+  instances.add_instance(object_, float3(0.0f, 0.0f, 2.0f), float3(0.0f), float3(2.0f));
+
+  GeometrySet realized = geometry_set_realize_instances(geometry_set);
+  EXPECT_FALSE(realized.has_instances());
+  const Mesh *mesh = realized.get_mesh_for_read();
+  ASSERT_NE(mesh, nullptr);
+  EXPECT_EQ(mesh->totvert, 6);
+  EXPECT_EQ(mesh->totpoly, 2);
+  EXPECT_EQ(mesh->mpoly[1].loopstart, 3);
+  EXPECT_EQ(mesh->mloop[4].v, 4);
+  EXPECT_EQ(mesh->medge[5].v2, 3);
+  EXPECT_EQ(float3(mesh->mvert[2].co), float3(2.0f, 0.0f, 1.0f));
+  EXPECT_EQ(float3(mesh->mvert[5].co), float3(4.0f, 0.0f, 2.0f));
+}
+
+TEST_F(GeometrySetInstancesTest, RealizeVertexGroups)
+{
+  MeshComponent &mesh_component =
+      object_->runtime.geometry_set_eval->get_component_for_write<MeshComponent>();
+  mesh_component.vertex_group_names().add("group", 0);
+  {
+    FloatWriteAttribute weights = mesh_component.attribute_try_get_for_write("group");
+    weights.set(1, 0.5f);
+  }
+
+  GeometrySet geometry_set;
+  InstancesComponent &instances = geometry_set.get_component_for_write<InstancesComponent>();
+  instances.add_instance(object_, float3(0.0f, 0.0f, 1.0f));
+  instances.add_instance(object_, float3(0.0f, 0.0f, 2.0f));
+
+  GeometrySet realized = geometry_set_realize_instances(geometry_set);
+  const MeshComponent *realized_component = realized.get_component_for_read<MeshComponent>();
+  ASSERT_NE(realized_component, nullptr);
+  EXPECT_TRUE(realized_component->vertex_group_names().contains("group"));
+
+  const Mesh *mesh = realized_component->get_for_read();
+  ASSERT_NE(mesh->dvert, nullptr);
+  EXPECT_EQ(mesh->dvert[3].totweight, 0);
+  EXPECT_EQ(mesh->dvert[4].totweight, 1);
+  EXPECT_EQ(mesh->dvert[4].dw[0].weight, 0.5f);
+  /* The weights are not copied into a generic attribute as well. */
+  EXPECT_EQ(CustomData_get_named_layer_index(&mesh->vdata, CD_PROP_FLOAT, "group"), -1);
+}
+
+TEST_F(GeometrySetInstancesTest, InstanceAttributes)
+{
+  GeometrySet geometry_set;
+  InstancesComponent &instances = geometry_set.get_component_for_write<InstancesComponent>();
+  instances.add_instance(object_, float3(1.0f, 0.0f, 0.0f));
+  GeometryComponent &component = instances;
+
+  EXPECT_TRUE(component.attribute_exists("scale"));
+  EXPECT_FALSE(component.attribute_try_create("other", ATTR_DOMAIN_POINT, CD_PROP_FLOAT3));
+  {
+    Float3WriteAttribute scale = component.attribute_try_get_for_write("scale");
+    scale.set(0, float3(3.0f));
+  }
+  EXPECT_EQ(instances.scales()[0], float3(3.0f));
+
+  Float3ReadAttribute position = component.attribute_try_get_for_read(
+      "position", ATTR_DOMAIN_POINT, CD_PROP_FLOAT3);
+  EXPECT_EQ(position[0], float3(1.0f, 0.0f, 0.0f));
+}
+
+}  // namespace blender::bke::tests
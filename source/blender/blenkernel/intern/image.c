@@ -605,6 +605,11 @@ static void copy_image_packedfiles(ListBase *lb_dst, const ListBase *lb_src)
 
     if (imapf_src->packedfile) {
       imapf_dst->packedfile = BKE_packedfile_duplicate(imapf_src->packedfile);
+      if (imapf_dst->packedfile == NULL) {
+        /* The deferred data of the source could not be read. */
+        MEM_freeN(imapf_dst);
+        continue;
+      }
     }
 
     BLI_addtail(lb_dst, imapf_dst);
@@ -4397,12 +4402,13 @@ static ImBuf *load_image_single(Image *ima,
     flag |= imbuf_alpha_flags_for_image(ima);
 
     imapf = BLI_findlink(&ima->packedfiles, view_id);
-    if (imapf->packedfile) {
+    if (imapf->packedfile && BKE_packedfile_data_acquire(imapf->packedfile)) {
       ibuf = IMB_ibImageFromMemory((unsigned char *)imapf->packedfile->data,
                                    imapf->packedfile->size,
                                    flag,
                                    ima->colorspace_settings.name,
                                    "<packed data>");
+      BKE_packedfile_data_release(imapf->packedfile);
     }
   }
   else {
@@ -0,0 +1,146 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+
+#include "DNA_ID.h"
+
+namespace blender::bke::tests {
+
+class LibIDMainNameTest : public testing::Test {
+ protected:
+  Main *bmain;
+
+  void SetUp() override
+  {
+    BKE_idtype_init();
+    bmain = BKE_main_new();
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+  }
+
+  ID *add_camera(const char *name)
+  {
+    return (ID *)BKE_id_new(bmain, ID_CA, name);
+  }
+};
+
+TEST_F(LibIDMainNameTest, unique_names)
+{
+  ID *id_a = add_camera("Cam");
+  ID *id_b = add_camera("Cam");
+  ID *id_c = add_camera("Cam");
+  EXPECT_STREQ(id_a->name + 2, "Cam");
+  EXPECT_STREQ(id_b->name + 2, "Cam.001");
+  EXPECT_STREQ(id_c->name + 2, "Cam.002");
+
+  /* Freed numbers are used again. */
+  BKE_id_free(bmain, id_b);
+  ID *id_d = add_camera("Cam");
+  EXPECT_STREQ(id_d->name + 2, "Cam.001");
+
+  /* An unused name is kept as is. */
+  ID *id_e = add_camera("Cam.010");
+  EXPECT_STREQ(id_e->name + 2, "Cam.010");
+  ID *id_f = add_camera("Cam.010");
+  EXPECT_STREQ(id_f->name + 2, "Cam.003");
+
+  /* The list stays sorted. */
+  const char *names_expected[] = {"Cam", "Cam.001", "Cam.002", "Cam.003", "Cam.010"};
+  int i = 0;
+  LISTBASE_FOREACH (ID *, id, &bmain->cameras) {
+    EXPECT_STREQ(id->name + 2, names_expected[i++]);
+  }
+  EXPECT_EQ(i, 5);
+}
+
+TEST_F(LibIDMainNameTest, rename)
+{
+  ID *id_a = add_camera("Cam");
+  ID *id_b = add_camera("Other");
+
+  BKE_libblock_rename(bmain, id_b, "Cam");
+  EXPECT_STREQ(id_b->name + 2, "Cam.001");
+
+  BKE_libblock_rename(bmain, id_a, "First");
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_CA, "Cam"), nullptr);
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_CA, "First"), id_a);
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_CA, "Cam.001"), id_b);
+
+  /* Renaming to the own name keeps it. */
+  BKE_libblock_rename(bmain, id_b, "Cam.001");
+  EXPECT_STREQ(id_b->name + 2, "Cam.001");
+
+  /* Names set directly are picked up. */
+  BLI_strncpy(id_a->name + 2, "Cam.001", sizeof(id_a->name) - 2);
+  BLI_libblock_ensure_unique_name(bmain, id_a->name);
+  EXPECT_STRNE(id_a->name + 2, id_b->name + 2);
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_CA, id_a->name + 2), id_a);
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_CA, id_b->name + 2), id_b);
+}
+
+TEST_F(LibIDMainNameTest, main_add)
+{
+  ID *id_a = add_camera("Cam");
+  /* Build the index before the new ID is added. */
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_CA, "Cam"), id_a);
+
+  ID *id_b = (ID *)BKE_id_new_nomain(ID_CA, "Cam");
+  BKE_libblock_management_main_add(bmain, id_b);
+  EXPECT_STREQ(id_b->name + 2, "Cam.001");
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_CA, "Cam"), id_a);
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_CA, "Cam.001"), id_b);
+
+  /* The name of the other ID is still in use. */
+  ID *id_c = add_camera("Cam");
+  EXPECT_STREQ(id_c->name + 2, "Cam.002");
+}
+
+TEST_F(LibIDMainNameTest, many_names)
+{
+  const int ids_num = 3000;
+  for (int i = 0; i < ids_num; i++) {
+    add_camera("Cam");
+  }
+  EXPECT_EQ(BLI_listbase_count(&bmain->cameras), ids_num);
+  EXPECT_NE(BKE_libblock_find_name(bmain, ID_CA, "Cam.2999"), nullptr);
+
+  for (ID *id = (ID *)bmain->cameras.first; id->next; id = (ID *)id->next) {
+    EXPECT_LT(BLI_strcasecmp(id->name, ((ID *)id->next)->name), 0);
+  }
+
+  /* Beyond the numbers that are used again, new names get a higher number. */
+  ID *id = (ID *)BKE_libblock_find_name(bmain, ID_CA, "Cam.2000");
+  ASSERT_NE(id, nullptr);
+  BKE_id_free(bmain, id);
+  EXPECT_EQ(BKE_libblock_find_name(bmain, ID_CA, "Cam.2000"), nullptr);
+  EXPECT_STREQ(add_camera("Cam")->name + 2, "Cam.3000");
+}
+
+}  // namespace blender::bke::tests
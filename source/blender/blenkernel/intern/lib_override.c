@@ -46,6 +46,7 @@
 #include "BKE_lib_query.h"
 #include "BKE_lib_remap.h"
 #include "BKE_main.h"
+#include "BKE_main_namemap.h"
 #include "BKE_scene.h"
 
 #include "BLI_ghash.h"
@@ -1757,7 +1758,9 @@ void BKE_lib_override_library_update(Main *bmain, ID *local)
    * different from reference linked ID. But local ID names need to be unique in a given type
    * list of Main, so we cannot always keep it identical, which is why we need this special
    * manual handling here. */
+  BKE_main_namemap_remove_name(bmain, tmp_id, tmp_id->name + 2);
   BLI_strncpy(tmp_id->name, local->name, sizeof(tmp_id->name));
+  BKE_main_namemap_add_name(bmain, tmp_id);
 
   /* Those ugly loop-back pointers again. Luckily we only need to deal with the shape keys here,
    * collections' parents are fully runtime and reconstructed later. */
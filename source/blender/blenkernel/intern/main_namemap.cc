@@ -0,0 +1,288 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <algorithm>
+#include <bitset>
+#include <string>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_map.hh"
+#include "BLI_string.h"
+#include "BLI_string_utils.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_ID.h"
+
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+#include "BKE_main_namemap.h" /* own include */
+
+using blender::Map;
+
+/* -------------------------------------------------------------------- */
+/** \name BKE_main_namemap API
+ * \{ */
+
+struct NameNumbers {
+  /** Numbers in use below #MAIN_NAMEMAP_NUMBERS_IN_USE_MAX, zero is the base name itself. */
+  std::bitset<MAIN_NAMEMAP_NUMBERS_IN_USE_MAX> used;
+  /** Highest number ever used for the base name, this is not lowered when IDs are removed. */
+  int max_used = -1;
+};
+
+struct LocalName {
+  /** An ID using the name. */
+  ID *id = nullptr;
+  /** Local names are unique, but may not be while they are made unique. */
+  int users = 0;
+};
+
+struct TypeNameMap {
+  bool is_valid = false;
+  /** Local IDs by `ID.name + 2`, linked IDs don't have to be unique. */
+  Map<std::string, LocalName> local_ids;
+  Map<std::string, NameNumbers> numbers;
+  /** Number of linked IDs using a name. */
+  Map<std::string, int> linked_names;
+};
+
+struct MainNameMap {
+  TypeNameMap types[INDEX_ID_MAX];
+
+  MEM_CXX_CLASS_ALLOC_FUNCS("MainNameMap")
+};
+
+static int namemap_split_name(const char *name, char *base_name)
+{
+  int number = 0;
+  BLI_split_name_num(base_name, &number, name, '.');
+  return number;
+}
+
+/**
+ * Whether `name` is the name that is generated for its number, e.g. `name.001` or `name`
+ * but not `name.1`. Only these free their number when removed, since other names with the same
+ * number may still exist.
+ */
+static bool namemap_name_is_canonical(const char *name, const char *base_name, const int number)
+{
+  if (number == 0) {
+    return STREQ(name, base_name);
+  }
+  char canonical_name[MAX_ID_NAME];
+  BLI_snprintf(canonical_name, sizeof(canonical_name), "%s.%.3d", base_name, number);
+  return STREQ(name, canonical_name);
+}
+
+static void namemap_type_add(TypeNameMap &type_map, ID *id)
+{
+  const char *name = id->name + 2;
+  if (ID_IS_LINKED(id)) {
+    type_map.linked_names.lookup_or_add(name, 0)++;
+    return;
+  }
+  /* Keep the first ID when names are not unique (yet), like a search in the list would. */
+  LocalName &local_name = type_map.local_ids.lookup_or_add_default(name);
+  if (local_name.users++ == 0) {
+    local_name.id = id;
+  }
+
+  char base_name[MAX_ID_NAME];
+  const int number = namemap_split_name(name, base_name);
+  NameNumbers &numbers = type_map.numbers.lookup_or_add_default(base_name);
+  if (number < MAIN_NAMEMAP_NUMBERS_IN_USE_MAX) {
+    numbers.used.set((size_t)number);
+  }
+  numbers.max_used = std::max(numbers.max_used, number);
+}
+
+/** Find another local ID using `name`, only needed when names are not unique. */
+static ID *namemap_local_id_find_other(Main *bmain, const ID *id_other, const char *name)
+{
+  ListBase *lb = which_libbase(bmain, GS(id_other->name));
+  LISTBASE_FOREACH (ID *, id, lb) {
+    if (id != id_other && !ID_IS_LINKED(id) && STREQ(id->name + 2, name)) {
+      return id;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * \param r_is_built: Set to true when the index was built from the list, it then already contains
+ * all IDs in the list with their current names.
+ */
+static TypeNameMap &namemap_type_ensure_ex(Main *bmain, const short id_type, bool *r_is_built)
+{
+  if (bmain->name_map == nullptr) {
+    bmain->name_map = new MainNameMap();
+  }
+  TypeNameMap &type_map = bmain->name_map->types[BKE_idtype_idcode_to_index(id_type)];
+  *r_is_built = !type_map.is_valid;
+  if (!type_map.is_valid) {
+    ListBase *lb = which_libbase(bmain, id_type);
+    LISTBASE_FOREACH (ID *, id, lb) {
+      namemap_type_add(type_map, id);
+    }
+    type_map.is_valid = true;
+  }
+  return type_map;
+}
+
+static TypeNameMap &namemap_type_ensure(Main *bmain, const short id_type)
+{
+  bool is_built;
+  return namemap_type_ensure_ex(bmain, id_type, &is_built);
+}
+
+void BKE_main_namemap_destroy(MainNameMap **r_name_map)
+{
+  delete *r_name_map;
+  *r_name_map = nullptr;
+}
+
+/**
+ * Invalidate the index of all types, for when IDs are added, removed or renamed without going
+ * through `BKE_lib_id` functions.
+ */
+void BKE_main_namemap_clear(Main *bmain)
+{
+  BKE_main_namemap_destroy(&bmain->name_map);
+}
+
+void BKE_main_namemap_clear_type(Main *bmain, const short id_type)
+{
+  if (bmain->name_map == nullptr) {
+    return;
+  }
+  TypeNameMap &type_map = bmain->name_map->types[BKE_idtype_idcode_to_index(id_type)];
+  type_map.local_ids.clear();
+  type_map.numbers.clear();
+  type_map.linked_names.clear();
+  type_map.is_valid = false;
+}
+
+/**
+ * Register the current name of an ID that is in the lists of `bmain`.
+ */
+void BKE_main_namemap_add_name(Main *bmain, ID *id)
+{
+  bool is_built;
+  TypeNameMap &type_map = namemap_type_ensure_ex(bmain, GS(id->name), &is_built);
+  if (!is_built) {
+    namemap_type_add(type_map, id);
+  }
+}
+
+/**
+ * Unregister `name` for `id`, for IDs that are removed from `bmain` or renamed.
+ * `id` must have been registered with that name, see #BKE_main_namemap_add_name.
+ */
+void BKE_main_namemap_remove_name(Main *bmain, ID *id, const char *name)
+{
+  TypeNameMap &type_map = namemap_type_ensure(bmain, GS(id->name));
+  if (ID_IS_LINKED(id)) {
+    int *users = type_map.linked_names.lookup_ptr(name);
+    if (users != nullptr && --(*users) == 0) {
+      type_map.linked_names.remove(name);
+    }
+    return;
+  }
+  LocalName *local_name = type_map.local_ids.lookup_ptr(name);
+  if (local_name == nullptr || (local_name->users == 1 && local_name->id != id)) {
+    /* The name is not used by `id`, don't free it for another ID. */
+    return;
+  }
+  if (--local_name->users > 0) {
+    if (local_name->id == id) {
+      local_name->id = namemap_local_id_find_other(bmain, id, name);
+    }
+    return;
+  }
+  type_map.local_ids.remove(name);
+
+  char base_name[MAX_ID_NAME];
+  const int number = namemap_split_name(name, base_name);
+  if (number < MAIN_NAMEMAP_NUMBERS_IN_USE_MAX &&
+      namemap_name_is_canonical(name, base_name, number)) {
+    NameNumbers *numbers = type_map.numbers.lookup_ptr(base_name);
+    if (numbers != nullptr) {
+      numbers->used.reset((size_t)number);
+    }
+  }
+}
+
+/**
+ * Check if a local ID other than `id_ignore` uses `name`.
+ */
+bool BKE_main_namemap_contains_name(Main *bmain,
+                                    const short id_type,
+                                    const char *name,
+                                    const ID *id_ignore)
+{
+  TypeNameMap &type_map = namemap_type_ensure(bmain, id_type);
+  LocalName *local_name = type_map.local_ids.lookup_ptr(name);
+  if (local_name == nullptr) {
+    return false;
+  }
+  return local_name->users > 1 || local_name->id != id_ignore;
+}
+
+/**
+ * Get the number to use for a new name with `base_name`: the smallest unused one below
+ * #MAIN_NAMEMAP_NUMBERS_IN_USE_MAX, otherwise one higher than all used ones (and at least
+ * `number_min`).
+ */
+int BKE_main_namemap_get_unused_number(Main *bmain,
+                                       const short id_type,
+                                       const char *base_name,
+                                       const int number_min)
+{
+  TypeNameMap &type_map = namemap_type_ensure(bmain, id_type);
+  const NameNumbers *numbers = type_map.numbers.lookup_ptr(base_name);
+  if (numbers == nullptr) {
+    return number_min;
+  }
+  for (int number = 1; number < MAIN_NAMEMAP_NUMBERS_IN_USE_MAX; number++) {
+    if (!numbers->used.test((size_t)number)) {
+      return number;
+    }
+  }
+  return std::max(number_min, numbers->max_used + 1);
+}
+
+/**
+ * Find an ID by name, local IDs take precedence over linked ones.
+ */
+ID *BKE_main_namemap_find_name(Main *bmain, const short id_type, const char *name)
+{
+  TypeNameMap &type_map = namemap_type_ensure(bmain, id_type);
+  LocalName *local_name = type_map.local_ids.lookup_ptr(name);
+  ID *id = (local_name != nullptr) ? local_name->id : nullptr;
+  if (id == nullptr && type_map.linked_names.contains(name)) {
+    ListBase *lb = which_libbase(bmain, id_type);
+    id = (ID *)BLI_findstring(lb, name, offsetof(ID, name) + 2);
+  }
+  return id;
+}
+
+/** \} */
@@ -41,6 +41,8 @@
 #include "DNA_volume_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_font.h"
@@ -56,6 +58,8 @@
 
 #include "BLO_read_write.h"
 
+static bool packedfile_deferred_remove(PackedFile *pf);
+
 int BKE_packedfile_seek(PackedFile *pf, int offset, int whence)
 {
   int oldseek = -1, seek = 0;
@@ -95,7 +99,7 @@ void BKE_packedfile_rewind(PackedFile *pf)
 
 int BKE_packedfile_read(PackedFile *pf, void *data, int size)
 {
-  if ((pf != NULL) && (size >= 0) && (data != NULL)) {
+  if ((pf != NULL) && (size >= 0) && (data != NULL) && BKE_packedfile_data_acquire(pf)) {
     if (size + pf->seek > pf->size) {
       size = pf->size - pf->seek;
     }
@@ -108,6 +112,7 @@ int BKE_packedfile_read(PackedFile *pf, void *data, int size)
     }
 
     pf->seek += size;
+    BKE_packedfile_data_release(pf);
   }
   else {
     size = -1;
@@ -155,7 +160,9 @@ int BKE_packedfile_count_all(Main *bmain)
 void BKE_packedfile_free(PackedFile *pf)
 {
   if (pf) {
-    BLI_assert(pf->data != NULL);
+    const bool is_deferred = packedfile_deferred_remove(pf);
+    BLI_assert(pf->data != NULL || is_deferred);
+    UNUSED_VARS_NDEBUG(is_deferred);
 
     MEM_SAFE_FREE(pf->data);
     MEM_freeN(pf);
@@ -168,12 +175,17 @@ void BKE_packedfile_free(PackedFile *pf)
 PackedFile *BKE_packedfile_duplicate(const PackedFile *pf_src)
 {
   BLI_assert(pf_src != NULL);
-  BLI_assert(pf_src->data != NULL);
+  /* The duplicate owns its data, deferred data can't be shared. */
+  if (!BKE_packedfile_data_acquire((PackedFile *)pf_src)) {
+    printf("%s: Packed data could not be read, it is not duplicated\n", __func__);
+    return NULL;
+  }
 
   PackedFile *pf_dst;
 
   pf_dst = MEM_dupallocN(pf_src);
   pf_dst->data = MEM_dupallocN(pf_src->data);
+  BKE_packedfile_data_release((PackedFile *)pf_src);
 
   return pf_dst;
 }
@@ -333,7 +345,8 @@ int BKE_packedfile_write_to_file(ReportList *reports,
   /* make sure the path to the file exists... */
   BLI_make_existing_file(name);
 
-  file = BLI_open(name, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+  const bool has_data = BKE_packedfile_data_acquire(pf);
+  file = has_data ? BLI_open(name, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666) : -1;
   if (file == -1) {
     BKE_reportf(reports, RPT_ERROR, "Error creating file '%s'", name);
     ret_value = RET_ERROR;
@@ -349,6 +362,9 @@ int BKE_packedfile_write_to_file(ReportList *reports,
 
     close(file);
   }
+  if (has_data) {
+    BKE_packedfile_data_release(pf);
+  }
 
   if (remove_tmp) {
     if (ret_value == RET_ERROR) {
@@ -396,7 +412,7 @@ enum ePF_FileCompare BKE_packedfile_compare_to_file(const char *ref_file_name,
   if (BLI_stat(name, &st) == -1) {
     ret_val = PF_CMP_NOFILE;
   }
-  else if (st.st_size != pf->size) {
+  else if (st.st_size != pf->size || !BKE_packedfile_data_acquire(pf)) {
     ret_val = PF_CMP_DIFFERS;
   }
   else {
@@ -429,6 +445,7 @@ enum ePF_FileCompare BKE_packedfile_compare_to_file(const char *ref_file_name,
 
       close(file);
     }
+    BKE_packedfile_data_release(pf);
   }
 
   return ret_val;
@@ -534,9 +551,11 @@ static void unpack_generate_paths(const char *name,
     /* For images we can add the file extension based on the file magic. */
     if (id_type == ID_IM) {
       ImagePackedFile *imapf = ((Image *)id)->packedfiles.last;
-      if (imapf != NULL && imapf->packedfile != NULL) {
-        const PackedFile *pf = imapf->packedfile;
+      if (imapf != NULL && imapf->packedfile != NULL &&
+          BKE_packedfile_data_acquire(imapf->packedfile)) {
+        PackedFile *pf = imapf->packedfile;
         enum eImbFileType ftype = IMB_ispic_type_from_memory((const uchar *)pf->data, pf->size);
+        BKE_packedfile_data_release(pf);
         if (ftype != IMB_FTYPE_NONE) {
           const int imtype = BKE_image_ftype_to_imtype(ftype, NULL);
           BKE_image_path_ensure_ext_from_imtype(tempname, imtype);
@@ -873,11 +892,461 @@ void BKE_packedfile_id_unpack(Main *bmain, ID *id, ReportList *reports, enum ePF
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Deferred Packed Data
+ *
+ * Files read with #BLO_READ_DEFER_PACKED_DATA don't read the contents of packed files,
+ * #PackedFile.data stays NULL until #BKE_packedfile_data_acquire reads it from the .blend file.
+ * Data read this way may be freed again to stay within #BKE_packedfile_deferred_budget_set, once
+ * nothing uses it anymore.
+ *
+ * Undo steps don't store the deferred data, only where it can be read from. Undo steps written
+ * to disk get the data itself, see #BKE_packedfile_undo_data_read. Since undo steps can't be
+ * changed once written, the data they refer to is read into memory before the file it comes from
+ * is replaced, see #BKE_packedfile_deferred_file_overwrite.
+ * \{ */
+
+/** Where deferred data can be read from, stored as the data of the packed file in undo steps. */
+typedef struct PackedFileDeferredInfo {
+  char filepath[FILE_MAX];
+  uint64_t file_offset;
+  /** Used to detect the file changing after it was read. */
+  int64_t file_size;
+  int64_t file_mtime;
+} PackedFileDeferredInfo;
+
+typedef struct PackedFileDeferred {
+  struct PackedFileDeferred *next, *prev;
+  PackedFile *pf;
+  PackedFileDeferredInfo info;
+  /** Number of #BKE_packedfile_data_acquire calls without release, the data is kept while set. */
+  int users;
+  /** Data that is never freed to fit the budget. */
+  bool is_pinned;
+} PackedFileDeferred;
+
+/** Deferred data that undo steps refer to. */
+typedef struct PackedFileDeferredUndo {
+  PackedFileDeferredInfo info;
+  int size;
+  /** Read once the file is about to be replaced, NULL before that. */
+  void *data;
+} PackedFileDeferredUndo;
+
+static struct {
+  ThreadMutex mutex;
+  /** Maps #PackedFile to #PackedFileDeferred. */
+  GHash *map;
+  /** Deferred packed files that have their data in memory, least recently used first. */
+  ListBase loaded;
+  size_t loaded_size;
+  /** Zero for no limit. */
+  size_t budget;
+  /** Maps #PackedFileDeferredInfo to #PackedFileDeferredUndo. */
+  GHash *undo_map;
+} g_packedfile_deferred = {BLI_MUTEX_INITIALIZER};
+
+static uint packedfile_deferred_info_hash(const void *key)
+{
+  const PackedFileDeferredInfo *info = key;
+  return BLI_ghashutil_strhash_p(info->filepath) ^
+         BLI_ghashutil_uinthash((uint)(info->file_offset ^ (uint64_t)info->file_mtime));
+}
+
+static bool packedfile_deferred_info_cmp(const void *a, const void *b)
+{
+  const PackedFileDeferredInfo *info_a = a;
+  const PackedFileDeferredInfo *info_b = b;
+  return (info_a->file_offset != info_b->file_offset) ||
+         (info_a->file_size != info_b->file_size) ||
+         (info_a->file_mtime != info_b->file_mtime) || !STREQ(info_a->filepath, info_b->filepath);
+}
+
+static void packedfile_defer_data_ex(PackedFile *pf, const PackedFileDeferredInfo *info)
+{
+  PackedFileDeferred *deferred = MEM_callocN(sizeof(*deferred), __func__);
+  deferred->pf = pf;
+  deferred->info = *info;
+
+  BLI_mutex_lock(&g_packedfile_deferred.mutex);
+  if (g_packedfile_deferred.map == NULL) {
+    g_packedfile_deferred.map = BLI_ghash_ptr_new(__func__);
+  }
+  BLI_ghash_insert(g_packedfile_deferred.map, pf, deferred);
+  BLI_mutex_unlock(&g_packedfile_deferred.mutex);
+}
+
+bool BKE_packedfile_defer_data(PackedFile *pf, const char *filepath, uint64_t file_offset)
+{
+  BLI_assert(pf->data == NULL);
+  BLI_stat_t st;
+  if (BLI_stat(filepath, &st) == -1) {
+    return false;
+  }
+
+  PackedFileDeferredInfo info = {{0}};
+  BLI_strncpy(info.filepath, filepath, sizeof(info.filepath));
+  info.file_offset = file_offset;
+  info.file_size = (int64_t)st.st_size;
+  info.file_mtime = (int64_t)st.st_mtime;
+  packedfile_defer_data_ex(pf, &info);
+  return true;
+}
+
+/** Read directly from the file, see #packedfile_deferred_info_read. */
+static bool packedfile_deferred_info_read_file(const PackedFileDeferredInfo *info,
+                                               void *data,
+                                               const int size)
+{
+  BLI_stat_t st;
+  if (BLI_stat(info->filepath, &st) == -1 || (int64_t)st.st_size != info->file_size ||
+      (int64_t)st.st_mtime != info->file_mtime) {
+    printf("%s: '%s' changed since it was read, packed data is not available\n",
+           __func__,
+           info->filepath);
+    return false;
+  }
+
+  const int file = BLI_open(info->filepath, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return false;
+  }
+  const bool success = (BLI_lseek(file, (int64_t)info->file_offset, SEEK_SET) != -1) &&
+                       (read(file, data, size) == size);
+  close(file);
+  return success;
+}
+
+/** Must be called with the mutex locked. */
+static bool packedfile_deferred_info_read(const PackedFileDeferredInfo *info,
+                                          void *data,
+                                          const int size)
+{
+  const PackedFileDeferredUndo *undo = (g_packedfile_deferred.undo_map != NULL) ?
+                                           BLI_ghash_lookup(g_packedfile_deferred.undo_map,
+                                                            info) :
+                                           NULL;
+  if (undo != NULL && undo->data != NULL) {
+    if (undo->size != size) {
+      return false;
+    }
+    memcpy(data, undo->data, (size_t)size);
+    return true;
+  }
+  return packedfile_deferred_info_read_file(info, data, size);
+}
+
+static bool packedfile_deferred_read(PackedFileDeferred *deferred)
+{
+  PackedFile *pf = deferred->pf;
+  void *data = MEM_mallocN(pf->size, "packFile");
+  if (!packedfile_deferred_info_read(&deferred->info, data, pf->size)) {
+    MEM_freeN(data);
+    return false;
+  }
+  pf->data = data;
+  return true;
+}
+
+/**
+ * Read the deferred data of a packed file in an undo step, for undo steps that are written to
+ * disk. `undo_data` is the data of a #PackedFile with #PACKEDFILE_SEEK_DEFERRED as seek.
+ *
+ * \return false when the data could not be read.
+ */
+bool BKE_packedfile_undo_data_read(const void *undo_data,
+                                   const size_t undo_data_size,
+                                   void *r_data,
+                                   const int size)
+{
+  if (undo_data_size != sizeof(PackedFileDeferredInfo)) {
+    return false;
+  }
+  BLI_mutex_lock(&g_packedfile_deferred.mutex);
+  const bool success = packedfile_deferred_info_read(undo_data, r_data, size);
+  BLI_mutex_unlock(&g_packedfile_deferred.mutex);
+  return success;
+}
+
+/** Free the least recently used data that is not in use until the budget is met. */
+static void packedfile_deferred_evict(void)
+{
+  const size_t budget = g_packedfile_deferred.budget;
+  PackedFileDeferred *deferred = g_packedfile_deferred.loaded.first;
+  while (budget != 0 && g_packedfile_deferred.loaded_size > budget && deferred != NULL) {
+    PackedFileDeferred *deferred_next = deferred->next;
+    if (deferred->users == 0) {
+      BLI_remlink(&g_packedfile_deferred.loaded, deferred);
+      g_packedfile_deferred.loaded_size -= (size_t)deferred->pf->size;
+      MEM_SAFE_FREE(deferred->pf->data);
+    }
+    deferred = deferred_next;
+  }
+}
+
+static void packedfile_deferred_free(PackedFileDeferred *deferred)
+{
+  if (deferred->pf->data != NULL && !deferred->is_pinned) {
+    BLI_remlink(&g_packedfile_deferred.loaded, deferred);
+    g_packedfile_deferred.loaded_size -= (size_t)deferred->pf->size;
+  }
+  MEM_freeN(deferred);
+}
+
+static PackedFileDeferred *packedfile_deferred_lookup(const PackedFile *pf)
+{
+  return (g_packedfile_deferred.map != NULL) ? BLI_ghash_lookup(g_packedfile_deferred.map, pf) :
+                                               NULL;
+}
+
+/** Stop tracking the packed file of `deferred`, must be called with the mutex locked. */
+static void packedfile_deferred_discard(PackedFileDeferred *deferred)
+{
+  BLI_ghash_remove(g_packedfile_deferred.map, deferred->pf, NULL, NULL);
+  packedfile_deferred_free(deferred);
+  if (BLI_ghash_len(g_packedfile_deferred.map) == 0) {
+    BLI_ghash_free(g_packedfile_deferred.map, NULL, NULL);
+    g_packedfile_deferred.map = NULL;
+  }
+}
+
+/**
+ * Stop tracking `pf`, the data is kept as is.
+ * \return true when `pf` had deferred data.
+ */
+static bool packedfile_deferred_remove(PackedFile *pf)
+{
+  BLI_mutex_lock(&g_packedfile_deferred.mutex);
+  PackedFileDeferred *deferred = packedfile_deferred_lookup(pf);
+  if (deferred != NULL) {
+    BLI_assert(deferred->users == 0);
+    packedfile_deferred_discard(deferred);
+  }
+  BLI_mutex_unlock(&g_packedfile_deferred.mutex);
+  return deferred != NULL;
+}
+
+/**
+ * Read the data of the packed file of `deferred` if needed and stop tracking it, the packed file
+ * owns its data afterwards. Must be called with the mutex locked.
+ *
+ * \return false when the data could not be read, the packed file stays deferred then.
+ */
+static bool packedfile_deferred_materialize(PackedFileDeferred *deferred)
+{
+  PackedFile *pf = deferred->pf;
+  if (pf->data == NULL) {
+    if (!packedfile_deferred_read(deferred)) {
+      return false;
+    }
+    /* Not in the loaded list, don't let freeing remove it from there. */
+    deferred->is_pinned = true;
+  }
+  /* Users of acquired data keep a valid pointer, releasing it does nothing from now on. */
+  packedfile_deferred_discard(deferred);
+  return true;
+}
+
+/**
+ * Make sure the data of a packed file is in memory, reading it from the .blend file when it was
+ * deferred. The data stays valid until #BKE_packedfile_data_release is called.
+ *
+ * \return false when the data could not be read, there is nothing to release then.
+ */
+bool BKE_packedfile_data_acquire(PackedFile *pf)
+{
+  BLI_mutex_lock(&g_packedfile_deferred.mutex);
+  PackedFileDeferred *deferred = packedfile_deferred_lookup(pf);
+  if (deferred != NULL && !deferred->is_pinned) {
+    if (pf->data == NULL) {
+      if (packedfile_deferred_read(deferred)) {
+        g_packedfile_deferred.loaded_size += (size_t)pf->size;
+        BLI_addtail(&g_packedfile_deferred.loaded, deferred);
+      }
+    }
+    else {
+      /* Most recently used. */
+      BLI_remlink(&g_packedfile_deferred.loaded, deferred);
+      BLI_addtail(&g_packedfile_deferred.loaded, deferred);
+    }
+    if (pf->data != NULL) {
+      deferred->users++;
+      packedfile_deferred_evict();
+    }
+  }
+  const bool success = (pf->data != NULL);
+  BLI_mutex_unlock(&g_packedfile_deferred.mutex);
+  return success;
+}
+
+/**
+ * Allow data returned by #BKE_packedfile_data_acquire to be freed again to fit the budget.
+ */
+void BKE_packedfile_data_release(PackedFile *pf)
+{
+  BLI_mutex_lock(&g_packedfile_deferred.mutex);
+  PackedFileDeferred *deferred = packedfile_deferred_lookup(pf);
+  if (deferred != NULL && !deferred->is_pinned) {
+    BLI_assert(deferred->users > 0);
+    deferred->users--;
+    packedfile_deferred_evict();
+  }
+  BLI_mutex_unlock(&g_packedfile_deferred.mutex);
+}
+
+/**
+ * Like #BKE_packedfile_data_acquire, for data that has to stay valid for as long as the packed
+ * file itself. There is no need to release it.
+ */
+bool BKE_packedfile_data_acquire_pinned(PackedFile *pf)
+{
+  BLI_mutex_lock(&g_packedfile_deferred.mutex);
+  PackedFileDeferred *deferred = packedfile_deferred_lookup(pf);
+  if (deferred != NULL && !deferred->is_pinned) {
+    if (pf->data == NULL) {
+      packedfile_deferred_read(deferred);
+    }
+    else {
+      BLI_remlink(&g_packedfile_deferred.loaded, deferred);
+      g_packedfile_deferred.loaded_size -= (size_t)pf->size;
+    }
+    deferred->is_pinned = (pf->data != NULL);
+  }
+  const bool success = (pf->data != NULL);
+  BLI_mutex_unlock(&g_packedfile_deferred.mutex);
+  return success;
+}
+
+/**
+ * Limit the memory used by deferred packed data that has been read, zero for no limit.
+ */
+void BKE_packedfile_deferred_budget_set(size_t budget)
+{
+  BLI_mutex_lock(&g_packedfile_deferred.mutex);
+  g_packedfile_deferred.budget = budget;
+  packedfile_deferred_evict();
+  BLI_mutex_unlock(&g_packedfile_deferred.mutex);
+}
+
+/**
+ * Read all deferred data from `filepath` into memory, before the file is replaced. This includes
+ * the data that undo steps refer to, it's kept until #BKE_packedfile_deferred_undo_free.
+ */
+void BKE_packedfile_deferred_file_overwrite(const char *filepath)
+{
+  BLI_mutex_lock(&g_packedfile_deferred.mutex);
+  if (g_packedfile_deferred.map != NULL) {
+    GHashIterator gh_iter;
+    /* Discarding frees the map once it's empty. */
+    GHash *map = g_packedfile_deferred.map;
+    const uint len = BLI_ghash_len(map);
+    PackedFileDeferred **deferred_array = MEM_malloc_arrayN(
+        len, sizeof(*deferred_array), __func__);
+    uint i = 0;
+    GHASH_ITER (gh_iter, map) {
+      deferred_array[i++] = BLI_ghashIterator_getValue(&gh_iter);
+    }
+    for (i = 0; i < len; i++) {
+      PackedFileDeferred *deferred = deferred_array[i];
+      if (BLI_path_cmp(deferred->info.filepath, filepath) == 0) {
+        packedfile_deferred_materialize(deferred);
+      }
+    }
+    MEM_freeN(deferred_array);
+  }
+  if (g_packedfile_deferred.undo_map != NULL) {
+    GHashIterator gh_iter;
+    GHASH_ITER (gh_iter, g_packedfile_deferred.undo_map) {
+      PackedFileDeferredUndo *undo = BLI_ghashIterator_getValue(&gh_iter);
+      if (undo->data == NULL && BLI_path_cmp(undo->info.filepath, filepath) == 0) {
+        undo->data = MEM_mallocN((size_t)undo->size, "packFile");
+        if (!packedfile_deferred_info_read_file(&undo->info, undo->data, undo->size)) {
+          MEM_SAFE_FREE(undo->data);
+        }
+      }
+    }
+  }
+  BLI_mutex_unlock(&g_packedfile_deferred.mutex);
+}
+
+/**
+ * Free the deferred data kept for undo steps, for when there are no undo steps anymore.
+ */
+void BKE_packedfile_deferred_undo_free(void)
+{
+  BLI_mutex_lock(&g_packedfile_deferred.mutex);
+  if (g_packedfile_deferred.undo_map != NULL) {
+    GHashIterator gh_iter;
+    GHASH_ITER (gh_iter, g_packedfile_deferred.undo_map) {
+      PackedFileDeferredUndo *undo = BLI_ghashIterator_getValue(&gh_iter);
+      MEM_SAFE_FREE(undo->data);
+    }
+    BLI_ghash_free(g_packedfile_deferred.undo_map, NULL, MEM_freeN);
+    g_packedfile_deferred.undo_map = NULL;
+  }
+  BLI_mutex_unlock(&g_packedfile_deferred.mutex);
+}
+
+/**
+ * Write where the deferred data of `pf` can be read from instead of the data itself.
+ * \return false when `pf` is not deferred.
+ */
+static bool packedfile_deferred_blend_write_undo(BlendWriter *writer, PackedFile *pf)
+{
+  BLI_mutex_lock(&g_packedfile_deferred.mutex);
+  PackedFileDeferred *deferred = packedfile_deferred_lookup(pf);
+  if (deferred != NULL) {
+    if (g_packedfile_deferred.undo_map == NULL) {
+      g_packedfile_deferred.undo_map = BLI_ghash_new(
+          packedfile_deferred_info_hash, packedfile_deferred_info_cmp, __func__);
+    }
+    if (!BLI_ghash_haskey(g_packedfile_deferred.undo_map, &deferred->info)) {
+      PackedFileDeferredUndo *undo = MEM_callocN(sizeof(*undo), __func__);
+      undo->info = deferred->info;
+      undo->size = pf->size;
+      BLI_ghash_insert(g_packedfile_deferred.undo_map, &undo->info, undo);
+    }
+
+    PackedFile pf_tmp = *pf;
+    pf_tmp.seek = PACKEDFILE_SEEK_DEFERRED;
+    pf_tmp.data = &deferred->info;
+    BLO_write_struct_at_address(writer, PackedFile, pf, &pf_tmp);
+    BLO_write_raw(writer, sizeof(deferred->info), &deferred->info);
+  }
+  BLI_mutex_unlock(&g_packedfile_deferred.mutex);
+  return deferred != NULL;
+}
+
+/** \} */
+
 void BKE_packedfile_blend_write(BlendWriter *writer, PackedFile *pf)
 {
   if (pf == NULL) {
     return;
   }
+  if (BLO_write_is_undo(writer)) {
+    /* Reading deferred data for every undo step would defeat the purpose of deferring it. */
+    if (packedfile_deferred_blend_write_undo(writer, pf)) {
+      return;
+    }
+  }
+  else {
+    /* The written file may replace the one deferred data is read from. */
+    BLI_mutex_lock(&g_packedfile_deferred.mutex);
+    PackedFileDeferred *deferred = packedfile_deferred_lookup(pf);
+    const bool has_data = (deferred == NULL) || packedfile_deferred_materialize(deferred);
+    BLI_mutex_unlock(&g_packedfile_deferred.mutex);
+    if (!has_data) {
+      /* Reading the file skips packed files without data. */
+      printf("%s: Packed data of size %d could not be read, it is not written\n",
+             __func__,
+             pf->size);
+      PackedFile pf_tmp = *pf;
+      pf_tmp.data = NULL;
+      BLO_write_struct_at_address(writer, PackedFile, pf, &pf_tmp);
+      return;
+    }
+  }
   BLO_write_struct(writer, PackedFile, pf);
   BLO_write_raw(writer, pf->size, pf->data);
 }
@@ -890,7 +1359,34 @@ void BKE_packedfile_blend_read(BlendDataReader *reader, PackedFile **pf_p)
     return;
   }
 
-  BLO_read_packed_address(reader, &pf->data);
+  if (pf->seek == PACKEDFILE_SEEK_DEFERRED) {
+    /* Written by #packedfile_deferred_blend_write_undo. */
+    PackedFileDeferredInfo *info = pf->data;
+    BLO_read_data_address(reader, &info);
+    pf->seek = 0;
+    pf->data = NULL;
+    if (info != NULL) {
+      packedfile_defer_data_ex(pf, info);
+      MEM_freeN(info);
+      return;
+    }
+  }
+  else {
+    const char *filepath;
+    uint64_t file_offset;
+    if (BLO_read_packed_data_is_deferred(reader, pf->data, &filepath, &file_offset)) {
+      void *data_old = pf->data;
+      pf->data = NULL;
+      if (BKE_packedfile_defer_data(pf, filepath, file_offset)) {
+        return;
+      }
+      /* Fall back to reading the data now. */
+      pf->data = data_old;
+    }
+
+    BLO_read_packed_address(reader, &pf->data);
+  }
+
   if (pf->data == NULL) {
     /* We cannot allow a PackedFile with a NULL data field,
      * the whole code assumes this is not possible. See T70315. */
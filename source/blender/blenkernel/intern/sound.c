@@ -550,7 +550,10 @@ static void sound_load_audio(Main *bmain, bSound *sound, bool free_waveform)
 
     /* but we need a packed file then */
     if (pf) {
-      sound->handle = AUD_Sound_bufferFile((unsigned char *)pf->data, pf->size);
+      if (BKE_packedfile_data_acquire(pf)) {
+        sound->handle = AUD_Sound_bufferFile((unsigned char *)pf->data, pf->size);
+        BKE_packedfile_data_release(pf);
+      }
     }
     else {
       /* or else load it from disk */
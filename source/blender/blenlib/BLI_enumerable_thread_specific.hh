@@ -0,0 +1,78 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * An #EnumerableThreadSpecific holds a separate value for every thread that accesses it. This is
+ * useful to give every task of a parallel algorithm some scratch memory that is reused for all the
+ * work done on the same thread, without any synchronization.
+ *
+ * This is a thin wrapper around `tbb::enumerable_thread_specific`. Without TBB, there is only a
+ * single value, because all work is done on the calling thread.
+ */
+
+#include "BLI_task.hh"
+#include "BLI_utility_mixins.hh"
+
+namespace blender {
+
+template<typename T> class EnumerableThreadSpecific : NonCopyable, NonMovable {
+#ifdef WITH_TBB
+ private:
+  tbb::enumerable_thread_specific<T> values_;
+
+ public:
+  /* Get the value for the current thread. It is default constructed on first use. */
+  T &local()
+  {
+    return values_.local();
+  }
+
+  auto begin()
+  {
+    return values_.begin();
+  }
+
+  auto end()
+  {
+    return values_.end();
+  }
+#else
+ private:
+  T value_;
+
+ public:
+  T &local()
+  {
+    return value_;
+  }
+
+  T *begin()
+  {
+    return &value_;
+  }
+
+  T *end()
+  {
+    return &value_ + 1;
+  }
+#endif
+};
+
+}  // namespace blender
@@ -204,6 +204,20 @@ class IndexMask {
   {
     return indices_.size();
   }
+
+  /**
+   * Returns a new IndexMask that references a contiguous part of the indices in this mask. The
+   * referenced indices are not changed, so the new mask can be used with the same arrays.
+   */
+  IndexMask slice(IndexRange slice) const
+  {
+    return IndexMask(indices_.slice(slice));
+  }
+
+  IndexMask slice(int64_t start, int64_t size) const
+  {
+    return this->slice(IndexRange(start, size));
+  }
 };
 
 }  // namespace blender
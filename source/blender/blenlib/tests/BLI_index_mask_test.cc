@@ -1,6 +1,7 @@
 /* Apache License, Version 2.0 */
 
 #include "BLI_index_mask.hh"
+#include "BLI_vector.hh"
 #include "testing/testing.h"
 
 namespace blender::tests {
@@ -40,4 +41,17 @@ TEST(index_mask, RangeConstructor)
   EXPECT_EQ(indices[2], 5);
 }
 
+TEST(index_mask, Slice)
+{
+  Vector<int64_t> indices = {2, 4, 5, 6, 9};
+  IndexMask mask = indices.as_span();
+  IndexMask slice = mask.slice(1, 3);
+  EXPECT_EQ(slice.size(), 3);
+  EXPECT_EQ(slice[0], 4);
+  EXPECT_EQ(slice[2], 6);
+  EXPECT_TRUE(slice.is_range());
+  EXPECT_EQ(slice.min_array_size(), 7);
+  EXPECT_FALSE(mask.slice(2, 3).is_range());
+}
+
 }  // namespace blender::tests
@@ -0,0 +1,83 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_fileops.h"
+#include "BLI_mmap.h"
+#include "BLI_path_util.h"
+
+#include <fcntl.h>
+#include <string>
+
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
+
+namespace blender::tests {
+
+class MMapTest : public testing::Test {
+ protected:
+  std::string filepath_;
+  int file_ = -1;
+
+  void SetUp() override
+  {
+    filepath_ = testing::TempDir() + "BLI_mmap_test.bin";
+    int file = BLI_open(filepath_.c_str(), O_BINARY | O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    ASSERT_NE(file, -1);
+    char data[256];
+    for (int i = 0; i < 256; i++) {
+      data[i] = (char)i;
+    }
+    ASSERT_EQ(write(file, data, sizeof(data)), (int)sizeof(data));
+    close(file);
+
+    file_ = BLI_open(filepath_.c_str(), O_BINARY | O_RDONLY, 0);
+    ASSERT_NE(file_, -1);
+  }
+
+  void TearDown() override
+  {
+    if (file_ != -1) {
+      close(file_);
+    }
+    BLI_delete(filepath_.c_str(), false, false);
+  }
+};
+
+TEST_F(MMapTest, Read)
+{
+  BLI_mmap_file *file = BLI_mmap_open(file_);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(BLI_mmap_get_length(file), 256);
+
+  char buffer[16];
+  EXPECT_TRUE(BLI_mmap_read(file, buffer, 100, sizeof(buffer)));
+  for (int i = 0; i < 16; i++) {
+    EXPECT_EQ(buffer[i], (char)(100 + i));
+  }
+
+  const char *memory = (const char *)BLI_mmap_get_pointer(file);
+  EXPECT_EQ(memory[42], (char)42);
+  EXPECT_FALSE(BLI_mmap_any_io_error(file));
+
+  BLI_mmap_free(file);
+}
+
+TEST_F(MMapTest, ReadOutOfBounds)
+{
+  BLI_mmap_file *file = BLI_mmap_open(file_);
+  ASSERT_NE(file, nullptr);
+
+  char buffer[16];
+  EXPECT_TRUE(BLI_mmap_read(file, buffer, 240, 16));
+  EXPECT_FALSE(BLI_mmap_read(file, buffer, 241, 16));
+  EXPECT_FALSE(BLI_mmap_read(file, buffer, 300, 1));
+  EXPECT_TRUE(BLI_mmap_read(file, buffer, 256, 0));
+
+  BLI_mmap_free(file);
+}
+
+}  // namespace blender::tests
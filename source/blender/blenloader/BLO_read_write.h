@@ -193,6 +193,10 @@ bool BLO_write_is_undo(BlendWriter *writer);
 void *BLO_read_get_new_data_address(BlendDataReader *reader, const void *old_address);
 void *BLO_read_get_new_data_address_no_us(BlendDataReader *reader, const void *old_address);
 void *BLO_read_get_new_packed_address(BlendDataReader *reader, const void *old_address);
+bool BLO_read_packed_data_is_deferred(BlendDataReader *reader,
+                                      const void *old_address,
+                                      const char **r_filepath,
+                                      uint64_t *r_file_offset);
 
 #define BLO_read_data_address(reader, ptr_p) \
   *((void **)ptr_p) = BLO_read_get_new_data_address((reader), *(ptr_p))
@@ -81,7 +81,7 @@ typedef struct BlendFileData {
 } BlendFileData;
 
 struct BlendFileReadParams {
-  uint skip_flags : 3; /* eBLOReadSkip */
+  uint skip_flags : 4; /* eBLOReadSkip */
   uint is_startup : 1;
 
   /** Whether we are reading the memfile for an undo (< 0) or a redo (> 0). */
@@ -95,6 +95,11 @@ typedef enum eBLOReadSkip {
   BLO_READ_SKIP_DATA = (1 << 1),
   /** Do not attempt to re-use IDs from old bmain for unchanged ones in case of undo. */
   BLO_READ_SKIP_UNDO_OLD_MAIN = (1 << 2),
+  /**
+   * Don't read the contents of packed files, they are read from the file when accessed,
+   * see #BKE_packedfile_data_acquire. Only supported for uncompressed files.
+   */
+  BLO_READ_DEFER_PACKED_DATA = (1 << 3),
 } eBLOReadSkip;
 #define BLO_READ_SKIP_ALL (BLO_READ_SKIP_USERDEF | BLO_READ_SKIP_DATA)
 
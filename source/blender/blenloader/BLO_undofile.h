@@ -24,6 +24,10 @@
  * \ingroup blenloader
  */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct GHash;
 struct Scene;
 
@@ -32,8 +36,15 @@ typedef struct {
   const char *buf;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, this chunk is identical to the one of the same ID in the previous step,
+   * and shares its memory. */
   bool is_identical;
+  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk
+   * (always true for identical chunks, but also set for chunks matching any other chunk of the
+   * previous step). */
+  bool is_shared;
+  /** When true, the memory is part of the compressed buffer of the #MemFile, `buf` is NULL. */
+  bool is_compressed;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
    * Defined when writing the next step (i.e. last undo step has those always false). */
@@ -41,11 +52,18 @@ typedef struct {
   /** Session UUID of the ID being currently written (MAIN_ID_SESSION_UUID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uuid;
+  /** Hash of the content, to find matching chunks in the previous step. */
+  uint hash;
 } MemFileChunk;
 
 typedef struct MemFile {
   ListBase chunks;
+  /** Size of the memory owned by this #MemFile (compressed size for compressed chunks). */
   size_t size;
+
+  /** Content of all compressed chunks, in order. */
+  void *compressed_buf;
+  size_t compressed_size;
 } MemFile;
 
 typedef struct MemFileWriteData {
@@ -57,6 +75,8 @@ typedef struct MemFileWriteData {
 
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   struct GHash *id_session_uuid_mapping;
+  /** Maps a content hash to the first reference MemFileChunk with that hash. */
+  struct GHash *hash_mapping;
 } MemFileWriteData;
 
 typedef struct MemFileUndoData {
@@ -78,9 +98,16 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
 extern void BLO_memfile_clear_future(MemFile *memfile);
+extern void BLO_memfile_compress(MemFile *memfile, const MemFile *memfile_next);
+extern void BLO_memfile_uncompress(MemFile *memfile);
+extern void BLO_memfile_share(MemFile *memfile, MemFile *r_memfile);
 
 /* utilities */
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                          struct Main *bmain,
                                          struct Scene **r_scene);
 extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename);
+
+#ifdef __cplusplus
+}
+#endif
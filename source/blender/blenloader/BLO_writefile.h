@@ -24,6 +24,10 @@
  * \brief external writefile function prototypes.
  */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct BlendThumbnail;
 struct Main;
 struct MemFile;
@@ -70,5 +74,12 @@ extern bool BLO_write_file_mem(struct Main *mainvar,
                                struct MemFile *compare,
                                struct MemFile *current,
                                int write_flags);
+extern bool BLO_write_file_to_memfile(struct Main *mainvar,
+                                      struct MemFile *r_memfile,
+                                      const int write_flags);
 
 /** \} */
+
+#ifdef __cplusplus
+}
+#endif
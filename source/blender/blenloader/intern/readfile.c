@@ -68,6 +68,8 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -81,6 +83,7 @@
 #include "BKE_idtype.h"
 #include "BKE_layer.h"
 #include "BKE_lib_id.h"
+#include "BKE_main_namemap.h"
 #include "BKE_lib_override.h"
 #include "BKE_lib_query.h"
 #include "BKE_main.h" /* for Main */
@@ -168,7 +171,7 @@
  * Delay reading blocks we might not use (especially applies to library linking).
  * which keeps large arrays in memory from data-blocks we may not even use.
  *
- * \note This is disabled when using compression,
+ * \note This is disabled when using compression without a frame index,
  * while zlib supports seek it's unusably slow, see: T61880.
  */
 #define USE_BHEAD_READ_ON_DEMAND
@@ -191,6 +194,7 @@
 /* local prototypes */
 static void read_libraries(FileData *basefd, ListBase *mainlist);
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname);
+static void *read_deferred_data(FileData *fd, const void *adr, const bool increase_users);
 static BHead *find_bhead_from_code_name(FileData *fd, const short idcode, const char *name);
 static BHead *find_bhead_from_idname(FileData *fd, const char *idname);
 static bool library_link_idcode_needs_tag_check(const short idcode, const int flag);
@@ -459,6 +463,8 @@ void blo_join_main(ListBase *mainlist)
   Main *tojoin, *mainl;
 
   mainl = mainlist->first;
+  /* IDs are moved between the lists directly. */
+  BKE_main_namemap_clear(mainl);
   while ((tojoin = mainl->next)) {
     add_main_to_main(mainl, tojoin);
     BLI_remlink(mainlist, tojoin);
@@ -493,6 +499,9 @@ void blo_split_main(ListBase *mainlist, Main *main)
   mainlist->first = mainlist->last = main;
   main->next = NULL;
 
+  /* IDs are moved between the lists directly. */
+  BKE_main_namemap_clear(main);
+
   if (BLI_listbase_is_empty(&main->libraries)) {
     return;
   }
@@ -927,6 +936,11 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if (fd->mmap_file != NULL) {
+    /* Doesn't change the reading position, so this can be used from multiple threads. */
+    return BLI_mmap_read(
+        fd->mmap_file, buf, (size_t)new_bhead->file_offset, (size_t)new_bhead->bhead.len);
+  }
   off64_t offset_backup = fd->file_offset;
   if (UNLIKELY(fd->seek(fd, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -943,6 +957,24 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   return success;
 }
 
+/**
+ * Access the data of a block that is read on demand in place, when the file is memory-mapped.
+ * \return NULL when the data has to be read instead.
+ * \note Check #BLI_mmap_any_io_error after accessing the data.
+ */
+static const void *blo_bhead_data_mapped(FileData *fd, BHead *thisblock)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if (fd->mmap_file == NULL || !BLI_mmap_supports_direct_access()) {
+    return NULL;
+  }
+  if (new_bhead->file_offset + (off64_t)new_bhead->bhead.len > (off64_t)fd->buffersize) {
+    return NULL;
+  }
+  return POINTER_OFFSET(BLI_mmap_get_pointer(fd->mmap_file), new_bhead->file_offset);
+}
+
 static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
 {
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
@@ -1139,6 +1171,54 @@ static off64_t fd_seek_data_from_file(FileData *filedata, off64_t offset, int wh
   return filedata->file_offset;
 }
 
+/* Memory-mapped file reading.
+ * By using mmap(), we can map a file so that it can be treated like normal memory,
+ * meaning that we can just read from it with memcpy() etc.
+ * This avoids system call overhead and can significantly speed up file loading,
+ * data that is read on demand can also be accessed in place, see #blo_bhead_data_mapped.
+ */
+
+static ssize_t fd_read_from_mmap(FileData *filedata,
+                                 void *buffer,
+                                 size_t size,
+                                 bool *UNUSED(r_is_memchunck_identical))
+{
+  /* don't read more bytes than there are available in the buffer */
+  size_t readsize = MIN2(size, (size_t)(filedata->buffersize - filedata->file_offset));
+
+  if (!BLI_mmap_read(filedata->mmap_file, buffer, filedata->file_offset, readsize)) {
+    return 0;
+  }
+
+  filedata->file_offset += readsize;
+
+  return readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  off64_t new_pos;
+  if (whence == SEEK_CUR) {
+    new_pos = filedata->file_offset + offset;
+  }
+  else if (whence == SEEK_SET) {
+    new_pos = offset;
+  }
+  else if (whence == SEEK_END) {
+    new_pos = filedata->buffersize + offset;
+  }
+  else {
+    return -1;
+  }
+
+  if (new_pos < 0 || new_pos > filedata->buffersize) {
+    return -1;
+  }
+
+  filedata->file_offset = new_pos;
+  return filedata->file_offset;
+}
+
 /* GZip file reading. */
 
 static ssize_t fd_read_gzip_from_file(FileData *filedata,
@@ -1160,6 +1240,304 @@ static ssize_t fd_read_gzip_from_file(FileData *filedata,
   return readsize;
 }
 
+/* Block-compressed GZip file reading (see #BLEND_GZIP_FRAME_SIZE). */
+
+typedef struct GzipFrame {
+  off64_t compressed_offset;
+  off64_t uncompressed_offset;
+  uint32_t compressed_size;
+  uint32_t uncompressed_size;
+} GzipFrame;
+
+typedef struct GzipFrameReader {
+  GzipFrame *frames;
+  int frames_num;
+  off64_t uncompressed_size;
+
+  /** Frames `[window_start, window_start + window_len)` are decompressed into #window_buf. */
+  int window_start;
+  int window_len;
+  /** Maximum number of frames decompressed at once, in parallel. */
+  int window_max;
+  /** Each decompressed frame uses #BLEND_GZIP_FRAME_SIZE bytes. */
+  char *window_buf;
+
+  /** Compressed data of the frames in the window. */
+  char *compressed_buf;
+  size_t compressed_buf_len;
+  /** Per frame in the window, whether decompression succeeded. */
+  bool *window_ok;
+} GzipFrameReader;
+
+/**
+ * Read the frame index from the end of the file.
+ * \return NULL when the file does not contain a (valid) frame index.
+ */
+static GzipFrameReader *gzip_frame_reader_create(int file)
+{
+  const off64_t file_size = BLI_lseek(file, 0, SEEK_END);
+  /* Index member header (16), index footer (8) and empty deflate stream with trailer (10). */
+  const off64_t tail_len = 8 + 10;
+  if (file_size < 16 + tail_len) {
+    return NULL;
+  }
+
+  uchar tail[8 + 10];
+  if (BLI_lseek(file, file_size - tail_len, SEEK_SET) == -1 ||
+      read(file, tail, sizeof(tail)) != sizeof(tail)) {
+    return NULL;
+  }
+  const uchar tail_expect[10] = {0x03, 0x00, 0, 0, 0, 0, 0, 0, 0, 0};
+  if (memcmp(tail + 4, BLEND_GZIP_INDEX_MAGIC, 4) != 0 ||
+      memcmp(tail + 8, tail_expect, sizeof(tail_expect)) != 0) {
+    return NULL;
+  }
+
+  const uint32_t frames_num = blo_gzip_index_read_uint32(tail);
+  if (frames_num > BLEND_GZIP_INDEX_FRAMES_MAX) {
+    return NULL;
+  }
+  const size_t index_len = (size_t)frames_num * 8 + 8;
+  const off64_t member_offset = file_size - 10 - (off64_t)index_len - 16;
+  if (member_offset < 0) {
+    return NULL;
+  }
+
+  uchar *member = MEM_mallocN(16 + index_len, __func__);
+  if (BLI_lseek(file, member_offset, SEEK_SET) == -1 ||
+      read(file, member, 16 + index_len) != (ssize_t)(16 + index_len)) {
+    MEM_freeN(member);
+    return NULL;
+  }
+
+  const size_t xlen = (size_t)member[10] | ((size_t)member[11] << 8);
+  const size_t sub_len = (size_t)member[14] | ((size_t)member[15] << 8);
+  if (!(member[0] == 0x1f && member[1] == 0x8b && member[2] == 0x08 && (member[3] & 0x04)) ||
+      member[12] != BLEND_GZIP_INDEX_SI1 || member[13] != BLEND_GZIP_INDEX_SI2 ||
+      xlen != 4 + index_len || sub_len != index_len) {
+    MEM_freeN(member);
+    return NULL;
+  }
+
+  GzipFrameReader *reader = MEM_callocN(sizeof(GzipFrameReader), __func__);
+  reader->frames = MEM_mallocN(sizeof(GzipFrame) * MAX2(frames_num, 1), __func__);
+  reader->frames_num = (int)frames_num;
+
+  off64_t compressed_offset = 0;
+  off64_t uncompressed_offset = 0;
+  bool is_valid = true;
+  const uchar *entry = member + 16;
+  for (int i = 0; i < reader->frames_num; i++, entry += 8) {
+    GzipFrame *frame = &reader->frames[i];
+    frame->compressed_offset = compressed_offset;
+    frame->uncompressed_offset = uncompressed_offset;
+    frame->compressed_size = blo_gzip_index_read_uint32(entry);
+    frame->uncompressed_size = blo_gzip_index_read_uint32(entry + 4);
+    if (frame->uncompressed_size > BLEND_GZIP_FRAME_SIZE) {
+      is_valid = false;
+      break;
+    }
+    compressed_offset += frame->compressed_size;
+    uncompressed_offset += frame->uncompressed_size;
+  }
+  MEM_freeN(member);
+
+  /* The frames must exactly cover the file up to the index member. */
+  if (!is_valid || compressed_offset != member_offset) {
+    MEM_freeN(reader->frames);
+    MEM_freeN(reader);
+    return NULL;
+  }
+
+  reader->uncompressed_size = uncompressed_offset;
+  reader->window_max = max_ii(1, BLI_system_thread_count());
+  reader->window_buf = MEM_mallocN((size_t)reader->window_max * BLEND_GZIP_FRAME_SIZE, __func__);
+  reader->window_ok = MEM_mallocN(sizeof(bool) * (size_t)reader->window_max, __func__);
+  return reader;
+}
+
+static void gzip_frame_reader_free(GzipFrameReader *reader)
+{
+  MEM_freeN(reader->frames);
+  MEM_freeN(reader->window_buf);
+  MEM_freeN(reader->window_ok);
+  MEM_SAFE_FREE(reader->compressed_buf);
+  MEM_freeN(reader);
+}
+
+static void gzip_frame_decompress_cb(void *__restrict userdata,
+                                     const int iter,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  GzipFrameReader *reader = userdata;
+  const GzipFrame *frame = &reader->frames[reader->window_start + iter];
+  const GzipFrame *frame_first = &reader->frames[reader->window_start];
+
+  z_stream strm = {NULL};
+  bool ok = false;
+  if (inflateInit2(&strm, 16 + MAX_WBITS) == Z_OK) {
+    strm.next_in = (Bytef *)reader->compressed_buf +
+                   (frame->compressed_offset - frame_first->compressed_offset);
+    strm.avail_in = frame->compressed_size;
+    strm.next_out = (Bytef *)reader->window_buf + (size_t)iter * BLEND_GZIP_FRAME_SIZE;
+    strm.avail_out = frame->uncompressed_size;
+
+    ok = (inflate(&strm, Z_FINISH) == Z_STREAM_END) &&
+         (strm.total_out == frame->uncompressed_size);
+    inflateEnd(&strm);
+  }
+  reader->window_ok[iter] = ok;
+}
+
+/**
+ * Decompress `frames_num` frames starting at `frame_start` in parallel, replacing the window.
+ */
+static bool gzip_frame_reader_window_load(FileData *filedata, int frame_start, int frames_num)
+{
+  GzipFrameReader *reader = filedata->gzframes;
+  BLI_assert(frames_num > 0 && frames_num <= reader->window_max);
+  BLI_assert(frame_start + frames_num <= reader->frames_num);
+
+  const GzipFrame *frame_first = &reader->frames[frame_start];
+  const GzipFrame *frame_last = &reader->frames[frame_start + frames_num - 1];
+  const size_t compressed_len = (size_t)(frame_last->compressed_offset -
+                                         frame_first->compressed_offset) +
+                                frame_last->compressed_size;
+
+  reader->window_start = frame_start;
+  reader->window_len = 0;
+
+  if (compressed_len > reader->compressed_buf_len) {
+    MEM_SAFE_FREE(reader->compressed_buf);
+    reader->compressed_buf = MEM_mallocN(compressed_len, __func__);
+    reader->compressed_buf_len = compressed_len;
+  }
+
+  /* The frames are contiguous in the file, read them all at once. */
+  if (BLI_lseek(filedata->filedes, frame_first->compressed_offset, SEEK_SET) == -1) {
+    return false;
+  }
+  size_t read_len = 0;
+  while (read_len < compressed_len) {
+    const ssize_t readsize = read(filedata->filedes,
+                                  reader->compressed_buf + read_len,
+                                  MIN2(compressed_len - read_len, (size_t)INT_MAX));
+    if (readsize <= 0) {
+      return false;
+    }
+    read_len += (size_t)readsize;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, frames_num, reader, gzip_frame_decompress_cb, &settings);
+
+  for (int i = 0; i < frames_num; i++) {
+    if (!reader->window_ok[i]) {
+      return false;
+    }
+  }
+  reader->window_len = frames_num;
+  return true;
+}
+
+static int gzip_frame_reader_find(const GzipFrameReader *reader, off64_t offset)
+{
+  int low = 0;
+  int high = reader->frames_num;
+  while (low < high) {
+    const int mid = low + (high - low) / 2;
+    const GzipFrame *frame = &reader->frames[mid];
+    if (offset < frame->uncompressed_offset) {
+      high = mid;
+    }
+    else if (offset >= frame->uncompressed_offset + frame->uncompressed_size) {
+      low = mid + 1;
+    }
+    else {
+      return mid;
+    }
+  }
+  return reader->frames_num;
+}
+
+static ssize_t fd_read_gzip_frames_from_file(FileData *filedata,
+                                             void *buffer,
+                                             size_t size,
+                                             bool *UNUSED(r_is_memchunck_identical))
+{
+  GzipFrameReader *reader = filedata->gzframes;
+  size_t totread = 0;
+
+  while (totread < size) {
+    const int frame_index = gzip_frame_reader_find(reader, filedata->file_offset);
+    if (frame_index == reader->frames_num) {
+      /* End of file. */
+      break;
+    }
+
+    if (!(frame_index >= reader->window_start &&
+          frame_index < reader->window_start + reader->window_len)) {
+      int frames_num;
+      if (reader->window_len != 0 && frame_index == reader->window_start + reader->window_len) {
+        /* Sequential reading, decompress as many frames ahead as possible. */
+        frames_num = reader->window_max;
+      }
+      else {
+        /* Random access (reading on demand), only decompress what is needed for this read. */
+        const int frame_last = gzip_frame_reader_find(
+            reader, filedata->file_offset + (off64_t)(size - totread) - 1);
+        frames_num = frame_last - frame_index + 1;
+      }
+      frames_num = min_ii(frames_num,
+                          min_ii(reader->window_max, reader->frames_num - frame_index));
+
+      if (!gzip_frame_reader_window_load(filedata, frame_index, frames_num)) {
+        printf("fd_read_gzip_frames_from_file: zlib error\n");
+        return EOF;
+      }
+    }
+
+    const GzipFrame *frame = &reader->frames[frame_index];
+    const size_t frame_offset = (size_t)(filedata->file_offset - frame->uncompressed_offset);
+    const size_t readsize = MIN2(size - totread, frame->uncompressed_size - frame_offset);
+    const char *frame_data = reader->window_buf +
+                             (size_t)(frame_index - reader->window_start) *
+                                 BLEND_GZIP_FRAME_SIZE;
+
+    memcpy(POINTER_OFFSET(buffer, totread), frame_data + frame_offset, readsize);
+    totread += readsize;
+    filedata->file_offset += (off64_t)readsize;
+  }
+
+  return (ssize_t)totread;
+}
+
+static off64_t fd_seek_gzip_frames_from_file(FileData *filedata, off64_t offset, int whence)
+{
+  const GzipFrameReader *reader = filedata->gzframes;
+  off64_t new_offset;
+  switch (whence) {
+    case SEEK_SET:
+      new_offset = offset;
+      break;
+    case SEEK_CUR:
+      new_offset = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      new_offset = reader->uncompressed_size + offset;
+      break;
+    default:
+      return -1;
+  }
+  if (new_offset < 0 || new_offset > reader->uncompressed_size) {
+    return -1;
+  }
+  filedata->file_offset = new_offset;
+  return new_offset;
+}
+
 /* Memory reading. */
 
 static ssize_t fd_read_from_memory(FileData *filedata,
@@ -1305,6 +1683,8 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
 
   gzFile gzfile = (gzFile)Z_NULL;
+  GzipFrameReader *gzframes = NULL;
+  BLI_mmap_file *mmap_file = NULL;
 
   char header[7];
 
@@ -1323,8 +1703,29 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   /* Regular file. */
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-    read_fn = fd_read_data_from_file;
-    seek_fn = fd_seek_data_from_file;
+    /* Map the file to memory when possible, falling back to regular reading. */
+    mmap_file = BLI_mmap_open(file);
+    BLI_lseek(file, 0, SEEK_SET);
+    if (mmap_file != NULL) {
+      read_fn = fd_read_from_mmap;
+      seek_fn = fd_seek_from_mmap;
+    }
+    else {
+      read_fn = fd_read_data_from_file;
+      seek_fn = fd_seek_data_from_file;
+    }
+  }
+
+  /* Block-compressed gzip file with a frame index, supports seeking. */
+  if ((read_fn == NULL) &&
+      /* Check header magic. */
+      (header[0] == 0x1f && header[1] == 0x8b)) {
+    gzframes = gzip_frame_reader_create(file);
+    BLI_lseek(file, 0, SEEK_SET);
+    if (gzframes != NULL) {
+      read_fn = fd_read_gzip_frames_from_file;
+      seek_fn = fd_seek_gzip_frames_from_file;
+    }
   }
 
   /* Gzip file. */
@@ -1357,6 +1758,11 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  fd->gzframes = gzframes;
+  if (mmap_file != NULL) {
+    fd->mmap_file = mmap_file;
+    fd->buffersize = BLI_mmap_get_length(mmap_file);
+  }
 
   fd->read = read_fn;
   fd->seek = seek_fn;
@@ -1424,20 +1830,34 @@ static ssize_t fd_read_gzip_from_memory(FileData *filedata,
   filedata->strm.next_out = (Bytef *)buffer;
   filedata->strm.avail_out = (uint)size;
 
-  /* Inflate another chunk. */
-  err = inflate(&filedata->strm, Z_SYNC_FLUSH);
+  while (filedata->strm.avail_out != 0) {
+    /* Inflate another chunk. */
+    err = inflate(&filedata->strm, Z_SYNC_FLUSH);
 
-  if (err == Z_STREAM_END) {
-    return 0;
-  }
-  if (err != Z_OK) {
-    printf("fd_read_gzip_from_memory: zlib error\n");
-    return 0;
+    if (err == Z_STREAM_END) {
+      if (filedata->strm.avail_in == 0) {
+        break;
+      }
+      /* Block-compressed files consist of multiple gzip members, continue with the next one. */
+      if (inflateReset(&filedata->strm) != Z_OK) {
+        printf("fd_read_gzip_from_memory: zlib error\n");
+        return 0;
+      }
+    }
+    else if (err == Z_BUF_ERROR) {
+      /* No progress possible, the data is truncated. */
+      break;
+    }
+    else if (err != Z_OK) {
+      printf("fd_read_gzip_from_memory: zlib error\n");
+      return 0;
+    }
   }
 
-  filedata->file_offset += size;
+  const size_t readsize = size - filedata->strm.avail_out;
+  filedata->file_offset += readsize;
 
-  return (ssize_t)size;
+  return (ssize_t)readsize;
 }
 
 static int fd_read_gzip_from_memory_init(FileData *fd)
@@ -1517,6 +1937,14 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+    if (fd->gzframes != NULL) {
+      gzip_frame_reader_free(fd->gzframes);
+    }
+
+    if (fd->mmap_file != NULL) {
+      BLI_mmap_free(fd->mmap_file);
+    }
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
@@ -1557,6 +1985,9 @@ void blo_filedata_free(FileData *fd)
     if (fd->globmap) {
       oldnewmap_free(fd->globmap);
     }
+    if (fd->deferred_datamap) {
+      BLI_ghash_free(fd->deferred_datamap, NULL, NULL);
+    }
     if (fd->packedmap) {
       oldnewmap_free(fd->packedmap);
     }
@@ -1718,13 +2149,21 @@ BlendThumbnail *BLO_thumbnail_from_file(const char *filepath)
 /* only direct databocks */
 static void *newdataadr(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  void *newadr = oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  if (UNLIKELY(newadr == NULL && fd->deferred_datamap != NULL)) {
+    newadr = read_deferred_data(fd, adr, true);
+  }
+  return newadr;
 }
 
 /* only direct databocks */
 static void *newdataadr_no_us(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
+  void *newadr = oldnewmap_lookup_and_inc(fd->datamap, adr, false);
+  if (UNLIKELY(newadr == NULL && fd->deferred_datamap != NULL)) {
+    newadr = read_deferred_data(fd, adr, false);
+  }
+  return newadr;
 }
 
 /* direct datablocks with global linking */
@@ -1740,7 +2179,7 @@ static void *newpackedadr(FileData *fd, const void *adr)
     return oldnewmap_lookup_and_inc(fd->packedmap, adr, true);
   }
 
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return newdataadr(fd, adr);
 }
 
 /* only lib data */
@@ -2083,7 +2522,11 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+/**
+ * Read the data of a block into newly allocated memory. I/O errors are reported in
+ * \a r_file_error instead of \a fd, so that this can be used from multiple threads.
+ */
+static void *read_struct_ex(FileData *fd, BHead *bh, const char *blockname, bool *r_file_error)
 {
   void *temp = NULL;
 
@@ -2098,7 +2541,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
         bh = blo_bhead_read_full(fd, bh);
         if (UNLIKELY(bh == NULL)) {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
+          *r_file_error = true;
           return NULL;
         }
       }
@@ -2108,16 +2551,26 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        const void *data = (bh + 1);
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
+          /* Reconstruct from the memory-mapped file in place, instead of copying the data first. */
+          data = blo_bhead_data_mapped(fd, bh);
+          if (data == NULL) {
+            bh = blo_bhead_read_full(fd, bh);
+            if (UNLIKELY(bh == NULL)) {
+              *r_file_error = true;
+              return NULL;
+            }
+            data = (bh + 1);
           }
         }
 #endif
-        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
+        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, data);
+        if (UNLIKELY(fd->mmap_file != NULL && BLI_mmap_any_io_error(fd->mmap_file))) {
+          *r_file_error = true;
+          MEM_SAFE_FREE(temp);
+        }
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -2130,7 +2583,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
           /* Instead of allocating the bhead, then copying it,
            * read the data from the file directly into the memory. */
           if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+            *r_file_error = true;
             MEM_freeN(temp);
             temp = NULL;
           }
@@ -2151,6 +2604,16 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+  bool file_error = false;
+  void *temp = read_struct_ex(fd, bh, blockname, &file_error);
+  if (file_error) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+  return temp;
+}
+
 /* Like read_struct, but gets a pointer without allocating. Only works for
  * undo since DNA must match. */
 static const void *peek_struct_undo(FileData *fd, BHead *bhead)
@@ -3007,6 +3470,7 @@ static void direct_link_library(FileData *fd, Library *lib, Main *main)
         /*              change_link_placeholder_to_real_ID_pointer_fd(fd, lib, newmain->curlib); */
 
         BLI_remlink(&main->libraries, lib);
+        BKE_main_namemap_clear(main);
         MEM_freeN(lib);
 
         /* Now, since Blender always expect **latest** Main pointer from fd->mainlist
@@ -3098,6 +3562,7 @@ static ID *create_placeholder(Main *mainvar, const short idcode, const char *idn
 
   BLI_addtail(lb, ph_id);
   id_sort_by_name(lb, ph_id, NULL);
+  BKE_main_namemap_clear(mainvar);
 
   BKE_lib_libblock_session_uuid_ensure(ph_id);
 
@@ -3246,9 +3711,269 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
   return success;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Deferred Data-Blocks
+ *
+ * With #BLO_READ_DEFER_PACKED_DATA, the contents of large packed files in uncompressed files are
+ * not read with the other data-blocks of their ID. Packed files take their location in the file
+ * with #BLO_read_packed_data_is_deferred, otherwise the data is read when its address is looked
+ * up.
+ * \{ */
+
+/** Smaller packed files are always read, this avoids overhead for small files. */
+#define DEFERRED_DATA_SIZE_MIN (64 * 1024)
+
+/**
+ * \param bhead_prev: The data-block before `bhead`. Packed file contents are written as raw data
+ * right after their #PackedFile, see #BKE_packedfile_blend_write.
+ */
+static bool read_data_is_deferred(const FileData *fd, BHead *bhead, const BHead *bhead_prev)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  /* Raw data is written using #SDNA index zero, see #writedata. */
+  return (fd->deferred_datamap != NULL) && (bhead->SDNAnr == 0) &&
+         (bhead->len >= DEFERRED_DATA_SIZE_MIN) && !BHEADN_FROM_BHEAD(bhead)->has_data &&
+         (bhead_prev != NULL) && (bhead_prev->code == DATA) &&
+         (bhead_prev->SDNAnr == fd->deferred_packedfile_sdna_nr);
+#else
+  UNUSED_VARS(fd, bhead, bhead_prev);
+  return false;
+#endif
+}
+
+static bool read_deferred_data_is_supported(const FileData *fd)
+{
+  /* The data is read using the offset in the file, which only works for uncompressed files. */
+  return (fd->skip_flags & BLO_READ_DEFER_PACKED_DATA) && (fd->mmap_file != NULL) &&
+         (fd->memfile == NULL);
+}
+
+static void *read_deferred_data(FileData *fd, const void *adr, const bool increase_users)
+{
+  BHead *bhead = BLI_ghash_popkey(fd->deferred_datamap, adr, NULL);
+  if (bhead == NULL) {
+    return NULL;
+  }
+  void *data = read_struct(fd, bhead, __func__);
+  if (data == NULL) {
+    return NULL;
+  }
+  oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+  return oldnewmap_lookup_and_inc(fd->datamap, adr, increase_users);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Read Data-Blocks Ahead (Parallel)
+ *
+ * Reconstructing the DNA structs of data-blocks (copying, endian switching and converting
+ * between DNA versions) is the most expensive part of reading a file, and is independent for
+ * every block. When reading a whole file, a first sequential pass indexes the data-blocks of
+ * every ID, which are then read in parallel. The IDs themselves are still read and linked
+ * sequentially by #read_libblock, which takes the prepared data in #read_data_into_datamap.
+ *
+ * \{ */
+
+typedef struct PreparedIDData {
+  /** The ID block and the block after its data-blocks. */
+  BHead *bhead;
+  BHead *bhead_next;
+  /** The data-blocks following the ID block and their reconstructed data (NULL on failure). */
+  BHead **data_bheads;
+  void **data;
+  int data_len;
+} PreparedIDData;
+
+typedef struct PreparedData {
+  PreparedIDData *ids;
+  int ids_len;
+  /** Maps ID #BHead to #PreparedIDData. */
+  GHash *id_map;
+} PreparedData;
+
+static bool read_file_data_prepare_is_supported(const FileData *fd)
+{
+  /* Undo only reads changed IDs, reading all data ahead would be wasted. */
+  if (fd->memfile != NULL) {
+    return false;
+  }
+  if (fd->skip_flags & BLO_READ_SKIP_DATA) {
+    return false;
+  }
+  /* Data that is read on demand has to be accessible from multiple threads. */
+  if (fd->seek != NULL && fd->mmap_file == NULL) {
+    return false;
+  }
+  return true;
+}
+
+static bool read_file_data_prepare_bhead_is_id(const BHead *bhead)
+{
+  /* Logic must match #blo_read_file_internal, which reads these using #read_libblock. */
+  return (bhead->code == ID_SCRN) || BKE_idtype_idcode_is_valid(bhead->code);
+}
+
+typedef struct PrepareTLS {
+  /** Set when reading failed, #FileData.flags is only updated after all threads finished. */
+  bool file_error;
+} PrepareTLS;
+
+static void read_file_data_prepare_cb(void *__restrict userdata,
+                                      const int iter,
+                                      const TaskParallelTLS *__restrict tls)
+{
+  FileData *fd = userdata;
+  PrepareTLS *prepare_tls = tls->userdata_chunk;
+  PreparedIDData *prepared = &fd->prepared_data->ids[iter];
+  const short idcode = (prepared->bhead->code == ID_SCRN) ? ID_SCR : prepared->bhead->code;
+  const char *allocname = dataname(idcode);
+
+  for (int i = 0; i < prepared->data_len; i++) {
+    const BHead *bhead_prev = (i > 0) ? prepared->data_bheads[i - 1] : NULL;
+    if (!read_data_is_deferred(fd, prepared->data_bheads[i], bhead_prev)) {
+      prepared->data[i] = read_struct_ex(
+          fd, prepared->data_bheads[i], allocname, &prepare_tls->file_error);
+    }
+  }
+}
+
+static void read_file_data_prepare_reduce(const void *__restrict UNUSED(userdata),
+                                          void *__restrict chunk_join,
+                                          void *__restrict chunk)
+{
+  PrepareTLS *join = chunk_join;
+  const PrepareTLS *prepare_tls = chunk;
+  join->file_error |= prepare_tls->file_error;
+}
+
+/**
+ * Index the data-blocks of all IDs in the file and read them in parallel.
+ */
+static void read_file_data_prepare(FileData *fd, BHead *bhead_first)
+{
+  int ids_len = 0;
+  int data_len = 0;
+
+  /* First pass: read all block headers (and data that is not read on demand) and count. */
+  for (BHead *bhead = bhead_first; bhead != NULL && bhead->code != ENDB;
+       bhead = blo_bhead_next(fd, bhead)) {
+    if (read_file_data_prepare_bhead_is_id(bhead)) {
+      BHead *bhead_data = blo_bhead_next(fd, bhead);
+      if (bhead_data != NULL && bhead_data->code == DATA) {
+        ids_len++;
+      }
+    }
+    else if (bhead->code == DATA) {
+      data_len++;
+    }
+  }
+
+  if (ids_len == 0) {
+    return;
+  }
+
+  PreparedData *prepared_data = MEM_callocN(sizeof(PreparedData), __func__);
+  prepared_data->ids = MEM_calloc_arrayN(ids_len, sizeof(PreparedIDData), __func__);
+  prepared_data->id_map = BLI_ghash_ptr_new_ex(__func__, (uint)ids_len);
+  BHead **data_bheads = MEM_malloc_arrayN(MAX2(data_len, 1), sizeof(BHead *), __func__);
+  void **data = MEM_calloc_arrayN(MAX2(data_len, 1), sizeof(void *), __func__);
+
+  /* Second pass: gather the data-blocks of every ID, all headers are in memory now. */
+  int data_index = 0;
+  for (BHead *bhead = bhead_first; bhead != NULL && bhead->code != ENDB;
+       bhead = blo_bhead_next(fd, bhead)) {
+    if (!read_file_data_prepare_bhead_is_id(bhead)) {
+      continue;
+    }
+    BHead *bhead_data = blo_bhead_next(fd, bhead);
+    if (bhead_data == NULL || bhead_data->code != DATA) {
+      continue;
+    }
+    PreparedIDData *prepared = &prepared_data->ids[prepared_data->ids_len++];
+    prepared->bhead = bhead;
+    prepared->data_bheads = &data_bheads[data_index];
+    prepared->data = &data[data_index];
+    while (bhead_data != NULL && bhead_data->code == DATA) {
+      data_bheads[data_index++] = bhead_data;
+      prepared->data_len++;
+      bhead_data = blo_bhead_next(fd, bhead_data);
+    }
+    prepared->bhead_next = bhead_data;
+    BLI_ghash_insert(prepared_data->id_map, bhead, prepared);
+  }
+  BLI_assert(prepared_data->ids_len == ids_len);
+
+  fd->prepared_data = prepared_data;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  PrepareTLS prepare_tls = {false};
+  settings.userdata_chunk = &prepare_tls;
+  settings.userdata_chunk_size = sizeof(prepare_tls);
+  settings.func_reduce = read_file_data_prepare_reduce;
+  BLI_task_parallel_range(0, ids_len, fd, read_file_data_prepare_cb, &settings);
+
+  if (prepare_tls.file_error) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+}
+
+/**
+ * Free the prepared data, including data of IDs that have not been read.
+ */
+static void read_file_data_prepare_free(FileData *fd)
+{
+  PreparedData *prepared_data = fd->prepared_data;
+  if (prepared_data == NULL) {
+    return;
+  }
+  for (int i = 0; i < prepared_data->ids_len; i++) {
+    PreparedIDData *prepared = &prepared_data->ids[i];
+    for (int j = 0; j < prepared->data_len; j++) {
+      MEM_SAFE_FREE(prepared->data[j]);
+    }
+  }
+  if (prepared_data->ids_len != 0) {
+    MEM_freeN(prepared_data->ids[0].data_bheads);
+    MEM_freeN(prepared_data->ids[0].data);
+  }
+  MEM_freeN(prepared_data->ids);
+  BLI_ghash_free(prepared_data->id_map, NULL, NULL);
+  MEM_freeN(prepared_data);
+  fd->prepared_data = NULL;
+}
+
+/** \} */
+
 /* Read all data associated with a datablock into datamap. */
 static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *allocname)
 {
+  if (fd->deferred_datamap != NULL) {
+    BLI_ghash_clear(fd->deferred_datamap, NULL, NULL);
+  }
+
+  if (fd->prepared_data != NULL) {
+    PreparedIDData *prepared = BLI_ghash_lookup(fd->prepared_data->id_map, bhead);
+    if (prepared != NULL) {
+      for (int i = 0; i < prepared->data_len; i++) {
+        const BHead *bhead_prev = (i > 0) ? prepared->data_bheads[i - 1] : NULL;
+        if (read_data_is_deferred(fd, prepared->data_bheads[i], bhead_prev)) {
+          BLI_ghash_insert(
+              fd->deferred_datamap, (void *)prepared->data_bheads[i]->old, prepared->data_bheads[i]);
+        }
+        else if (prepared->data[i]) {
+          oldnewmap_insert(fd->datamap, prepared->data_bheads[i]->old, prepared->data[i], 0);
+          /* Owned by the data-map now. */
+          prepared->data[i] = NULL;
+        }
+      }
+      return prepared->bhead_next;
+    }
+  }
+
+  BHead *bhead_prev = bhead;
   bhead = blo_bhead_next(fd, bhead);
 
   while (bhead && bhead->code == DATA) {
@@ -3268,11 +3993,17 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
     }
 #endif
 
-    void *data = read_struct(fd, bhead, allocname);
-    if (data) {
-      oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+    if (read_data_is_deferred(fd, bhead, bhead_prev)) {
+      BLI_ghash_insert(fd->deferred_datamap, (void *)bhead->old, bhead);
+    }
+    else {
+      void *data = read_struct(fd, bhead, allocname);
+      if (data) {
+        oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+      }
     }
 
+    bhead_prev = bhead;
     bhead = blo_bhead_next(fd, bhead);
   }
 
@@ -3386,6 +4117,8 @@ static void read_libblock_undo_restore_identical(
   ListBase *new_lb = which_libbase(main, idcode);
   BLI_remlink(old_lb, id_old);
   BLI_addtail(new_lb, id_old);
+  BKE_main_namemap_clear(old_bmain);
+  BKE_main_namemap_clear(main);
 
   /* Recalc flags, mostly these just remain as they are. */
   id_old->recalc |= direct_link_id_restore_recalc_exceptions(id_old);
@@ -3427,6 +4160,8 @@ static void read_libblock_undo_restore_at_old_address(FileData *fd, Main *main,
   ListBase *new_lb = which_libbase(main, idcode);
   BLI_remlink(old_lb, id_old);
   BLI_remlink(new_lb, id);
+  BKE_main_namemap_clear(old_bmain);
+  BKE_main_namemap_clear(main);
 
   /* We do not need any remapping from this call here, since no ID pointer is valid in the data
    * currently (they are all pointing to old addresses, and need to go through `lib_link`
@@ -3567,6 +4302,7 @@ static BHead *read_libblock(FileData *fd,
   /* NOTE: id must be added to the list before direct_link_id(), since
    * direct_link_library() may remove it from there in case of duplicates. */
   BLI_addtail(lb, id);
+  BKE_main_namemap_clear(main);
 
   /* Insert into library map for lookup by newly read datablocks (with pointer value bhead->old).
    * Note that existing datablocks in memory (which pointer value would be id_old) are not remapped
@@ -4022,6 +4758,14 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  if (read_deferred_data_is_supported(fd)) {
+    fd->deferred_datamap = BLI_ghash_ptr_new(__func__);
+    fd->deferred_packedfile_sdna_nr = DNA_struct_find_nr(fd->filesdna, "PackedFile");
+  }
+  if (read_file_data_prepare_is_supported(fd)) {
+    read_file_data_prepare(fd, bhead);
+  }
+
   while (bhead) {
     switch (bhead->code) {
       case DATA:
@@ -4073,6 +4817,13 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  /* Data of IDs that were skipped. */
+  read_file_data_prepare_free(fd);
+  if (fd->deferred_datamap != NULL) {
+    BLI_ghash_free(fd->deferred_datamap, NULL, NULL);
+    fd->deferred_datamap = NULL;
+  }
+
   /* do before read_libraries, but skip undo case */
   if (fd->memfile == NULL) {
     if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
@@ -4984,6 +5735,8 @@ static void split_main_newid(Main *mainptr, Main *main_newid)
   ListBase *lbarray_newid[MAX_LIBARRAY];
   int i = set_listbasepointers(mainptr, lbarray);
   set_listbasepointers(main_newid, lbarray_newid);
+  BKE_main_namemap_clear(mainptr);
+  BKE_main_namemap_clear(main_newid);
   while (i--) {
     BLI_listbase_clear(lbarray_newid[i]);
 
@@ -5216,6 +5969,7 @@ static void read_library_linked_ids(FileData *basefd,
       ID *id_next = id->next;
       if ((id->tag & LIB_TAG_ID_LINK_PLACEHOLDER) && !(id->flag & LIB_INDIRECT_WEAK_LINK)) {
         BLI_remlink(lbarray[a], id);
+        BKE_main_namemap_clear(mainvar);
 
         /* When playing with lib renaming and such, you may end with cases where
          * you have more than one linked ID of the same data-block from same
@@ -5293,10 +6047,15 @@ static FileData *read_library_file_data(FileData *basefd,
                      TIP_("Read packed library:  '%s', parent '%s'"),
                      mainptr->curlib->filepath,
                      library_parent_filepath(mainptr->curlib));
-    fd = blo_filedata_from_memory(pf->data, pf->size, basefd->reports);
+    /* The file data keeps using the memory while the library is read. */
+    fd = BKE_packedfile_data_acquire_pinned(pf) ?
+             blo_filedata_from_memory(pf->data, pf->size, basefd->reports) :
+             NULL;
 
     /* Needed for library_append and read_libraries. */
-    BLI_strncpy(fd->relabase, mainptr->curlib->filepath_abs, sizeof(fd->relabase));
+    if (fd != NULL) {
+      BLI_strncpy(fd->relabase, mainptr->curlib->filepath_abs, sizeof(fd->relabase));
+    }
   }
   else {
     /* Read file on disk. */
@@ -5454,6 +6213,33 @@ void *BLO_read_get_new_packed_address(BlendDataReader *reader, const void *old_a
   return newpackedadr(reader->fd, old_address);
 }
 
+/**
+ * Check if packed data was not read because of #BLO_READ_DEFER_PACKED_DATA, when true the data
+ * can be read from `r_file_offset` in `r_filepath` later on.
+ */
+bool BLO_read_packed_data_is_deferred(BlendDataReader *reader,
+                                      const void *old_address,
+                                      const char **r_filepath,
+                                      uint64_t *r_file_offset)
+{
+  FileData *fd = reader->fd;
+  if (fd->deferred_datamap == NULL || old_address == NULL) {
+    return false;
+  }
+  BHead *bhead = BLI_ghash_lookup(fd->deferred_datamap, old_address);
+  if (bhead == NULL) {
+    return false;
+  }
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  *r_filepath = fd->relabase;
+  *r_file_offset = (uint64_t)BHEADN_FROM_BHEAD(bhead)->file_offset;
+  return true;
+#else
+  UNUSED_VARS(r_filepath, r_file_offset);
+  return false;
+#endif
+}
+
 ID *BLO_read_get_new_id_address(BlendLibReader *reader, Library *lib, ID *id)
 {
   return newlibadr(reader->fd, lib, id);
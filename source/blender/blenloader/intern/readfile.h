@@ -33,12 +33,15 @@
 #include "DNA_windowmanager_types.h" /* for ReportType */
 #include "zlib.h"
 
+struct BLI_mmap_file;
 struct BLOCacheStorage;
+struct GzipFrameReader;
 struct IDNameLib_Map;
 struct Key;
 struct MemFile;
 struct Object;
 struct OldNewMap;
+struct PreparedData;
 struct ReportList;
 struct UserDef;
 
@@ -82,6 +85,8 @@ typedef struct FileData {
 
   /** Regular file reading. */
   int filedes;
+  /** Memory-mapped file reading, the file size is stored in #buffersize. */
+  struct BLI_mmap_file *mmap_file;
 
   /** Variables needed for reading from memory / stream. */
   const char *buffer;
@@ -93,6 +98,8 @@ typedef struct FileData {
 
   /** Variables needed for reading from file. */
   gzFile gzfiledes;
+  /** Block-compressed gzip file reading, used instead of #gzfiledes when a frame index exists. */
+  struct GzipFrameReader *gzframes;
   /** Gzip stream for memory decompression. */
   z_stream strm;
 
@@ -127,6 +134,13 @@ typedef struct FileData {
   struct BHeadSort *bheadmap;
   int tot_bheadmap;
 
+  /** Data-blocks read ahead in parallel, see #read_file_data_prepare. */
+  struct PreparedData *prepared_data;
+  /** Data-blocks of the current ID that are not read yet, see #BLO_READ_DEFER_PACKED_DATA. */
+  struct GHash *deferred_datamap;
+  /** SDNA index of #PackedFile in the file, only packed file contents are deferred. */
+  int deferred_packedfile_sdna_nr;
+
   /** See: #USE_GHASH_BHEAD. */
   struct GHash *bhead_idname_hash;
 
@@ -140,6 +154,42 @@ typedef struct FileData {
 
 #define SIZEOFBLENDERHEADER 12
 
+/**
+ * Block-compressed gzip files.
+ *
+ * Compressed files are written as a sequence of independent gzip members (frames), each holding
+ * at most #BLEND_GZIP_FRAME_SIZE bytes of uncompressed data. They are followed by an empty gzip
+ * member whose header extra field (sub-field ID #BLEND_GZIP_INDEX_SI1, #BLEND_GZIP_INDEX_SI2)
+ * stores the frame index:
+ *
+ * - `uint32 compressed_size, uint32 uncompressed_size` for every frame.
+ * - `uint32` number of frames.
+ * - #BLEND_GZIP_INDEX_MAGIC.
+ *
+ * All integers are little endian. The index member ends with the 10 bytes of an empty deflate
+ * stream and gzip trailer, so the index can be found from the end of the file.
+ */
+#define BLEND_GZIP_FRAME_SIZE (1 << 20)
+#define BLEND_GZIP_INDEX_SI1 'B'
+#define BLEND_GZIP_INDEX_SI2 'I'
+#define BLEND_GZIP_INDEX_MAGIC "BFIX"
+/** Limited by the 16 bit length of the gzip extra field. */
+#define BLEND_GZIP_INDEX_FRAMES_MAX ((0xffff - 4 - 8) / 8)
+
+BLI_INLINE void blo_gzip_index_write_uint32(unsigned char *dst, uint32_t value)
+{
+  dst[0] = (unsigned char)(value & 0xff);
+  dst[1] = (unsigned char)((value >> 8) & 0xff);
+  dst[2] = (unsigned char)((value >> 16) & 0xff);
+  dst[3] = (unsigned char)((value >> 24) & 0xff);
+}
+
+BLI_INLINE uint32_t blo_gzip_index_read_uint32(const unsigned char *src)
+{
+  return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) |
+         ((uint32_t)src[3] << 24);
+}
+
 /***/
 struct Main;
 void blo_join_main(ListBase *mainlist);
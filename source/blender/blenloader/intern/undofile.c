@@ -36,22 +36,105 @@
 #  include <io.h>
 #endif
 
+#include "zlib.h"
+
 #include "MEM_guardedalloc.h"
 
+#include "DNA_genfile.h"
 #include "DNA_listBase.h"
+#include "DNA_packedFile_types.h"
+#include "DNA_sdna_types.h"
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_threads.h"
 
+#include "BLO_blend_defs.h"
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
 
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
+#include "BKE_packedFile.h"
 
 /* keep last */
 #include "BLI_strict_flags.h"
 
+/* -------------------------------------------------------------------- */
+/** \name Shared Chunk Memory
+ *
+ * The memory of a chunk never changes once written. Snapshots made by #BLO_memfile_share add a
+ * user to that memory instead of copying it, so it's only freed by whichever of the owning chunk
+ * and the snapshot chunks goes last.
+ * \{ */
+
+static struct {
+  ThreadMutex mutex;
+  /** Maps chunk memory to its number of users besides the chunk that owns it. */
+  GHash *users;
+} g_memfile_shared = {BLI_MUTEX_INITIALIZER};
+
+/** Must be called with the mutex locked. */
+static void memfile_chunk_buf_free(const char *buf)
+{
+  if (g_memfile_shared.users != NULL) {
+    void **users_p = BLI_ghash_lookup_p(g_memfile_shared.users, buf);
+    if (users_p != NULL) {
+      const uint users = POINTER_AS_UINT(*users_p) - 1;
+      if (users != 0) {
+        *users_p = POINTER_FROM_UINT(users);
+      }
+      else {
+        BLI_ghash_remove(g_memfile_shared.users, buf, NULL, NULL);
+        if (BLI_ghash_len(g_memfile_shared.users) == 0) {
+          BLI_ghash_free(g_memfile_shared.users, NULL, NULL);
+          g_memfile_shared.users = NULL;
+        }
+      }
+      return;
+    }
+  }
+  MEM_freeN((void *)buf);
+}
+
+/**
+ * Fill \a r_memfile with chunks sharing the memory of the chunks of \a memfile, instead of
+ * copying it. Used to write a snapshot of the undo state from another thread, both memfiles can
+ * be freed in any order.
+ */
+void BLO_memfile_share(MemFile *memfile, MemFile *r_memfile)
+{
+  BLO_memfile_uncompress(memfile);
+
+  memset(r_memfile, 0, sizeof(*r_memfile));
+
+  BLI_mutex_lock(&g_memfile_shared.mutex);
+  if (g_memfile_shared.users == NULL && !BLI_listbase_is_empty(&memfile->chunks)) {
+    g_memfile_shared.users = BLI_ghash_ptr_new(__func__);
+  }
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+    void **users_p;
+    if (BLI_ghash_ensure_p(g_memfile_shared.users, (void *)chunk->buf, &users_p)) {
+      *users_p = POINTER_FROM_UINT(POINTER_AS_UINT(*users_p) + 1);
+    }
+    else {
+      *users_p = POINTER_FROM_UINT(1);
+    }
+
+    /* Not shared in the sense of #MemFileChunk.is_shared, freeing it removes a user. */
+    MemFileChunk *chunk_new = MEM_callocN(sizeof(MemFileChunk), "MemFileChunk");
+    chunk_new->buf = chunk->buf;
+    chunk_new->size = chunk->size;
+    chunk_new->id_session_uuid = chunk->id_session_uuid;
+    chunk_new->hash = chunk->hash;
+    BLI_addtail(&r_memfile->chunks, chunk_new);
+  }
+  BLI_mutex_unlock(&g_memfile_shared.mutex);
+}
+
+/** \} */
+
 /* **************** support for memory-write, for undo buffers *************** */
 
 /* not memfile itself */
@@ -59,12 +142,16 @@ void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
+  BLI_mutex_lock(&g_memfile_shared.mutex);
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
+    if (chunk->is_shared == false && chunk->is_compressed == false) {
+      memfile_chunk_buf_free(chunk->buf);
     }
     MEM_freeN(chunk);
   }
+  BLI_mutex_unlock(&g_memfile_shared.mutex);
+  MEM_SAFE_FREE(memfile->compressed_buf);
+  memfile->compressed_size = 0;
   memfile->size = 0;
 }
 
@@ -79,7 +166,7 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
 
   /* First, detect all memchunks in second memfile that are not owned by it. */
   for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
+    if (sc->is_shared) {
       BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
     }
   }
@@ -87,12 +174,14 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
   /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
    * it is also used by the second memfile, transfer the ownership. */
   for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
+    if (!fc->is_shared && !fc->is_compressed) {
       MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
       if (sc != NULL) {
-        BLI_assert(sc->is_identical);
+        BLI_assert(sc->is_shared);
         sc->is_identical = false;
-        fc->is_identical = true;
+        sc->is_shared = false;
+        fc->is_shared = true;
+        second->size += sc->size;
       }
       /* Note that if the second memfile does not use that chunk, we assume that the first one
        * fully owns it without sharing it with any other memfile, and hence it should be freed with
@@ -113,12 +202,127 @@ void BLO_memfile_clear_future(MemFile *memfile)
   }
 }
 
+/**
+ * Compress the memory owned by \a memfile, for undo steps that are unlikely to be read again soon.
+ * Chunks shared with \a memfile_next (the next undo step) are kept as is, the other steps only
+ * share memory through it.
+ */
+void BLO_memfile_compress(MemFile *memfile, const MemFile *memfile_next)
+{
+  if (memfile->compressed_buf != NULL) {
+    return;
+  }
+
+  GSet *buffers_shared = BLI_gset_ptr_new(__func__);
+  if (memfile_next != NULL) {
+    LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile_next->chunks) {
+      if (chunk->is_shared) {
+        BLI_gset_add(buffers_shared, (void *)chunk->buf);
+      }
+    }
+  }
+
+  size_t raw_size = 0;
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (!chunk->is_shared && !BLI_gset_haskey(buffers_shared, chunk->buf)) {
+      chunk->is_compressed = true;
+      raw_size += chunk->size;
+    }
+  }
+  BLI_gset_free(buffers_shared, NULL);
+
+  /* Sizes are 32 bit in zlib on some platforms. */
+  bool use_compression = (raw_size != 0 && raw_size <= UINT_MAX);
+  size_t compressed_size = use_compression ? (size_t)deflateBound(NULL, (uLong)raw_size) : 0;
+  char *compressed_buf = use_compression ? MEM_mallocN(compressed_size, __func__) : NULL;
+
+  if (use_compression) {
+    z_stream stream = {NULL};
+    use_compression = deflateInit(&stream, Z_BEST_SPEED) == Z_OK;
+    if (use_compression) {
+      stream.next_out = (Bytef *)compressed_buf;
+      stream.avail_out = (uInt)compressed_size;
+      LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+        if (chunk->is_compressed) {
+          stream.next_in = (Bytef *)chunk->buf;
+          stream.avail_in = (uInt)chunk->size;
+          deflate(&stream, Z_NO_FLUSH);
+        }
+      }
+      use_compression = deflate(&stream, Z_FINISH) == Z_STREAM_END &&
+                        stream.total_out < raw_size;
+      compressed_size = stream.total_out;
+      deflateEnd(&stream);
+    }
+  }
+
+  if (!use_compression) {
+    MEM_SAFE_FREE(compressed_buf);
+    LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+      chunk->is_compressed = false;
+    }
+    return;
+  }
+
+  BLI_mutex_lock(&g_memfile_shared.mutex);
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (chunk->is_compressed) {
+      memfile_chunk_buf_free(chunk->buf);
+      chunk->buf = NULL;
+    }
+  }
+  BLI_mutex_unlock(&g_memfile_shared.mutex);
+  memfile->compressed_buf = MEM_reallocN(compressed_buf, compressed_size);
+  memfile->compressed_size = compressed_size;
+  memfile->size = memfile->size - raw_size + compressed_size;
+}
+
+/**
+ * Restore the chunks compressed by #BLO_memfile_compress, needed before reading \a memfile.
+ */
+void BLO_memfile_uncompress(MemFile *memfile)
+{
+  if (memfile->compressed_buf == NULL) {
+    return;
+  }
+
+  z_stream stream = {NULL};
+  stream.next_in = (Bytef *)memfile->compressed_buf;
+  stream.avail_in = (uInt)memfile->compressed_size;
+  int ret = inflateInit(&stream);
+  BLI_assert(ret == Z_OK);
+
+  size_t raw_size = 0;
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (chunk->is_compressed) {
+      char *buf = MEM_mallocN(chunk->size, "Chunk buffer");
+      stream.next_out = (Bytef *)buf;
+      stream.avail_out = (uInt)chunk->size;
+      ret = inflate(&stream, Z_SYNC_FLUSH);
+      BLI_assert(ELEM(ret, Z_OK, Z_STREAM_END) && stream.avail_out == 0);
+      chunk->buf = buf;
+      chunk->is_compressed = false;
+      raw_size += chunk->size;
+    }
+  }
+  inflateEnd(&stream);
+  UNUSED_VARS_NDEBUG(ret);
+
+  memfile->size = memfile->size - memfile->compressed_size + raw_size;
+  MEM_freeN(memfile->compressed_buf);
+  memfile->compressed_buf = NULL;
+  memfile->compressed_size = 0;
+}
+
 void BLO_memfile_write_init(MemFileWriteData *mem_data,
                             MemFile *written_memfile,
                             MemFile *reference_memfile)
 {
   mem_data->written_memfile = written_memfile;
   mem_data->reference_memfile = reference_memfile;
+  if (reference_memfile != NULL) {
+    BLO_memfile_uncompress(reference_memfile);
+  }
   mem_data->reference_current_chunk = reference_memfile ? reference_memfile->chunks.first : NULL;
 
   /* If we have a reference memfile, we generate a mapping between the session_uuid's of the
@@ -144,6 +348,18 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
         }
       }
     }
+
+    /* Chunks that don't match the one at the same position (e.g. after data was inserted in an
+     * ID) may still be found by their content. */
+    mem_data->hash_mapping = BLI_ghash_new(
+        BLI_ghashutil_inthash_p_simple, BLI_ghashutil_intcmp, __func__);
+    LISTBASE_FOREACH (MemFileChunk *, mem_chunk, &reference_memfile->chunks) {
+      void **entry;
+      if (!BLI_ghash_ensure_p(
+              mem_data->hash_mapping, POINTER_FROM_UINT(mem_chunk->hash), &entry)) {
+        *entry = mem_chunk;
+      }
+    }
   }
 }
 
@@ -152,6 +368,9 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
   if (mem_data->id_session_uuid_mapping != NULL) {
     BLI_ghash_free(mem_data->id_session_uuid_mapping, NULL, NULL);
   }
+  if (mem_data->hash_mapping != NULL) {
+    BLI_ghash_free(mem_data->hash_mapping, NULL, NULL);
+  }
 }
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
@@ -163,26 +382,41 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   curchunk->size = size;
   curchunk->buf = NULL;
   curchunk->is_identical = false;
+  curchunk->is_shared = false;
+  curchunk->is_compressed = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
   curchunk->is_identical_future = true;
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
+  curchunk->hash = BLI_hash_mm2((const unsigned char *)buf, size, 0);
   BLI_addtail(&memfile->chunks, curchunk);
 
   /* we compare compchunk with buf */
   if (*compchunk_step != NULL) {
     MemFileChunk *compchunk = *compchunk_step;
-    if (compchunk->size == curchunk->size) {
+    if (compchunk->size == curchunk->size && compchunk->hash == curchunk->hash) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
+        curchunk->is_shared = true;
         compchunk->is_identical_future = true;
       }
     }
     *compchunk_step = compchunk->next;
   }
 
+  /* Share the memory of any other matching chunk, without considering the data unchanged. */
+  if (curchunk->buf == NULL && mem_data->hash_mapping != NULL) {
+    MemFileChunk *compchunk = BLI_ghash_lookup(mem_data->hash_mapping,
+                                               POINTER_FROM_UINT(curchunk->hash));
+    if (compchunk != NULL && compchunk->size == curchunk->size &&
+        memcmp(compchunk->buf, buf, size) == 0) {
+      curchunk->buf = compchunk->buf;
+      curchunk->is_shared = true;
+    }
+  }
+
   /* not equal... */
   if (curchunk->buf == NULL) {
     char *buf_new = MEM_mallocN(size, "Chunk buffer");
@@ -197,6 +431,7 @@ struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                   struct Scene **r_scene)
 {
   struct Main *bmain_undo = NULL;
+  BLO_memfile_uncompress(memfile);
   BlendFileData *bfd = BLO_read_from_memfile(bmain,
                                              BKE_main_blendfile_path(bmain),
                                              memfile,
@@ -215,6 +450,150 @@ struct Main *BLO_memfile_main_get(struct MemFile *memfile,
   return bmain_undo;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Writing Memfiles to Disk
+ *
+ * Undo steps only store where deferred packed data can be read from, see
+ * #PACKEDFILE_SEEK_DEFERRED. Files written to disk get the data itself, so they don't depend on
+ * the file it was deferred from.
+ * \{ */
+
+/** Position in the content of a #MemFile, which is split into chunks. */
+typedef struct MemFileCursor {
+  const MemFileChunk *chunk;
+  size_t offset;
+} MemFileCursor;
+
+/** Copy the next `size` bytes, \return false when the end is reached before. */
+static bool memfile_cursor_read(MemFileCursor *cursor, void *r_data, size_t size)
+{
+  char *dst = r_data;
+  while (size != 0) {
+    if (cursor->chunk == NULL) {
+      return false;
+    }
+    const size_t copy_size = MIN2(size, cursor->chunk->size - cursor->offset);
+    memcpy(dst, cursor->chunk->buf + cursor->offset, copy_size);
+    dst += copy_size;
+    size -= copy_size;
+    cursor->offset += copy_size;
+    if (cursor->offset == cursor->chunk->size) {
+      cursor->chunk = cursor->chunk->next;
+      cursor->offset = 0;
+    }
+  }
+  return true;
+}
+
+static bool memfile_file_write(int file, const void *data, size_t size)
+{
+#ifdef _WIN32
+  return (size_t)write(file, data, (uint)size) == size;
+#else
+  return (size_t)write(file, data, size) == size;
+#endif
+}
+
+/** Write the next `size` bytes (or all remaining ones) to `file` as they are. */
+static bool memfile_cursor_write(MemFileCursor *cursor, int file, size_t size)
+{
+  while (size != 0 && cursor->chunk != NULL) {
+    const size_t write_size = MIN2(size, cursor->chunk->size - cursor->offset);
+    if (!memfile_file_write(file, cursor->chunk->buf + cursor->offset, write_size)) {
+      return false;
+    }
+    size -= write_size;
+    cursor->offset += write_size;
+    if (cursor->offset == cursor->chunk->size) {
+      cursor->chunk = cursor->chunk->next;
+      cursor->offset = 0;
+    }
+  }
+  return true;
+}
+
+/**
+ * Write a #PackedFile with deferred data and the data-block after it, with the data read from
+ * the file it was deferred from when possible.
+ */
+static bool memfile_write_packedfile_deferred(MemFileCursor *cursor,
+                                              int file,
+                                              const BHead *bhead,
+                                              PackedFile *pf)
+{
+  BHead bhead_data;
+  if (!memfile_cursor_read(cursor, &bhead_data, sizeof(bhead_data)) || bhead_data.len < 0) {
+    return false;
+  }
+  void *undo_data = MEM_mallocN((size_t)bhead_data.len, __func__);
+  bool success = memfile_cursor_read(cursor, undo_data, (size_t)bhead_data.len);
+
+  void *data = NULL;
+  if (success && bhead_data.old == pf->data && pf->size >= 0) {
+    data = MEM_mallocN((size_t)pf->size, __func__);
+    if (BKE_packedfile_undo_data_read(undo_data, (size_t)bhead_data.len, data, pf->size)) {
+      pf->seek = 0;
+      bhead_data.len = pf->size;
+    }
+    else {
+      /* Keep it deferred, the file can still be read while the original file exists. */
+      MEM_SAFE_FREE(data);
+    }
+  }
+
+  success = success && memfile_file_write(file, bhead, sizeof(*bhead)) &&
+            memfile_file_write(file, pf, sizeof(*pf)) &&
+            memfile_file_write(file, &bhead_data, sizeof(bhead_data)) &&
+            memfile_file_write(file, data ? data : undo_data, (size_t)bhead_data.len);
+
+  MEM_SAFE_FREE(data);
+  MEM_freeN(undo_data);
+  return success;
+}
+
+static bool memfile_write_expanded(MemFile *memfile, int file)
+{
+  const int packedfile_sdna_nr = DNA_struct_find_nr(DNA_sdna_current_get(), "PackedFile");
+  MemFileCursor cursor = {memfile->chunks.first, 0};
+
+  /* File header, see #write_file_handle. */
+  if (!memfile_cursor_write(&cursor, file, 12)) {
+    return false;
+  }
+
+  BHead bhead;
+  while (memfile_cursor_read(&cursor, &bhead, sizeof(bhead))) {
+    if (bhead.code == DATA && bhead.SDNAnr == packedfile_sdna_nr && bhead.nr == 1 &&
+        bhead.len == sizeof(PackedFile)) {
+      PackedFile pf;
+      if (!memfile_cursor_read(&cursor, &pf, sizeof(pf))) {
+        return false;
+      }
+      if (pf.seek == PACKEDFILE_SEEK_DEFERRED) {
+        if (!memfile_write_packedfile_deferred(&cursor, file, &bhead, &pf)) {
+          return false;
+        }
+      }
+      else if (!memfile_file_write(file, &bhead, sizeof(bhead)) ||
+               !memfile_file_write(file, &pf, sizeof(pf))) {
+        return false;
+      }
+      continue;
+    }
+
+    if (!memfile_file_write(file, &bhead, sizeof(bhead)) ||
+        !memfile_cursor_write(&cursor, file, (size_t)bhead.len)) {
+      return false;
+    }
+    if (bhead.code == ENDB) {
+      break;
+    }
+  }
+
+  /* Anything after the last block. */
+  return memfile_cursor_write(&cursor, file, memfile->size);
+}
+
 /**
  * Saves .blend using undo buffer.
  *
@@ -222,9 +601,10 @@ struct Main *BLO_memfile_main_get(struct MemFile *memfile,
  */
 bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
 {
-  MemFileChunk *chunk;
   int file, oflags;
 
+  BLO_memfile_uncompress(memfile);
+
   /* note: This is currently used for autosave and 'quit.blend',
    * where _not_ following symlinks is OK,
    * however if this is ever executed explicitly by the user,
@@ -251,20 +631,11 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
     return false;
   }
 
-  for (chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
-#ifdef _WIN32
-    if ((size_t)write(file, chunk->buf, (uint)chunk->size) != chunk->size)
-#else
-    if ((size_t)write(file, chunk->buf, chunk->size) != chunk->size)
-#endif
-    {
-      break;
-    }
-  }
+  const bool success = memfile_write_expanded(memfile, file);
 
   close(file);
 
-  if (chunk) {
+  if (!success) {
     fprintf(stderr,
             "Unable to save '%s': %s\n",
             filename,
@@ -273,3 +644,5 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
   }
   return true;
 }
+
+/** \} */
@@ -439,14 +439,14 @@ static void do_versions_windowmanager_2_50(bScreen *screen)
   }
 }
 
-static void versions_gpencil_add_main(ListBase *lb, ID *id, const char *name)
+static void versions_gpencil_add_main(Main *bmain, ListBase *lb, ID *id, const char *name)
 {
   BLI_addtail(lb, id);
   id->us = 1;
   id->flag = LIB_FAKEUSER;
   *((short *)id->name) = ID_GD;
 
-  BKE_id_new_name_validate(lb, id, name);
+  BKE_id_new_name_validate(bmain, lb, id, name);
   /* alphabetic insertion: is in BKE_id_new_name_validate */
 
   BKE_lib_libblock_session_uuid_ensure(id);
@@ -467,21 +467,21 @@ static void do_versions_gpencil_2_50(Main *main, bScreen *screen)
       if (sl->spacetype == SPACE_VIEW3D) {
         View3D *v3d = (View3D *)sl;
         if (v3d->gpd) {
-          versions_gpencil_add_main(&main->gpencils, (ID *)v3d->gpd, "GPencil View3D");
+          versions_gpencil_add_main(main, &main->gpencils, (ID *)v3d->gpd, "GPencil View3D");
           v3d->gpd = NULL;
         }
       }
       else if (sl->spacetype == SPACE_NODE) {
         SpaceNode *snode = (SpaceNode *)sl;
         if (snode->gpd) {
-          versions_gpencil_add_main(&main->gpencils, (ID *)snode->gpd, "GPencil Node");
+          versions_gpencil_add_main(main, &main->gpencils, (ID *)snode->gpd, "GPencil Node");
           snode->gpd = NULL;
         }
       }
       else if (sl->spacetype == SPACE_SEQ) {
         SpaceSeq *sseq = (SpaceSeq *)sl;
         if (sseq->gpd) {
-          versions_gpencil_add_main(&main->gpencils, (ID *)sseq->gpd, "GPencil Node");
+          versions_gpencil_add_main(main, &main->gpencils, (ID *)sseq->gpd, "GPencil Node");
           sseq->gpd = NULL;
         }
       }
@@ -489,7 +489,7 @@ static void do_versions_gpencil_2_50(Main *main, bScreen *screen)
         SpaceImage *sima = (SpaceImage *)sl;
 #if 0 /* see comment on r28002 */
         if (sima->gpd) {
-          versions_gpencil_add_main(&main->gpencil, (ID *)sima->gpd, "GPencil Image");
+          versions_gpencil_add_main(main, &main->gpencil, (ID *)sima->gpd, "GPencil Image");
           sima->gpd = NULL;
         }
 #else
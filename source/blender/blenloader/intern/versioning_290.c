@@ -729,7 +729,7 @@ void blo_do_versions_290(FileData *fd, Library *UNUSED(lib), Main *bmain)
       short id_codes[] = {ID_BR, ID_PAL};
       for (int i = 0; i < ARRAY_SIZE(id_codes); i++) {
         ListBase *lb = which_libbase(bmain, id_codes[i]);
-        BKE_main_id_repair_duplicate_names_listbase(lb);
+        BKE_main_id_repair_duplicate_names_listbase(bmain, lb);
       }
     }
 
@@ -1434,5 +1434,29 @@ void blo_do_versions_290(FileData *fd, Library *UNUSED(lib), Main *bmain)
    */
   {
     /* Keep this block, even when empty. */
+
+    /* Keep the values of existing Attribute Randomize nodes. */
+    if (!DNA_struct_find(fd->filesdna, "NodeAttributeRandomize")) {
+      LISTBASE_FOREACH (bNodeTree *, ntree, &bmain->nodetrees) {
+        if (ntree->type != NTREE_GEOMETRY) {
+          continue;
+        }
+        LISTBASE_FOREACH (bNode *, node, &ntree->nodes) {
+          if (node->type == GEO_NODE_ATTRIBUTE_RANDOMIZE && node->storage == NULL) {
+            NodeAttributeRandomize *data = MEM_callocN(sizeof(NodeAttributeRandomize), __func__);
+            data->flag = GEO_NODE_ATTRIBUTE_RANDOMIZE_LEGACY_RNG;
+            node->storage = data;
+          }
+        }
+      }
+    }
+
+    if (!DNA_struct_elem_find(fd->filesdna, "bNodeTree", "int", "cache_memory_limit")) {
+      LISTBASE_FOREACH (Scene *, scene, &bmain->scenes) {
+        if (scene->nodetree) {
+          scene->nodetree->cache_memory_limit = 1024;
+        }
+      }
+    }
   }
 }
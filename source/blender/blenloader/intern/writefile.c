@@ -70,6 +70,12 @@
  * - write #GLOB (#FileGlobal struct) (some global vars).
  * - write #DNA1 (#SDNA struct)
  * - write #USER (#UserDef struct) if filename is ``~/.config/blender/X.XX/config/startup.blend``.
+ *
+ * COMPRESSION
+ * ===========
+ *
+ * With #G_FILE_COMPRESS the data above is stored as block-compressed gzip, compressed on worker
+ * threads, see #BLEND_GZIP_FRAME_SIZE for the layout.
  */
 
 #include <fcntl.h>
@@ -101,6 +107,7 @@
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_mempool.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
 #include "BKE_blender_version.h"
@@ -147,8 +154,17 @@
 typedef enum {
   WW_WRAP_NONE = 1,
   WW_WRAP_ZLIB,
+  WW_WRAP_MEMFILE,
 } eWriteWrapType;
 
+/** A compressed frame that has been written to the file, used to build the frame index. */
+typedef struct ZlibFrame {
+  struct ZlibFrame *next, *prev;
+
+  uint32_t compressed_size;
+  uint32_t uncompressed_size;
+} ZlibFrame;
+
 typedef struct WriteWrap WriteWrap;
 struct WriteWrap {
   /* callbacks */
@@ -160,15 +176,31 @@ struct WriteWrap {
   bool use_buf;
 
   /* internal */
-  union {
-    int file_handle;
-    gzFile gz_handle;
-  } _user_data;
+  int file_handle;
+  /** Written to instead of a file by #WW_WRAP_MEMFILE. */
+  MemFile *memfile;
+  struct {
+    ListBase threadpool;
+    /** #ZlibWriteFrameTask, in the order they have been dispatched. */
+    ListBase tasks;
+    ThreadMutex mutex;
+    ThreadCondition condition;
+    /** Number of the frame that is allowed to be written to the file next. */
+    int next_frame;
+    int num_frames;
+
+    /** Uncompressed data of the frame that is being filled (#BLEND_GZIP_FRAME_SIZE bytes). */
+    char *frame_buf;
+    size_t frame_buf_used_len;
+
+    /** #ZlibFrame, in file order. */
+    ListBase frames;
+
+    bool write_error;
+  } zlib;
 };
 
 /* none */
-#define FILE_HANDLE(ww) (ww)->_user_data.file_handle
-
 static bool ww_open_none(WriteWrap *ww, const char *filepath)
 {
   int file;
@@ -176,7 +208,7 @@ static bool ww_open_none(WriteWrap *ww, const char *filepath)
   file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
 
   if (file != -1) {
-    FILE_HANDLE(ww) = file;
+    ww->file_handle = file;
     return true;
   }
 
@@ -184,39 +216,259 @@ static bool ww_open_none(WriteWrap *ww, const char *filepath)
 }
 static bool ww_close_none(WriteWrap *ww)
 {
-  return (close(FILE_HANDLE(ww)) != -1);
+  return (close(ww->file_handle) != -1);
 }
 static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return write(FILE_HANDLE(ww), buf, buf_len);
+  return write(ww->file_handle, buf, buf_len);
 }
-#undef FILE_HANDLE
 
-/* zlib */
-#define FILE_HANDLE(ww) (ww)->_user_data.gz_handle
+/* zlib
+ *
+ * The data is split into frames of #BLEND_GZIP_FRAME_SIZE bytes which are compressed on worker
+ * threads as independent gzip members, while the main thread keeps producing data.
+ * Concatenated gzip members are a valid gzip stream, so such files can still be read by any
+ * gzip reader. The last member is empty and stores an index of all frames in its header,
+ * allowing readers to decompress frames in parallel and to seek in the file. */
 
-static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
+typedef struct ZlibWriteFrameTask {
+  struct ZlibWriteFrameTask *next, *prev;
+
+  WriteWrap *ww;
+  char *data;
+  size_t size;
+  int frame_number;
+} ZlibWriteFrameTask;
+
+static void *ww_write_zlib_thread(void *arg)
 {
-  gzFile file;
+  ZlibWriteFrameTask *task = arg;
+  WriteWrap *ww = task->ww;
+
+  z_stream strm = {NULL};
+  uLong out_buf_len = 0;
+  char *out_buf = NULL;
+  size_t out_size = 0;
+  bool ok = false;
+
+  /* Window bits of `16 + MAX_WBITS` write a gzip header and trailer around the frame. */
+  if (deflateInit2(&strm, 1, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+    out_buf_len = deflateBound(&strm, (uLong)task->size);
+    out_buf = MEM_mallocN(out_buf_len, "zlib frame out buffer");
+
+    strm.next_in = (Bytef *)task->data;
+    strm.avail_in = (uInt)task->size;
+    strm.next_out = (Bytef *)out_buf;
+    strm.avail_out = (uInt)out_buf_len;
+
+    ok = (deflate(&strm, Z_FINISH) == Z_STREAM_END);
+    out_size = strm.total_out;
+    deflateEnd(&strm);
+  }
+
+  MEM_freeN(task->data);
+  task->data = NULL;
+
+  BLI_mutex_lock(&ww->zlib.mutex);
+
+  while (ww->zlib.next_frame != task->frame_number) {
+    BLI_condition_wait(&ww->zlib.condition, &ww->zlib.mutex);
+  }
+
+  if (ok && !ww->zlib.write_error) {
+    if (ww_write_none(ww, out_buf, out_size) == out_size) {
+      ZlibFrame *frame = MEM_mallocN(sizeof(ZlibFrame), "zlib frame info");
+      frame->compressed_size = (uint32_t)out_size;
+      frame->uncompressed_size = (uint32_t)task->size;
+      BLI_addtail(&ww->zlib.frames, frame);
+    }
+    else {
+      ww->zlib.write_error = true;
+    }
+  }
+  else {
+    ww->zlib.write_error = true;
+  }
+
+  ww->zlib.next_frame++;
+
+  BLI_mutex_unlock(&ww->zlib.mutex);
+  BLI_condition_notify_all(&ww->zlib.condition);
 
-  file = BLI_gzopen(filepath, "wb1");
+  if (out_buf != NULL) {
+    MEM_freeN(out_buf);
+  }
+  return NULL;
+}
 
-  if (file != Z_NULL) {
-    FILE_HANDLE(ww) = file;
+static void ww_write_zlib_frame_dispatch(WriteWrap *ww)
+{
+  ZlibWriteFrameTask *task = MEM_mallocN(sizeof(ZlibWriteFrameTask), __func__);
+  task->data = ww->zlib.frame_buf;
+  task->size = ww->zlib.frame_buf_used_len;
+  task->frame_number = ww->zlib.num_frames++;
+  task->ww = ww;
+
+  ww->zlib.frame_buf = MEM_mallocN(BLEND_GZIP_FRAME_SIZE, "zlib frame buffer");
+  ww->zlib.frame_buf_used_len = 0;
+
+  BLI_addtail(&ww->zlib.tasks, task);
+
+  /* If there's a free worker thread, just push the frame into that thread.
+   * Otherwise, wait for the oldest thread to finish, this also bounds the amount of
+   * uncompressed data that is kept in memory. */
+  if (!BLI_available_threads(&ww->zlib.threadpool)) {
+    ZlibWriteFrameTask *first_task = ww->zlib.tasks.first;
+    /* If the task list was empty before we pushed our task, there should
+     * always be a free thread. */
+    BLI_assert(first_task != task);
+    BLI_threadpool_remove(&ww->zlib.threadpool, first_task);
+    BLI_remlink(&ww->zlib.tasks, first_task);
+    MEM_freeN(first_task);
+  }
+  BLI_threadpool_insert(&ww->zlib.threadpool, task);
+}
+
+/**
+ * Write the trailing empty gzip member holding the frame index in its extra header field,
+ * see #BLEND_GZIP_INDEX_MAGIC for the layout.
+ */
+static bool ww_write_zlib_frame_index(WriteWrap *ww)
+{
+  const int num_frames = BLI_listbase_count(&ww->zlib.frames);
+  if (num_frames > BLEND_GZIP_INDEX_FRAMES_MAX) {
+    /* The index does not fit into the header, the file is still valid
+     * but can only be decompressed sequentially. */
     return true;
   }
 
-  return false;
+  const size_t index_len = (size_t)num_frames * 8 + 8;
+  const size_t member_len = 10 + 2 + 4 + index_len + 10;
+  uchar *member = MEM_mallocN(member_len, __func__);
+  uchar *p = member;
+
+  /* Header: magic, deflate, #FEXTRA flag, no time-stamp, no extra flags, unknown OS. */
+  const uchar header[10] = {0x1f, 0x8b, 0x08, 0x04, 0, 0, 0, 0, 0, 0xff};
+  memcpy(p, header, sizeof(header));
+  p += sizeof(header);
+
+  const size_t xlen = 4 + index_len;
+  *p++ = (uchar)(xlen & 0xff);
+  *p++ = (uchar)(xlen >> 8);
+  *p++ = BLEND_GZIP_INDEX_SI1;
+  *p++ = BLEND_GZIP_INDEX_SI2;
+  *p++ = (uchar)(index_len & 0xff);
+  *p++ = (uchar)(index_len >> 8);
+
+  LISTBASE_FOREACH (ZlibFrame *, frame, &ww->zlib.frames) {
+    blo_gzip_index_write_uint32(p, frame->compressed_size);
+    blo_gzip_index_write_uint32(p + 4, frame->uncompressed_size);
+    p += 8;
+  }
+  blo_gzip_index_write_uint32(p, (uint32_t)num_frames);
+  memcpy(p + 4, BLEND_GZIP_INDEX_MAGIC, 4);
+  p += 8;
+
+  /* Empty deflate stream, followed by the CRC and size of the (empty) data. */
+  const uchar footer[10] = {0x03, 0x00, 0, 0, 0, 0, 0, 0, 0, 0};
+  memcpy(p, footer, sizeof(footer));
+  p += sizeof(footer);
+
+  BLI_assert((size_t)(p - member) == member_len);
+
+  const bool ok = (ww_write_none(ww, (const char *)member, member_len) == member_len);
+  MEM_freeN(member);
+  return ok;
+}
+
+static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
+{
+  if (!ww_open_none(ww, filepath)) {
+    return false;
+  }
+
+  /* Leave one thread for the main writing logic, unless we only have one hardware thread. */
+  const int num_threads = MAX2(1, BLI_system_thread_count() - 1);
+  BLI_threadpool_init(&ww->zlib.threadpool, ww_write_zlib_thread, num_threads);
+  BLI_mutex_init(&ww->zlib.mutex);
+  BLI_condition_init(&ww->zlib.condition);
+
+  ww->zlib.frame_buf = MEM_mallocN(BLEND_GZIP_FRAME_SIZE, "zlib frame buffer");
+  ww->zlib.frame_buf_used_len = 0;
+
+  return true;
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-  return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+  if (ww->zlib.frame_buf_used_len != 0) {
+    ww_write_zlib_frame_dispatch(ww);
+  }
+  MEM_freeN(ww->zlib.frame_buf);
+  ww->zlib.frame_buf = NULL;
+
+  BLI_threadpool_end(&ww->zlib.threadpool);
+  BLI_freelistN(&ww->zlib.tasks);
+
+  BLI_mutex_end(&ww->zlib.mutex);
+  BLI_condition_end(&ww->zlib.condition);
+
+  bool ok = !ww->zlib.write_error;
+  if (ok) {
+    ok = ww_write_zlib_frame_index(ww);
+  }
+  BLI_freelistN(&ww->zlib.frames);
+
+  return ww_close_none(ww) && ok;
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+  if (ww->zlib.write_error) {
+    return 0;
+  }
+
+  size_t remaining_len = buf_len;
+  while (remaining_len != 0) {
+    const size_t copy_len = MIN2(remaining_len,
+                                 BLEND_GZIP_FRAME_SIZE - ww->zlib.frame_buf_used_len);
+    memcpy(ww->zlib.frame_buf + ww->zlib.frame_buf_used_len, buf, copy_len);
+    ww->zlib.frame_buf_used_len += copy_len;
+    buf += copy_len;
+    remaining_len -= copy_len;
+
+    if (ww->zlib.frame_buf_used_len == BLEND_GZIP_FRAME_SIZE) {
+      ww_write_zlib_frame_dispatch(ww);
+    }
+  }
+
+  return buf_len;
+}
+
+/* memfile
+ *
+ * A regular file kept in memory, e.g. to be written to disk from another thread with
+ * #BLO_memfile_write_file. Unlike undo steps, chunks are never shared. */
+
+static bool ww_open_memfile(WriteWrap *UNUSED(ww), const char *UNUSED(filepath))
+{
+  return true;
+}
+static bool ww_close_memfile(WriteWrap *UNUSED(ww))
+{
+  return true;
+}
+static size_t ww_write_memfile(WriteWrap *ww, const char *buf, size_t buf_len)
+{
+  char *chunk_buf = MEM_mallocN(buf_len, "Chunk buffer");
+  memcpy(chunk_buf, buf, buf_len);
+
+  MemFileChunk *chunk = MEM_callocN(sizeof(MemFileChunk), "MemFileChunk");
+  chunk->buf = chunk_buf;
+  chunk->size = buf_len;
+  chunk->id_session_uuid = MAIN_ID_SESSION_UUID_UNSET;
+  BLI_addtail(&ww->memfile->chunks, chunk);
+  ww->memfile->size += buf_len;
+  return buf_len;
 }
-#undef FILE_HANDLE
 
 /* --- end compression types --- */
 
@@ -229,9 +481,17 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->open = ww_open_zlib;
       r_ww->close = ww_close_zlib;
       r_ww->write = ww_write_zlib;
+      /* Frames are buffered by the writer itself. */
       r_ww->use_buf = false;
       break;
     }
+    case WW_WRAP_MEMFILE: {
+      r_ww->open = ww_open_memfile;
+      r_ww->close = ww_close_memfile;
+      r_ww->write = ww_write_memfile;
+      r_ww->use_buf = true;
+      break;
+    }
     default: {
       r_ww->open = ww_open_none;
       r_ww->close = ww_close_none;
@@ -1225,9 +1485,12 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
+  bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
 
-  ww.close(&ww);
+  /* Compressed frames may still be written to disk while closing. */
+  if (ww.close(&ww) == false) {
+    err = true;
+  }
 
   if (UNLIKELY(path_list_backup)) {
     BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
@@ -1242,6 +1505,9 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* file save to temporary file was successful */
+  /* Undo steps may still read deferred packed data from the file that is replaced. */
+  BKE_packedfile_deferred_file_overwrite(filepath);
+
   /* now do reverse file history (move .blend1 -> .blend2, .blend -> .blend1) */
   if (use_save_versions) {
     const bool err_hist = do_history(filepath, reports);
@@ -1277,6 +1543,28 @@ bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int w
   return (err == 0);
 }
 
+/**
+ * Write a regular file (not an undo step) into \a r_memfile, without compression, thumbnail or
+ * path remapping. It can then be written to disk with #BLO_memfile_write_file.
+ *
+ * \return Success.
+ */
+bool BLO_write_file_to_memfile(Main *mainvar, MemFile *r_memfile, const int write_flags)
+{
+  WriteWrap ww;
+  ww_handle_init(WW_WRAP_MEMFILE, &ww);
+  memset(r_memfile, 0, sizeof(*r_memfile));
+  ww.memfile = r_memfile;
+
+  const bool err = write_file_handle(
+      mainvar, &ww, NULL, NULL, write_flags & ~G_FILE_COMPRESS, false, NULL);
+  if (err) {
+    BLO_memfile_free(r_memfile);
+  }
+
+  return (err == 0);
+}
+
 void BLO_write_raw(BlendWriter *writer, size_t size_in_bytes, const void *data_ptr)
 {
   writedata(writer->wd, DATA, size_in_bytes, data_ptr);
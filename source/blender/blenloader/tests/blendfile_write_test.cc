@@ -0,0 +1,352 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "blendfile_loading_base_test.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_customdata.h"
+#include "BKE_global.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_packedFile.h"
+
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_path_util.h"
+
+#include "BLO_readfile.h"
+#include "BLO_undofile.h"
+#include "BLO_writefile.h"
+
+#include "DNA_image_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_packedFile_types.h"
+
+class BlendfileWriteTest : public BlendfileLoadingBaseTest {
+ protected:
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    BKE_tempdir_init(nullptr);
+  }
+
+  /* Enough vertices for the mesh data to span several compressed frames. */
+  static constexpr int verts_num = 400000;
+
+  Main *test_main_new()
+  {
+    Main *bmain = BKE_main_new();
+    Mesh *mesh = BKE_mesh_add(bmain, "TestMesh");
+    mesh->mvert = (MVert *)CustomData_add_layer(
+        &mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, verts_num);
+    mesh->totvert = verts_num;
+    for (int i = 0; i < verts_num; i++) {
+      mesh->mvert[i].co[0] = (float)i;
+      mesh->mvert[i].co[1] = (float)(i % 7);
+      mesh->mvert[i].co[2] = -(float)i;
+    }
+    return bmain;
+  }
+
+  void write_test_file(const char *filepath, const int write_flags)
+  {
+    Main *bmain = test_main_new();
+    BlendFileWriteParams params = {BLO_WRITE_PATH_REMAP_NONE};
+    EXPECT_TRUE(BLO_write_file(bmain, filepath, write_flags, &params, nullptr));
+    BKE_main_free(bmain);
+  }
+
+  void expect_test_mesh(BlendFileData *bfd)
+  {
+    ASSERT_NE(bfd, nullptr);
+    Mesh *mesh = (Mesh *)bfd->main->meshes.first;
+    ASSERT_NE(mesh, nullptr);
+    ASSERT_EQ(mesh->totvert, verts_num);
+    const MVert *mvert = (const MVert *)CustomData_get_layer(&mesh->vdata, CD_MVERT);
+    ASSERT_NE(mvert, nullptr);
+    for (int i = 0; i < verts_num; i++) {
+      EXPECT_EQ(mvert[i].co[0], (float)i);
+      EXPECT_EQ(mvert[i].co[1], (float)(i % 7));
+      EXPECT_EQ(mvert[i].co[2], -(float)i);
+    }
+    BLO_blendfiledata_free(bfd);
+  }
+
+  /* Two images with a packed file each, of different contents. */
+  void write_packed_test_file(const char *filepath, const int data_size)
+  {
+    Main *bmain = BKE_main_new();
+    for (int i = 0; i < 2; i++) {
+      Image *ima = (Image *)BKE_id_new(bmain, ID_IM, "TestImage");
+      char *data = (char *)MEM_mallocN(data_size, __func__);
+      for (int j = 0; j < data_size; j++) {
+        data[j] = (char)(i + j);
+      }
+      ImagePackedFile *imapf = (ImagePackedFile *)MEM_callocN(sizeof(*imapf), __func__);
+      imapf->packedfile = BKE_packedfile_new_from_memory(data, data_size);
+      BLI_addtail(&ima->packedfiles, imapf);
+    }
+    BlendFileWriteParams params = {BLO_WRITE_PATH_REMAP_NONE};
+    EXPECT_TRUE(BLO_write_file(bmain, filepath, 0, &params, nullptr));
+    BKE_main_free(bmain);
+  }
+
+  void expect_packed_data(BlendFileData *bfd, const int data_size)
+  {
+    ASSERT_NE(bfd, nullptr);
+    int i = 0;
+    LISTBASE_FOREACH (Image *, ima, &bfd->main->images) {
+      ImagePackedFile *imapf = (ImagePackedFile *)ima->packedfiles.first;
+      ASSERT_NE(imapf, nullptr);
+      PackedFile *pf = imapf->packedfile;
+      ASSERT_NE(pf, nullptr);
+      ASSERT_EQ(pf->size, data_size);
+      ASSERT_TRUE(BKE_packedfile_data_acquire(pf));
+      const char *data = (const char *)pf->data;
+      EXPECT_EQ(data[0], (char)i);
+      EXPECT_EQ(data[data_size - 1], (char)(i + data_size - 1));
+      BKE_packedfile_data_release(pf);
+      i++;
+    }
+    EXPECT_EQ(i, 2);
+    BLO_blendfiledata_free(bfd);
+  }
+};
+
+TEST_F(BlendfileWriteTest, CompressedRoundTrip)
+{
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "compressed.blend");
+  write_test_file(filepath, G_FILE_COMPRESS);
+
+  /* Compressed files are (multi-member) gzip files. */
+  size_t file_size = 0;
+  unsigned char *file_mem = (unsigned char *)BLI_file_read_binary_as_mem(filepath, 0, &file_size);
+  ASSERT_NE(file_mem, nullptr);
+  ASSERT_GT(file_size, 2);
+  EXPECT_EQ(file_mem[0], 0x1f);
+  EXPECT_EQ(file_mem[1], 0x8b);
+
+  /* Read through the frame index. */
+  expect_test_mesh(BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, nullptr));
+
+  /* Read as a sequential gzip stream. */
+  expect_test_mesh(BLO_read_from_memory(file_mem, (int)file_size, BLO_READ_SKIP_NONE, nullptr));
+
+  MEM_freeN(file_mem);
+  BLI_delete(filepath, false, false);
+}
+
+TEST_F(BlendfileWriteTest, UncompressedRoundTrip)
+{
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "uncompressed.blend");
+  write_test_file(filepath, 0);
+
+  expect_test_mesh(BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, nullptr));
+
+  BLI_delete(filepath, false, false);
+}
+
+TEST_F(BlendfileWriteTest, DeferredPackedData)
+{
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "packed.blend");
+
+  const int data_size = 256 * 1024;
+  write_packed_test_file(filepath, data_size);
+
+  BlendFileData *bfd = BLO_read_from_file(filepath, BLO_READ_DEFER_PACKED_DATA, nullptr);
+  ASSERT_NE(bfd, nullptr);
+  ASSERT_EQ(BLI_listbase_count(&bfd->main->images), 2);
+  PackedFile *pf[2];
+  int i = 0;
+  LISTBASE_FOREACH (Image *, ima, &bfd->main->images) {
+    ImagePackedFile *imapf = (ImagePackedFile *)ima->packedfiles.first;
+    ASSERT_NE(imapf, nullptr);
+    pf[i] = imapf->packedfile;
+    ASSERT_NE(pf[i], nullptr);
+    EXPECT_EQ(pf[i]->size, data_size);
+    EXPECT_EQ(pf[i]->data, nullptr);
+    i++;
+  }
+
+  /* Only one of the packed files fits in the budget. */
+  BKE_packedfile_deferred_budget_set(data_size);
+  for (i = 0; i < 2; i++) {
+    ASSERT_TRUE(BKE_packedfile_data_acquire(pf[i]));
+    const char *data = (const char *)pf[i]->data;
+    EXPECT_EQ(data[0], (char)i);
+    EXPECT_EQ(data[data_size - 1], (char)(i + data_size - 1));
+    BKE_packedfile_data_release(pf[i]);
+  }
+  EXPECT_EQ(pf[0]->data, nullptr);
+  EXPECT_NE(pf[1]->data, nullptr);
+
+  /* Data in use is not freed, even when it doesn't fit. */
+  ASSERT_TRUE(BKE_packedfile_data_acquire(pf[0]));
+  ASSERT_TRUE(BKE_packedfile_data_acquire(pf[1]));
+  EXPECT_NE(pf[0]->data, nullptr);
+  EXPECT_NE(pf[1]->data, nullptr);
+  BKE_packedfile_data_release(pf[1]);
+  EXPECT_EQ(pf[1]->data, nullptr);
+  BKE_packedfile_data_release(pf[0]);
+  EXPECT_NE(pf[0]->data, nullptr);
+  BKE_packedfile_deferred_budget_set(0);
+  BLO_blendfiledata_free(bfd);
+
+  /* Undo steps written to disk don't depend on the file the data was deferred from. */
+  char filepath_undo[FILE_MAX];
+  BLI_join_dirfile(filepath_undo, sizeof(filepath_undo), BKE_tempdir_session(), "quit.blend");
+  bfd = BLO_read_from_file(filepath, BLO_READ_DEFER_PACKED_DATA, nullptr);
+  ASSERT_NE(bfd, nullptr);
+  MemFile memfile = {{nullptr}};
+  ASSERT_TRUE(BLO_write_file_mem(bfd->main, nullptr, &memfile, 0));
+  EXPECT_LT(memfile.size, size_t(data_size));
+  EXPECT_TRUE(BLO_memfile_write_file(&memfile, filepath_undo));
+  BLO_memfile_free(&memfile);
+  BLO_blendfiledata_free(bfd);
+  BLI_delete(filepath, false, false);
+
+  bfd = BLO_read_from_file(filepath_undo, BLO_READ_SKIP_NONE, nullptr);
+  ASSERT_NE(bfd, nullptr);
+  i = 0;
+  LISTBASE_FOREACH (Image *, ima, &bfd->main->images) {
+    ImagePackedFile *imapf = (ImagePackedFile *)ima->packedfiles.first;
+    ASSERT_NE(imapf, nullptr);
+    const PackedFile *pf_undo = imapf->packedfile;
+    ASSERT_NE(pf_undo, nullptr);
+    ASSERT_EQ(pf_undo->size, data_size);
+    ASSERT_NE(pf_undo->data, nullptr);
+    const char *data = (const char *)pf_undo->data;
+    EXPECT_EQ(data[0], (char)i);
+    EXPECT_EQ(data[data_size - 1], (char)(i + data_size - 1));
+    i++;
+  }
+  EXPECT_EQ(i, 2);
+
+  BLO_blendfiledata_free(bfd);
+  BLI_delete(filepath_undo, false, false);
+}
+
+TEST_F(BlendfileWriteTest, DeferredPackedDataSave)
+{
+  char filepath[FILE_MAX];
+  char filepath_undo[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "packed_save.blend");
+  BLI_join_dirfile(filepath_undo, sizeof(filepath_undo), BKE_tempdir_session(), "quit.blend");
+
+  const int data_size = 256 * 1024;
+  write_packed_test_file(filepath, data_size);
+
+  BlendFileData *bfd = BLO_read_from_file(filepath, BLO_READ_DEFER_PACKED_DATA, nullptr);
+  ASSERT_NE(bfd, nullptr);
+  MemFile memfile = {{nullptr}};
+  ASSERT_TRUE(BLO_write_file_mem(bfd->main, nullptr, &memfile, 0));
+
+  /* Nothing fits in the budget, saving still writes all data. Saving over the file the data was
+   * deferred from keeps the undo step readable. */
+  BKE_packedfile_deferred_budget_set(1);
+  BlendFileWriteParams params = {BLO_WRITE_PATH_REMAP_NONE};
+  EXPECT_TRUE(BLO_write_file(bfd->main, filepath, 0, &params, nullptr));
+  BLO_blendfiledata_free(bfd);
+
+  EXPECT_TRUE(BLO_memfile_write_file(&memfile, filepath_undo));
+  BLO_memfile_free(&memfile);
+  BKE_packedfile_deferred_undo_free();
+
+  expect_packed_data(BLO_read_from_file(filepath, BLO_READ_DEFER_PACKED_DATA, nullptr),
+                     data_size);
+  expect_packed_data(BLO_read_from_file(filepath_undo, BLO_READ_SKIP_NONE, nullptr), data_size);
+  BKE_packedfile_deferred_budget_set(0);
+
+  BLI_delete(filepath, false, false);
+  BLI_delete(filepath_undo, false, false);
+}
+
+TEST_F(BlendfileWriteTest, MemFileUndo)
+{
+  Main *bmain = test_main_new();
+  MemFile memfile_a = {{nullptr}};
+  MemFile memfile_b = {{nullptr}};
+  MemFile memfile_c = {{nullptr}};
+  ASSERT_TRUE(BLO_write_file_mem(bmain, nullptr, &memfile_a, 0));
+  const size_t size_a = memfile_a.size;
+
+  /* Only the changed part of the vertices takes new memory. */
+  Mesh *mesh = (Mesh *)bmain->meshes.first;
+  mesh->mvert[0].co[0] = -1.0f;
+  BLO_memfile_clear_future(&memfile_a);
+  ASSERT_TRUE(BLO_write_file_mem(bmain, &memfile_a, &memfile_b, 0));
+  EXPECT_LT(memfile_b.size, size_a / 100);
+  mesh->mvert[0].co[0] = 0.0f;
+
+  /* Memory that is not used by the next step is compressed. */
+  BLO_memfile_compress(&memfile_a, &memfile_b);
+  EXPECT_NE(memfile_a.compressed_buf, nullptr);
+  EXPECT_LT(memfile_a.size, size_a);
+
+  /* The compressed step can be used as reference, matching the content of any chunk. */
+  BLO_memfile_clear_future(&memfile_a);
+  ASSERT_TRUE(BLO_write_file_mem(bmain, &memfile_a, &memfile_c, 0));
+  EXPECT_EQ(memfile_a.compressed_buf, nullptr);
+  EXPECT_EQ(memfile_a.size, size_a);
+  EXPECT_EQ(memfile_c.size, 0);
+
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "memfile.blend");
+  BLO_memfile_compress(&memfile_a, &memfile_b);
+  ASSERT_TRUE(BLO_memfile_write_file(&memfile_a, filepath));
+  expect_test_mesh(BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, nullptr));
+
+  BLO_memfile_free(&memfile_a);
+  BLO_memfile_free(&memfile_b);
+  BLO_memfile_free(&memfile_c);
+  BKE_main_free(bmain);
+  BLI_delete(filepath, false, false);
+}
+
+TEST_F(BlendfileWriteTest, MemFileShare)
+{
+  Main *bmain = test_main_new();
+  MemFile memfile = {{nullptr}};
+  MemFile memfile_shared = {{nullptr}};
+  ASSERT_TRUE(BLO_write_file_mem(bmain, nullptr, &memfile, 0));
+  BKE_main_free(bmain);
+
+  BLO_memfile_share(&memfile, &memfile_shared);
+  ASSERT_EQ(BLI_listbase_count(&memfile_shared.chunks), BLI_listbase_count(&memfile.chunks));
+  EXPECT_EQ(((MemFileChunk *)memfile_shared.chunks.first)->buf,
+            ((MemFileChunk *)memfile.chunks.first)->buf);
+
+  /* The shared memory stays valid when the undo step is compressed and freed. */
+  BLO_memfile_compress(&memfile, nullptr);
+  EXPECT_NE(memfile.compressed_buf, nullptr);
+  BLO_memfile_free(&memfile);
+
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "memfile_shared.blend");
+  ASSERT_TRUE(BLO_memfile_write_file(&memfile_shared, filepath));
+  BLO_memfile_free(&memfile_shared);
+  expect_test_mesh(BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, nullptr));
+
+  BLI_delete(filepath, false, false);
+}
@@ -356,8 +356,10 @@ void COM_deinitialize(void);
 /**
  * \brief Clear all compositor caches. (Compositor system will still remain available).
  * To deinitialize the compositor use the COM_deinitialize method.
+ * \note Must be called when data the compositor reads changes outside of the node tree, like the
+ * pixels of an image or a mask, because the cached buffers don't notice that.
  */
-// void COM_clearCaches(void); // NOT YET WRITTEN
+void COM_clearCaches(void);
 
 #ifdef __cplusplus
 }
@@ -68,10 +68,17 @@ typedef enum CompositorPriority {
 // workscheduler threading models
 /**
  * COM_TM_QUEUE is a multi-threaded model, which uses the BLI_thread_queue pattern.
- * This is the default option.
+ * This is the default option when building without TBB.
  */
 #define COM_TM_QUEUE 1
 
+/**
+ * COM_TM_TASK is a multi-threaded model, which pushes the work packages into a BLI_task pool.
+ * The packages are executed by the threads of the shared task scheduler, which is also used by
+ * the rest of Blender. This is the default option when building with TBB.
+ */
+#define COM_TM_TASK 2
+
 /**
  * COM_TM_NOTHREAD is a single threading model, everything is executed in the caller thread.
  * easy for debugging
@@ -79,9 +86,14 @@ typedef enum CompositorPriority {
 #define COM_TM_NOTHREAD 0
 
 /**
- * COM_CURRENT_THREADING_MODEL can be one of the above, COM_TM_QUEUE is currently default.
+ * COM_CURRENT_THREADING_MODEL can be one of the above. Without TBB, task pools execute their tasks
+ * in the calling thread, so COM_TM_TASK is only used when TBB is available.
  */
-#define COM_CURRENT_THREADING_MODEL COM_TM_QUEUE
+#ifdef WITH_TBB
+#  define COM_CURRENT_THREADING_MODEL COM_TM_TASK
+#else
+#  define COM_CURRENT_THREADING_MODEL COM_TM_QUEUE
+#endif
 // chunk order
 /**
  * \brief The order of chunks to be scheduled
@@ -102,6 +114,15 @@ typedef enum OrderOfChunks {
 
 #define COM_RULE_OF_THIRDS_DIVIDER 100.0f
 
+/** \brief number of row bands per thread the full frame execution model splits a buffer into */
+#define COM_FULL_FRAME_BANDS_PER_THREAD 4
+
+/**
+ * \brief maximum number of pixels an operation calculates in one call to executeSpan.
+ * Span buffers are allocated on the stack, 4 floats per pixel.
+ */
+#define COM_SPAN_LENGTH 64
+
 #define COM_NUM_CHANNELS_VALUE 1
 #define COM_NUM_CHANNELS_VECTOR 3
 #define COM_NUM_CHANNELS_COLOR 4
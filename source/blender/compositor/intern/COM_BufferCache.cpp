@@ -0,0 +1,385 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <cstring>
+#include <map>
+#include <typeinfo>
+
+#include "COM_BufferCache.h"
+#include "COM_ExecutionGroup.h"
+#include "COM_NodeOperation.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+
+#include "BKE_camera.h"
+#include "BKE_node.h"
+
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+
+#include "DNA_camera_types.h"
+#include "DNA_color_types.h"
+#include "DNA_node_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "MEM_guardedalloc.h"
+
+struct CachedBuffer {
+  MemoryBuffer *buffer;
+  size_t size;
+  uint64_t lastUsed;
+};
+
+static ThreadMutex g_mutex = BLI_MUTEX_INITIALIZER;
+static std::map<uint64_t, CachedBuffer> g_buffers;
+static size_t g_size = 0;
+static uint64_t g_useCounter = 0;
+static unsigned int g_generation = 0;
+
+/* -------------------------------------------------------------------- */
+/** \name Keys
+ * \{ */
+
+/**
+ * 64 bit FNV-1a hash, collisions would silently show wrong results, so 32 bits are not enough.
+ */
+class KeyHasher {
+ private:
+  uint64_t m_hash;
+
+ public:
+  KeyHasher() : m_hash(0xcbf29ce484222325)
+  {
+  }
+
+  void add(const void *data, size_t size)
+  {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+      m_hash = (m_hash ^ bytes[i]) * 0x100000001b3;
+    }
+  }
+
+  void add(uint64_t value)
+  {
+    add(&value, sizeof(value));
+  }
+
+  void add(float value)
+  {
+    add(&value, sizeof(value));
+  }
+
+  void add(const char *str)
+  {
+    add(str, strlen(str) + 1);
+  }
+
+  /* Memory allocated with MEM_*, used for node storage and socket values. */
+  void addAllocation(const void *data)
+  {
+    if (data == nullptr) {
+      add((uint64_t)0);
+    }
+    else {
+      add(data, MEM_allocN_len(data));
+    }
+  }
+
+  uint64_t get() const
+  {
+    return m_hash;
+  }
+};
+
+/* Curve mappings are copied when the tree is localized for execution, hash their points instead
+ * of the pointers to them. */
+static void hash_curve_mapping(KeyHasher &hasher, const CurveMapping *cumap)
+{
+  hasher.add((uint64_t)cumap->flag);
+  hasher.add((uint64_t)cumap->preset);
+  hasher.add((uint64_t)cumap->tone);
+  hasher.add(&cumap->clipr, sizeof(cumap->clipr));
+  hasher.add(cumap->black, sizeof(cumap->black));
+  hasher.add(cumap->white, sizeof(cumap->white));
+  for (int i = 0; i < CM_TOT; i++) {
+    const CurveMap *cuma = &cumap->cm[i];
+    hasher.add(cuma->ext_in, sizeof(cuma->ext_in));
+    hasher.add(cuma->ext_out, sizeof(cuma->ext_out));
+    hasher.add((uint64_t)cuma->totpoint);
+    for (int a = 0; a < cuma->totpoint; a++) {
+      hasher.add(cuma->curve[a].x);
+      hasher.add(cuma->curve[a].y);
+      hasher.add((uint64_t)cuma->curve[a].flag);
+    }
+  }
+}
+
+static void hash_node_storage(KeyHasher &hasher, const bNode *node)
+{
+  if (node->storage == nullptr) {
+    return;
+  }
+  switch (node->type) {
+    case CMP_NODE_CURVE_VEC:
+    case CMP_NODE_CURVE_RGB:
+    case CMP_NODE_TIME:
+    case CMP_NODE_HUECORRECT:
+      hash_curve_mapping(hasher, (const CurveMapping *)node->storage);
+      break;
+    case CMP_NODE_CRYPTOMATTE: {
+      const NodeCryptomatte *crypto = (const NodeCryptomatte *)node->storage;
+      LISTBASE_FOREACH (const CryptomatteEntry *, entry, &crypto->entries) {
+        hasher.add(entry->encoded_hash);
+      }
+      hasher.add((uint64_t)crypto->num_inputs);
+      break;
+    }
+    case CMP_NODE_MOVIEDISTORTION:
+      /* Runtime cache of the distortion, the settings are in custom1 and the clip. */
+      break;
+    default:
+      hasher.addAllocation(node->storage);
+      break;
+  }
+}
+
+/* Some nodes read data outside of the node tree while they are converted into operations, the
+ * key has to change when that data does. */
+static void hash_node_scene_data(KeyHasher &hasher, const bNode *node, const Scene *scene)
+{
+  switch (node->type) {
+    case CMP_NODE_DEFOCUS: {
+      const NodeDefocus *data = (const NodeDefocus *)node->storage;
+      if (data == nullptr || data->no_zbuf) {
+        break;
+      }
+      /* Same fallbacks as #DefocusNode::convertToOperations. */
+      const Scene *defocus_scene = node->id ? (const Scene *)node->id : scene;
+      Object *camob = defocus_scene ? defocus_scene->camera : nullptr;
+      if (camob == nullptr || camob->type != OB_CAMERA) {
+        break;
+      }
+      const Camera *camera = (const Camera *)camob->data;
+      hasher.add((uint64_t)camob->id.session_uuid);
+      hasher.add(camera->lens);
+      hasher.add((uint64_t)camera->sensor_fit);
+      hasher.add(camera->sensor_x);
+      hasher.add(camera->sensor_y);
+      /* Covers the focus distance as well as the transforms of the camera and focus object. */
+      hasher.add(BKE_camera_object_dof_distance(camob));
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+static void hash_node_sockets(KeyHasher &hasher, const ListBase *sockets)
+{
+  LISTBASE_FOREACH (const bNodeSocket *, sock, sockets) {
+    /* The links of a node decide how it is converted into operations. */
+    hasher.add((uint64_t)(sock->flag & (SOCK_IN_USE | SOCK_UNAVAIL)));
+    hasher.addAllocation(sock->default_value);
+    hasher.addAllocation(sock->storage);
+  }
+}
+
+class OperationHasher {
+ private:
+  uint64_t m_contextHash;
+  const Scene *m_scene;
+  std::map<const bNode *, uint64_t> m_nodeHashes;
+  std::map<NodeOperation *, uint64_t> m_operationHashes;
+
+  uint64_t hashNode(const bNode *node)
+  {
+    auto found = m_nodeHashes.find(node);
+    if (found != m_nodeHashes.end()) {
+      return found->second;
+    }
+    KeyHasher hasher;
+    hasher.add(node->idname);
+    hasher.add((uint64_t)node->type);
+    hasher.add((uint64_t)(node->flag & NODE_MUTED));
+    hasher.add((uint64_t)node->custom1);
+    hasher.add((uint64_t)node->custom2);
+    hasher.add(node->custom3);
+    hasher.add(node->custom4);
+    /* Session UUID instead of the pointer, so that new data-blocks never match old ones. */
+    hasher.add((uint64_t)(node->id ? node->id->session_uuid : 0));
+    hash_node_storage(hasher, node);
+    hash_node_scene_data(hasher, node, m_scene);
+    hash_node_sockets(hasher, &node->inputs);
+    hash_node_sockets(hasher, &node->outputs);
+    m_nodeHashes[node] = hasher.get();
+    return hasher.get();
+  }
+
+ public:
+  OperationHasher(const CompositorContext &context) : m_scene(context.getScene())
+  {
+    const RenderData *rd = context.getRenderData();
+    KeyHasher hasher;
+    hasher.add((uint64_t)context.getFramenumber());
+    hasher.add((uint64_t)context.getQuality());
+    hasher.add(context.getViewName() ? context.getViewName() : "");
+    hasher.add((uint64_t)rd->xsch);
+    hasher.add((uint64_t)rd->ysch);
+    hasher.add((uint64_t)rd->size);
+    m_contextHash = hasher.get();
+  }
+
+  uint64_t hashOperation(NodeOperation *operation)
+  {
+    auto found = m_operationHashes.find(operation);
+    if (found != m_operationHashes.end()) {
+      return found->second;
+    }
+    KeyHasher hasher;
+    hasher.add(m_contextHash);
+    hasher.add(typeid(*operation).name());
+    hasher.add((uint64_t)operation->getWidth());
+    hasher.add((uint64_t)operation->getHeight());
+    if (operation->getbNode()) {
+      hasher.add(hashNode(operation->getbNode()));
+      hasher.add((uint64_t)operation->getbNodeOperationIndex());
+    }
+    if (operation->isSetOperation()) {
+      /* Constants for unlinked inputs don't have a node, their value is all there is. */
+      float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      operation->readSampled(value, 0.0f, 0.0f, COM_PS_NEAREST);
+      hasher.add(value, sizeof(value));
+    }
+    if (operation->isReadBufferOperation()) {
+      ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+      hasher.add(hashOperation(readOperation->getMemoryProxy()->getWriteBufferOperation()));
+    }
+    for (unsigned int i = 0; i < operation->getNumberOfInputSockets(); i++) {
+      NodeOperationOutput *link = operation->getInputSocket(i)->getLink();
+      hasher.add(link ? hashOperation(&link->getOperation()) : (uint64_t)0);
+    }
+    m_operationHashes[operation] = hasher.get();
+    return hasher.get();
+  }
+};
+
+void BufferCache::determineKeys(const CompositorContext &context,
+                                const vector<ExecutionGroup *> &groups)
+{
+  OperationHasher hasher(context);
+  for (ExecutionGroup *group : groups) {
+    NodeOperation *operation = group->getOutputOperation();
+    group->setCacheKey(operation->isWriteBufferOperation() ? hasher.hashOperation(operation) : 0);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Storage
+ * \{ */
+
+unsigned int BufferCache::getGeneration()
+{
+  BLI_mutex_lock(&g_mutex);
+  const unsigned int generation = g_generation;
+  BLI_mutex_unlock(&g_mutex);
+  return generation;
+}
+
+bool BufferCache::restore(uint64_t key, MemoryProxy *proxy)
+{
+  MemoryBuffer *buffer = proxy->getBuffer();
+  bool found = false;
+  BLI_mutex_lock(&g_mutex);
+  auto cached = g_buffers.find(key);
+  if (cached != g_buffers.end()) {
+    MemoryBuffer *cachedBuffer = cached->second.buffer;
+    if (cachedBuffer->getWidth() == buffer->getWidth() &&
+        cachedBuffer->getHeight() == buffer->getHeight() &&
+        cachedBuffer->get_num_channels() == buffer->get_num_channels()) {
+      buffer->copyContentFrom(cachedBuffer);
+      cached->second.lastUsed = ++g_useCounter;
+      found = true;
+    }
+  }
+  BLI_mutex_unlock(&g_mutex);
+  return found;
+}
+
+static void free_cached_buffer(std::map<uint64_t, CachedBuffer>::iterator cached)
+{
+  g_size -= cached->second.size;
+  delete cached->second.buffer;
+  g_buffers.erase(cached);
+}
+
+void BufferCache::store(uint64_t key,
+                        MemoryProxy *proxy,
+                        unsigned int generation,
+                        size_t memoryLimit)
+{
+  MemoryBuffer *buffer = proxy->getBuffer();
+  const size_t size = sizeof(float) * buffer->getWidth() * buffer->getHeight() *
+                      buffer->get_num_channels();
+  if (size > memoryLimit) {
+    return;
+  }
+
+  MemoryBuffer *copy = new MemoryBuffer(proxy->getDataType(), buffer->getRect());
+  copy->copyContentFrom(buffer);
+
+  BLI_mutex_lock(&g_mutex);
+  if (generation != g_generation) {
+    BLI_mutex_unlock(&g_mutex);
+    delete copy;
+    return;
+  }
+  auto existing = g_buffers.find(key);
+  if (existing != g_buffers.end()) {
+    free_cached_buffer(existing);
+  }
+  while (g_size + size > memoryLimit) {
+    auto oldest = g_buffers.begin();
+    for (auto iter = g_buffers.begin(); iter != g_buffers.end(); ++iter) {
+      if (iter->second.lastUsed < oldest->second.lastUsed) {
+        oldest = iter;
+      }
+    }
+    free_cached_buffer(oldest);
+  }
+  g_buffers[key] = {copy, size, ++g_useCounter};
+  g_size += size;
+  BLI_mutex_unlock(&g_mutex);
+}
+
+void BufferCache::clear()
+{
+  BLI_mutex_lock(&g_mutex);
+  for (auto &cached : g_buffers) {
+    delete cached.second.buffer;
+  }
+  g_buffers.clear();
+  g_size = 0;
+  g_generation++;
+  BLI_mutex_unlock(&g_mutex);
+}
+
+/** \} */
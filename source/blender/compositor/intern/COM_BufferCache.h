@@ -0,0 +1,77 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "COM_CompositorContext.h"
+#include "COM_MemoryProxy.h"
+
+class ExecutionGroup;
+
+using std::vector;
+
+/**
+ * \brief Keeps the output buffers of execution groups between executions of the compositor.
+ *
+ * Every buffer is stored under a key that hashes everything its content depends on: the
+ * operations that fill it, the settings and links of the nodes they were created for and the
+ * parts of the CompositorContext that influence the result. When a later execution finds the key
+ * of one of its groups, the buffer is copied back and neither the group nor the groups it depends
+ * on are executed again.
+ *
+ * Scene data that nodes read while they are converted, like the camera of the Defocus node, is
+ * part of the key too. Other data outside of the node tree, like the pixels of images, masks and
+ * render results, is not. The cache has to be cleared when such data changes, see
+ * #COM_clearCaches.
+ * \ingroup Memory
+ */
+class BufferCache {
+ public:
+  /**
+   * \brief determine the cache keys of all groups that write to a MemoryProxy.
+   * \note the operations must be initialized, constant operations are hashed by their value.
+   */
+  static void determineKeys(const CompositorContext &context,
+                            const vector<ExecutionGroup *> &groups);
+
+  /**
+   * \brief get the number that changes every time the cache is cleared.
+   * Buffers computed while the cache was cleared may depend on outdated data and are not stored.
+   */
+  static unsigned int getGeneration();
+
+  /**
+   * \brief copy the buffer stored under the given key into the buffer of the proxy.
+   * \return false when nothing is stored under the key.
+   */
+  static bool restore(uint64_t key, MemoryProxy *proxy);
+
+  /**
+   * \brief store a copy of the buffer of the proxy under the given key.
+   * Least recently used buffers are freed to stay within the memory limit.
+   */
+  static void store(uint64_t key, MemoryProxy *proxy, unsigned int generation, size_t memoryLimit);
+
+  /**
+   * \brief free all stored buffers.
+   */
+  static void clear();
+};
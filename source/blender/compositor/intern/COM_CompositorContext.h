@@ -267,6 +267,22 @@ class CompositorContext {
   {
     return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0;
   }
+  bool isFullFrameEnabled() const
+  {
+    return (this->getbNodeTree()->flag & NTREE_COM_FULL_FRAME) != 0;
+  }
+
+  /**
+   * \brief Get the memory in bytes the BufferCache may use, zero when it is disabled.
+   * The cache is only used when editing, a render does not execute the same tree twice.
+   */
+  size_t getCacheMemoryLimit() const
+  {
+    if (this->isRendering() || this->getbNodeTree()->cache_memory_limit <= 0) {
+      return 0;
+    }
+    return (size_t)this->getbNodeTree()->cache_memory_limit * 1024 * 1024;
+  }
 
   /**
    * \brief Get the render percentage as a factor.
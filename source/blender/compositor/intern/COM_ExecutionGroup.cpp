@@ -56,9 +56,13 @@ ExecutionGroup::ExecutionGroup()
   this->m_initialized = false;
   this->m_openCL = false;
   this->m_singleThreaded = false;
+  this->m_fullFrame = false;
+  this->m_cacheKey = 0;
+  this->m_isCached = false;
   this->m_chunksFinished = 0;
   BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
   this->m_executionStartTime = 0;
+  this->m_executionTime = 0;
 }
 
 CompositorPriority ExecutionGroup::getRenderPriotrity()
@@ -132,7 +136,8 @@ void ExecutionGroup::initExecution()
     this->m_chunkExecutionStates = (ChunkExecutionState *)MEM_mallocN(
         sizeof(ChunkExecutionState) * this->m_numberOfChunks, __func__);
     for (index = 0; index < this->m_numberOfChunks; index++) {
-      this->m_chunkExecutionStates[index] = COM_ES_NOT_SCHEDULED;
+      this->m_chunkExecutionStates[index] = this->m_isCached ? COM_ES_EXECUTED :
+                                                               COM_ES_NOT_SCHEDULED;
     }
   }
 
@@ -178,6 +183,23 @@ void ExecutionGroup::determineNumberOfChunks()
     this->m_numberOfYChunks = 1;
     this->m_numberOfChunks = 1;
   }
+  else if (this->m_fullFrame) {
+    const int border_width = BLI_rcti_size_x(&this->m_viewerBorder);
+    const int border_height = BLI_rcti_size_y(&this->m_viewerBorder);
+    if (border_width <= 0 || border_height <= 0) {
+      this->m_numberOfXChunks = 0;
+      this->m_numberOfYChunks = 0;
+      this->m_numberOfChunks = 0;
+      return;
+    }
+    /* A few bands per thread, so that threads which finish early can take over remaining work. */
+    const int max_bands = BLI_system_thread_count() * COM_FULL_FRAME_BANDS_PER_THREAD;
+    const int band_count = min_ii(border_height, max_bands);
+    this->m_chunkSize = divide_ceil_u(border_height, band_count);
+    this->m_numberOfXChunks = 1;
+    this->m_numberOfYChunks = divide_ceil_u(border_height, this->m_chunkSize);
+    this->m_numberOfChunks = this->m_numberOfYChunks;
+  }
   else {
     const float chunkSizef = this->m_chunkSize;
     const int border_width = BLI_rcti_size_x(&this->m_viewerBorder);
@@ -371,6 +393,83 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
   MEM_freeN(chunkOrder);
 }
 
+void ExecutionGroup::setFullFrameArea(const rcti *area)
+{
+  this->m_fullFrame = true;
+  if (area != nullptr) {
+    /* Leaves an empty border when the area is outside of the group. */
+    BLI_rcti_isect(area, &this->m_viewerBorder, &this->m_viewerBorder);
+  }
+}
+
+void ExecutionGroup::determineFullFrameDependingAreas(vector<MemoryProxy *> *memoryProxies,
+                                                      vector<rcti> *areas)
+{
+  if (BLI_rcti_is_empty(&this->m_viewerBorder)) {
+    return;
+  }
+  for (NodeOperation *operation : this->m_operations) {
+    if (operation->isReadBufferOperation()) {
+      ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+      rcti area;
+      BLI_rcti_init(&area, 0, 0, 0, 0);
+      determineDependingAreaOfInterest(&this->m_viewerBorder, readOperation, &area);
+      memoryProxies->push_back(readOperation->getMemoryProxy());
+      areas->push_back(area);
+    }
+  }
+}
+
+/**
+ * Unlike #execute, this is called for every execution group, in the order of their dependencies.
+ * All chunks can be scheduled at once, because the buffers they read from are complete already.
+ */
+void ExecutionGroup::executeFullFrame(ExecutionSystem *graph)
+{
+  const CompositorContext &context = graph->getContext();
+  const bNodeTree *bTree = context.getbNodeTree();
+  if (this->m_width == 0 || this->m_height == 0) {
+    return;
+  }
+  if (bTree->test_break && bTree->test_break(bTree->tbh)) {
+    return;
+  }
+  if (this->m_numberOfChunks == 0) {
+    return;
+  }
+
+  this->m_executionStartTime = PIL_check_seconds_timer();
+  this->m_chunksFinished = 0;
+  /* Only report progress for the groups the user is waiting for, same as #execute. */
+  this->m_bTree = this->isOutputExecutionGroup() ? bTree : nullptr;
+
+  DebugInfo::execution_group_started(this);
+  for (unsigned int chunkNumber = 0; chunkNumber < this->m_numberOfChunks; chunkNumber++) {
+    scheduleChunk(chunkNumber);
+  }
+  WorkScheduler::finish();
+  DebugInfo::execution_group_finished(this);
+
+  if (bTree->update_draw) {
+    bTree->update_draw(bTree->udh);
+  }
+}
+
+bool ExecutionGroup::isComplete() const
+{
+  if (this->m_numberOfChunks == 0 || this->m_viewerBorder.xmin != 0 ||
+      this->m_viewerBorder.ymin != 0 || this->m_viewerBorder.xmax != (int)this->m_width ||
+      this->m_viewerBorder.ymax != (int)this->m_height) {
+    return false;
+  }
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+      return false;
+    }
+  }
+  return true;
+}
+
 MemoryBuffer **ExecutionGroup::getInputBuffersOpenCL(int chunkNumber)
 {
   rcti rect;
@@ -438,6 +537,29 @@ void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memo
   }
 }
 
+void ExecutionGroup::addExecutionTime(double seconds)
+{
+  atomic_add_and_fetch_uint64(&this->m_executionTime, (uint64_t)(seconds * 1000000.0));
+}
+
+std::string ExecutionGroup::getNodeNames() const
+{
+  std::string names;
+  vector<const bNode *> nodes;
+  for (const NodeOperation *operation : this->m_operations) {
+    const bNode *node = operation->getbNode();
+    if (node == nullptr || std::find(nodes.begin(), nodes.end(), node) != nodes.end()) {
+      continue;
+    }
+    if (!nodes.empty()) {
+      names += ", ";
+    }
+    names += node->name;
+    nodes.push_back(node);
+  }
+  return names;
+}
+
 inline void ExecutionGroup::determineChunkRect(rcti *rect,
                                                const unsigned int xChunk,
                                                const unsigned int yChunk) const
@@ -449,6 +571,11 @@ inline void ExecutionGroup::determineChunkRect(rcti *rect,
     BLI_rcti_init(
         rect, this->m_viewerBorder.xmin, border_width, this->m_viewerBorder.ymin, border_height);
   }
+  else if (this->m_fullFrame) {
+    const unsigned int miny = yChunk * this->m_chunkSize + this->m_viewerBorder.ymin;
+    const unsigned int maxy = min(miny + this->m_chunkSize, (unsigned int)m_viewerBorder.ymax);
+    BLI_rcti_init(rect, this->m_viewerBorder.xmin, this->m_viewerBorder.xmax, miny, maxy);
+  }
   else {
     const unsigned int minx = xChunk * this->m_chunkSize + this->m_viewerBorder.xmin;
     const unsigned int miny = yChunk * this->m_chunkSize + this->m_viewerBorder.ymin;
@@ -588,11 +715,13 @@ void ExecutionGroup::determineDependingAreaOfInterest(rcti *input,
 
 void ExecutionGroup::determineDependingMemoryProxies(vector<MemoryProxy *> *memoryProxies)
 {
-  unsigned int index;
-  for (index = 0; index < this->m_cachedReadOperations.size(); index++) {
-    ReadBufferOperation *readOperation =
-        (ReadBufferOperation *)this->m_cachedReadOperations[index];
-    memoryProxies->push_back(readOperation->getMemoryProxy());
+  /* Use all operations instead of the cached read operations, so that this also works before
+   * #initExecution. The order is the same. */
+  for (NodeOperation *operation : this->m_operations) {
+    if (operation->isReadBufferOperation()) {
+      ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+      memoryProxies->push_back(readOperation->getMemoryProxy());
+    }
   }
 }
 
@@ -22,6 +22,8 @@
 #  include "MEM_guardedalloc.h"
 #endif
 
+#include <string>
+
 #include "BLI_rect.h"
 #include "COM_CompositorContext.h"
 #include "COM_Device.h"
@@ -127,6 +129,24 @@ class ExecutionGroup {
    */
   bool m_singleThreaded;
 
+  /**
+   * \brief is this ExecutionGroup executed by the full frame execution model.
+   * In that case the chunks are row bands that span the whole width of the border.
+   * \see ExecutionSystem.executeFullFrame
+   */
+  bool m_fullFrame;
+
+  /**
+   * \brief key of the output buffer in the BufferCache, zero when the group does not write to a
+   * MemoryProxy.
+   */
+  uint64_t m_cacheKey;
+
+  /**
+   * \brief the output buffer has been restored from the BufferCache, no chunk is executed.
+   */
+  bool m_isCached;
+
   /**
    * \brief what is the maximum number field of all ReadBufferOperation in this ExecutionGroup.
    * \note this is used to construct the MemoryBuffers that will be passed during execution.
@@ -181,6 +201,11 @@ class ExecutionGroup {
    */
   double m_executionStartTime;
 
+  /**
+   * \brief time spent executing chunks of this group in microseconds, summed over all threads
+   */
+  uint64_t m_executionTime;
+
   // methods
   /**
    * \brief check whether parameter operation can be added to the execution group
@@ -375,6 +400,26 @@ class ExecutionGroup {
    */
   void finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers);
 
+  /**
+   * \brief add the time a device spent on executing a chunk of this group.
+   * This covers all operations of the group, see ExecutionSystem::printExecutionTimes.
+   * \note can be called from multiple threads at the same time.
+   */
+  void addExecutionTime(double seconds);
+
+  /**
+   * \brief get the time spent on executing chunks of this group, summed over all threads.
+   */
+  double getExecutionTime() const
+  {
+    return this->m_executionTime / 1000000.0;
+  }
+
+  /**
+   * \brief get the names of the nodes the operations of this group have been created for.
+   */
+  std::string getNodeNames() const;
+
   /**
    * \brief deinitExecution is called just after execution the whole graph.
    * \note It will release all needed resources
@@ -399,6 +444,61 @@ class ExecutionGroup {
    */
   void execute(ExecutionSystem *graph);
 
+  /**
+   * \brief set the area that is computed by the full frame execution model.
+   * \note The area is clipped to the current border of this ExecutionGroup. When area is nullptr
+   * the border is used as is.
+   * \note Must be called before initExecution, because it changes how chunks are determined.
+   */
+  void setFullFrameArea(const rcti *area);
+
+  /**
+   * \brief determine the areas of the MemoryProxy's this ExecutionGroup depends on, that are
+   * needed to compute the full frame area of this group.
+   * \param memoryProxies: result
+   * \param areas: result, the needed area for every MemoryProxy in memoryProxies
+   */
+  void determineFullFrameDependingAreas(vector<MemoryProxy *> *memoryProxies,
+                                        vector<rcti> *areas);
+
+  /**
+   * \brief execute all row bands of this ExecutionGroup at once.
+   * \note In contrast to execute, no dependencies are scheduled. All groups this group depends on
+   * must have been executed before.
+   * \see ExecutionSystem.executeFullFrame
+   */
+  void executeFullFrame(ExecutionSystem *graph);
+
+  void setCacheKey(uint64_t key)
+  {
+    this->m_cacheKey = key;
+  }
+
+  uint64_t getCacheKey() const
+  {
+    return this->m_cacheKey;
+  }
+
+  /**
+   * \brief mark the output buffer as restored from the BufferCache.
+   * \note Must be called before initExecution, all chunks are considered executed.
+   */
+  void setCached()
+  {
+    this->m_isCached = true;
+  }
+
+  bool isCached() const
+  {
+    return this->m_isCached;
+  }
+
+  /**
+   * \brief check if every pixel of the output buffer has been computed.
+   * This is not the case when a border is used or when the execution has been canceled.
+   */
+  bool isComplete() const;
+
   /**
    * \brief this method determines the MemoryProxy's where this execution group depends on.
    * \note After this method determineDependingAreaOfInterest can be called to determine
@@ -18,13 +18,21 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <set>
+
+#include "BLI_rect.h"
 #include "BLI_utildefines.h"
 #include "PIL_time.h"
 
+#include "BKE_global.h"
 #include "BKE_node.h"
 
 #include "BLT_translation.h"
 
+#include "COM_BufferCache.h"
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionGroup.h"
@@ -32,6 +40,7 @@
 #include "COM_NodeOperationBuilder.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_WorkScheduler.h"
+#include "COM_WriteBufferOperation.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
 #  include "MEM_guardedalloc.h"
@@ -131,6 +140,7 @@ void ExecutionSystem::execute()
 {
   const bNodeTree *editingtree = this->m_context.getbNodeTree();
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | Initializing execution"));
+  const double start_time = PIL_check_seconds_timer();
 
   DebugInfo::execute_started(this);
 
@@ -171,6 +181,22 @@ void ExecutionSystem::execute()
       operation->initExecution();
     }
   }
+  /* A render changes the render result, so the cache is outdated as well. */
+  const size_t cacheMemoryLimit = this->m_context.getCacheMemoryLimit();
+  const unsigned int cacheGeneration = BufferCache::getGeneration();
+  if (cacheMemoryLimit > 0) {
+    restoreCachedGroups();
+  }
+  else {
+    BufferCache::clear();
+  }
+  /* Areas of interest are determined after the operations are initialized, because they can
+   * depend on the settings of the operations. */
+  const bool use_full_frame = this->m_context.isFullFrameEnabled();
+  vector<ExecutionGroup *> fullFrameGroups;
+  if (use_full_frame) {
+    determineFullFrameGroups(&fullFrameGroups);
+  }
   for (index = 0; index < this->m_groups.size(); index++) {
     ExecutionGroup *executionGroup = this->m_groups[index];
     executionGroup->setChunksize(this->m_context.getChunksize());
@@ -179,15 +205,28 @@ void ExecutionSystem::execute()
 
   WorkScheduler::start(this->m_context);
 
-  executeGroups(COM_PRIORITY_HIGH);
-  if (!this->getContext().isFastCalculation()) {
-    executeGroups(COM_PRIORITY_MEDIUM);
-    executeGroups(COM_PRIORITY_LOW);
+  if (use_full_frame) {
+    executeFullFrame(fullFrameGroups);
+  }
+  else {
+    executeGroups(COM_PRIORITY_HIGH);
+    if (!this->getContext().isFastCalculation()) {
+      executeGroups(COM_PRIORITY_MEDIUM);
+      executeGroups(COM_PRIORITY_LOW);
+    }
   }
 
   WorkScheduler::finish();
   WorkScheduler::stop();
 
+  if (cacheMemoryLimit > 0) {
+    storeCachedGroups(cacheGeneration);
+  }
+
+  if (G.debug & G_DEBUG) {
+    printExecutionTimes(PIL_check_seconds_timer() - start_time);
+  }
+
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -211,6 +250,158 @@ void ExecutionSystem::executeGroups(CompositorPriority priority)
   }
 }
 
+static void add_group_in_dependency_order(ExecutionGroup *group,
+                                          vector<ExecutionGroup *> *result,
+                                          std::set<ExecutionGroup *> &visited)
+{
+  if (!visited.insert(group).second) {
+    return;
+  }
+  vector<MemoryProxy *> memoryProxies;
+  group->determineDependingMemoryProxies(&memoryProxies);
+  for (MemoryProxy *memoryProxy : memoryProxies) {
+    add_group_in_dependency_order(memoryProxy->getExecutor(), result, visited);
+  }
+  result->push_back(group);
+}
+
+void ExecutionSystem::determineFullFrameGroups(vector<ExecutionGroup *> *result)
+{
+  vector<ExecutionGroup *> outputGroups;
+  findOutputExecutionGroup(&outputGroups, COM_PRIORITY_HIGH);
+  if (!this->getContext().isFastCalculation()) {
+    findOutputExecutionGroup(&outputGroups, COM_PRIORITY_MEDIUM);
+    findOutputExecutionGroup(&outputGroups, COM_PRIORITY_LOW);
+  }
+
+  std::set<ExecutionGroup *> visited;
+  for (ExecutionGroup *group : outputGroups) {
+    add_group_in_dependency_order(group, result, visited);
+  }
+
+  /* Propagate the areas of interest from the outputs to their dependencies. Going through the
+   * groups in reverse dependency order makes sure that all areas requested from a group are known
+   * before its own dependencies are determined. */
+  std::map<ExecutionGroup *, rcti> areas;
+  for (auto iter = result->rbegin(); iter != result->rend(); ++iter) {
+    ExecutionGroup *group = *iter;
+    rcti empty_area;
+    BLI_rcti_init(&empty_area, 0, 0, 0, 0);
+    if (group->isCached()) {
+      /* Nothing to compute, so nothing is needed from the dependencies either. */
+      group->setFullFrameArea(&empty_area);
+      continue;
+    }
+    if (group->isOutputExecutionGroup()) {
+      group->setFullFrameArea(nullptr);
+    }
+    else {
+      auto area = areas.find(group);
+      group->setFullFrameArea(area == areas.end() ? &empty_area : &area->second);
+    }
+
+    vector<MemoryProxy *> memoryProxies;
+    vector<rcti> dependingAreas;
+    group->determineFullFrameDependingAreas(&memoryProxies, &dependingAreas);
+    for (unsigned int i = 0; i < memoryProxies.size(); i++) {
+      if (BLI_rcti_is_empty(&dependingAreas[i])) {
+        continue;
+      }
+      ExecutionGroup *dependency = memoryProxies[i]->getExecutor();
+      auto area = areas.find(dependency);
+      if (area == areas.end()) {
+        areas[dependency] = dependingAreas[i];
+      }
+      else {
+        BLI_rcti_union(&area->second, &dependingAreas[i]);
+      }
+    }
+  }
+}
+
+void ExecutionSystem::executeFullFrame(const vector<ExecutionGroup *> &groups)
+{
+  for (ExecutionGroup *group : groups) {
+    group->executeFullFrame(this);
+  }
+}
+
+void ExecutionSystem::restoreCachedGroups()
+{
+  BufferCache::determineKeys(this->m_context, this->m_groups);
+
+  vector<ExecutionGroup *> groups;
+  findOutputExecutionGroup(&groups, COM_PRIORITY_HIGH);
+  if (!this->getContext().isFastCalculation()) {
+    findOutputExecutionGroup(&groups, COM_PRIORITY_MEDIUM);
+    findOutputExecutionGroup(&groups, COM_PRIORITY_LOW);
+  }
+
+  /* Walk from the outputs to their dependencies, but stop at restored buffers. */
+  std::set<ExecutionGroup *> visited(groups.begin(), groups.end());
+  while (!groups.empty()) {
+    ExecutionGroup *group = groups.back();
+    groups.pop_back();
+
+    vector<MemoryProxy *> memoryProxies;
+    group->determineDependingMemoryProxies(&memoryProxies);
+    for (MemoryProxy *memoryProxy : memoryProxies) {
+      ExecutionGroup *dependency = memoryProxy->getExecutor();
+      if (dependency == nullptr || !visited.insert(dependency).second) {
+        continue;
+      }
+      if (dependency->getCacheKey() != 0 &&
+          BufferCache::restore(dependency->getCacheKey(), memoryProxy)) {
+        dependency->setCached();
+      }
+      else {
+        groups.push_back(dependency);
+      }
+    }
+  }
+}
+
+void ExecutionSystem::storeCachedGroups(unsigned int generation)
+{
+  /* The fast pass computes approximations, and a canceled execution may have finished chunks
+   * early. */
+  const bNodeTree *editingtree = this->m_context.getbNodeTree();
+  if (this->m_context.isFastCalculation() ||
+      (editingtree->test_break && editingtree->test_break(editingtree->tbh))) {
+    return;
+  }
+
+  const size_t memoryLimit = this->m_context.getCacheMemoryLimit();
+  for (ExecutionGroup *group : this->m_groups) {
+    if (group->getCacheKey() == 0 || group->isCached() || !group->isComplete()) {
+      continue;
+    }
+    WriteBufferOperation *writeOperation = (WriteBufferOperation *)group->getOutputOperation();
+    BufferCache::store(
+        group->getCacheKey(), writeOperation->getMemoryProxy(), generation, memoryLimit);
+  }
+}
+
+void ExecutionSystem::printExecutionTimes(double total_time) const
+{
+  vector<ExecutionGroup *> groups = this->m_groups;
+  std::sort(groups.begin(), groups.end(), [](ExecutionGroup *a, ExecutionGroup *b) {
+    return a->getExecutionTime() > b->getExecutionTime();
+  });
+
+  printf("Compositor: executed in %.3f s\n", total_time);
+  for (ExecutionGroup *group : groups) {
+    if (group->getExecutionTime() == 0.0) {
+      continue;
+    }
+    printf("  %8.3f s  %ux%u  %s\n",
+           group->getExecutionTime(),
+           group->getWidth(),
+           group->getHeight(),
+           group->getNodeNames().c_str());
+  }
+}
+
 void ExecutionSystem::findOutputExecutionGroup(vector<ExecutionGroup *> *result,
                                                CompositorPriority priority) const
 {
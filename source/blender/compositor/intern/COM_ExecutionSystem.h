@@ -107,6 +107,21 @@ class ExecutionGroup;
  * \see ExecutionSystem.addReadWriteBufferOperations
  * \see NodeOperation.isComplex
  * \see ExecutionGroup class representing the ExecutionGroup
+ *
+ * \section EM_FullFrame Full frame execution
+ * By default the output ExecutionGroup's are split into chunks, and every chunk schedules the
+ * chunks of other groups it depends on. When the full frame execution model is enabled, the areas
+ * of interest of all ExecutionGroup's are determined once up front. The groups are then executed
+ * one after another in the order of their dependencies. Every group computes its whole area in
+ * row bands that are distributed over the threads.
+ * \see ExecutionSystem.executeFullFrame
+ *
+ * \section EM_Cache Buffer cache
+ * When editing, the buffers of the ExecutionGroup's that write to a MemoryProxy are kept in the
+ * BufferCache after the execution. The next execution restores the buffers of groups that did not
+ * change and only executes what comes after them, so tweaking a node at the end of the tree does
+ * not execute the expensive nodes before it again.
+ * \see ExecutionSystem.restoreCachedGroups
  */
 
 /**
@@ -188,6 +203,34 @@ class ExecutionSystem {
  private:
   void executeGroups(CompositorPriority priority);
 
+  /**
+   * \brief determine the groups the full frame execution model has to execute, in the order of
+   * their dependencies, and set the areas they have to compute.
+   */
+  void determineFullFrameGroups(vector<ExecutionGroup *> *result);
+
+  void executeFullFrame(const vector<ExecutionGroup *> &groups);
+
+  /**
+   * \brief restore the buffers of the groups that did not change since an earlier execution.
+   * Only groups needed by the outputs are restored, the groups they depend on are not executed.
+   */
+  void restoreCachedGroups();
+
+  /**
+   * \brief store the complete buffers of the executed groups for later executions.
+   */
+  void storeCachedGroups(unsigned int generation);
+
+  /**
+   * \brief print how much time was spent in every ExecutionGroup, slowest first.
+   * The time is measured per group and not per operation. The operations of a group are evaluated
+   * pixel by pixel through each other from the executeRegion of its output operation, so the time
+   * of a single operation cannot be separated without a timer for every pixel. Every group lists
+   * the nodes its operations were created for instead.
+   */
+  void printExecutionTimes(double total_time) const;
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
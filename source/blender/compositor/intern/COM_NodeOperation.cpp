@@ -37,6 +37,8 @@ NodeOperation::NodeOperation()
   this->m_isResolutionSet = false;
   this->m_openCL = false;
   this->m_btree = nullptr;
+  this->m_bnode = nullptr;
+  this->m_bnodeOperationIndex = 0;
 }
 
 NodeOperation::~NodeOperation()
@@ -123,6 +123,19 @@ class NodeOperation : public SocketReader {
    */
   bool m_isResolutionSet;
 
+  /**
+   * \brief the node this operation has been created for, used to identify it in reports.
+   * nullptr for operations that are added by the system, like conversions and buffers.
+   */
+  const bNode *m_bnode;
+
+  /**
+   * \brief index of this operation among the operations created for m_bnode.
+   * Tells apart operations of the same kind created for one node, like the passes of a render
+   * layer.
+   */
+  int m_bnodeOperationIndex;
+
  public:
   virtual ~NodeOperation();
 
@@ -187,6 +200,20 @@ class NodeOperation : public SocketReader {
   {
     this->m_btree = tree;
   }
+
+  void setbNode(const bNode *node, int operationIndex)
+  {
+    this->m_bnode = node;
+    this->m_bnodeOperationIndex = operationIndex;
+  }
+  const bNode *getbNode() const
+  {
+    return this->m_bnode;
+  }
+  int getbNodeOperationIndex() const
+  {
+    return this->m_bnodeOperationIndex;
+  }
   virtual void initExecution();
 
   /**
@@ -38,7 +38,10 @@
 #include "COM_NodeOperationBuilder.h" /* own include */
 
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree)
-    : m_context(context), m_current_node(nullptr), m_active_viewer(nullptr)
+    : m_context(context),
+      m_current_node(nullptr),
+      m_current_node_operations(0),
+      m_active_viewer(nullptr)
 {
   m_graph.from_bNodeTree(*context, b_nodetree);
 }
@@ -56,6 +59,7 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
     Node *node = (Node *)m_graph.nodes()[index];
 
     m_current_node = node;
+    m_current_node_operations = 0;
 
     DebugInfo::node_to_operations(node);
     node->convertToOperations(converter, *m_context);
@@ -125,6 +129,9 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
+  if (m_current_node) {
+    operation->setbNode(m_current_node->getbNode(), m_current_node_operations++);
+  }
   m_operations.push_back(operation);
 }
 
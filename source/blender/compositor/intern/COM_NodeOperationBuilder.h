@@ -88,6 +88,8 @@ class NodeOperationBuilder {
   OutputSocketMap m_output_map;
 
   Node *m_current_node;
+  /** Number of operations added for m_current_node so far */
+  int m_current_node_operations;
 
   /** Operation that will be writing to the viewer image
    *  Only one operation can occupy this place at a time,
@@ -94,6 +94,23 @@ class SocketReader {
   {
   }
 
+  /**
+   * \brief calculate a horizontal span of pixels
+   * \note this method is called for non-complex, operations that only combine the pixels of their
+   * inputs at the same position override it to process the whole span at once.
+   * \param output: is a float array of length * 4 elements, every pixel uses 4 floats, also when
+   * the output has less channels
+   * \param x: the x-coordinate of the first pixel of the span in image space
+   * \param y: the y-coordinate of the span in image space
+   * \param length: the number of pixels to calculate, at most #COM_SPAN_LENGTH
+   */
+  virtual void executeSpan(float *output, int x, int y, int length)
+  {
+    for (int i = 0; i < length; i++) {
+      executePixelSampled(&output[i * 4], x + i, y, COM_PS_NEAREST);
+    }
+  }
+
  public:
   inline void readSampled(float result[4], float x, float y, PixelSampler sampler)
   {
@@ -107,6 +124,10 @@ class SocketReader {
   {
     executePixelFiltered(result, x, y, dx, dy);
   }
+  inline void readSpan(float *result, int x, int y, int length)
+  {
+    executeSpan(result, x, y, length);
+  }
 
   virtual void *initializeTileData(rcti * /*rect*/)
   {
@@ -29,6 +29,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "PIL_time.h"
 
@@ -40,6 +41,8 @@
 #  endif
 #elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 /* do nothing - default */
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+/* do nothing - default with TBB */
 #else
 #  error COM_CURRENT_THREADING_MODEL No threading model selected
 #endif
@@ -47,13 +50,20 @@
 /** \brief list of all CPUDevices. for every hardware thread an instance of CPUDevice is created */
 static vector<CPUDevice *> g_cpudevices;
 static ThreadLocal(CPUDevice *) g_thread_device;
+static bool g_cpuInitialized = false;
 
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+/** \brief all scheduled work for the cpu, executed by the threads of the shared task scheduler */
+static TaskPool *g_cpupool = nullptr;
+#endif
+
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE || COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+#  if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 /** \brief list of all thread for every CPUDevice in cpudevices a thread exists. */
 static ListBase g_cputhreads;
-static bool g_cpuInitialized = false;
 /** \brief all scheduled work for the cpu */
 static ThreadQueue *g_cpuqueue;
+#  endif
 static ThreadQueue *g_gpuqueue;
 #  ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -69,7 +79,34 @@ static bool g_openclInitialized = false;
 #  endif
 #endif
 
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+static void thread_execute_task(TaskPool *__restrict pool, void *taskdata)
+{
+  /* Skip the remaining work once the user canceled, instead of waiting for every package to
+   * notice the break on its own. */
+  const bNodeTree *btree = (const bNodeTree *)BLI_task_pool_user_data(pool);
+  if (BLI_task_pool_canceled(pool) || (btree->test_break && btree->test_break(btree->tbh))) {
+    return;
+  }
+
+  WorkPackage *work = (WorkPackage *)taskdata;
+  /* Tasks can run on any thread of the scheduler, so the device only lives as long as the task.
+   * The thread id is stable for every thread, which is what operations with per-thread data
+   * need. */
+  CPUDevice device(BLI_task_parallel_thread_id(nullptr));
+  BLI_thread_local_set(g_thread_device, &device);
+  device.execute(work);
+  BLI_thread_local_set(g_thread_device, nullptr);
+}
+
+static void free_work_package(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  delete (WorkPackage *)taskdata;
+}
+#endif
+
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE || COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+#  if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 void *WorkScheduler::thread_execute_cpu(void *data)
 {
   CPUDevice *device = (CPUDevice *)data;
@@ -82,6 +119,7 @@ void *WorkScheduler::thread_execute_cpu(void *data)
 
   return nullptr;
 }
+#  endif
 
 void *WorkScheduler::thread_execute_gpu(void *data)
 {
@@ -115,19 +153,32 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
 #  else
   BLI_thread_queue_push(g_cpuqueue, package);
 #  endif
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+#  ifdef COM_OPENCL_ENABLED
+  if (group->isOpenCL() && g_openclActive) {
+    BLI_thread_queue_push(g_gpuqueue, package);
+    return;
+  }
+#  endif
+  BLI_task_pool_push(g_cpupool, thread_execute_task, package, true, free_work_package);
 #endif
 }
 
 void WorkScheduler::start(CompositorContext &context)
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE || COM_CURRENT_THREADING_MODEL == COM_TM_TASK
   unsigned int index;
+#  if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
   g_cpuqueue = BLI_thread_queue_init();
   BLI_threadpool_init(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
   for (index = 0; index < g_cpudevices.size(); index++) {
     Device *device = g_cpudevices[index];
     BLI_threadpool_insert(&g_cputhreads, device);
   }
+#  else
+  /* The node tree is passed along to check for user breaks. */
+  g_cpupool = BLI_task_pool_create((void *)context.getbNodeTree(), TASK_PRIORITY_HIGH);
+#  endif
 #  ifdef COM_OPENCL_ENABLED
   if (context.getHasActiveOpenCLDevices()) {
     g_gpuqueue = BLI_thread_queue_init();
@@ -158,15 +209,28 @@ void WorkScheduler::finish()
 #  else
   BLI_thread_queue_wait_finish(cpuqueue);
 #  endif
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  /* The calling thread helps executing the CPU work while waiting. */
+  BLI_task_pool_work_and_wait(g_cpupool);
+#  ifdef COM_OPENCL_ENABLED
+  if (g_openclActive) {
+    BLI_thread_queue_wait_finish(g_gpuqueue);
+  }
+#  endif
 #endif
 }
 void WorkScheduler::stop()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE || COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+#  if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
   BLI_thread_queue_nowait(g_cpuqueue);
   BLI_threadpool_end(&g_cputhreads);
   BLI_thread_queue_free(g_cpuqueue);
   g_cpuqueue = nullptr;
+#  else
+  BLI_task_pool_free(g_cpupool);
+  g_cpupool = nullptr;
+#  endif
 #  ifdef COM_OPENCL_ENABLED
   if (g_openclActive) {
     BLI_thread_queue_nowait(g_gpuqueue);
@@ -180,7 +244,7 @@ void WorkScheduler::stop()
 
 bool WorkScheduler::hasGPUDevices()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE || COM_CURRENT_THREADING_MODEL == COM_TM_TASK
 #  ifdef COM_OPENCL_ENABLED
   return !g_gpudevices.empty();
 #  else
@@ -191,7 +255,7 @@ bool WorkScheduler::hasGPUDevices()
 #endif
 }
 
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE || COM_CURRENT_THREADING_MODEL == COM_TM_TASK
 static void CL_CALLBACK clContextError(const char *errinfo,
                                        const void * /*private_info*/,
                                        size_t /*cb*/,
@@ -203,7 +267,15 @@ static void CL_CALLBACK clContextError(const char *errinfo,
 
 void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  /* The shared task scheduler decides on the number of threads. Only the thread local storage
+   * for the device of the current task is needed. */
+  UNUSED_VARS(num_cpu_threads);
+  if (!g_cpuInitialized) {
+    BLI_thread_local_create(g_thread_device);
+    g_cpuInitialized = true;
+  }
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
   /* deinitialize if number of threads doesn't match */
   if (g_cpudevices.size() != num_cpu_threads) {
     Device *device;
@@ -230,7 +302,9 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
     BLI_thread_local_create(g_thread_device);
     g_cpuInitialized = true;
   }
+#endif
 
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE || COM_CURRENT_THREADING_MODEL == COM_TM_TASK
 #  ifdef COM_OPENCL_ENABLED
   /* deinitialize OpenCL GPU's */
   if (use_opencl && !g_openclInitialized) {
@@ -325,7 +399,12 @@ void WorkScheduler::initialize(bool use_opencl, int num_cpu_threads)
 
 void WorkScheduler::deinitialize()
 {
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_TASK
+  if (g_cpuInitialized) {
+    BLI_thread_local_delete(g_thread_device);
+    g_cpuInitialized = false;
+  }
+#elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
   /* deinitialize CPU threads */
   if (g_cpuInitialized) {
     Device *device;
@@ -338,7 +417,9 @@ void WorkScheduler::deinitialize()
     BLI_thread_local_delete(g_thread_device);
     g_cpuInitialized = false;
   }
+#endif
 
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE || COM_CURRENT_THREADING_MODEL == COM_TM_TASK
 #  ifdef COM_OPENCL_ENABLED
   /* deinitialize OpenCL GPU's */
   if (g_openclInitialized) {
@@ -31,7 +31,7 @@
  */
 class WorkScheduler {
 
-#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE || COM_CURRENT_THREADING_MODEL == COM_TM_TASK
   /**
    * \brief are we being stopped.
    */
@@ -23,6 +23,7 @@
 #include "BKE_node.h"
 #include "BKE_scene.h"
 
+#include "COM_BufferCache.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_MovieDistortionOperation.h"
 #include "COM_WorkScheduler.h"
@@ -110,6 +111,7 @@ void COM_execute(RenderData *rd,
 
 void COM_deinitialize()
 {
+  BufferCache::clear();
   if (is_compositorMutex_init) {
     BLI_mutex_lock(&s_compositorMutex);
     WorkScheduler::deinitialize();
@@ -118,3 +120,9 @@ void COM_deinitialize()
     BLI_mutex_end(&s_compositorMutex);
   }
 }
+
+void COM_clearCaches()
+{
+  /* Doesn't lock the compositor, a running execution notices and doesn't store its buffers. */
+  BufferCache::clear();
+}
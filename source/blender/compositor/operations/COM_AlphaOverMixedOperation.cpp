@@ -18,6 +18,10 @@
 
 #include "COM_AlphaOverMixedOperation.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 AlphaOverMixedOperation::AlphaOverMixedOperation()
 {
   this->m_x = 0.0f;
@@ -53,3 +57,42 @@ void AlphaOverMixedOperation::executePixelSampled(float output[4],
     output[3] = (mul * inputColor1[3]) + value[0] * inputOverColor[3];
   }
 }
+
+void AlphaOverMixedOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values[COM_SPAN_LENGTH * 4];
+  float colors1[COM_SPAN_LENGTH * 4];
+  float overColors[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(values, colors1, overColors, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    const float *inputColor1 = &colors1[i * 4];
+    const float *inputOverColor = &overColors[i * 4];
+    const float value = values[i * 4];
+    float *result = &output[i * 4];
+
+    if (inputOverColor[3] <= 0.0f) {
+      copy_v4_v4(result, inputColor1);
+    }
+    else if (value == 1.0f && inputOverColor[3] >= 1.0f) {
+      copy_v4_v4(result, inputOverColor);
+    }
+    else {
+      const float addfac = 1.0f - this->m_x + inputOverColor[3] * this->m_x;
+      const float premul = value * addfac;
+      const float mul = 1.0f - value * inputOverColor[3];
+#ifdef __SSE2__
+      /* Alpha of the over color is weighted by the value, not by the premultiplied factor. */
+      const __m128 factor = _mm_setr_ps(premul, premul, premul, value);
+      const __m128 color1 = _mm_mul_ps(_mm_set1_ps(mul), _mm_loadu_ps(inputColor1));
+      const __m128 overColor = _mm_mul_ps(factor, _mm_loadu_ps(inputOverColor));
+      _mm_storeu_ps(result, _mm_add_ps(color1, overColor));
+#else
+      result[0] = (mul * inputColor1[0]) + premul * inputOverColor[0];
+      result[1] = (mul * inputColor1[1]) + premul * inputOverColor[1];
+      result[2] = (mul * inputColor1[2]) + premul * inputOverColor[2];
+      result[3] = (mul * inputColor1[3]) + value * inputOverColor[3];
+#endif
+    }
+  }
+}
@@ -18,6 +18,10 @@
 
 #include "COM_AlphaOverPremultiplyOperation.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 AlphaOverPremultiplyOperation::AlphaOverPremultiplyOperation()
 {
   /* pass */
@@ -52,3 +56,39 @@ void AlphaOverPremultiplyOperation::executePixelSampled(float output[4],
     output[3] = (mul * inputColor1[3]) + value[0] * inputOverColor[3];
   }
 }
+
+void AlphaOverPremultiplyOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values[COM_SPAN_LENGTH * 4];
+  float colors1[COM_SPAN_LENGTH * 4];
+  float overColors[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(values, colors1, overColors, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    const float *inputColor1 = &colors1[i * 4];
+    const float *inputOverColor = &overColors[i * 4];
+    const float value = values[i * 4];
+    float *result = &output[i * 4];
+
+    /* Zero alpha values should still permit an add of RGB data */
+    if (inputOverColor[3] < 0.0f) {
+      copy_v4_v4(result, inputColor1);
+    }
+    else if (value == 1.0f && inputOverColor[3] >= 1.0f) {
+      copy_v4_v4(result, inputOverColor);
+    }
+    else {
+      const float mul = 1.0f - value * inputOverColor[3];
+#ifdef __SSE2__
+      const __m128 color1 = _mm_mul_ps(_mm_set1_ps(mul), _mm_loadu_ps(inputColor1));
+      const __m128 overColor = _mm_mul_ps(_mm_set1_ps(value), _mm_loadu_ps(inputOverColor));
+      _mm_storeu_ps(result, _mm_add_ps(color1, overColor));
+#else
+      result[0] = (mul * inputColor1[0]) + value * inputOverColor[0];
+      result[1] = (mul * inputColor1[1]) + value * inputOverColor[1];
+      result[2] = (mul * inputColor1[2]) + value * inputOverColor[2];
+      result[3] = (mul * inputColor1[3]) + value * inputOverColor[3];
+#endif
+    }
+  }
+}
@@ -35,4 +35,5 @@ class AlphaOverPremultiplyOperation : public MixBaseOperation {
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
@@ -18,7 +18,11 @@
 
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
+#include "BLI_rect.h"
 #include "COM_OpenCLDevice.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+#include "MEM_guardedalloc.h"
 
 #include "RE_pipeline.h"
 
@@ -39,17 +43,184 @@ BokehBlurOperation::BokehBlurOperation()
   this->m_inputBoundingBoxReader = nullptr;
 
   this->m_extend_bounds = false;
+  this->m_useBoxBlur = false;
+  this->m_boxBlurInitialized = false;
 }
 
-void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
+struct BokehBlurTileData {
+  MemoryBuffer *input;
+  /** Box blur of the tile, null when the per-tap loop is used. */
+  MemoryBuffer *boxBlur;
+};
+
+void *BokehBlurOperation::initializeTileData(rcti *rect)
 {
   lockMutex();
   if (!this->m_sizeavailable) {
     updateSize();
   }
-  void *buffer = getInputOperation(0)->initializeTileData(nullptr);
+  MemoryBuffer *inputBuffer = (MemoryBuffer *)getInputOperation(0)->initializeTileData(nullptr);
+  if (!this->m_boxBlurInitialized) {
+    this->m_useBoxBlur = canUseBoxBlur(inputBuffer);
+    this->m_boxBlurInitialized = true;
+  }
   unlockMutex();
-  return buffer;
+
+  BokehBlurTileData *data = new BokehBlurTileData();
+  data->input = inputBuffer;
+  data->boxBlur = this->m_useBoxBlur ? createBoxBlurBuffer(inputBuffer, rect) : nullptr;
+  return data;
+}
+
+void BokehBlurOperation::deinitializeTileData(rcti * /*rect*/, void *data)
+{
+  BokehBlurTileData *tileData = (BokehBlurTileData *)data;
+  delete tileData->boxBlur;
+  delete tileData;
+}
+
+/* Constants are written into a buffer before they reach complex operations, look through it. */
+static bool is_constant_input(NodeOperation *operation)
+{
+  if (operation->isReadBufferOperation()) {
+    MemoryProxy *proxy = ((ReadBufferOperation *)operation)->getMemoryProxy();
+    NodeOperationOutput *link = proxy->getWriteBufferOperation()->getInputSocket(0)->getLink();
+    if (link == nullptr) {
+      return false;
+    }
+    operation = &link->getOperation();
+  }
+  return operation->isSetOperation();
+}
+
+/**
+ * A constant bokeh weights all pixels of the square around a pixel the same, so the blur is the
+ * average of that square. That is a box blur, which can be calculated with running sums in a
+ * time that doesn't depend on the size.
+ */
+bool BokehBlurOperation::canUseBoxBlur(MemoryBuffer *inputBuffer)
+{
+  if (!is_constant_input(getInputOperation(1))) {
+    return false;
+  }
+  float bokeh[4];
+  this->m_inputBokehProgram->readSampled(bokeh, 0, 0, COM_PS_NEAREST);
+  if (bokeh[0] == 0.0f || bokeh[1] == 0.0f || bokeh[2] == 0.0f || bokeh[3] == 0.0f) {
+    return false;
+  }
+
+  /* Lower qualities skip pixels, small sizes add the center pixel again. */
+  const float max_dim = max(this->getWidth(), this->getHeight());
+  const int pixelSize = this->m_size * max_dim / 100.0f;
+  if (getStep() != 1 || pixelSize < 2) {
+    return false;
+  }
+
+  const rcti *rect = inputBuffer->getRect();
+  return inputBuffer->get_num_channels() == COM_NUM_CHANNELS_COLOR && rect->xmin == 0 &&
+         rect->ymin == 0 && rect->xmax == (int)this->getWidth() &&
+         rect->ymax == (int)this->getHeight();
+}
+
+/**
+ * Sums of the windows [i - radius, i + radius) clipped to [0, len) for every i in [begin, end).
+ * Element j of the line is at `line[(j - first) * stride]`, only elements in the windows are read.
+ */
+static void box_blur_sum_line(const float *line,
+                              const int first,
+                              const int stride,
+                              const int len,
+                              const int begin,
+                              const int end,
+                              const int radius,
+                              float *r_sums,
+                              const int r_stride)
+{
+  double sum[4] = {0.0, 0.0, 0.0, 0.0};
+  int imin = max_ii(begin - radius, 0);
+  int imax = imin;
+  for (int i = begin; i < end; i++) {
+    for (; imax < min_ii(i + radius, len); imax++) {
+      for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+        sum[c] += line[(imax - first) * stride + c];
+      }
+    }
+    for (; imin < max_ii(i - radius, 0); imin++) {
+      for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+        sum[c] -= line[(imin - first) * stride + c];
+      }
+    }
+    for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+      r_sums[(i - begin) * r_stride + c] = sum[c];
+    }
+  }
+}
+
+/**
+ * Box blur of the pixels in `rect`. Only the part of the input the tile depends on is read, the
+ * scheduler doesn't compute the rest of it. Running sums would carry NaN and infinite values to
+ * pixels outside of their window, so those inputs use the per-tap loop and null is returned.
+ */
+MemoryBuffer *BokehBlurOperation::createBoxBlurBuffer(MemoryBuffer *inputBuffer, rcti *rect)
+{
+  const float max_dim = max(this->getWidth(), this->getHeight());
+  const int radius = this->m_size * max_dim / 100.0f;
+  const int width = inputBuffer->getWidth();
+  const int height = inputBuffer->getHeight();
+  const float *input = inputBuffer->getBuffer();
+
+  const int xmin = max_ii(rect->xmin - radius, 0);
+  const int xmax = min_ii(rect->xmax - 1 + radius, width);
+  const int ymin = max_ii(rect->ymin - radius, 0);
+  const int ymax = min_ii(rect->ymax - 1 + radius, height);
+  for (int y = ymin; y < ymax; y++) {
+    for (int x = xmin; x < xmax; x++) {
+      if (!is_finite_v4(&input[(y * width + x) * COM_NUM_CHANNELS_COLOR])) {
+        return nullptr;
+      }
+    }
+  }
+
+  /* Sums of the rows of the window, for all rows the columns of the tile depend on. */
+  const int tileWidth = BLI_rcti_size_x(rect);
+  const int rowStride = tileWidth * COM_NUM_CHANNELS_COLOR;
+  float *rowSums = (float *)MEM_mallocN(sizeof(float) * rowStride * (ymax - ymin), __func__);
+  for (int y = ymin; y < ymax; y++) {
+    box_blur_sum_line(&input[(y * width + xmin) * COM_NUM_CHANNELS_COLOR],
+                      xmin,
+                      COM_NUM_CHANNELS_COLOR,
+                      width,
+                      rect->xmin,
+                      rect->xmax,
+                      radius,
+                      &rowSums[(y - ymin) * rowStride],
+                      COM_NUM_CHANNELS_COLOR);
+  }
+
+  MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, rect);
+  float *output = result->getBuffer();
+  for (int x = rect->xmin; x < rect->xmax; x++) {
+    float *outputColumn = &output[(x - rect->xmin) * COM_NUM_CHANNELS_COLOR];
+    box_blur_sum_line(&rowSums[(x - rect->xmin) * COM_NUM_CHANNELS_COLOR],
+                      ymin,
+                      rowStride,
+                      height,
+                      rect->ymin,
+                      rect->ymax,
+                      radius,
+                      outputColumn,
+                      rowStride);
+
+    const int windowWidth = min_ii(x + radius, width) - max_ii(x - radius, 0);
+    for (int y = rect->ymin; y < rect->ymax; y++) {
+      const int windowHeight = min_ii(y + radius, height) - max_ii(y - radius, 0);
+      mul_v4_fl(&outputColumn[(y - rect->ymin) * rowStride],
+                1.0f / ((float)windowWidth * windowHeight));
+    }
+  }
+  MEM_freeN(rowSums);
+
+  return result;
 }
 
 void BokehBlurOperation::initExecution()
@@ -72,14 +243,18 @@ void BokehBlurOperation::initExecution()
 
 void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
+  BokehBlurTileData *tileData = (BokehBlurTileData *)data;
   float color_accum[4];
   float tempBoundingBox[4];
   float bokeh[4];
 
   this->m_inputBoundingBoxReader->readSampled(tempBoundingBox, x, y, COM_PS_NEAREST);
-  if (tempBoundingBox[0] > 0.0f) {
+  if (tempBoundingBox[0] > 0.0f && tileData->boxBlur) {
+    tileData->boxBlur->read(output, x, y);
+  }
+  else if (tempBoundingBox[0] > 0.0f) {
     float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-    MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
+    MemoryBuffer *inputBuffer = tileData->input;
     float *buffer = inputBuffer->getBuffer();
     int bufferwidth = inputBuffer->getWidth();
     int bufferstartx = inputBuffer->getRect()->xmin;
@@ -132,6 +307,7 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 
 void BokehBlurOperation::deinitExecution()
 {
+  this->m_boxBlurInitialized = false;
   deinitMutex();
   this->m_inputProgram = nullptr;
   this->m_inputBokehProgram = nullptr;
@@ -34,10 +34,21 @@ class BokehBlurOperation : public NodeOperation, public QualityStepHelper {
   float m_bokehDimension;
   bool m_extend_bounds;
 
+  /**
+   * \brief blur every tile with a box instead of sampling the bokeh for every pixel.
+   * \see createBoxBlurBuffer
+   */
+  bool m_useBoxBlur;
+  bool m_boxBlurInitialized;
+
+  bool canUseBoxBlur(MemoryBuffer *inputBuffer);
+  MemoryBuffer *createBoxBlurBuffer(MemoryBuffer *inputBuffer, rcti *rect);
+
  public:
   BokehBlurOperation();
 
   void *initializeTileData(rcti *rect);
+  void deinitializeTileData(rcti *rect, void *data);
   /**
    * the inner loop of this program
    */
@@ -44,6 +44,15 @@ void ColorRampOperation::executePixelSampled(float output[4],
   BKE_colorband_evaluate(this->m_colorBand, values[0], output);
 }
 
+void ColorRampOperation::executeSpan(float *output, int x, int y, int length)
+{
+  this->m_inputProgram->readSpan(output, x, y, length);
+  for (int i = 0; i < length; i++) {
+    float *pixel = &output[i * 4];
+    BKE_colorband_evaluate(this->m_colorBand, pixel[0], pixel);
+  }
+}
+
 void ColorRampOperation::deinitExecution()
 {
   this->m_inputProgram = nullptr;
@@ -20,6 +20,10 @@
 
 #include "IMB_colormanagement.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 ConvertBaseOperation::ConvertBaseOperation()
 {
   this->m_inputOperation = nullptr;
@@ -54,6 +58,16 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::executeSpan(float *output, int x, int y, int length)
+{
+  this->m_inputOperation->readSpan(output, x, y, length);
+  for (int i = 0; i < length; i++) {
+    float *pixel = &output[i * 4];
+    pixel[1] = pixel[2] = pixel[0];
+    pixel[3] = 1.0f;
+  }
+}
+
 /* ******** Color to Value ******** */
 
 ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperation()
@@ -72,6 +86,15 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4],
   output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::executeSpan(float *output, int x, int y, int length)
+{
+  this->m_inputOperation->readSpan(output, x, y, length);
+  for (int i = 0; i < length; i++) {
+    float *pixel = &output[i * 4];
+    pixel[0] = (pixel[0] + pixel[1] + pixel[2]) / 3.0f;
+  }
+}
+
 /* ******** Color to BW ******** */
 
 ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
@@ -90,6 +113,15 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4],
   output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::executeSpan(float *output, int x, int y, int length)
+{
+  this->m_inputOperation->readSpan(output, x, y, length);
+  for (int i = 0; i < length; i++) {
+    float *pixel = &output[i * 4];
+    pixel[0] = IMB_colormanagement_get_luminance(pixel);
+  }
+}
+
 /* ******** Color to Vector ******** */
 
 ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOperation()
@@ -108,6 +140,12 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4],
   copy_v3_v3(output, color);
 }
 
+void ConvertColorToVectorOperation::executeSpan(float *output, int x, int y, int length)
+{
+  /* The vector is stored in the first three channels of the color. */
+  this->m_inputOperation->readSpan(output, x, y, length);
+}
+
 /* ******** Value to Vector ******** */
 
 ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOperation()
@@ -126,6 +164,15 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4],
   output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::executeSpan(float *output, int x, int y, int length)
+{
+  this->m_inputOperation->readSpan(output, x, y, length);
+  for (int i = 0; i < length; i++) {
+    float *pixel = &output[i * 4];
+    pixel[1] = pixel[2] = pixel[0];
+  }
+}
+
 /* ******** Vector to Color ******** */
 
 ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOperation()
@@ -143,6 +190,14 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::executeSpan(float *output, int x, int y, int length)
+{
+  this->m_inputOperation->readSpan(output, x, y, length);
+  for (int i = 0; i < length; i++) {
+    output[i * 4 + 3] = 1.0f;
+  }
+}
+
 /* ******** Vector to Value ******** */
 
 ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOperation()
@@ -161,6 +216,15 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4],
   output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::executeSpan(float *output, int x, int y, int length)
+{
+  this->m_inputOperation->readSpan(output, x, y, length);
+  for (int i = 0; i < length; i++) {
+    float *pixel = &output[i * 4];
+    pixel[0] = (pixel[0] + pixel[1] + pixel[2]) / 3.0f;
+  }
+}
+
 /* ******** RGB to YCC ******** */
 
 ConvertRGBToYCCOperation::ConvertRGBToYCCOperation() : ConvertBaseOperation()
@@ -370,6 +434,27 @@ void ConvertPremulToStraightOperation::executePixelSampled(float output[4],
   output[3] = alpha;
 }
 
+void ConvertPremulToStraightOperation::executeSpan(float *output, int x, int y, int length)
+{
+  this->m_inputOperation->readSpan(output, x, y, length);
+  for (int i = 0; i < length; i++) {
+    float *pixel = &output[i * 4];
+    const float alpha = pixel[3];
+    if (fabsf(alpha) < 1e-5f) {
+      zero_v3(pixel);
+    }
+    else {
+#ifdef __SSE2__
+      _mm_storeu_ps(pixel, _mm_mul_ps(_mm_loadu_ps(pixel), _mm_set1_ps(1.0f / alpha)));
+#else
+      mul_v3_fl(pixel, 1.0f / alpha);
+#endif
+    }
+    /* never touches the alpha */
+    pixel[3] = alpha;
+  }
+}
+
 /* ******** Straight to Premul ******** */
 
 ConvertStraightToPremulOperation::ConvertStraightToPremulOperation() : ConvertBaseOperation()
@@ -395,6 +480,22 @@ void ConvertStraightToPremulOperation::executePixelSampled(float output[4],
   output[3] = alpha;
 }
 
+void ConvertStraightToPremulOperation::executeSpan(float *output, int x, int y, int length)
+{
+  this->m_inputOperation->readSpan(output, x, y, length);
+  for (int i = 0; i < length; i++) {
+    float *pixel = &output[i * 4];
+    const float alpha = pixel[3];
+#ifdef __SSE2__
+    _mm_storeu_ps(pixel, _mm_mul_ps(_mm_loadu_ps(pixel), _mm_set1_ps(alpha)));
+#else
+    mul_v3_fl(pixel, alpha);
+#endif
+    /* never touches the alpha */
+    pixel[3] = alpha;
+  }
+}
+
 /* ******** Separate Channels ******** */
 
 SeparateChannelOperation::SeparateChannelOperation()
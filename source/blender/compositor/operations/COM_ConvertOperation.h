@@ -36,6 +36,7 @@ class ConvertValueToColorOperation : public ConvertBaseOperation {
   ConvertValueToColorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class ConvertColorToValueOperation : public ConvertBaseOperation {
@@ -43,6 +44,7 @@ class ConvertColorToValueOperation : public ConvertBaseOperation {
   ConvertColorToValueOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class ConvertColorToBWOperation : public ConvertBaseOperation {
@@ -50,6 +52,7 @@ class ConvertColorToBWOperation : public ConvertBaseOperation {
   ConvertColorToBWOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class ConvertColorToVectorOperation : public ConvertBaseOperation {
@@ -57,6 +60,7 @@ class ConvertColorToVectorOperation : public ConvertBaseOperation {
   ConvertColorToVectorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class ConvertValueToVectorOperation : public ConvertBaseOperation {
@@ -64,6 +68,7 @@ class ConvertValueToVectorOperation : public ConvertBaseOperation {
   ConvertValueToVectorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class ConvertVectorToColorOperation : public ConvertBaseOperation {
@@ -71,6 +76,7 @@ class ConvertVectorToColorOperation : public ConvertBaseOperation {
   ConvertVectorToColorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class ConvertVectorToValueOperation : public ConvertBaseOperation {
@@ -78,6 +84,7 @@ class ConvertVectorToValueOperation : public ConvertBaseOperation {
   ConvertVectorToValueOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class ConvertRGBToYCCOperation : public ConvertBaseOperation {
@@ -141,6 +148,7 @@ class ConvertPremulToStraightOperation : public ConvertBaseOperation {
   ConvertPremulToStraightOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class ConvertStraightToPremulOperation : public ConvertBaseOperation {
@@ -148,6 +156,7 @@ class ConvertStraightToPremulOperation : public ConvertBaseOperation {
   ConvertStraightToPremulOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class SeparateChannelOperation : public NodeOperation {
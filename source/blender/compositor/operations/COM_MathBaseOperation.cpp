@@ -71,6 +71,21 @@ void MathBaseOperation::clampIfNeeded(float *color)
   }
 }
 
+void MathBaseOperation::readInputSpans(float *output, float *values2, int x, int y, int length)
+{
+  this->m_inputValue1Operation->readSpan(output, x, y, length);
+  this->m_inputValue2Operation->readSpan(values2, x, y, length);
+}
+
+void MathBaseOperation::clampSpanIfNeeded(float *output, int length)
+{
+  if (this->m_useClamp) {
+    for (int i = 0; i < length; i++) {
+      CLAMP(output[i * 4], 0.0f, 1.0f);
+    }
+  }
+}
+
 void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
   float inputValue1[4];
@@ -84,6 +99,18 @@ void MathAddOperation::executePixelSampled(float output[4], float x, float y, Pi
   clampIfNeeded(output);
 }
 
+void MathAddOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(output, values2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    output[i * 4] += values2[i * 4];
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -100,6 +127,18 @@ void MathSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathSubtractOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(output, values2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    output[i * 4] -= values2[i * 4];
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 void MathMultiplyOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -116,6 +155,18 @@ void MathMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(output, values2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    output[i * 4] *= values2[i * 4];
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 void MathDivideOperation::executePixelSampled(float output[4],
                                               float x,
                                               float y,
@@ -137,6 +188,23 @@ void MathDivideOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathDivideOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(output, values2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    if (values2[i * 4] == 0) { /* We don't want to divide by zero. */
+      output[i * 4] = 0.0;
+    }
+    else {
+      output[i * 4] /= values2[i * 4];
+    }
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 void MathSineOperation::executePixelSampled(float output[4],
                                             float x,
                                             float y,
@@ -356,6 +424,18 @@ void MathMinimumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMinimumOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(output, values2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    output[i * 4] = min(output[i * 4], values2[i * 4]);
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 void MathMaximumOperation::executePixelSampled(float output[4],
                                                float x,
                                                float y,
@@ -372,6 +452,18 @@ void MathMaximumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMaximumOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(output, values2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    output[i * 4] = max(output[i * 4], values2[i * 4]);
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 void MathRoundOperation::executePixelSampled(float output[4],
                                              float x,
                                              float y,
@@ -43,6 +43,14 @@ class MathBaseOperation : public NodeOperation {
 
   void clampIfNeeded(float color[4]);
 
+  /**
+   * \brief read the spans of the first two inputs, see #SocketReader.executeSpan.
+   * The first input is read into the output, which is calculated in place.
+   */
+  void readInputSpans(float *output, float *values2, int x, int y, int length);
+
+  void clampSpanIfNeeded(float *output, int length);
+
  public:
   /**
    * the inner loop of this program
@@ -76,6 +84,7 @@ class MathAddOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 class MathSubtractOperation : public MathBaseOperation {
  public:
@@ -83,6 +92,7 @@ class MathSubtractOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 class MathMultiplyOperation : public MathBaseOperation {
  public:
@@ -90,6 +100,7 @@ class MathMultiplyOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 class MathDivideOperation : public MathBaseOperation {
  public:
@@ -97,6 +108,7 @@ class MathDivideOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 class MathSineOperation : public MathBaseOperation {
  public:
@@ -183,6 +195,7 @@ class MathMinimumOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 class MathMaximumOperation : public MathBaseOperation {
  public:
@@ -190,6 +203,7 @@ class MathMaximumOperation : public MathBaseOperation {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 class MathRoundOperation : public MathBaseOperation {
  public:
@@ -20,6 +20,10 @@
 
 #include "BLI_math.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /* ******** Mix Base Operation ******** */
 
 MixBaseOperation::MixBaseOperation()
@@ -63,6 +67,23 @@ void MixBaseOperation::executePixelSampled(float output[4], float x, float y, Pi
   output[3] = inputColor1[3];
 }
 
+void MixBaseOperation::readInputSpans(
+    float *values, float *colors1, float *colors2, int x, int y, int length)
+{
+  this->m_inputValueOperation->readSpan(values, x, y, length);
+  this->m_inputColor1Operation->readSpan(colors1, x, y, length);
+  this->m_inputColor2Operation->readSpan(colors2, x, y, length);
+}
+
+void MixBaseOperation::clampSpanIfNeeded(float *output, int length)
+{
+  if (m_useClamp) {
+    for (int i = 0; i < length; i++) {
+      clamp_v4(&output[i * 4], 0.0f, 1.0f);
+    }
+  }
+}
+
 void MixBaseOperation::determineResolution(unsigned int resolution[2],
                                            unsigned int preferredResolution[2])
 {
@@ -124,6 +145,37 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
   clampIfNeeded(output);
 }
 
+void MixAddOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values[COM_SPAN_LENGTH * 4];
+  float colors1[COM_SPAN_LENGTH * 4];
+  float colors2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(values, colors1, colors2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    const float *inputColor1 = &colors1[i * 4];
+    const float *inputColor2 = &colors2[i * 4];
+    float *result = &output[i * 4];
+    float value = values[i * 4];
+    if (this->useValueAlphaMultiply()) {
+      value *= inputColor2[3];
+    }
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    const __m128 value4 = _mm_set1_ps(value);
+    _mm_storeu_ps(result, _mm_add_ps(color1, _mm_mul_ps(value4, color2)));
+#else
+    result[0] = inputColor1[0] + value * inputColor2[0];
+    result[1] = inputColor1[1] + value * inputColor2[1];
+    result[2] = inputColor1[2] + value * inputColor2[2];
+#endif
+    result[3] = inputColor1[3];
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation()
@@ -158,6 +210,39 @@ void MixBlendOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixBlendOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values[COM_SPAN_LENGTH * 4];
+  float colors1[COM_SPAN_LENGTH * 4];
+  float colors2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(values, colors1, colors2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    const float *inputColor1 = &colors1[i * 4];
+    const float *inputColor2 = &colors2[i * 4];
+    float *result = &output[i * 4];
+    float value = values[i * 4];
+    if (this->useValueAlphaMultiply()) {
+      value *= inputColor2[3];
+    }
+    const float valuem = 1.0f - value;
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    const __m128 value4 = _mm_set1_ps(value);
+    const __m128 valuem4 = _mm_set1_ps(valuem);
+    _mm_storeu_ps(result, _mm_add_ps(_mm_mul_ps(valuem4, color1), _mm_mul_ps(value4, color2)));
+#else
+    result[0] = valuem * (inputColor1[0]) + value * (inputColor2[0]);
+    result[1] = valuem * (inputColor1[1]) + value * (inputColor2[1]);
+    result[2] = valuem * (inputColor1[2]) + value * (inputColor2[2]);
+#endif
+    result[3] = inputColor1[3];
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixColorBurnOperation::MixColorBurnOperation()
@@ -319,6 +404,41 @@ void MixDarkenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDarkenOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values[COM_SPAN_LENGTH * 4];
+  float colors1[COM_SPAN_LENGTH * 4];
+  float colors2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(values, colors1, colors2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    const float *inputColor1 = &colors1[i * 4];
+    const float *inputColor2 = &colors2[i * 4];
+    float *result = &output[i * 4];
+    float value = values[i * 4];
+    if (this->useValueAlphaMultiply()) {
+      value *= inputColor2[3];
+    }
+    const float valuem = 1.0f - value;
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    const __m128 value4 = _mm_set1_ps(value);
+    const __m128 valuem4 = _mm_set1_ps(valuem);
+    _mm_storeu_ps(result,
+                  _mm_add_ps(_mm_mul_ps(_mm_min_ps(color1, color2), value4),
+                             _mm_mul_ps(color1, valuem4)));
+#else
+    result[0] = min_ff(inputColor1[0], inputColor2[0]) * value + inputColor1[0] * valuem;
+    result[1] = min_ff(inputColor1[1], inputColor2[1]) * value + inputColor1[1] * valuem;
+    result[2] = min_ff(inputColor1[2], inputColor2[2]) * value + inputColor1[2] * valuem;
+#endif
+    result[3] = inputColor1[3];
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDifferenceOperation::MixDifferenceOperation()
@@ -352,6 +472,41 @@ void MixDifferenceOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDifferenceOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values[COM_SPAN_LENGTH * 4];
+  float colors1[COM_SPAN_LENGTH * 4];
+  float colors2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(values, colors1, colors2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    const float *inputColor1 = &colors1[i * 4];
+    const float *inputColor2 = &colors2[i * 4];
+    float *result = &output[i * 4];
+    float value = values[i * 4];
+    if (this->useValueAlphaMultiply()) {
+      value *= inputColor2[3];
+    }
+    const float valuem = 1.0f - value;
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    const __m128 value4 = _mm_set1_ps(value);
+    const __m128 valuem4 = _mm_set1_ps(valuem);
+    /* Clearing the sign bit is fabsf for all channels. */
+    const __m128 difference = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(color1, color2));
+    _mm_storeu_ps(result, _mm_add_ps(_mm_mul_ps(valuem4, color1), _mm_mul_ps(value4, difference)));
+#else
+    result[0] = valuem * inputColor1[0] + value * fabsf(inputColor1[0] - inputColor2[0]);
+    result[1] = valuem * inputColor1[1] + value * fabsf(inputColor1[1] - inputColor2[1]);
+    result[2] = valuem * inputColor1[2] + value * fabsf(inputColor1[2] - inputColor2[2]);
+#endif
+    result[3] = inputColor1[3];
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDivideOperation::MixDivideOperation()
@@ -624,6 +779,39 @@ void MixLightenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixLightenOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values[COM_SPAN_LENGTH * 4];
+  float colors1[COM_SPAN_LENGTH * 4];
+  float colors2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(values, colors1, colors2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    const float *inputColor1 = &colors1[i * 4];
+    const float *inputColor2 = &colors2[i * 4];
+    float *result = &output[i * 4];
+    float value = values[i * 4];
+    if (this->useValueAlphaMultiply()) {
+      value *= inputColor2[3];
+    }
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    const __m128 value4 = _mm_set1_ps(value);
+    /* Picks the product when it is larger, like the comparison in #executePixelSampled. */
+    _mm_storeu_ps(result, _mm_max_ps(_mm_mul_ps(value4, color2), color1));
+#else
+    for (int c = 0; c < 3; c++) {
+      const float tmp = value * inputColor2[c];
+      result[c] = (tmp > inputColor1[c]) ? tmp : inputColor1[c];
+    }
+#endif
+    result[3] = inputColor1[3];
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Linear Light Operation ******** */
 
 MixLinearLightOperation::MixLinearLightOperation()
@@ -705,6 +893,39 @@ void MixMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values[COM_SPAN_LENGTH * 4];
+  float colors1[COM_SPAN_LENGTH * 4];
+  float colors2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(values, colors1, colors2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    const float *inputColor1 = &colors1[i * 4];
+    const float *inputColor2 = &colors2[i * 4];
+    float *result = &output[i * 4];
+    float value = values[i * 4];
+    if (this->useValueAlphaMultiply()) {
+      value *= inputColor2[3];
+    }
+    const float valuem = 1.0f - value;
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    const __m128 value4 = _mm_set1_ps(value);
+    const __m128 valuem4 = _mm_set1_ps(valuem);
+    _mm_storeu_ps(result, _mm_mul_ps(color1, _mm_add_ps(valuem4, _mm_mul_ps(value4, color2))));
+#else
+    result[0] = inputColor1[0] * (valuem + value * inputColor2[0]);
+    result[1] = inputColor1[1] * (valuem + value * inputColor2[1]);
+    result[2] = inputColor1[2] * (valuem + value * inputColor2[2]);
+#endif
+    result[3] = inputColor1[3];
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation()
@@ -831,6 +1052,41 @@ void MixScreenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixScreenOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values[COM_SPAN_LENGTH * 4];
+  float colors1[COM_SPAN_LENGTH * 4];
+  float colors2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(values, colors1, colors2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    const float *inputColor1 = &colors1[i * 4];
+    const float *inputColor2 = &colors2[i * 4];
+    float *result = &output[i * 4];
+    float value = values[i * 4];
+    if (this->useValueAlphaMultiply()) {
+      value *= inputColor2[3];
+    }
+    const float valuem = 1.0f - value;
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 value4 = _mm_set1_ps(value);
+    const __m128 valuem4 = _mm_set1_ps(valuem);
+    const __m128 factor = _mm_add_ps(valuem4, _mm_mul_ps(value4, _mm_sub_ps(one, color2)));
+    _mm_storeu_ps(result, _mm_sub_ps(one, _mm_mul_ps(factor, _mm_sub_ps(one, color1))));
+#else
+    result[0] = 1.0f - (valuem + value * (1.0f - inputColor2[0])) * (1.0f - inputColor1[0]);
+    result[1] = 1.0f - (valuem + value * (1.0f - inputColor2[1])) * (1.0f - inputColor1[1]);
+    result[2] = 1.0f - (valuem + value * (1.0f - inputColor2[2])) * (1.0f - inputColor1[2]);
+#endif
+    result[3] = inputColor1[3];
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Soft Light Operation ******** */
 
 MixSoftLightOperation::MixSoftLightOperation()
@@ -909,6 +1165,37 @@ void MixSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixSubtractOperation::executeSpan(float *output, int x, int y, int length)
+{
+  float values[COM_SPAN_LENGTH * 4];
+  float colors1[COM_SPAN_LENGTH * 4];
+  float colors2[COM_SPAN_LENGTH * 4];
+  this->readInputSpans(values, colors1, colors2, x, y, length);
+
+  for (int i = 0; i < length; i++) {
+    const float *inputColor1 = &colors1[i * 4];
+    const float *inputColor2 = &colors2[i * 4];
+    float *result = &output[i * 4];
+    float value = values[i * 4];
+    if (this->useValueAlphaMultiply()) {
+      value *= inputColor2[3];
+    }
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    const __m128 value4 = _mm_set1_ps(value);
+    _mm_storeu_ps(result, _mm_sub_ps(color1, _mm_mul_ps(value4, color2)));
+#else
+    result[0] = inputColor1[0] - value * (inputColor2[0]);
+    result[1] = inputColor1[1] - value * (inputColor2[1]);
+    result[2] = inputColor1[2] - value * (inputColor2[2]);
+#endif
+    result[3] = inputColor1[3];
+  }
+
+  clampSpanIfNeeded(output, length);
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation()
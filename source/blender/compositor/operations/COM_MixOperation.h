@@ -43,6 +43,14 @@ class MixBaseOperation : public NodeOperation {
     }
   }
 
+  /**
+   * \brief read the spans of the value and color inputs, see #SocketReader.executeSpan.
+   * The buffers must be able to hold #COM_SPAN_LENGTH pixels.
+   */
+  void readInputSpans(float *values, float *colors1, float *colors2, int x, int y, int length);
+
+  void clampSpanIfNeeded(float *output, int length);
+
  public:
   /**
    * Default constructor
@@ -84,12 +92,14 @@ class MixAddOperation : public MixBaseOperation {
  public:
   MixAddOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixBlendOperation : public MixBaseOperation {
  public:
   MixBlendOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixColorBurnOperation : public MixBaseOperation {
@@ -108,12 +118,14 @@ class MixDarkenOperation : public MixBaseOperation {
  public:
   MixDarkenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
  public:
   MixDifferenceOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixDivideOperation : public MixBaseOperation {
@@ -144,6 +156,7 @@ class MixLightenOperation : public MixBaseOperation {
  public:
   MixLightenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
@@ -156,6 +169,7 @@ class MixMultiplyOperation : public MixBaseOperation {
  public:
   MixMultiplyOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -174,6 +188,7 @@ class MixScreenOperation : public MixBaseOperation {
  public:
   MixScreenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
@@ -186,6 +201,7 @@ class MixSubtractOperation : public MixBaseOperation {
  public:
   MixSubtractOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
 };
 
 class MixValueOperation : public MixBaseOperation {
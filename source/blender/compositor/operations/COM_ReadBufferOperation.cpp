@@ -74,6 +74,21 @@ void ReadBufferOperation::executePixelSampled(float output[4],
   }
 }
 
+void ReadBufferOperation::executeSpan(float *output, int x, int y, int length)
+{
+  if (m_single_value) {
+    m_buffer->read(output, 0, 0);
+    for (int i = 1; i < length; i++) {
+      copy_v4_v4(&output[i * 4], output);
+    }
+  }
+  else {
+    for (int i = 0; i < length; i++) {
+      m_buffer->read(&output[i * 4], x + i, y);
+    }
+  }
+}
+
 void ReadBufferOperation::executePixelExtend(float output[4],
                                              float x,
                                              float y,
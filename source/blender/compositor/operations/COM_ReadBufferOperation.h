@@ -43,6 +43,7 @@ class ReadBufferOperation : public NodeOperation {
 
   void *initializeTileData(rcti *rect);
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, int x, int y, int length);
   void executePixelExtend(float output[4],
                           float x,
                           float y,
@@ -31,6 +31,13 @@ void SetValueOperation::executePixelSampled(float output[4],
   output[0] = this->m_value;
 }
 
+void SetValueOperation::executeSpan(float *output, int /*x*/, int /*y*/, int length)
+{
+  for (int i = 0; i < length; i++) {
+    output[i * 4] = this->m_value;
+  }
+}
+
 void SetValueOperation::determineResolution(unsigned int resolution[2],
                                             unsigned int preferredResolution[2])
 {
@@ -87,33 +87,31 @@ void ViewerOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
   const int y1 = rect->ymin;
   const int x2 = rect->xmax;
   const int y2 = rect->ymax;
-  const int offsetadd = (this->getWidth() - (x2 - x1));
-  const int offsetadd4 = offsetadd * 4;
-  int offset = (y1 * this->getWidth() + x1);
-  int offset4 = offset * 4;
-  float alpha[4], depth[4];
+  float span[COM_SPAN_LENGTH * 4];
   int x;
   int y;
   bool breaked = false;
 
   for (y = y1; y < y2 && (!breaked); y++) {
-    for (x = x1; x < x2; x++) {
-      this->m_imageInput->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
+    for (x = x1; x < x2; x += COM_SPAN_LENGTH) {
+      const int length = min_ii(COM_SPAN_LENGTH, x2 - x);
+      const int offset = y * this->getWidth() + x;
+      /* The viewer buffer is RGBA, so the image span is written in place. */
+      this->m_imageInput->readSpan(&buffer[offset * 4], x, y, length);
       if (this->m_useAlphaInput) {
-        this->m_alphaInput->readSampled(alpha, x, y, COM_PS_NEAREST);
-        buffer[offset4 + 3] = alpha[0];
+        this->m_alphaInput->readSpan(span, x, y, length);
+        for (int i = 0; i < length; i++) {
+          buffer[(offset + i) * 4 + 3] = span[i * 4];
+        }
+      }
+      this->m_depthInput->readSpan(span, x, y, length);
+      for (int i = 0; i < length; i++) {
+        depthbuffer[offset + i] = span[i * 4];
       }
-      this->m_depthInput->readSampled(depth, x, y, COM_PS_NEAREST);
-      depthbuffer[offset] = depth[0];
-
-      offset++;
-      offset4 += 4;
     }
     if (isBraked()) {
       breaked = true;
     }
-    offset += offsetadd;
-    offset4 += offsetadd4;
   }
   updateImage(rect);
 }
@@ -79,6 +79,12 @@ void WrapOperation::executePixelSampled(float output[4], float x, float y, Pixel
   executePixelExtend(output, nx, ny, sampler, extend_x, extend_y);
 }
 
+void WrapOperation::executeSpan(float *output, int x, int y, int length)
+{
+  /* Every pixel is wrapped, don't read the span directly from the buffer. */
+  NodeOperation::executeSpan(output, x, y, length);
+}
+
 bool WrapOperation::determineDependingAreaOfInterest(rcti *input,
                                                      ReadBufferOperation *readOperation,
                                                      rcti *output)
@@ -19,7 +19,9 @@
 #include "COM_WriteBufferOperation.h"
 #include "COM_OpenCLDevice.h"
 #include "COM_defines.h"
+#include "BLI_math_base.h"
 #include <cstdio>
+#include <cstring>
 
 WriteBufferOperation::WriteBufferOperation(DataType datatype)
 {
@@ -91,14 +93,27 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
     int x2 = rect->xmax;
     int y2 = rect->ymax;
 
+    float span[COM_SPAN_LENGTH * 4];
     int x;
     int y;
     bool breaked = false;
     for (y = y1; y < y2 && (!breaked); y++) {
-      int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
-      for (x = x1; x < x2; x++) {
-        this->m_input->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-        offset4 += num_channels;
+      int offset = (y * memoryBuffer->getWidth() + x1) * num_channels;
+      for (x = x1; x < x2; x += COM_SPAN_LENGTH) {
+        const int length = min_ii(COM_SPAN_LENGTH, x2 - x);
+        this->m_input->readSpan(span, x, y, length);
+        if (num_channels == COM_NUM_CHANNELS_COLOR) {
+          memcpy(&buffer[offset], span, sizeof(float) * 4 * length);
+          offset += 4 * length;
+        }
+        else {
+          for (int i = 0; i < length; i++) {
+            for (int c = 0; c < num_channels; c++) {
+              buffer[offset + c] = span[i * 4 + c];
+            }
+            offset += num_channels;
+          }
+        }
       }
       if (isBraked()) {
         breaked = true;
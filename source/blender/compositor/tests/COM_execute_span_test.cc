@@ -0,0 +1,274 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+
+#include "COM_AlphaOverKeyOperation.h"
+#include "COM_AlphaOverMixedOperation.h"
+#include "COM_AlphaOverPremultiplyOperation.h"
+#include "COM_ConvertOperation.h"
+#include "COM_MathBaseOperation.h"
+#include "COM_MixOperation.h"
+#include "COM_SetColorOperation.h"
+#include "COM_SetValueOperation.h"
+
+#include "BLI_timeit.hh"
+
+namespace blender::compositor::tests {
+namespace {
+
+static int num_channels(NodeOperation &operation)
+{
+  switch (operation.getOutputSocket()->getDataType()) {
+    case COM_DT_VALUE:
+      return COM_NUM_CHANNELS_VALUE;
+    case COM_DT_VECTOR:
+      return COM_NUM_CHANNELS_VECTOR;
+    case COM_DT_COLOR:
+    default:
+      return COM_NUM_CHANNELS_COLOR;
+  }
+}
+
+/**
+ * Input with a different value in every channel of every pixel. The values are multiples of 1/8
+ * between -0.25 and 1.25, so that exact zeros and ones reach the branches of the operations.
+ */
+class PatternOperation : public NodeOperation {
+ private:
+  int m_seed;
+
+ public:
+  PatternOperation(DataType datatype, int seed) : m_seed(seed)
+  {
+    this->addOutputSocket(datatype);
+  }
+
+ protected:
+  void executePixelSampled(float output[4], float x, float y, PixelSampler /*sampler*/) override
+  {
+    /* Only write the channels of the data type, some readers pass a single float. */
+    for (int c = 0; c < num_channels(*this); c++) {
+      output[c] = (((int)x * 7 + (int)y * 3 + c * 5 + m_seed) % 13) / 8.0f - 0.25f;
+    }
+  }
+};
+
+static void link(NodeOperation &from, NodeOperation &to, unsigned int index)
+{
+  to.getInputSocket(index)->setLink(from.getOutputSocket());
+}
+
+/* The span has to contain the same pixels as reading them one by one. */
+static void expect_span_matches_pixels(NodeOperation &operation)
+{
+  const int channels = num_channels(operation);
+  operation.initExecution();
+  for (int y = 0; y < 3; y++) {
+    /* Start in the middle of a span and end with a partial one. */
+    for (int x = 5; x < 200; x += COM_SPAN_LENGTH) {
+      float span[COM_SPAN_LENGTH * 4];
+      const int length = std::min(COM_SPAN_LENGTH, 200 - x);
+      operation.readSpan(span, x, y, length);
+      for (int i = 0; i < length; i++) {
+        float pixel[4];
+        operation.readSampled(pixel, x + i, y, COM_PS_NEAREST);
+        for (int c = 0; c < channels; c++) {
+          EXPECT_FLOAT_EQ(span[i * 4 + c], pixel[c]);
+        }
+      }
+    }
+  }
+  operation.deinitExecution();
+}
+
+TEST(execute_span, Mix)
+{
+  PatternOperation value(COM_DT_VALUE, 0);
+  PatternOperation color1(COM_DT_COLOR, 3);
+  PatternOperation color2(COM_DT_COLOR, 8);
+
+  MixAddOperation add;
+  MixBlendOperation blend;
+  MixColorBurnOperation color_burn;
+  MixDarkenOperation darken;
+  MixDifferenceOperation difference;
+  MixLightenOperation lighten;
+  MixMultiplyOperation multiply;
+  MixScreenOperation screen;
+  MixSubtractOperation subtract;
+  MixBaseOperation *operations[] = {
+      &add, &blend, &color_burn, &darken, &difference, &lighten, &multiply, &screen, &subtract};
+
+  for (MixBaseOperation *operation : operations) {
+    link(value, *operation, 0);
+    link(color1, *operation, 1);
+    link(color2, *operation, 2);
+    for (const bool use_alpha : {false, true}) {
+      for (const bool use_clamp : {false, true}) {
+        operation->setUseValueAlphaMultiply(use_alpha);
+        operation->setUseClamp(use_clamp);
+        expect_span_matches_pixels(*operation);
+      }
+    }
+  }
+}
+
+TEST(execute_span, AlphaOver)
+{
+  PatternOperation value(COM_DT_VALUE, 2);
+  PatternOperation color1(COM_DT_COLOR, 5);
+  PatternOperation color2(COM_DT_COLOR, 1);
+
+  AlphaOverKeyOperation key;
+  AlphaOverMixedOperation mixed;
+  AlphaOverPremultiplyOperation premultiply;
+  mixed.setX(0.3f);
+  MixBaseOperation *operations[] = {&key, &mixed, &premultiply};
+
+  for (MixBaseOperation *operation : operations) {
+    link(value, *operation, 0);
+    link(color1, *operation, 1);
+    link(color2, *operation, 2);
+    expect_span_matches_pixels(*operation);
+  }
+}
+
+TEST(execute_span, Math)
+{
+  PatternOperation value1(COM_DT_VALUE, 4);
+  PatternOperation value2(COM_DT_VALUE, 9);
+
+  MathAddOperation add;
+  MathSubtractOperation subtract;
+  MathMultiplyOperation multiply;
+  MathDivideOperation divide;
+  MathMinimumOperation minimum;
+  MathMaximumOperation maximum;
+  MathSineOperation sine;
+  MathBaseOperation *operations[] = {
+      &add, &subtract, &multiply, &divide, &minimum, &maximum, &sine};
+
+  for (MathBaseOperation *operation : operations) {
+    link(value1, *operation, 0);
+    link(value2, *operation, 1);
+    for (const bool use_clamp : {false, true}) {
+      operation->setUseClamp(use_clamp);
+      expect_span_matches_pixels(*operation);
+    }
+  }
+}
+
+TEST(execute_span, Convert)
+{
+  PatternOperation value(COM_DT_VALUE, 6);
+  PatternOperation vector(COM_DT_VECTOR, 7);
+  PatternOperation color(COM_DT_COLOR, 10);
+
+  ConvertValueToColorOperation value_to_color;
+  ConvertValueToVectorOperation value_to_vector;
+  ConvertVectorToColorOperation vector_to_color;
+  ConvertVectorToValueOperation vector_to_value;
+  ConvertColorToValueOperation color_to_value;
+  ConvertColorToVectorOperation color_to_vector;
+  ConvertPremulToStraightOperation premul_to_straight;
+  ConvertStraightToPremulOperation straight_to_premul;
+
+  link(value, value_to_color, 0);
+  link(value, value_to_vector, 0);
+  link(vector, vector_to_color, 0);
+  link(vector, vector_to_value, 0);
+  link(color, color_to_value, 0);
+  link(color, color_to_vector, 0);
+  link(color, premul_to_straight, 0);
+  link(color, straight_to_premul, 0);
+
+  NodeOperation *operations[] = {&value_to_color,
+                                 &value_to_vector,
+                                 &vector_to_color,
+                                 &vector_to_value,
+                                 &color_to_value,
+                                 &color_to_vector,
+                                 &premul_to_straight,
+                                 &straight_to_premul};
+  for (NodeOperation *operation : operations) {
+    expect_span_matches_pixels(*operation);
+  }
+}
+
+TEST(execute_span, Constants)
+{
+  SetValueOperation value;
+  value.setValue(0.25f);
+  SetColorOperation color;
+  const float rgba[4] = {0.1f, 0.2f, 0.3f, 0.4f};
+  color.setChannels(rgba);
+
+  expect_span_matches_pixels(value);
+  expect_span_matches_pixels(color);
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It fills a 4K buffer with the result of a mix once
+ * pixel by pixel, like WriteBufferOperation did before, and once with spans.
+ */
+#if 0
+TEST(execute_span, Benchmark)
+{
+  const int width = 3840;
+  const int height = 2160;
+  SetValueOperation value;
+  value.setValue(0.5f);
+  SetColorOperation color1;
+  const float rgba1[4] = {0.1f, 0.2f, 0.3f, 1.0f};
+  color1.setChannels(rgba1);
+  SetColorOperation color2;
+  const float rgba2[4] = {0.9f, 0.8f, 0.7f, 0.5f};
+  color2.setChannels(rgba2);
+  MixMultiplyOperation multiply;
+  link(value, multiply, 0);
+  link(color1, multiply, 1);
+  link(color2, multiply, 2);
+  multiply.setUseClamp(true);
+  multiply.initExecution();
+
+  float *buffer = new float[width * height * 4];
+  for (int i = 0; i < 3; i++) {
+    {
+      SCOPED_TIMER("Pixels");
+      for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+          multiply.readSampled(&buffer[(y * width + x) * 4], x, y, COM_PS_NEAREST);
+        }
+      }
+    }
+    {
+      SCOPED_TIMER("Spans ");
+      for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x += COM_SPAN_LENGTH) {
+          const int length = std::min(COM_SPAN_LENGTH, width - x);
+          multiply.readSpan(&buffer[(y * width + x) * 4], x, y, length);
+        }
+      }
+    }
+  }
+  /* Print a value to avoid some compiler optimizations. */
+  std::cout << "Value: " << buffer[width * height * 2] << "\n";
+  delete[] buffer;
+  multiply.deinitExecution();
+}
+
+/**
+ * Timer 'Pixels' took 209.537 ms
+ * Timer 'Spans ' took 84.8029 ms
+ * Timer 'Pixels' took 136.066 ms
+ * Timer 'Spans ' took 85.4412 ms
+ * Timer 'Pixels' took 141.614 ms
+ * Timer 'Spans ' took 88.943 ms
+ * Value: 0.095
+ */
+#endif
+
+}  // namespace
+}  // namespace blender::compositor::tests
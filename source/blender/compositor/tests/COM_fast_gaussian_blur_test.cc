@@ -0,0 +1,65 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "COM_FastGaussianBlurOperation.h"
+#include "COM_MemoryBuffer.h"
+
+namespace blender::compositor::tests {
+namespace {
+
+static MemoryBuffer *create_buffer(int width, int height)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, width, 0, height);
+  MemoryBuffer *buffer = new MemoryBuffer(COM_DT_COLOR, &rect);
+  buffer->clear();
+  return buffer;
+}
+
+TEST(fast_gaussian_blur, Constant)
+{
+  MemoryBuffer *buffer = create_buffer(67, 45);
+  float *pixels = buffer->getBuffer();
+  for (int i = 0; i < 67 * 45 * COM_NUM_CHANNELS_COLOR; i++) {
+    pixels[i] = 0.5f;
+  }
+  for (int c = 0; c < COM_NUM_CHANNELS_COLOR; c++) {
+    FastGaussianBlurOperation::IIR_gauss(buffer, 12.0f, c, 3);
+  }
+  for (int i = 0; i < 67 * 45 * COM_NUM_CHANNELS_COLOR; i++) {
+    EXPECT_NEAR(pixels[i], 0.5f, 1e-4f);
+  }
+  delete buffer;
+}
+
+TEST(fast_gaussian_blur, Impulse)
+{
+  const int size = 101;
+  const int center = size / 2;
+  MemoryBuffer *buffer = create_buffer(size, size);
+  float *pixels = buffer->getBuffer();
+  pixels[(center * size + center) * COM_NUM_CHANNELS_COLOR + 1] = 1.0f;
+
+  FastGaussianBlurOperation::IIR_gauss(buffer, 4.0f, 1, 3);
+
+  float sum = 0.0f;
+  for (int i = 0; i < size * size; i++) {
+    sum += pixels[i * COM_NUM_CHANNELS_COLOR + 1];
+    /* Only the given channel is blurred. */
+    EXPECT_EQ(pixels[i * COM_NUM_CHANNELS_COLOR], 0.0f);
+    EXPECT_EQ(pixels[i * COM_NUM_CHANNELS_COLOR + 2], 0.0f);
+  }
+  EXPECT_NEAR(sum, 1.0f, 1e-3f);
+
+  /* Rows and columns are filtered the same. */
+  for (int d = 0; d < 20; d++) {
+    const float horizontal = pixels[(center * size + center + d) * COM_NUM_CHANNELS_COLOR + 1];
+    const float vertical = pixels[((center + d) * size + center) * COM_NUM_CHANNELS_COLOR + 1];
+    EXPECT_NEAR(horizontal, vertical, 1e-6f);
+  }
+  delete buffer;
+}
+
+}  // namespace
+}  // namespace blender::compositor::tests
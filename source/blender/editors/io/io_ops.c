@@ -37,6 +37,18 @@
 #  include "io_usd.h"
 #endif
 
+#ifdef WITH_IO_WAVEFRONT_OBJ
+#  include "io_obj.h"
+#endif
+
+#ifdef WITH_IO_STL
+#  include "io_stl.h"
+#endif
+
+#ifdef WITH_IO_PLY
+#  include "io_ply.h"
+#endif
+
 #include "io_cache.h"
 
 void ED_operatortypes_io(void)
@@ -52,6 +64,19 @@ void ED_operatortypes_io(void)
 #endif
 #ifdef WITH_USD
   WM_operatortype_append(WM_OT_usd_export);
+  WM_operatortype_append(WM_OT_usd_import);
+#endif
+#ifdef WITH_IO_WAVEFRONT_OBJ
+  WM_operatortype_append(WM_OT_obj_export);
+  WM_operatortype_append(WM_OT_obj_import);
+#endif
+#ifdef WITH_IO_STL
+  WM_operatortype_append(WM_OT_stl_export);
+  WM_operatortype_append(WM_OT_stl_import);
+#endif
+#ifdef WITH_IO_PLY
+  WM_operatortype_append(WM_OT_ply_export);
+  WM_operatortype_append(WM_OT_ply_import);
 #endif
 
   WM_operatortype_append(CACHEFILE_OT_open);
@@ -0,0 +1,239 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup editor/io
+ */
+
+#ifdef WITH_IO_STL
+#  include "DNA_space_types.h"
+
+#  include "BKE_context.h"
+#  include "BKE_main.h"
+#  include "BKE_report.h"
+
+#  include "BLI_path_util.h"
+#  include "BLI_string.h"
+#  include "BLI_utildefines.h"
+
+#  include "BLT_translation.h"
+
+#  include "RNA_access.h"
+#  include "RNA_define.h"
+
+#  include "UI_interface.h"
+#  include "UI_resources.h"
+
+#  include "WM_api.h"
+#  include "WM_types.h"
+
+#  include "IO_stl.h"
+#  include "io_stl.h"
+#  include "io_utils.h"
+
+static int wm_stl_export_invoke(bContext *C, wmOperator *op, const wmEvent *UNUSED(event))
+{
+  io_ui_export_filepath_ensure(C, op, ".stl");
+  WM_event_add_fileselect(C, op);
+
+  return OPERATOR_RUNNING_MODAL;
+}
+
+static int wm_stl_export_exec(bContext *C, wmOperator *op)
+{
+  if (!RNA_struct_property_is_set(op->ptr, "filepath")) {
+    BKE_report(op->reports, RPT_ERROR, "No filename given");
+    return OPERATOR_CANCELLED;
+  }
+
+  struct STLExportParams params;
+  RNA_string_get(op->ptr, "filepath", params.filepath);
+  params.export_selected_objects = RNA_boolean_get(op->ptr, "export_selected_objects");
+  params.apply_modifiers = RNA_boolean_get(op->ptr, "apply_modifiers");
+  params.ascii_format = RNA_boolean_get(op->ptr, "ascii_format");
+  params.forward_axis = RNA_enum_get(op->ptr, "forward_axis");
+  params.up_axis = RNA_enum_get(op->ptr, "up_axis");
+  params.global_scale = RNA_float_get(op->ptr, "global_scale");
+
+  if (!io_ui_axes_check(op)) {
+    return OPERATOR_CANCELLED;
+  }
+  if (!STL_export(C, &params)) {
+    BKE_report(op->reports, RPT_ERROR, "Export failed, see the console for details");
+    return OPERATOR_CANCELLED;
+  }
+  return OPERATOR_FINISHED;
+}
+
+static void wm_stl_export_draw(bContext *UNUSED(C), wmOperator *op)
+{
+  uiLayout *layout = op->layout;
+  uiLayout *col;
+  struct PointerRNA *ptr = op->ptr;
+
+  uiLayoutSetPropSep(layout, true);
+
+  uiLayout *box = uiLayoutBox(layout);
+
+  col = uiLayoutColumn(box, true);
+  uiItemR(col, ptr, "export_selected_objects", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "apply_modifiers", 0, NULL, ICON_NONE);
+  uiItemR(box, ptr, "ascii_format", 0, NULL, ICON_NONE);
+
+  box = uiLayoutBox(layout);
+  io_ui_axes_draw(box, ptr);
+  uiItemR(box, ptr, "global_scale", 0, NULL, ICON_NONE);
+}
+
+void WM_OT_stl_export(struct wmOperatorType *ot)
+{
+  ot->name = "Export STL";
+  ot->description = "Export the triangles of mesh objects to an STL file";
+  ot->idname = "WM_OT_stl_export";
+
+  ot->invoke = wm_stl_export_invoke;
+  ot->exec = wm_stl_export_exec;
+  ot->poll = WM_operator_winactive;
+  ot->ui = wm_stl_export_draw;
+
+  WM_operator_properties_filesel(ot,
+                                 FILE_TYPE_FOLDER | FILE_TYPE_OBJECT_IO,
+                                 FILE_BLENDER,
+                                 FILE_SAVE,
+                                 WM_FILESEL_FILEPATH | WM_FILESEL_SHOW_PROPS,
+                                 FILE_DEFAULTDISPLAY,
+                                 FILE_SORT_DEFAULT);
+
+  RNA_def_boolean(ot->srna,
+                  "export_selected_objects",
+                  false,
+                  "Selection Only",
+                  "Only export the selected objects");
+  RNA_def_boolean(ot->srna,
+                  "apply_modifiers",
+                  true,
+                  "Apply Modifiers",
+                  "Export the meshes with their modifiers applied");
+  RNA_def_boolean(ot->srna,
+                  "ascii_format",
+                  false,
+                  "ASCII",
+                  "Write a text file instead of the smaller binary format");
+  io_ui_axes_def(ot, IO_AXIS_Y, IO_AXIS_Z);
+  RNA_def_float(ot->srna,
+                "global_scale",
+                1.0f,
+                0.001f,
+                10000.0f,
+                "Scale",
+                "Scale of the exported coordinates",
+                0.01f,
+                1000.0f);
+}
+
+static int wm_stl_import_exec(bContext *C, wmOperator *op)
+{
+  if (!RNA_struct_property_is_set(op->ptr, "filepath")) {
+    BKE_report(op->reports, RPT_ERROR, "No filename given");
+    return OPERATOR_CANCELLED;
+  }
+
+  struct STLImportParams params;
+  RNA_string_get(op->ptr, "filepath", params.filepath);
+  params.forward_axis = RNA_enum_get(op->ptr, "forward_axis");
+  params.up_axis = RNA_enum_get(op->ptr, "up_axis");
+  params.global_scale = RNA_float_get(op->ptr, "global_scale");
+  params.merge_distance = RNA_float_get(op->ptr, "merge_distance");
+  params.validate_mesh = RNA_boolean_get(op->ptr, "validate_mesh");
+
+  if (!io_ui_axes_check(op)) {
+    return OPERATOR_CANCELLED;
+  }
+  if (!STL_import(C, &params)) {
+    BKE_report(op->reports, RPT_ERROR, "Import failed, see the console for details");
+    return OPERATOR_CANCELLED;
+  }
+
+  WM_event_add_notifier(C, NC_SCENE | ND_OB_ACTIVE, CTX_data_scene(C));
+  return OPERATOR_FINISHED;
+}
+
+static void wm_stl_import_draw(bContext *UNUSED(C), wmOperator *op)
+{
+  uiLayout *layout = op->layout;
+  struct PointerRNA *ptr = op->ptr;
+
+  uiLayoutSetPropSep(layout, true);
+
+  uiLayout *box = uiLayoutBox(layout);
+  io_ui_axes_draw(box, ptr);
+  uiItemR(box, ptr, "global_scale", 0, NULL, ICON_NONE);
+
+  box = uiLayoutBox(layout);
+  uiItemR(box, ptr, "merge_distance", 0, NULL, ICON_NONE);
+  uiItemR(box, ptr, "validate_mesh", 0, NULL, ICON_NONE);
+}
+
+void WM_OT_stl_import(struct wmOperatorType *ot)
+{
+  ot->name = "Import STL";
+  ot->description = "Import an STL file as a mesh object";
+  ot->idname = "WM_OT_stl_import";
+
+  ot->invoke = WM_operator_filesel;
+  ot->exec = wm_stl_import_exec;
+  ot->poll = WM_operator_winactive;
+  ot->ui = wm_stl_import_draw;
+
+  WM_operator_properties_filesel(ot,
+                                 FILE_TYPE_FOLDER | FILE_TYPE_OBJECT_IO,
+                                 FILE_BLENDER,
+                                 FILE_OPENFILE,
+                                 WM_FILESEL_FILEPATH | WM_FILESEL_SHOW_PROPS,
+                                 FILE_DEFAULTDISPLAY,
+                                 FILE_SORT_ALPHA);
+
+  io_ui_axes_def(ot, IO_AXIS_Y, IO_AXIS_Z);
+  RNA_def_float(ot->srna,
+                "global_scale",
+                1.0f,
+                0.001f,
+                10000.0f,
+                "Scale",
+                "Scale of the imported coordinates",
+                0.01f,
+                1000.0f);
+  RNA_def_float_distance(ot->srna,
+                         "merge_distance",
+                         0.0f,
+                         0.0f,
+                         1.0f,
+                         "Merge Distance",
+                         "Merge triangle corners closer than this distance into one vertex, only "
+                         "exactly matching corners are merged when zero",
+                         0.0f,
+                         0.01f);
+  RNA_def_boolean(ot->srna,
+                  "validate_mesh",
+                  false,
+                  "Validate Mesh",
+                  "Check the imported mesh for invalid data (slow)");
+}
+
+#endif /* WITH_IO_STL */
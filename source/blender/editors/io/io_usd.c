@@ -242,4 +242,122 @@ void WM_OT_usd_export(struct wmOperatorType *ot)
                "are different settings for viewport and rendering");
 }
 
+static int wm_usd_import_invoke(bContext *C, wmOperator *op, const wmEvent *event)
+{
+  eUSDOperatorOptions *options = MEM_callocN(sizeof(eUSDOperatorOptions), "eUSDOperatorOptions");
+  options->as_background_job = true;
+  op->customdata = options;
+
+  return WM_operator_filesel(C, op, event);
+}
+
+static int wm_usd_import_exec(bContext *C, wmOperator *op)
+{
+  if (!RNA_struct_property_is_set(op->ptr, "filepath")) {
+    BKE_report(op->reports, RPT_ERROR, "No filename given");
+    return OPERATOR_CANCELLED;
+  }
+
+  char filename[FILE_MAX];
+  RNA_string_get(op->ptr, "filepath", filename);
+
+  eUSDOperatorOptions *options = (eUSDOperatorOptions *)op->customdata;
+  const bool as_background_job = (options != NULL && options->as_background_job);
+  MEM_SAFE_FREE(op->customdata);
+
+  struct USDImportParams params = {
+      RNA_float_get(op->ptr, "scale"),
+      RNA_boolean_get(op->ptr, "import_cameras"),
+      RNA_boolean_get(op->ptr, "import_lights"),
+      RNA_boolean_get(op->ptr, "import_meshes"),
+      RNA_boolean_get(op->ptr, "import_uvmaps"),
+      RNA_boolean_get(op->ptr, "import_normals"),
+      RNA_boolean_get(op->ptr, "validate_meshes"),
+  };
+
+  bool ok = USD_import(C, filename, &params, as_background_job);
+
+  return as_background_job || ok ? OPERATOR_FINISHED : OPERATOR_CANCELLED;
+}
+
+static void wm_usd_import_cancel(bContext *UNUSED(C), wmOperator *op)
+{
+  MEM_SAFE_FREE(op->customdata);
+}
+
+static void wm_usd_import_draw(bContext *UNUSED(C), wmOperator *op)
+{
+  uiLayout *layout = op->layout;
+  uiLayout *col;
+  struct PointerRNA *ptr = op->ptr;
+
+  uiLayoutSetPropSep(layout, true);
+
+  uiLayout *box = uiLayoutBox(layout);
+
+  col = uiLayoutColumn(box, true);
+  uiItemR(col, ptr, "import_meshes", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "import_cameras", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "import_lights", 0, NULL, ICON_NONE);
+
+  col = uiLayoutColumn(box, true);
+  uiItemR(col, ptr, "import_uvmaps", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "import_normals", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "validate_meshes", 0, NULL, ICON_NONE);
+
+  box = uiLayoutBox(layout);
+  uiItemR(box, ptr, "scale", 0, NULL, ICON_NONE);
+}
+
+void WM_OT_usd_import(struct wmOperatorType *ot)
+{
+  ot->name = "Import USD";
+  ot->description = "Import meshes, cameras and lights from a USD file";
+  ot->idname = "WM_OT_usd_import";
+
+  ot->invoke = wm_usd_import_invoke;
+  ot->exec = wm_usd_import_exec;
+  ot->cancel = wm_usd_import_cancel;
+  ot->poll = WM_operator_winactive;
+  ot->ui = wm_usd_import_draw;
+
+  WM_operator_properties_filesel(ot,
+                                 FILE_TYPE_FOLDER | FILE_TYPE_USD,
+                                 FILE_BLENDER,
+                                 FILE_OPENFILE,
+                                 WM_FILESEL_FILEPATH | WM_FILESEL_SHOW_PROPS,
+                                 FILE_DEFAULTDISPLAY,
+                                 FILE_SORT_ALPHA);
+
+  RNA_def_float(ot->srna,
+                "scale",
+                1.0f,
+                0.0001f,
+                1000.0f,
+                "Scale",
+                "Value by which to enlarge or shrink the objects with respect to the world's "
+                "origin, in addition to the meters per unit of the file",
+                0.0001f,
+                1000.0f);
+
+  RNA_def_boolean(ot->srna, "import_meshes", true, "Meshes", "Import mesh prims");
+  RNA_def_boolean(ot->srna, "import_cameras", true, "Cameras", "Import camera prims");
+  RNA_def_boolean(ot->srna, "import_lights", true, "Lights", "Import light prims");
+  RNA_def_boolean(ot->srna,
+                  "import_uvmaps",
+                  true,
+                  "UV Maps",
+                  "When checked, texture coordinate primvars are imported as UV maps");
+  RNA_def_boolean(ot->srna,
+                  "import_normals",
+                  true,
+                  "Normals",
+                  "When checked, authored normals are imported as custom normals");
+  RNA_def_boolean(ot->srna,
+                  "validate_meshes",
+                  false,
+                  "Validate Meshes",
+                  "Check imported mesh objects for invalid data (slow)");
+}
+
 #endif /* WITH_USD */
@@ -0,0 +1,113 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup editor/io
+ */
+
+#include "BKE_context.h"
+#include "BKE_main.h"
+#include "BKE_report.h"
+
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "BLT_translation.h"
+
+#include "RNA_access.h"
+#include "RNA_define.h"
+
+#include "UI_interface.h"
+#include "UI_resources.h"
+
+#include "WM_api.h"
+#include "WM_types.h"
+
+#include "IO_orientation.h"
+
+#include "io_utils.h"
+
+static const EnumPropertyItem io_axis_items[] = {
+    {IO_AXIS_X, "X", 0, "X", "Positive X axis"},
+    {IO_AXIS_Y, "Y", 0, "Y", "Positive Y axis"},
+    {IO_AXIS_Z, "Z", 0, "Z", "Positive Z axis"},
+    {IO_AXIS_NEGATIVE_X, "NEGATIVE_X", 0, "-X", "Negative X axis"},
+    {IO_AXIS_NEGATIVE_Y, "NEGATIVE_Y", 0, "-Y", "Negative Y axis"},
+    {IO_AXIS_NEGATIVE_Z, "NEGATIVE_Z", 0, "-Z", "Negative Z axis"},
+    {0, NULL, 0, NULL, NULL},
+};
+
+/* Define the "forward_axis" and "up_axis" properties, axes of the file. */
+void io_ui_axes_def(wmOperatorType *ot, const int forward_default, const int up_default)
+{
+  RNA_def_enum(ot->srna,
+               "forward_axis",
+               io_axis_items,
+               forward_default,
+               "Forward Axis",
+               "Axis of the file that points forward in Blender (-Y)");
+  RNA_def_enum(ot->srna,
+               "up_axis",
+               io_axis_items,
+               up_default,
+               "Up Axis",
+               "Axis of the file that points up in Blender (Z)");
+}
+
+void io_ui_axes_draw(uiLayout *layout, PointerRNA *ptr)
+{
+  uiLayout *col = uiLayoutColumn(layout, false);
+  uiItemR(col, ptr, "forward_axis", 0, IFACE_("Forward"), ICON_NONE);
+  uiItemR(col, ptr, "up_axis", 0, IFACE_("Up"), ICON_NONE);
+}
+
+/* Report an error when the axes don't define an orientation. */
+bool io_ui_axes_check(wmOperator *op)
+{
+  const int forward = RNA_enum_get(op->ptr, "forward_axis");
+  const int up = RNA_enum_get(op->ptr, "up_axis");
+  /* Opposite axes are three apart. */
+  if (forward % 3 == up % 3) {
+    BKE_report(op->reports, RPT_ERROR, "Forward and up axes must be different");
+    return false;
+  }
+  return true;
+}
+
+/* Default to the path of the blend-file with the extension of the format. */
+void io_ui_export_filepath_ensure(bContext *C, wmOperator *op, const char *ext)
+{
+  if (RNA_struct_property_is_set(op->ptr, "filepath")) {
+    return;
+  }
+  Main *bmain = CTX_data_main(C);
+  char filepath[FILE_MAX];
+  const char *main_blendfile_path = BKE_main_blendfile_path(bmain);
+
+  if (main_blendfile_path[0] == '\0') {
+    BLI_strncpy(filepath, "untitled", sizeof(filepath));
+  }
+  else {
+    BLI_strncpy(filepath, main_blendfile_path, sizeof(filepath));
+  }
+
+  BLI_path_extension_replace(filepath, sizeof(filepath), ext);
+  RNA_string_set(op->ptr, "filepath", filepath);
+}
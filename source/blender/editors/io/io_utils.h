@@ -0,0 +1,38 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup editor/io
+ *
+ * Operator properties shared by the importers and exporters of mesh file formats.
+ */
+
+#pragma once
+
+struct PointerRNA;
+struct bContext;
+struct uiLayout;
+struct wmOperator;
+struct wmOperatorType;
+
+void io_ui_axes_def(struct wmOperatorType *ot, const int forward_default, const int up_default);
+void io_ui_axes_draw(struct uiLayout *layout, struct PointerRNA *ptr);
+bool io_ui_axes_check(struct wmOperator *op);
+
+void io_ui_export_filepath_ensure(struct bContext *C, struct wmOperator *op, const char *ext);
@@ -66,6 +66,10 @@
 
 #include "render_intern.h" /* own include */
 
+#ifdef WITH_COMPOSITOR
+#  include "COM_compositor.h"
+#endif
+
 /***************************** Render Engines ********************************/
 
 void ED_render_scene_update(const DEGEditorUpdateContext *update_ctx, int updated)
@@ -229,6 +233,37 @@ static void lamp_changed(Main *UNUSED(bmain), Light *la)
   BKE_icon_changed(BKE_icon_id_ensure(&la->id));
 }
 
+#ifdef WITH_COMPOSITOR
+static bool node_tree_uses_id(const bNodeTree *ntree, const ID *id)
+{
+  LISTBASE_FOREACH (const bNode *, node, &ntree->nodes) {
+    if (node->id == id) {
+      return true;
+    }
+    if (node->type == NODE_GROUP && node->id && node_tree_uses_id((bNodeTree *)node->id, id)) {
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+/* The compositor keeps buffers between executions, they don't notice changes to the images,
+ * textures, masks and clips the node trees read from. */
+static void compositor_id_changed(Main *bmain, ID *id)
+{
+#ifdef WITH_COMPOSITOR
+  LISTBASE_FOREACH (Scene *, scene, &bmain->scenes) {
+    if (scene->use_nodes && scene->nodetree && node_tree_uses_id(scene->nodetree, id)) {
+      COM_clearCaches();
+      return;
+    }
+  }
+#else
+  UNUSED_VARS(bmain, id);
+#endif
+}
+
 static void texture_changed(Main *bmain, Tex *tex)
 {
   Scene *scene;
@@ -238,6 +273,8 @@ static void texture_changed(Main *bmain, Tex *tex)
   /* icons */
   BKE_icon_changed(BKE_icon_id_ensure(&tex->id));
 
+  compositor_id_changed(bmain, &tex->id);
+
   for (scene = bmain->scenes.first; scene; scene = scene->id.next) {
     /* paint overlays */
     for (view_layer = scene->view_layers.first; view_layer; view_layer = view_layer->next) {
@@ -267,6 +304,8 @@ static void image_changed(Main *bmain, Image *ima)
   /* icons */
   BKE_icon_changed(BKE_icon_id_ensure(&ima->id));
 
+  compositor_id_changed(bmain, &ima->id);
+
   /* textures */
   for (tex = bmain->textures.first; tex; tex = tex->id.next) {
     if (tex->type == TEX_IMAGE && tex->ima == ima) {
@@ -317,6 +356,10 @@ void ED_render_id_flush_update(const DEGEditorUpdateContext *update_ctx, ID *id)
     case ID_SCE:
       scene_changed(bmain, (Scene *)id);
       break;
+    case ID_MSK:
+    case ID_MC:
+      compositor_id_changed(bmain, id);
+      break;
     default:
       break;
   }
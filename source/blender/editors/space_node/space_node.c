@@ -55,6 +55,10 @@
 
 #include "node_intern.h" /* own include */
 
+#ifdef WITH_COMPOSITOR
+#  include "COM_compositor.h"
+#endif
+
 /* ******************** tree path ********************* */
 
 void ED_node_tree_start(SpaceNode *snode, bNodeTree *ntree, ID *id, ID *from)
@@ -328,6 +332,19 @@ static void node_init(struct wmWindowManager *UNUSED(wm), ScrArea *UNUSED(area))
 {
 }
 
+/* The compositor keeps buffers between executions, they don't notice undo and new render
+ * results. Edits of data-blocks the tree reads from are handled by #ED_render_id_flush_update. */
+static void node_area_clear_compositor_cache(SpaceNode *snode)
+{
+#ifdef WITH_COMPOSITOR
+  if (ED_node_is_compositor(snode)) {
+    COM_clearCaches();
+  }
+#else
+  UNUSED_VARS(snode);
+#endif
+}
+
 static void node_area_listener(wmWindow *UNUSED(win),
                                ScrArea *area,
                                wmNotifier *wmn,
@@ -370,6 +387,9 @@ static void node_area_listener(wmWindow *UNUSED(win),
         case ND_LAYER_CONTENT:
           ED_area_tag_refresh(area);
           break;
+        case ND_RENDER_RESULT:
+          node_area_clear_compositor_cache(snode);
+          break;
       }
       break;
 
@@ -478,6 +498,7 @@ static void node_area_listener(wmWindow *UNUSED(win),
       break;
     case NC_WM:
       if (wmn->data == ND_UNDO) {
+        node_area_clear_compositor_cache(snode);
         ED_area_tag_refresh(area);
       }
       break;
@@ -66,6 +66,36 @@ typedef struct MemFileUndoStep {
   MemFileUndoData *data;
 } MemFileUndoStep;
 
+/**
+ * Number of the most recent memfile steps that are kept uncompressed,
+ * older steps are compressed since they are less likely to be used.
+ */
+#define MEMFILE_UNDO_STEPS_UNCOMPRESSED 3
+
+static void memfile_undosys_step_data_size_update(MemFileUndoStep *us)
+{
+  us->data->undo_size = us->data->memfile.size;
+  us->step.data_size = us->data->undo_size;
+}
+
+/**
+ * Compress the step that just went past the #MEMFILE_UNDO_STEPS_UNCOMPRESSED most recent ones.
+ */
+static void memfile_undosys_step_compress_old(MemFileUndoStep *us_prev)
+{
+  UndoStep *us_iter = (UndoStep *)us_prev;
+  for (int i = 2; i < MEMFILE_UNDO_STEPS_UNCOMPRESSED && us_iter != NULL; i++) {
+    us_iter = BKE_undosys_step_same_type_prev(us_iter);
+  }
+  UndoStep *us_old_p = us_iter ? BKE_undosys_step_same_type_prev(us_iter) : NULL;
+  if (us_old_p == NULL) {
+    return;
+  }
+  MemFileUndoStep *us_old = (MemFileUndoStep *)us_old_p;
+  BLO_memfile_compress(&us_old->data->memfile, &((MemFileUndoStep *)us_iter)->data->memfile);
+  memfile_undosys_step_data_size_update(us_old);
+}
+
 static bool memfile_undosys_poll(bContext *C)
 {
   /* other poll functions must run first, this is a catch-all. */
@@ -101,6 +131,12 @@ static bool memfile_undosys_step_encode(struct bContext *UNUSED(C),
   us->data = BKE_memfile_undo_encode(bmain, us_prev ? us_prev->data : NULL);
   us->step.data_size = us->data->undo_size;
 
+  if (us_prev != NULL) {
+    /* The previous step may have been uncompressed to be used as reference. */
+    memfile_undosys_step_data_size_update(us_prev);
+    memfile_undosys_step_compress_old(us_prev);
+  }
+
   /* Store the fact that we should not re-use old data with that undo step, and reset the Main
    * flag. */
   us->step.use_old_bmain_data = !bmain->use_memfile_full_barrier;
@@ -192,6 +228,8 @@ static void memfile_undosys_step_decode(struct bContext *C,
   ED_editors_exit(bmain, false);
 
   MemFileUndoStep *us = (MemFileUndoStep *)us_p;
+  BLO_memfile_uncompress(&us->data->memfile);
+  memfile_undosys_step_data_size_update(us);
   BKE_memfile_undo_decode(us->data, undo_direction, use_old_bmain_data, C);
 
   for (UndoStep *us_iter = us_p->next; us_iter; us_iter = us_iter->next) {
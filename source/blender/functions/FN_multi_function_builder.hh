@@ -28,6 +28,48 @@
 
 namespace blender::fn {
 
+namespace builder_detail {
+
+/**
+ * Behaves like a span in which every element is the same value. This allows element loops to read
+ * a constant input without going through the indirection of a virtual span.
+ */
+template<typename T> class SingleValueSpan {
+ private:
+  const T &value_;
+
+ public:
+  SingleValueSpan(const T &value) : value_(value)
+  {
+  }
+
+  const T &operator[](const int64_t UNUSED(index)) const
+  {
+    return value_;
+  }
+};
+
+/**
+ * Calls the given function with a span type that gives direct access to the elements of the
+ * virtual span, when possible. Full arrays and single values are by far the most common inputs, so
+ * specializing the element loops for them allows the compiler to optimize them much better.
+ *
+ * Returns false when the span could not be devirtualized. Otherwise the return value of the
+ * function is passed through, so that multiple calls can be nested.
+ */
+template<typename T, typename FuncT> bool try_devirtualize(const VSpan<T> &span, const FuncT &func)
+{
+  if (span.is_full_array()) {
+    return func(span.as_full_array());
+  }
+  if (span.is_single_element()) {
+    return func(SingleValueSpan<T>(span.as_single_element()));
+  }
+  return false;
+}
+
+}  // namespace builder_detail
+
 /**
  * Generates a multi-function with the following parameters:
  * 1. single input (SI) of type In1
@@ -58,8 +100,15 @@ template<typename In1, typename Out1> class CustomMF_SI_SO : public MultiFunctio
   template<typename ElementFuncT> static FunctionT create_function(ElementFuncT element_fn)
   {
     return [=](IndexMask mask, VSpan<In1> in1, MutableSpan<Out1> out1) {
-      mask.foreach_index(
-          [&](int i) { new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i])); });
+      auto loop = [&](const auto &fast_in1) {
+        mask.foreach_index([&](int64_t i) {
+          new (static_cast<void *>(&out1[i])) Out1(element_fn(fast_in1[i]));
+        });
+        return true;
+      };
+      if (!builder_detail::try_devirtualize(in1, loop)) {
+        loop(in1);
+      }
     };
   }
 
@@ -101,8 +150,19 @@ class CustomMF_SI_SI_SO : public MultiFunction {
   template<typename ElementFuncT> static FunctionT create_function(ElementFuncT element_fn)
   {
     return [=](IndexMask mask, VSpan<In1> in1, VSpan<In2> in2, MutableSpan<Out1> out1) {
-      mask.foreach_index(
-          [&](int i) { new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i], in2[i])); });
+      auto loop = [&](const auto &fast_in1, const auto &fast_in2) {
+        mask.foreach_index([&](int64_t i) {
+          new (static_cast<void *>(&out1[i])) Out1(element_fn(fast_in1[i], fast_in2[i]));
+        });
+        return true;
+      };
+      const bool devirtualized = builder_detail::try_devirtualize(in1, [&](const auto &fast_in1) {
+        return builder_detail::try_devirtualize(
+            in2, [&](const auto &fast_in2) { return loop(fast_in1, fast_in2); });
+      });
+      if (!devirtualized) {
+        loop(in1, in2);
+      }
     };
   }
 
@@ -152,9 +212,22 @@ class CustomMF_SI_SI_SI_SO : public MultiFunction {
                VSpan<In2> in2,
                VSpan<In3> in3,
                MutableSpan<Out1> out1) {
-      mask.foreach_index([&](int i) {
-        new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i], in2[i], in3[i]));
+      auto loop = [&](const auto &fast_in1, const auto &fast_in2, const auto &fast_in3) {
+        mask.foreach_index([&](int64_t i) {
+          new (static_cast<void *>(&out1[i]))
+              Out1(element_fn(fast_in1[i], fast_in2[i], fast_in3[i]));
+        });
+        return true;
+      };
+      const bool devirtualized = builder_detail::try_devirtualize(in1, [&](const auto &fast_in1) {
+        return builder_detail::try_devirtualize(in2, [&](const auto &fast_in2) {
+          return builder_detail::try_devirtualize(
+              in3, [&](const auto &fast_in3) { return loop(fast_in1, fast_in2, fast_in3); });
+        });
       });
+      if (!devirtualized) {
+        loop(in1, in2, in3);
+      }
     };
   }
 
@@ -25,20 +25,49 @@
 namespace blender::fn {
 
 class MFNetworkEvaluationStorage;
+class MFBufferPool;
 
 class MFNetworkEvaluator : public MultiFunction {
+ public:
+  /**
+   * Masks up to this size are evaluated at once by default. Larger masks are split into chunks of
+   * this size, so that the temporary buffers of a chunk fit into the cache.
+   */
+  static constexpr int64_t default_chunk_size = 4096;
+
  private:
   Vector<const MFOutputSocket *> inputs_;
   Vector<const MFInputSocket *> outputs_;
+  int64_t chunk_size_ = default_chunk_size;
+  bool chunking_supported_;
 
  public:
   MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs, Vector<const MFInputSocket *> outputs);
 
+  /**
+   * Evaluate masks that are larger than the given size in chunks that are processed in parallel.
+   * The temporary buffers are only as large as a chunk, so that they can stay in the cache, and
+   * they are reused for all chunks that are evaluated on the same thread. A chunk size of zero
+   * evaluates the entire mask at once. The default is #default_chunk_size.
+   *
+   * Networks with vector inputs or outputs are always evaluated at once.
+   */
+  void set_chunk_size(int64_t chunk_size);
+
   void call(IndexMask mask, MFParams params, MFContext context) const override;
 
  private:
   using Storage = MFNetworkEvaluationStorage;
 
+  void evaluate_mask(IndexMask mask,
+                     MFParams params,
+                     MFContext context,
+                     MFBufferPool *buffer_pool) const;
+  void evaluate_chunk(IndexMask chunk_mask,
+                      MFParams params,
+                      MFContext context,
+                      MFBufferPool &buffer_pool) const;
+
   void copy_inputs_to_storage(MFParams params, Storage &storage) const;
   void copy_outputs_to_storage(
       MFParams params,
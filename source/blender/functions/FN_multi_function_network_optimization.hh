@@ -16,14 +16,39 @@
 
 #pragma once
 
+/** \file
+ * \ingroup fn
+ *
+ * Passes that simplify a #MFNetwork before it is evaluated. The individual passes can be used on
+ * their own, but usually #optimize should be called, which runs all of them in a sensible order.
+ */
+
 #include "FN_multi_function_network.hh"
 
 #include "BLI_resource_collector.hh"
 
 namespace blender::fn::mf_network_optimization {
 
-void dead_node_removal(MFNetwork &network);
-void constant_folding(MFNetwork &network, ResourceCollector &resources);
-void common_subnetwork_elimination(MFNetwork &network);
+/**
+ * Describes how much a network was reduced by #optimize.
+ */
+struct OptimizationStats {
+  int function_nodes_before = 0;
+  int function_nodes_after = 0;
+  /** Amount of output sockets that have been replaced by constants. */
+  int folded_sockets = 0;
+  /** Amount of function nodes whose outputs have been linked to an equivalent node. */
+  int deduplicated_nodes = 0;
+  /** Amount of nodes that have been removed because their outputs were not used anymore. */
+  int removed_nodes = 0;
+};
+
+int dead_node_removal(MFNetwork &network);
+int constant_folding(MFNetwork &network, ResourceCollector &resources);
+int common_subnetwork_elimination(MFNetwork &network);
+
+void optimize(MFNetwork &network,
+              ResourceCollector &resources,
+              OptimizationStats *r_stats = nullptr);
 
 }  // namespace blender::fn::mf_network_optimization
@@ -98,6 +98,14 @@ class GSpan {
     return POINTER_OFFSET(data_, type_->size() * index);
   }
 
+  GSpan slice(const int64_t start, const int64_t size) const
+  {
+    BLI_assert(start >= 0);
+    BLI_assert(size >= 0);
+    BLI_assert(start + size <= size_ || size == 0);
+    return GSpan(*type_, POINTER_OFFSET(data_, type_->size() * start), size);
+  }
+
   template<typename T> Span<T> typed() const
   {
     BLI_assert(type_->is<T>());
@@ -165,6 +173,14 @@ class GMutableSpan {
     return POINTER_OFFSET(data_, type_->size() * index);
   }
 
+  GMutableSpan slice(const int64_t start, const int64_t size) const
+  {
+    BLI_assert(start >= 0);
+    BLI_assert(size >= 0);
+    BLI_assert(start + size <= size_ || size == 0);
+    return GMutableSpan(*type_, POINTER_OFFSET(data_, type_->size() * start), size);
+  }
+
   template<typename T> MutableSpan<T> typed()
   {
     BLI_assert(type_->is<T>());
@@ -419,6 +435,31 @@ class GVSpan : public VSpanBase<void> {
     return VSpan<T>(*this);
   }
 
+  /**
+   * Returns a virtual span that references a part of this one. Single values stay single values
+   * with the new size.
+   */
+  GVSpan slice(const int64_t start, const int64_t size) const
+  {
+    BLI_assert(start >= 0);
+    BLI_assert(size >= 0);
+    BLI_assert(start + size <= this->virtual_size_ || size == 0);
+    GVSpan sliced = *this;
+    sliced.virtual_size_ = size;
+    switch (this->category_) {
+      case VSpanCategory::Single:
+        break;
+      case VSpanCategory::FullArray:
+        sliced.data_.full_array.data = POINTER_OFFSET(this->data_.full_array.data,
+                                                      type_->size() * start);
+        break;
+      case VSpanCategory::FullPointerArray:
+        sliced.data_.full_pointer_array.data = this->data_.full_pointer_array.data + start;
+        break;
+    }
+    return sliced;
+  }
+
   const void *as_single_element() const
   {
     BLI_assert(this->is_single_element());
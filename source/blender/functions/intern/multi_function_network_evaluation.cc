@@ -29,20 +29,64 @@
  * - Every node is executed at most once.
  * - Can compute sub-functions on a single element, when the result is the same for all elements.
  *
+ * - Can evaluate large masks in chunks in parallel. Temporary buffers are reused between chunks.
+ *
  * Possible improvements:
- * - Cache and reuse buffers.
  * - Use "deepest depth first" heuristic to decide which order the inputs of a node should be
  *   computed. This reduces the number of required temporary buffers when they are reused.
  */
 
 #include "FN_multi_function_network_evaluation.hh"
 
+#include "BLI_enumerable_thread_specific.hh"
 #include "BLI_stack.hh"
+#include "BLI_task.hh"
 
 namespace blender::fn {
 
 struct Value;
 
+/**
+ * Keeps temporary buffers around after they have been freed, so that they can be reused by later
+ * evaluations. This is used when a mask is evaluated in chunks, where all chunks need buffers of
+ * the same size. A buffer pool must only be used by one thread at a time.
+ */
+class MFBufferPool : NonCopyable, NonMovable {
+ private:
+  /* All buffers are allocated with the same alignment, so that they can be reused for any type. */
+  static constexpr int64_t Alignment = 64;
+  /* Unused buffers grouped by their size in bytes. */
+  Map<int64_t, Vector<void *>> unused_buffers_;
+
+ public:
+  MFBufferPool() = default;
+
+  ~MFBufferPool()
+  {
+    for (Vector<void *> &buffers : unused_buffers_.values()) {
+      for (void *buffer : buffers) {
+        MEM_freeN(buffer);
+      }
+    }
+  }
+
+  void *allocate(const int64_t size, const int64_t alignment)
+  {
+    BLI_assert(alignment <= Alignment);
+    UNUSED_VARS_NDEBUG(alignment);
+    Vector<void *> *buffers = unused_buffers_.lookup_ptr(size);
+    if (buffers != nullptr && !buffers->is_empty()) {
+      return buffers->pop_last();
+    }
+    return MEM_mallocN_aligned(size, Alignment, __func__);
+  }
+
+  void deallocate(void *buffer, const int64_t size)
+  {
+    unused_buffers_.lookup_or_add_default(size).append(buffer);
+  }
+};
+
 /**
  * This keeps track of all the values that flow through the multi-function network. Therefore it
  * maintains a mapping between output sockets and their corresponding values. Every `value`
@@ -56,9 +100,11 @@ class MFNetworkEvaluationStorage {
   IndexMask mask_;
   Array<Value *> value_per_output_id_;
   int64_t min_array_size_;
+  /* Optional pool that full buffers are taken from and given back to. */
+  MFBufferPool *buffer_pool_;
 
  public:
-  MFNetworkEvaluationStorage(IndexMask mask, int socket_id_amount);
+  MFNetworkEvaluationStorage(IndexMask mask, int socket_id_amount, MFBufferPool *buffer_pool);
   ~MFNetworkEvaluationStorage();
 
   /* Add the values that have been provided by the caller of the multi-function network. */
@@ -97,11 +143,15 @@ class MFNetworkEvaluationStorage {
   bool socket_is_computed(const MFOutputSocket &socket);
   bool is_same_value_for_every_index(const MFOutputSocket &socket);
   bool socket_has_buffer_for_output(const MFOutputSocket &socket);
+
+ private:
+  GMutableSpan allocate_full_buffer(const CPPType &type);
+  void free_full_buffer(GMutableSpan span);
 };
 
 MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
                                        Vector<const MFInputSocket *> outputs)
-    : inputs_(std::move(inputs)), outputs_(std::move(outputs))
+    : inputs_(std::move(inputs)), outputs_(std::move(outputs)), chunking_supported_(true)
 {
   BLI_assert(outputs_.size() > 0);
   MFSignatureBuilder signature = this->get_builder("Function Tree");
@@ -116,6 +166,8 @@ MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
         break;
       case MFDataType::Vector:
         signature.vector_input(socket->name(), type.vector_base_type());
+        /* Vector arrays cannot be sliced into chunks. */
+        chunking_supported_ = false;
         break;
     }
   }
@@ -130,19 +182,99 @@ MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
         break;
       case MFDataType::Vector:
         signature.vector_output(socket->name(), type.vector_base_type());
+        chunking_supported_ = false;
         break;
     }
   }
 }
 
+void MFNetworkEvaluator::set_chunk_size(const int64_t chunk_size)
+{
+  BLI_assert(chunk_size >= 0);
+  chunk_size_ = chunk_size;
+}
+
 void MFNetworkEvaluator::call(IndexMask mask, MFParams params, MFContext context) const
 {
   if (mask.size() == 0) {
     return;
   }
+  if (chunk_size_ == 0 || !chunking_supported_ || mask.size() <= chunk_size_) {
+    this->evaluate_mask(mask, params, context, nullptr);
+    return;
+  }
+
+  const int64_t chunks_amount = (mask.size() + chunk_size_ - 1) / chunk_size_;
+  EnumerableThreadSpecific<MFBufferPool> buffer_pools;
+  parallel_for(IndexRange(chunks_amount), 1, [&](const IndexRange chunk_range) {
+    MFBufferPool &buffer_pool = buffer_pools.local();
+    for (const int64_t chunk_index : chunk_range) {
+      const int64_t chunk_start = chunk_index * chunk_size_;
+      const int64_t chunk_size = std::min(chunk_size_, mask.size() - chunk_start);
+      this->evaluate_chunk(mask.slice(chunk_start, chunk_size), params, context, buffer_pool);
+    }
+  });
+}
 
+/**
+ * Evaluate a part of the mask. The indices are shifted so that the chunk starts at zero. That way
+ * the temporary buffers only have to be as large as the chunk.
+ */
+void MFNetworkEvaluator::evaluate_chunk(IndexMask chunk_mask,
+                                        MFParams params,
+                                        MFContext context,
+                                        MFBufferPool &buffer_pool) const
+{
+  const int64_t offset = chunk_mask[0];
+  const int64_t chunk_array_size = chunk_mask.min_array_size() - offset;
+
+  Vector<int64_t> shifted_indices;
+  IndexMask shifted_mask;
+  if (chunk_mask.is_range()) {
+    shifted_mask = IndexRange(chunk_mask.size());
+  }
+  else {
+    shifted_indices.reserve(chunk_mask.size());
+    for (const int64_t index : chunk_mask) {
+      shifted_indices.append(index - offset);
+    }
+    shifted_mask = shifted_indices.as_span();
+  }
+
+  MFParamsBuilder chunk_params{*this, chunk_array_size};
+  for (const int param_index : this->param_indices()) {
+    const MFParamType param_type = this->param_type(param_index);
+    switch (param_type.category()) {
+      case MFParamType::SingleInput: {
+        chunk_params.add_readonly_single_input(
+            params.readonly_single_input(param_index).slice(offset, chunk_array_size));
+        break;
+      }
+      case MFParamType::SingleOutput: {
+        chunk_params.add_uninitialized_single_output(
+            params.uninitialized_single_output(param_index).slice(offset, chunk_array_size));
+        break;
+      }
+      case MFParamType::SingleMutable:
+      case MFParamType::VectorInput:
+      case MFParamType::VectorOutput:
+      case MFParamType::VectorMutable: {
+        /* Networks with these parameters are not evaluated in chunks. */
+        BLI_assert(false);
+        break;
+      }
+    }
+  }
+  this->evaluate_mask(shifted_mask, chunk_params, context, &buffer_pool);
+}
+
+void MFNetworkEvaluator::evaluate_mask(IndexMask mask,
+                                       MFParams params,
+                                       MFContext context,
+                                       MFBufferPool *buffer_pool) const
+{
   const MFNetwork &network = outputs_[0]->node().network();
-  Storage storage(mask, network.socket_id_amount());
+  Storage storage(mask, network.socket_id_amount(), buffer_pool);
 
   Vector<const MFInputSocket *> outputs_to_initialize_in_the_end;
 
@@ -506,10 +638,13 @@ struct OwnVectorValue : public Value {
 /** \name Storage methods
  * \{ */
 
-MFNetworkEvaluationStorage::MFNetworkEvaluationStorage(IndexMask mask, int socket_id_amount)
+MFNetworkEvaluationStorage::MFNetworkEvaluationStorage(IndexMask mask,
+                                                       int socket_id_amount,
+                                                       MFBufferPool *buffer_pool)
     : mask_(mask),
       value_per_output_id_(socket_id_amount, nullptr),
-      min_array_size_(mask.min_array_size())
+      min_array_size_(mask.min_array_size()),
+      buffer_pool_(buffer_pool)
 {
 }
 
@@ -528,7 +663,7 @@ MFNetworkEvaluationStorage::~MFNetworkEvaluationStorage()
       }
       else {
         type.destruct_indices(span.data(), mask_);
-        MEM_freeN(span.data());
+        this->free_full_buffer(span);
       }
     }
     else if (any_value->type == ValueType::OwnVector) {
@@ -543,6 +678,25 @@ IndexMask MFNetworkEvaluationStorage::mask() const
   return mask_;
 }
 
+GMutableSpan MFNetworkEvaluationStorage::allocate_full_buffer(const CPPType &type)
+{
+  const int64_t size = min_array_size_ * type.size();
+  void *buffer = (buffer_pool_ == nullptr) ?
+                     MEM_mallocN_aligned(size, type.alignment(), AT) :
+                     buffer_pool_->allocate(size, type.alignment());
+  return GMutableSpan(type, buffer, min_array_size_);
+}
+
+void MFNetworkEvaluationStorage::free_full_buffer(GMutableSpan span)
+{
+  if (buffer_pool_ == nullptr) {
+    MEM_freeN(span.data());
+  }
+  else {
+    buffer_pool_->deallocate(span.data(), span.size() * span.type().size());
+  }
+}
+
 bool MFNetworkEvaluationStorage::socket_is_computed(const MFOutputSocket &socket)
 {
   Value *any_value = value_per_output_id_[socket.id()];
@@ -638,7 +792,7 @@ void MFNetworkEvaluationStorage::finish_input_socket(const MFInputSocket &socket
         }
         else {
           type.destruct_indices(span.data(), mask_);
-          MEM_freeN(span.data());
+          this->free_full_buffer(span);
         }
         value_per_output_id_[origin.id()] = nullptr;
       }
@@ -702,8 +856,7 @@ GMutableSpan MFNetworkEvaluationStorage::get_single_output__full(const MFOutputS
   Value *any_value = value_per_output_id_[socket.id()];
   if (any_value == nullptr) {
     const CPPType &type = socket.data_type().single_type();
-    void *buffer = MEM_mallocN_aligned(min_array_size_ * type.size(), type.alignment(), AT);
-    GMutableSpan span(type, buffer, min_array_size_);
+    GMutableSpan span = this->allocate_full_buffer(type);
 
     auto *value = allocator_.construct<OwnSingleValue>(span, socket.targets().size(), false);
     value_per_output_id_[socket.id()] = value;
@@ -802,8 +955,7 @@ GMutableSpan MFNetworkEvaluationStorage::get_mutable_single__full(const MFInputS
   }
 
   GVSpan virtual_span = this->get_single_input__full(input);
-  void *new_buffer = MEM_mallocN_aligned(min_array_size_ * type.size(), type.alignment(), AT);
-  GMutableSpan new_array_ref(type, new_buffer, min_array_size_);
+  GMutableSpan new_array_ref = this->allocate_full_buffer(type);
   virtual_span.materialize_to_uninitialized(mask_, new_array_ref.data());
 
   OwnSingleValue *new_value = allocator_.construct<OwnSingleValue>(
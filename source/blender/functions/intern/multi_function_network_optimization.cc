@@ -18,9 +18,6 @@
  * \ingroup fn
  */
 
-/* Used to check if two multi-functions have the exact same type. */
-#include <typeinfo>
-
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_network_evaluation.hh"
 #include "FN_multi_function_network_optimization.hh"
@@ -127,13 +124,15 @@ static Vector<MFNode *> find_nodes_based_on_mask(MFNetwork &network,
 
 /**
  * Unused nodes are all those nodes that no dummy node depends upon.
+ * Returns the number of removed nodes.
  */
-void dead_node_removal(MFNetwork &network)
+int dead_node_removal(MFNetwork &network)
 {
   Array<bool> node_is_used_mask = mask_nodes_to_the_left(network,
                                                          network.dummy_nodes().cast<MFNode *>());
   Vector<MFNode *> nodes_to_remove = find_nodes_based_on_mask(network, node_is_used_mask, false);
   network.remove(nodes_to_remove);
+  return nodes_to_remove.size();
 }
 
 /** \} */
@@ -300,19 +299,19 @@ static Array<MFOutputSocket *> compute_constant_sockets_and_add_folded_nodes(
   return add_constant_folded_sockets(network_fn, params, resources, network);
 }
 
-class MyClass {
-  MFDummyNode node;
-};
-
 /**
  * Find function nodes that always output the same value and replace those with constant nodes.
+ * Entire sub-networks that do not depend on a network input are evaluated at once. Only the
+ * sockets at the border to the non-constant part of the network are replaced. The nodes that
+ * computed them are left for #dead_node_removal.
+ * Returns the number of folded sockets.
  */
-void constant_folding(MFNetwork &network, ResourceCollector &resources)
+int constant_folding(MFNetwork &network, ResourceCollector &resources)
 {
   Vector<MFDummyNode *> temporary_nodes;
   Vector<MFInputSocket *> inputs_to_fold = find_constant_inputs_to_fold(network, temporary_nodes);
   if (inputs_to_fold.size() == 0) {
-    return;
+    return 0;
   }
 
   Array<MFOutputSocket *> folded_sockets = compute_constant_sockets_and_add_folded_nodes(
@@ -324,6 +323,7 @@ void constant_folding(MFNetwork &network, ResourceCollector &resources)
   }
 
   network.remove(temporary_nodes.as_span().cast<MFNode *>());
+  return inputs_to_fold.size();
 }
 
 /** \} */
@@ -427,10 +427,8 @@ static bool functions_are_equal(const MultiFunction &a, const MultiFunction &b)
   if (&a == &b) {
     return true;
   }
-  if (typeid(a) == typeid(b)) {
-    return a.equals(b);
-  }
-  return false;
+  /* Don't require the exact same type, e.g. a typed and a generic constant can be equal. */
+  return a.equals(b) || b.equals(a);
 }
 
 static bool nodes_output_same_values(DisjointSet &cache, const MFNode &a, const MFNode &b)
@@ -460,9 +458,10 @@ static bool nodes_output_same_values(DisjointSet &cache, const MFNode &a, const
   return true;
 }
 
-static void relink_duplicate_nodes(MFNetwork &network,
-                                   MultiValueMap<uint64_t, MFNode *> &nodes_by_hash)
+static int relink_duplicate_nodes(MFNetwork &network,
+                                  MultiValueMap<uint64_t, MFNode *> &nodes_by_hash)
 {
+  int deduplicated_amount = 0;
   DisjointSet same_node_cache{network.node_id_amount()};
 
   for (Span<MFNode *> nodes_with_same_hash : nodes_by_hash.values()) {
@@ -482,6 +481,7 @@ static void relink_duplicate_nodes(MFNetwork &network,
           for (int i : deduplicated_node.outputs().index_range()) {
             network.relink(node->output(i), deduplicated_node.output(i));
           }
+          deduplicated_amount++;
         }
         else {
           remaining_nodes.append(node);
@@ -490,17 +490,48 @@ static void relink_duplicate_nodes(MFNetwork &network,
       nodes_to_check = std::move(remaining_nodes);
     }
   }
+  return deduplicated_amount;
 }
 
 /**
  * Tries to detect duplicate sub-networks and eliminates them. This can help quite a lot when node
- * groups were used to create the network.
+ * groups were used to create the network. The duplicate nodes are only unlinked, they are left
+ * for #dead_node_removal.
+ * Returns the number of nodes whose outputs have been relinked.
  */
-void common_subnetwork_elimination(MFNetwork &network)
+int common_subnetwork_elimination(MFNetwork &network)
 {
   Array<uint64_t> node_hashes = compute_node_hashes(network);
   MultiValueMap<uint64_t, MFNode *> nodes_by_hash = group_nodes_by_hash(network, node_hashes);
-  relink_duplicate_nodes(network, nodes_by_hash);
+  return relink_duplicate_nodes(network, nodes_by_hash);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Optimization Pipeline
+ *
+ * \{ */
+
+/**
+ * Run all optimization passes on the network. Unused nodes are removed first, so that no work is
+ * spent on folding them. Constant folding runs before the elimination of common sub-networks,
+ * because it can create equal constant nodes that can be merged afterwards.
+ */
+void optimize(MFNetwork &network, ResourceCollector &resources, OptimizationStats *r_stats)
+{
+  OptimizationStats stats;
+  stats.function_nodes_before = network.function_nodes().size();
+
+  stats.removed_nodes += dead_node_removal(network);
+  stats.folded_sockets += constant_folding(network, resources);
+  stats.deduplicated_nodes += common_subnetwork_elimination(network);
+  stats.removed_nodes += dead_node_removal(network);
+
+  stats.function_nodes_after = network.function_nodes().size();
+  if (r_stats != nullptr) {
+    *r_stats = stats;
+  }
 }
 
 /** \} */
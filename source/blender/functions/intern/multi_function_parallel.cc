@@ -0,0 +1,92 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "FN_multi_function_parallel.hh"
+
+#include "BLI_task.hh"
+
+namespace blender::fn {
+
+ParallelMultiFunction::ParallelMultiFunction(const MultiFunction &fn, const int64_t grain_size)
+    : fn_(fn), grain_size_(grain_size)
+{
+  MFSignatureBuilder signature = this->get_builder(fn.name());
+  if (fn.depends_on_context()) {
+    signature.depends_on_context();
+  }
+  threading_supported_ = true;
+  for (const int param_index : fn.param_indices()) {
+    const MFParamType param_type = fn.param_type(param_index);
+    const StringRefNull param_name = fn.param_name(param_index);
+    switch (param_type.interface_type()) {
+      case MFParamType::Input:
+        signature.input(param_name, param_type.data_type());
+        break;
+      case MFParamType::Output:
+        signature.output(param_name, param_type.data_type());
+        break;
+      case MFParamType::Mutable:
+        signature.mutable_(param_name, param_type.data_type());
+        break;
+    }
+    /* Vector arrays cannot be appended to from multiple threads at the same time. */
+    if (param_type.data_type().is_vector()) {
+      threading_supported_ = false;
+    }
+  }
+}
+
+void ParallelMultiFunction::call(IndexMask mask, MFParams params, MFContext context) const
+{
+  if (!threading_supported_ || mask.size() <= grain_size_) {
+    fn_.call(mask, params, context);
+    return;
+  }
+
+  /* The sliced masks still reference the original indices, so every task can pass the same
+   * (full size) arrays to the wrapped function. Different tasks never access the same element. */
+  parallel_for(mask.index_range(), grain_size_, [&](const IndexRange sub_range) {
+    const IndexMask sub_mask = mask.slice(sub_range);
+    MFParamsBuilder sub_params{fn_, sub_mask.min_array_size()};
+    for (const int param_index : fn_.param_indices()) {
+      const MFParamType param_type = fn_.param_type(param_index);
+      switch (param_type.category()) {
+        case MFParamType::SingleInput: {
+          sub_params.add_readonly_single_input(params.readonly_single_input(param_index));
+          break;
+        }
+        case MFParamType::SingleOutput: {
+          sub_params.add_uninitialized_single_output(
+              params.uninitialized_single_output(param_index));
+          break;
+        }
+        case MFParamType::SingleMutable: {
+          sub_params.add_single_mutable(params.single_mutable(param_index));
+          break;
+        }
+        case MFParamType::VectorInput:
+        case MFParamType::VectorOutput:
+        case MFParamType::VectorMutable: {
+          BLI_assert(false);
+          break;
+        }
+      }
+    }
+    fn_.call(sub_mask, sub_params, context);
+  });
+}
+
+}  // namespace blender::fn
@@ -5,6 +5,7 @@
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_network.hh"
 #include "FN_multi_function_network_evaluation.hh"
+#include "FN_multi_function_network_optimization.hh"
 
 namespace blender::fn::tests {
 namespace {
@@ -65,6 +66,93 @@ TEST(multi_function_network, Test1)
   }
 }
 
+TEST(multi_function_network, ChunkedEvaluation)
+{
+  CustomMF_SI_SO<int, int> add_10_fn("add 10", [](int value) { return value + 10; });
+  CustomMF_SI_SI_SO<int, int, int> multiply_fn("multiply", [](int a, int b) { return a * b; });
+
+  MFNetwork network;
+
+  MFNode &node1 = network.add_function(add_10_fn);
+  MFNode &node2 = network.add_function(multiply_fn);
+  MFOutputSocket &input1 = network.add_input("Input 1", MFDataType::ForSingle<int>());
+  MFOutputSocket &input2 = network.add_input("Input 2", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket = network.add_output("Output", MFDataType::ForSingle<int>());
+  network.add_link(input1, node1.input(0));
+  network.add_link(node1.output(0), node2.input(0));
+  network.add_link(input2, node2.input(1));
+  network.add_link(node2.output(0), output_socket);
+
+  MFNetworkEvaluator network_fn{{&input1, &input2}, {&output_socket}};
+  network_fn.set_chunk_size(100);
+
+  const int size = 10000;
+  Array<int> values(size);
+  for (const int i : values.index_range()) {
+    values[i] = i;
+  }
+  /* Skip some indices, so that the chunks are not ranges. */
+  Vector<int64_t> indices;
+  for (const int i : IndexRange(size)) {
+    if (i % 7 != 3) {
+      indices.append(i);
+    }
+  }
+
+  const int factor = 2;
+  Array<int> results(size, -1);
+  MFParamsBuilder params(network_fn, size);
+  params.add_readonly_single_input(values.as_span());
+  params.add_readonly_single_input(&factor);
+  params.add_uninitialized_single_output(results.as_mutable_span());
+
+  MFContextBuilder context;
+  network_fn.call(indices.as_span(), params, context);
+
+  for (const int i : IndexRange(size)) {
+    if (i % 7 == 3) {
+      EXPECT_EQ(results[i], -1);
+    }
+    else {
+      EXPECT_EQ(results[i], (i + 10) * 2);
+    }
+  }
+}
+
+TEST(multi_function_network, ChunkedEvaluationByDefault)
+{
+  CustomMF_SI_SO<int, int> add_10_fn("add 10", [](int value) { return value + 10; });
+
+  MFNetwork network;
+
+  MFNode &node = network.add_function(add_10_fn);
+  MFOutputSocket &input_socket = network.add_input("Input", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket = network.add_output("Output", MFDataType::ForSingle<int>());
+  network.add_link(input_socket, node.input(0));
+  network.add_link(node.output(0), output_socket);
+
+  /* No chunk size is set, so masks larger than the default chunk size are split up. */
+  MFNetworkEvaluator network_fn{{&input_socket}, {&output_socket}};
+
+  const int size = MFNetworkEvaluator::default_chunk_size * 3 + 5;
+  Array<int> values(size);
+  for (const int i : values.index_range()) {
+    values[i] = i;
+  }
+
+  Array<int> results(size, -1);
+  MFParamsBuilder params(network_fn, size);
+  params.add_readonly_single_input(values.as_span());
+  params.add_uninitialized_single_output(results.as_mutable_span());
+
+  MFContextBuilder context;
+  network_fn.call(IndexRange(size), params, context);
+
+  for (const int i : IndexRange(size)) {
+    EXPECT_EQ(results[i], i + 10);
+  }
+}
+
 class ConcatVectorsFunction : public MultiFunction {
  public:
   ConcatVectorsFunction()
@@ -251,5 +339,66 @@ TEST(multi_function_network, Test2)
   }
 }
 
+TEST(multi_function_network, Optimize)
+{
+  CustomMF_Constant<int> constant_3_fn{3};
+  CustomMF_Constant<int> constant_4_fn{4};
+  CustomMF_SI_SI_SO<int, int, int> add_fn("add", [](int a, int b) { return a + b; });
+  CustomMF_SI_SI_SO<int, int, int> multiply_fn("multiply", [](int a, int b) { return a * b; });
+  CustomMF_SI_SO<int, int> add_10_fn("add 10", [](int value) { return value + 10; });
+
+  MFNetwork network;
+
+  MFNode &constant_3 = network.add_function(constant_3_fn);
+  MFNode &constant_4 = network.add_function(constant_4_fn);
+  MFNode &sum = network.add_function(add_fn);
+  MFNode &multiply1 = network.add_function(multiply_fn);
+  MFNode &multiply2 = network.add_function(multiply_fn);
+  MFNode &unused = network.add_function(add_10_fn);
+  MFOutputSocket &input = network.add_input("Input", MFDataType::ForSingle<int>());
+  MFInputSocket &output1 = network.add_output("Output 1", MFDataType::ForSingle<int>());
+  MFInputSocket &output2 = network.add_output("Output 2", MFDataType::ForSingle<int>());
+  network.add_link(constant_3.output(0), sum.input(0));
+  network.add_link(constant_4.output(0), sum.input(1));
+  network.add_link(input, multiply1.input(0));
+  network.add_link(sum.output(0), multiply1.input(1));
+  network.add_link(input, multiply2.input(0));
+  network.add_link(sum.output(0), multiply2.input(1));
+  network.add_link(input, unused.input(0));
+  network.add_link(multiply1.output(0), output1);
+  network.add_link(multiply2.output(0), output2);
+
+  ResourceCollector resources;
+  mf_network_optimization::OptimizationStats stats;
+  mf_network_optimization::optimize(network, resources, &stats);
+
+  EXPECT_EQ(stats.function_nodes_before, 6);
+  EXPECT_EQ(stats.function_nodes_after, 2);
+  EXPECT_EQ(stats.folded_sockets, 1);
+  EXPECT_EQ(stats.deduplicated_nodes, 1);
+  EXPECT_EQ(stats.removed_nodes, 5);
+  EXPECT_EQ(output1.origin(), output2.origin());
+
+  MFNetworkEvaluator network_fn{{&input}, {&output1, &output2}};
+
+  Array<int> values = {1, 2, 5};
+  Array<int> results1(values.size(), 0);
+  Array<int> results2(values.size(), 0);
+
+  MFParamsBuilder params(network_fn, values.size());
+  params.add_readonly_single_input(values.as_span());
+  params.add_uninitialized_single_output(results1.as_mutable_span());
+  params.add_uninitialized_single_output(results2.as_mutable_span());
+
+  MFContextBuilder context;
+  network_fn.call(IndexRange(values.size()), params, context);
+
+  EXPECT_EQ(results1[0], 7);
+  EXPECT_EQ(results1[1], 14);
+  EXPECT_EQ(results1[2], 35);
+  EXPECT_EQ(results2[0], 7);
+  EXPECT_EQ(results2[2], 35);
+}
+
 }  // namespace
 }  // namespace blender::fn::tests
@@ -0,0 +1,108 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_timeit.hh"
+
+#include "FN_multi_function_builder.hh"
+#include "FN_multi_function_parallel.hh"
+
+namespace blender::fn::tests {
+namespace {
+
+TEST(multi_function_parallel, SingleInputs)
+{
+  CustomMF_SI_SI_SO<int, int, int> fn("add", [](int a, int b) { return a + b; });
+  ParallelMultiFunction parallel_fn{fn, 100};
+  EXPECT_EQ(parallel_fn.param_amount(), 3);
+
+  const int size = 10000;
+  Array<int> values_a(size);
+  for (const int i : values_a.index_range()) {
+    values_a[i] = i;
+  }
+  const int value_b = 5;
+  Array<int> outputs(size, -1);
+
+  MFParamsBuilder params(parallel_fn, size);
+  params.add_readonly_single_input(values_a.as_span());
+  params.add_readonly_single_input(&value_b);
+  params.add_uninitialized_single_output(outputs.as_mutable_span());
+
+  MFContextBuilder context;
+  parallel_fn.call(IndexRange(size), params, context);
+
+  for (const int i : outputs.index_range()) {
+    EXPECT_EQ(outputs[i], i + 5);
+  }
+}
+
+TEST(multi_function_parallel, IndexMask)
+{
+  CustomMF_SI_SO<int, int> fn("double", [](int a) { return a * 2; });
+  ParallelMultiFunction parallel_fn{fn, 2};
+
+  Array<int> inputs = {1, 2, 3, 4, 5, 6, 7};
+  Array<int> outputs(inputs.size(), 0);
+
+  MFParamsBuilder params(parallel_fn, inputs.size());
+  params.add_readonly_single_input(inputs.as_span());
+  params.add_uninitialized_single_output(outputs.as_mutable_span());
+
+  MFContextBuilder context;
+  parallel_fn.call({0, 2, 3, 6}, params, context);
+
+  EXPECT_EQ(outputs[0], 2);
+  EXPECT_EQ(outputs[1], 0);
+  EXPECT_EQ(outputs[2], 6);
+  EXPECT_EQ(outputs[3], 8);
+  EXPECT_EQ(outputs[4], 0);
+  EXPECT_EQ(outputs[5], 0);
+  EXPECT_EQ(outputs[6], 14);
+}
+
+#if 0
+TEST(multi_function_parallel, Benchmark)
+{
+  const int64_t size = 10000000;
+  Array<float> values_a(size, 1.0f);
+  /* Attribute nodes often get a single value for one of their inputs. */
+  const float value_b = 2.0f;
+  Array<float> outputs(size);
+
+  CustomMF_SI_SI_SO<float, float, float> fn{"add", [](float a, float b) { return a + b; }};
+  ParallelMultiFunction parallel_fn{fn, 4096};
+  MFContextBuilder context;
+
+  auto call_function = [&](const MultiFunction &fn_to_call, StringRef name) {
+    MFParamsBuilder params(fn_to_call, size);
+    params.add_readonly_single_input(values_a.as_span());
+    params.add_readonly_single_input(&value_b);
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    SCOPED_TIMER(name);
+    fn_to_call.call(IndexRange(size), params, context);
+  };
+
+  for (int i = 0; i < 3; i++) {
+    {
+      /* Element wise access through virtual spans, like attribute nodes did before. */
+      VSpan<float> span_a{values_a.as_span()};
+      VSpan<float> span_b = VSpan<float>::FromSingle(&value_b, size);
+      SCOPED_TIMER("virtual span loop");
+      for (const int64_t index : IndexRange(size)) {
+        outputs[index] = span_a[index] + span_b[index];
+      }
+    }
+    call_function(fn, "devirtualized       ");
+    call_function(parallel_fn, "parallel            ");
+  }
+
+  /* Print a value to avoid some compiler optimizations. */
+  std::cout << "Value: " << outputs[size / 2] << "\n";
+}
+
+#endif
+
+}  // namespace
+}  // namespace blender::fn::tests
@@ -0,0 +1,61 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/*
+ * Writing of large files by formatting blocks of them with multiple threads, which are then
+ * written in order.
+ */
+
+#include <cstdio>
+#include <functional>
+#include <string>
+
+#include "BLI_compiler_attrs.h"
+#include "BLI_index_range.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+namespace blender::io {
+
+/** Formats a block of the file, appending it to \a r_data. */
+using FormatBlockFn = std::function<void(std::string &r_data)>;
+
+/**
+ * Add a block for every \a block_size elements of \a size, that formats its range of elements.
+ */
+void add_blocks(int64_t size,
+                int64_t block_size,
+                const std::function<void(IndexRange range, std::string &r_data)> &format,
+                Vector<FormatBlockFn> &r_blocks);
+
+/**
+ * Format the \a blocks in parallel and write them to \a file in order. Only a limited number of
+ * blocks is formatted ahead, to bound the memory used.
+ */
+void write_blocks(FILE *file, Span<FormatBlockFn> blocks);
+
+/** Append formatted text, for short items such as a line of numbers. */
+void append_format(std::string &r_data, const char *format, ...) ATTR_PRINTF_FORMAT(2, 3);
+
+/** Append the bytes of \a value. */
+template<typename T> void append_binary(std::string &r_data, const T &value)
+{
+  r_data.append((const char *)&value, sizeof(T));
+}
+
+}  // namespace blender::io
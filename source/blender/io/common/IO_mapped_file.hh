@@ -0,0 +1,53 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include "BLI_string_ref.hh"
+#include "BLI_utility_mixins.hh"
+
+struct BLI_mmap_file;
+
+namespace blender::io {
+
+/**
+ * The contents of a file, memory mapped where that avoids a copy.
+ */
+class MappedFile : NonCopyable, NonMovable {
+ private:
+  int file_ = -1;
+  BLI_mmap_file *mmap_file_ = nullptr;
+  void *mem_ = nullptr;
+  StringRef data_;
+
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  /** Return false when the file can't be read. */
+  bool open(const char *filepath);
+
+  /** The contents, as text for text based formats. */
+  StringRef data() const
+  {
+    return data_;
+  }
+
+  /** Errors accessing mapped memory are only known once it has been read. */
+  bool has_io_error() const;
+};
+
+}  // namespace blender::io
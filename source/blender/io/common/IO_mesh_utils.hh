@@ -0,0 +1,75 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/*
+ * Utilities shared by the importers and exporters of mesh file formats (OBJ, STL, PLY), which
+ * write all meshes into one file without hierarchy.
+ */
+
+#include <string>
+
+#include "BLI_float4x4.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+#include "IO_orientation.h"
+
+struct Depsgraph;
+struct Main;
+struct Material;
+struct Mesh;
+struct Object;
+struct Scene;
+struct ViewLayer;
+
+namespace blender::io {
+
+/** A mesh to export. Instances are temporary objects, so the needed object data is copied. */
+struct ExportMesh {
+  std::string name;
+  const Mesh *mesh;
+  float4x4 world_matrix;
+  /** Materials by slot, null for empty slots. */
+  Vector<const Material *> materials;
+};
+
+/**
+ * Gather the visible (or selected) mesh objects of the evaluated \a depsgraph, including
+ * instances. The meshes stay valid as long as the depsgraph isn't evaluated again.
+ */
+Vector<ExportMesh> gather_export_meshes(Depsgraph *depsgraph,
+                                        bool selected_objects_only,
+                                        bool apply_modifiers);
+
+/**
+ * Matrix converting from the axes \a src_forward and \a src_up to the axes \a dst_forward and
+ * \a dst_up, scaled by \a scale.
+ */
+float4x4 axis_conversion_matrix(
+    eIOAxis src_forward, eIOAxis src_up, eIOAxis dst_forward, eIOAxis dst_up, float scale);
+
+/**
+ * Add the \a objects created by an importer to the active collection, selecting only them and
+ * making the last one active.
+ */
+void import_objects_add_to_view_layer(Main *bmain,
+                                      Scene *scene,
+                                      ViewLayer *view_layer,
+                                      Span<Object *> objects);
+
+}  // namespace blender::io
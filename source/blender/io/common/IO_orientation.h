@@ -0,0 +1,39 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/*
+ * Orientation options shared by importers and exporters of formats without a fixed up axis.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Axes as used by #mat3_from_axis_conversion. */
+typedef enum eIOAxis {
+  IO_AXIS_X = 0,
+  IO_AXIS_Y = 1,
+  IO_AXIS_Z = 2,
+  IO_AXIS_NEGATIVE_X = 3,
+  IO_AXIS_NEGATIVE_Y = 4,
+  IO_AXIS_NEGATIVE_Z = 5,
+} eIOAxis;
+
+#ifdef __cplusplus
+}
+#endif
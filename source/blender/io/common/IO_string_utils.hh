@@ -0,0 +1,61 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Parsing of text based file formats (OBJ, MTL, ASCII PLY and STL). The functions take the
+ * remaining text of a line and return what is left of it after the parsed part, so the text is
+ * never copied.
+ */
+
+#pragma once
+
+#include "BLI_string_ref.hh"
+
+namespace blender::io {
+
+/**
+ * Return the next line of \a buffer (without the line ending) and remove it from \a buffer.
+ * Lines ending with a backslash are continued on the next line.
+ */
+StringRef read_next_line(StringRef &buffer);
+
+/**
+ * Find the end of the line containing \a pos, i.e. the position after its line ending.
+ */
+int64_t find_line_end(StringRef buffer, int64_t pos);
+
+StringRef drop_whitespace(StringRef str);
+StringRef drop_non_whitespace(StringRef str);
+/** Remove whitespace at the start and the end, e.g. for names. */
+StringRef strip_whitespace(StringRef str);
+
+/**
+ * Parse an integer, \a r_value is set to \a fallback when there is none.
+ * Leading whitespace is skipped when \a skip_space is true.
+ */
+StringRef parse_int(StringRef str, int fallback, int &r_value, bool skip_space = true);
+
+/**
+ * Parse a float in the decimal notation written by all exporters (`[+-]123.456[e[+-]7]`),
+ * other notations such as `inf` are left to the standard library.
+ * \a r_value is set to \a fallback when there is no number.
+ */
+StringRef parse_float(StringRef str, float fallback, float &r_value, bool skip_space = true);
+
+/** Parse \a count floats separated by whitespace. */
+StringRef parse_floats(StringRef str, float fallback, float *r_values, int count);
+
+}  // namespace blender::io
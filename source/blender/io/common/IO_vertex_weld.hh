@@ -0,0 +1,38 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include "BLI_array.hh"
+#include "BLI_float3.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+namespace blender::io {
+
+/**
+ * Merge positions that are at most \a merge_distance apart, e.g. the separate corners of the
+ * triangles of an STL file. Positions are put in a hash grid with cells of that size, so only
+ * the neighboring cells have to be searched. With a distance of zero only equal positions are
+ * merged.
+ *
+ * \return The index into \a r_merged_positions for every position.
+ */
+Array<int> weld_positions(Span<float3> positions,
+                          float merge_distance,
+                          Vector<float3> &r_merged_positions);
+
+}  // namespace blender::io
@@ -0,0 +1,68 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cstdarg>
+
+#include "BLI_array.hh"
+#include "BLI_task.hh"
+
+#include "IO_block_writer.hh"
+
+namespace blender::io {
+
+/** Number of blocks that are formatted before they are written. */
+static const int64_t blocks_per_batch = 64;
+
+void add_blocks(const int64_t size,
+                const int64_t block_size,
+                const std::function<void(IndexRange range, std::string &r_data)> &format,
+                Vector<FormatBlockFn> &r_blocks)
+{
+  for (int64_t start = 0; start < size; start += block_size) {
+    const IndexRange range(start, std::min(block_size, size - start));
+    r_blocks.append([format, range](std::string &r_data) { format(range, r_data); });
+  }
+}
+
+void write_blocks(FILE *file, Span<FormatBlockFn> blocks)
+{
+  for (int64_t start = 0; start < blocks.size(); start += blocks_per_batch) {
+    const Span<FormatBlockFn> batch = blocks.slice(
+        start, std::min(blocks_per_batch, blocks.size() - start));
+    Array<std::string> datas(batch.size());
+    parallel_for(batch.index_range(), 1, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        batch[i](datas[i]);
+      }
+    });
+    for (const std::string &data : datas) {
+      fwrite(data.data(), 1, data.size(), file);
+    }
+  }
+}
+
+void append_format(std::string &r_data, const char *format, ...)
+{
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  const int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  r_data.append(buf, (size_t)std::min(len, (int)sizeof(buf) - 1));
+}
+
+}  // namespace blender::io
@@ -0,0 +1,72 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <fcntl.h>
+#ifndef WIN32
+#  include <unistd.h> /* for close */
+#else
+#  include <io.h>
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_mmap.h"
+
+#include "IO_mapped_file.hh"
+
+namespace blender::io {
+
+MappedFile::~MappedFile()
+{
+  if (mmap_file_ != nullptr) {
+    BLI_mmap_free(mmap_file_);
+  }
+  if (file_ != -1) {
+    close(file_);
+  }
+  MEM_SAFE_FREE(mem_);
+}
+
+bool MappedFile::open(const char *filepath)
+{
+  if (BLI_mmap_supports_direct_access()) {
+    file_ = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+    if (file_ == -1) {
+      return false;
+    }
+    mmap_file_ = BLI_mmap_open(file_);
+    if (mmap_file_ != nullptr) {
+      data_ = StringRef((const char *)BLI_mmap_get_pointer(mmap_file_),
+                        (int64_t)BLI_mmap_get_length(mmap_file_));
+      return true;
+    }
+  }
+  size_t size = 0;
+  mem_ = BLI_file_read_binary_as_mem(filepath, 0, &size);
+  if (mem_ == nullptr) {
+    return false;
+  }
+  data_ = StringRef((const char *)mem_, (int64_t)size);
+  return true;
+}
+
+bool MappedFile::has_io_error() const
+{
+  return mmap_file_ != nullptr && BLI_mmap_any_io_error(mmap_file_);
+}
+
+}  // namespace blender::io
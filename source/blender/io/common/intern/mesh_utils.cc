@@ -0,0 +1,110 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "BLI_math_matrix.h"
+#include "BLI_math_rotation.h"
+
+#include "DNA_collection_types.h"
+#include "DNA_layer_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_collection.h"
+#include "BKE_layer.h"
+#include "BKE_material.h"
+#include "BKE_object.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "IO_mesh_utils.hh"
+
+namespace blender::io {
+
+Vector<ExportMesh> gather_export_meshes(Depsgraph *depsgraph,
+                                        const bool selected_objects_only,
+                                        const bool apply_modifiers)
+{
+  Vector<ExportMesh> export_meshes;
+
+  DEG_OBJECT_ITER_BEGIN (depsgraph,
+                         ob,
+                         DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY |
+                             DEG_ITER_OBJECT_FLAG_LINKED_VIA_SET | DEG_ITER_OBJECT_FLAG_VISIBLE |
+                             DEG_ITER_OBJECT_FLAG_DUPLI) {
+    if (ob->type != OB_MESH) {
+      continue;
+    }
+    if (selected_objects_only && !(ob->base_flag & BASE_SELECTED)) {
+      continue;
+    }
+    const Mesh *mesh = apply_modifiers ? BKE_object_get_evaluated_mesh(ob) :
+                                         BKE_object_get_pre_modified_mesh(ob);
+    if (mesh == nullptr) {
+      continue;
+    }
+    ExportMesh export_mesh;
+    export_mesh.name = ob->id.name + 2;
+    export_mesh.mesh = mesh;
+    export_mesh.world_matrix = ob->obmat;
+    for (const int i : IndexRange(ob->totcol)) {
+      export_mesh.materials.append(BKE_object_material_get(ob, (short)(i + 1)));
+    }
+    export_meshes.append(std::move(export_mesh));
+  }
+  DEG_OBJECT_ITER_END;
+
+  return export_meshes;
+}
+
+float4x4 axis_conversion_matrix(const eIOAxis src_forward,
+                                const eIOAxis src_up,
+                                const eIOAxis dst_forward,
+                                const eIOAxis dst_up,
+                                const float scale)
+{
+  float mat3[3][3];
+  mat3_from_axis_conversion(src_forward, src_up, dst_forward, dst_up, mat3);
+  mul_m3_fl(mat3, scale);
+  float4x4 mat;
+  copy_m4_m3(mat.values, mat3);
+  return mat;
+}
+
+void import_objects_add_to_view_layer(Main *bmain,
+                                      Scene *scene,
+                                      ViewLayer *view_layer,
+                                      Span<Object *> objects)
+{
+  BKE_view_layer_base_deselect_all(view_layer);
+  LayerCollection *lc = BKE_layer_collection_get_active(view_layer);
+
+  for (Object *ob : objects) {
+    BKE_collection_object_add(bmain, lc->collection, ob);
+    Base *base = BKE_view_layer_base_find(view_layer, ob);
+    BKE_view_layer_base_select_and_set_active(view_layer, base);
+
+    DEG_id_tag_update_ex(
+        bmain, &ob->id, ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY | ID_RECALC_BASE_FLAGS);
+  }
+
+  DEG_id_tag_update(&lc->collection->id, ID_RECALC_COPY_ON_WRITE);
+  DEG_id_tag_update(&scene->id, ID_RECALC_BASE_FLAGS);
+  DEG_relations_tag_update(bmain);
+}
+
+}  // namespace blender::io
@@ -0,0 +1,220 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <cmath>
+#include <cstdlib>
+
+#include "BLI_utildefines.h"
+
+#include "IO_string_utils.hh"
+
+namespace blender::io {
+
+static bool is_whitespace(const char c)
+{
+  /* Backslashes are only expected at the end of continued lines. */
+  return ELEM(c, ' ', '\t', '\r', '\n', '\v', '\f', '\\');
+}
+
+static bool is_digit(const char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+/** Whether the newline at \a pos ends a line, instead of being escaped by a backslash. */
+static bool is_line_end(const StringRef buffer, const int64_t pos)
+{
+  int64_t prev = pos - 1;
+  if (prev >= 0 && buffer[prev] == '\r') {
+    prev--;
+  }
+  return prev < 0 || buffer[prev] != '\\';
+}
+
+int64_t find_line_end(const StringRef buffer, int64_t pos)
+{
+  while (true) {
+    pos = buffer.find('\n', pos);
+    if (pos == StringRef::not_found) {
+      return buffer.size();
+    }
+    if (is_line_end(buffer, pos)) {
+      return pos + 1;
+    }
+    pos++;
+  }
+}
+
+StringRef read_next_line(StringRef &buffer)
+{
+  const int64_t end = find_line_end(buffer, 0);
+  StringRef line = buffer.substr(0, end);
+  buffer = buffer.drop_prefix(end);
+  while (!line.is_empty() && ELEM(line.back(), '\n', '\r')) {
+    line = line.drop_suffix(1);
+  }
+  return line;
+}
+
+StringRef drop_whitespace(StringRef str)
+{
+  const char *p = str.begin();
+  const char *end = str.end();
+  while (p < end && is_whitespace(*p)) {
+    p++;
+  }
+  return StringRef(p, end);
+}
+
+StringRef drop_non_whitespace(StringRef str)
+{
+  const char *p = str.begin();
+  const char *end = str.end();
+  while (p < end && !is_whitespace(*p)) {
+    p++;
+  }
+  return StringRef(p, end);
+}
+
+StringRef strip_whitespace(StringRef str)
+{
+  str = drop_whitespace(str);
+  while (!str.is_empty() && is_whitespace(str.back())) {
+    str = str.drop_suffix(1);
+  }
+  return str;
+}
+
+StringRef parse_int(StringRef str, const int fallback, int &r_value, const bool skip_space)
+{
+  if (skip_space) {
+    str = drop_whitespace(str);
+  }
+  const char *p = str.begin();
+  const char *end = str.end();
+  const bool negative = (p < end && *p == '-');
+  if (p < end && ELEM(*p, '-', '+')) {
+    p++;
+  }
+  if (p == end || !is_digit(*p)) {
+    r_value = fallback;
+    return str;
+  }
+  int64_t value = 0;
+  while (p < end && is_digit(*p)) {
+    /* Clamp instead of overflowing, such indices are invalid anyway. */
+    value = std::min<int64_t>(value * 10 + (*p - '0'), INT32_MAX);
+    p++;
+  }
+  r_value = (int)(negative ? -value : value);
+  return StringRef(p, end);
+}
+
+/** Powers of ten that are exact in a double. */
+static const double pow10_exact[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                     1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                     1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/** Parse notations that are not handled by #parse_float with the standard library. */
+static StringRef parse_float_fallback(StringRef str, const float fallback, float &r_value)
+{
+  char buf[64];
+  const StringRef token = str.substr(0, drop_non_whitespace(str).data() - str.data());
+  if (token.is_empty() || token.size() >= (int64_t)sizeof(buf)) {
+    r_value = fallback;
+    return str;
+  }
+  token.unsafe_copy(buf);
+  char *buf_end = nullptr;
+  const float value = std::strtof(buf, &buf_end);
+  if (buf_end == buf) {
+    r_value = fallback;
+    return str;
+  }
+  r_value = value;
+  return str.drop_prefix(buf_end - buf);
+}
+
+StringRef parse_float(StringRef str, const float fallback, float &r_value, const bool skip_space)
+{
+  if (skip_space) {
+    str = drop_whitespace(str);
+  }
+  const char *p = str.begin();
+  const char *end = str.end();
+  const bool negative = (p < end && *p == '-');
+  if (p < end && ELEM(*p, '-', '+')) {
+    p++;
+  }
+
+  /* More digits than this don't make a difference for a float. */
+  const uint64_t mantissa_max = 100000000000000000ull;
+  uint64_t mantissa = 0;
+  int exponent = 0;
+  bool any_digits = false;
+  for (; p < end && is_digit(*p); p++) {
+    if (mantissa < mantissa_max) {
+      mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+    }
+    else {
+      exponent++;
+    }
+    any_digits = true;
+  }
+  if (p < end && *p == '.') {
+    for (p++; p < end && is_digit(*p); p++) {
+      if (mantissa < mantissa_max) {
+        mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        exponent--;
+      }
+      any_digits = true;
+    }
+  }
+  if (!any_digits) {
+    return parse_float_fallback(str, fallback, r_value);
+  }
+  if (p + 1 < end && ELEM(*p, 'e', 'E')) {
+    int exponent_value;
+    StringRef rest = parse_int(StringRef(p + 1, end), 0, exponent_value, false);
+    if (rest.data() != p + 1) {
+      exponent += exponent_value;
+      p = rest.data();
+    }
+  }
+
+  double value = (double)mantissa;
+  if (exponent < 0 && exponent >= -22) {
+    value /= pow10_exact[-exponent];
+  }
+  else if (exponent > 0 && exponent <= 22) {
+    value *= pow10_exact[exponent];
+  }
+  else if (exponent != 0) {
+    value *= std::pow(10.0, (double)exponent);
+  }
+  r_value = (float)(negative ? -value : value);
+  return StringRef(p, end);
+}
+
+StringRef parse_floats(StringRef str, const float fallback, float *r_values, const int count)
+{
+  for (int i = 0; i < count; i++) {
+    str = parse_float(str, fallback, r_values[i]);
+  }
+  return str;
+}
+
+}  // namespace blender::io
@@ -0,0 +1,64 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "IO_string_utils.hh"
+
+#include "testing/testing.h"
+
+#include <limits>
+
+namespace blender::io {
+
+TEST(string_utils, read_next_line)
+{
+  StringRef buffer = "v 1 2 3\r\nf 1 \\\n 2 3\nlast";
+  EXPECT_EQ(read_next_line(buffer), "v 1 2 3");
+  /* Continued lines are kept together, the backslash is parsed as whitespace. */
+  EXPECT_EQ(read_next_line(buffer), "f 1 \\\n 2 3");
+  EXPECT_EQ(read_next_line(buffer), "last");
+  EXPECT_TRUE(buffer.is_empty());
+}
+
+TEST(string_utils, parse_float)
+{
+  float value;
+  EXPECT_EQ(parse_float("  1.5 rest", 0.0f, value), " rest");
+  EXPECT_FLOAT_EQ(value, 1.5f);
+  parse_float("-0.000125", 0.0f, value);
+  EXPECT_FLOAT_EQ(value, -0.000125f);
+  parse_float("+2.5e-3", 0.0f, value);
+  EXPECT_FLOAT_EQ(value, 0.0025f);
+  parse_float("1E10", 0.0f, value);
+  EXPECT_FLOAT_EQ(value, 1e10f);
+  parse_float("0.1", 0.0f, value);
+  EXPECT_EQ(value, 0.1f);
+  parse_float("123456.789", 0.0f, value);
+  EXPECT_EQ(value, 123456.789f);
+  parse_float("inf", 0.0f, value);
+  EXPECT_EQ(value, std::numeric_limits<float>::infinity());
+  parse_float("x", -1.0f, value);
+  EXPECT_EQ(value, -1.0f);
+}
+
+TEST(string_utils, parse_int)
+{
+  int value;
+  EXPECT_EQ(parse_int(" -12/3", 0, value), "/3");
+  EXPECT_EQ(value, -12);
+  parse_int("/3", 7, value);
+  EXPECT_EQ(value, 7);
+}
+
+}  // namespace blender::io
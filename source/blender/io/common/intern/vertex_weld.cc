@@ -0,0 +1,126 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "BLI_map.hh"
+#include "BLI_math_vector.h"
+
+#include "IO_vertex_weld.hh"
+
+namespace blender::io {
+
+struct GridCell {
+  int x, y, z;
+
+  uint64_t hash() const
+  {
+    return (uint64_t)x * 73856093 ^ (uint64_t)y * 19349663 ^ (uint64_t)z * 83492791;
+  }
+
+  friend bool operator==(const GridCell &a, const GridCell &b)
+  {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+  }
+};
+
+/* Positions are hashed by their bits, -0.0 and 0.0 are equal but have different bits. */
+static float3 normalize_zero_sign(const float3 &position)
+{
+  return float3(position.x == 0.0f ? 0.0f : position.x,
+                position.y == 0.0f ? 0.0f : position.y,
+                position.z == 0.0f ? 0.0f : position.z);
+}
+
+/**
+ * Large positions and tiny merge distances exceed the integer range of the grid. Cells beyond a
+ * limit, which leaves room for the neighbor offsets, are clamped to it. Positions in the same cell
+ * are still compared by their distance, so this only makes the search slower.
+ */
+static int grid_cell_coordinate(const float value, const float cell_size_inv)
+{
+  constexpr float cell_limit = (float)(1 << 30);
+  const float cell = floorf(value * cell_size_inv);
+  if (std::isnan(cell)) {
+    return 0;
+  }
+  return (int)std::clamp(cell, -cell_limit, cell_limit);
+}
+
+static Array<int> weld_positions_exact(Span<float3> positions, Vector<float3> &r_merged_positions)
+{
+  Array<int> merged_indices(positions.size());
+  Map<float3, int> position_indices;
+  position_indices.reserve(positions.size());
+  for (const int64_t i : positions.index_range()) {
+    const float3 key = normalize_zero_sign(positions[i]);
+    merged_indices[i] = position_indices.lookup_or_add_cb(key, [&]() {
+      r_merged_positions.append(positions[i]);
+      return (int)r_merged_positions.size() - 1;
+    });
+  }
+  return merged_indices;
+}
+
+Array<int> weld_positions(Span<float3> positions,
+                          const float merge_distance,
+                          Vector<float3> &r_merged_positions)
+{
+  const float cell_size_inv = 1.0f / merge_distance;
+  if (merge_distance <= 0.0f || !std::isfinite(cell_size_inv)) {
+    return weld_positions_exact(positions, r_merged_positions);
+  }
+
+  const float merge_distance_sq = merge_distance * merge_distance;
+  Array<int> merged_indices(positions.size());
+  /* The last merged position added to a cell, the others are linked with #next_in_cell. */
+  Map<GridCell, int> cell_last;
+  Vector<int> next_in_cell;
+
+  for (const int64_t i : positions.index_range()) {
+    const float3 &position = positions[i];
+    const GridCell cell = {grid_cell_coordinate(position.x, cell_size_inv),
+                           grid_cell_coordinate(position.y, cell_size_inv),
+                           grid_cell_coordinate(position.z, cell_size_inv)};
+    int found = -1;
+    for (int dx = -1; dx <= 1 && found == -1; dx++) {
+      for (int dy = -1; dy <= 1 && found == -1; dy++) {
+        for (int dz = -1; dz <= 1 && found == -1; dz++) {
+          const GridCell neighbor = {cell.x + dx, cell.y + dy, cell.z + dz};
+          for (int merged = cell_last.lookup_default(neighbor, -1); merged != -1;
+               merged = next_in_cell[merged]) {
+            if (len_squared_v3v3(r_merged_positions[merged], position) <= merge_distance_sq) {
+              found = merged;
+              break;
+            }
+          }
+        }
+      }
+    }
+    if (found == -1) {
+      found = (int)r_merged_positions.size();
+      r_merged_positions.append(position);
+      int &last = cell_last.lookup_or_add(cell, -1);
+      next_in_cell.append(last);
+      last = found;
+    }
+    merged_indices[i] = found;
+  }
+  return merged_indices;
+}
+
+}  // namespace blender::io
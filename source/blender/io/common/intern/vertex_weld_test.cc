@@ -0,0 +1,75 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "IO_vertex_weld.hh"
+
+#include "testing/testing.h"
+
+namespace blender::io {
+
+TEST(vertex_weld, exact)
+{
+  const Array<float3> positions = {
+      {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0001f}};
+  Vector<float3> merged;
+  const Array<int> indices = weld_positions(positions, 0.0f, merged);
+  EXPECT_EQ(merged.size(), 3);
+  EXPECT_EQ(indices[0], 0);
+  EXPECT_EQ(indices[1], 1);
+  EXPECT_EQ(indices[2], 0);
+  EXPECT_EQ(indices[3], 2);
+}
+
+TEST(vertex_weld, exact_signed_zero)
+{
+  const Array<float3> positions = {{0.0f, 0.0f, 0.0f}, {-0.0f, 0.0f, -0.0f}};
+  Vector<float3> merged;
+  const Array<int> indices = weld_positions(positions, 0.0f, merged);
+  EXPECT_EQ(merged.size(), 1);
+  EXPECT_EQ(indices[1], indices[0]);
+}
+
+TEST(vertex_weld, distance_large_positions)
+{
+  /* The grid cells of these positions don't fit into an integer. */
+  const Array<float3> positions = {
+      {1.0e30f, 0.0f, 0.0f}, {1.0e30f, 0.0f, 1.0e-9f}, {-1.0e30f, 0.0f, 0.0f}};
+  Vector<float3> merged;
+  const Array<int> indices = weld_positions(positions, 1.0e-6f, merged);
+  EXPECT_EQ(merged.size(), 2);
+  EXPECT_EQ(indices[1], indices[0]);
+  EXPECT_NE(indices[2], indices[0]);
+}
+
+TEST(vertex_weld, distance)
+{
+  /* Close positions in different cells of the grid are merged too. */
+  const Array<float3> positions = {{0.0f, 0.0f, 0.0f},
+                                   {0.0099f, 0.0f, 0.0f},
+                                   {-0.0099f, 0.0f, 0.0f},
+                                   {0.0f, 0.011f, 0.0f},
+                                   {5.0f, 5.0f, 5.0f},
+                                   {4.995f, 5.005f, 5.0f}};
+  Vector<float3> merged;
+  const Array<int> indices = weld_positions(positions, 0.01f, merged);
+  EXPECT_EQ(merged.size(), 3);
+  EXPECT_EQ(indices[1], indices[0]);
+  EXPECT_EQ(indices[2], indices[0]);
+  EXPECT_NE(indices[3], indices[0]);
+  EXPECT_EQ(indices[5], indices[4]);
+  EXPECT_EQ(merged[indices[4]], float3(5.0f, 5.0f, 5.0f));
+}
+
+}  // namespace blender::io
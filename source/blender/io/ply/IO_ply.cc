@@ -0,0 +1,44 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include "BKE_context.h"
+
+#include "DEG_depsgraph.h"
+
+#include "IO_ply.h"
+
+#include "exporter/ply_export.hh"
+#include "importer/ply_import.hh"
+
+using namespace blender::io::ply;
+
+bool PLY_import(bContext *C, const PLYImportParams *import_params)
+{
+  Main *bmain = CTX_data_main(C);
+  Scene *scene = CTX_data_scene(C);
+  ViewLayer *view_layer = CTX_data_view_layer(C);
+  return importer_main(bmain, scene, view_layer, *import_params);
+}
+
+bool PLY_export(bContext *C, const PLYExportParams *export_params)
+{
+  Depsgraph *depsgraph = CTX_data_ensure_evaluated_depsgraph(C);
+  return exporter_main(depsgraph, *export_params);
+}
@@ -0,0 +1,72 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup ply
+ */
+
+#pragma once
+
+#include "BLI_utildefines.h"
+
+#include "IO_orientation.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct bContext;
+
+struct PLYImportParams {
+  /** Full path to the source .PLY file. */
+  char filepath[1024]; /* FILE_MAX */
+
+  eIOAxis forward_axis;
+  eIOAxis up_axis;
+  float global_scale;
+  /** Check the created mesh for invalid data (e.g. duplicate faces), at some cost. */
+  bool validate_mesh;
+};
+
+struct PLYExportParams {
+  /** Full path to the destination .PLY file. */
+  char filepath[1024]; /* FILE_MAX */
+
+  /** Only export the selected objects. */
+  bool export_selected_objects;
+  /** Export the evaluated meshes, otherwise the meshes without modifiers. */
+  bool apply_modifiers;
+  bool export_normals;
+  /** Export the active UV map. */
+  bool export_uv;
+  /** Export the active vertex color layer. */
+  bool export_colors;
+  /** Write the text format instead of binary little endian. */
+  bool ascii_format;
+
+  eIOAxis forward_axis;
+  eIOAxis up_axis;
+  float global_scale;
+};
+
+/* Both return true on success, errors are printed to the console. */
+
+bool PLY_import(struct bContext *C, const struct PLYImportParams *import_params);
+bool PLY_export(struct bContext *C, const struct PLYExportParams *export_params);
+
+#ifdef __cplusplus
+}
+#endif
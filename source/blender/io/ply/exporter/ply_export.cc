@@ -0,0 +1,323 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include <cstdio>
+
+#include "BLI_array.hh"
+#include "BLI_fileops.h"
+#include "BLI_map.hh"
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_blender_version.h"
+#include "BKE_customdata.h"
+#include "BKE_global.h"
+#include "BKE_mesh.h"
+
+#include "IO_block_writer.hh"
+
+#include "ply_export.hh"
+
+namespace blender::io::ply {
+
+/** Number of vertices or faces formatted by one task. */
+static const int64_t elements_per_block = 16384;
+
+/** A mesh vertex with the attributes of one of its face corners. */
+struct CornerVertex {
+  int vert;
+  float3 normal;
+  float2 uv;
+  Color4b color;
+
+  uint64_t hash() const
+  {
+    return (uint64_t)vert * 1059217 ^ normal.hash() ^ uv.hash() * 435109 ^ color.hash();
+  }
+
+  friend bool operator==(const CornerVertex &a, const CornerVertex &b)
+  {
+    return a.vert == b.vert && a.normal == b.normal && a.uv == b.uv && a.color == b.color;
+  }
+};
+
+void ply_mesh_prepare(const ExportMesh &export_mesh,
+                      const PLYExportParams &export_params,
+                      PlyExportMesh &r_ply_mesh)
+{
+  const Mesh *mesh = export_mesh.mesh;
+  const MLoopUV *mloopuv = export_params.export_uv ?
+                               (const MLoopUV *)CustomData_get_layer(&mesh->ldata, CD_MLOOPUV) :
+                               nullptr;
+  const MLoopCol *mloopcol = export_params.export_colors ? (const MLoopCol *)CustomData_get_layer(
+                                                               &mesh->ldata, CD_MLOOPCOL) :
+                                                           nullptr;
+  const float4x4 normal_matrix = export_mesh.world_matrix.inverted_transposed_affine();
+
+  /* Without per corner attributes the mesh vertices are used as they are. */
+  const bool split_corners = export_params.export_normals || mloopuv || mloopcol;
+
+  Map<CornerVertex, int> corner_vertices;
+  Array<int> mesh_to_ply_vert(split_corners ? 0 : mesh->totvert, -1);
+  r_ply_mesh.face_offsets.reserve(mesh->totpoly + 1);
+  r_ply_mesh.face_verts.reserve(mesh->totloop);
+  for (const int poly_index : IndexRange(mesh->totpoly)) {
+    const MPoly &mpoly = mesh->mpoly[poly_index];
+    r_ply_mesh.face_offsets.append((int)r_ply_mesh.face_verts.size());
+
+    float3 poly_normal;
+    if (export_params.export_normals && !(mpoly.flag & ME_SMOOTH)) {
+      BKE_mesh_calc_poly_normal(
+          &mpoly, &mesh->mloop[mpoly.loopstart], mesh->mvert, poly_normal);
+    }
+
+    for (const int loop_index : IndexRange(mpoly.loopstart, mpoly.totloop)) {
+      const int vert = (int)mesh->mloop[loop_index].v;
+      if (!split_corners) {
+        int &ply_vert = mesh_to_ply_vert[vert];
+        if (ply_vert == -1) {
+          ply_vert = (int)r_ply_mesh.positions.size();
+          r_ply_mesh.positions.append(export_mesh.world_matrix * float3(mesh->mvert[vert].co));
+        }
+        r_ply_mesh.face_verts.append(ply_vert);
+        continue;
+      }
+
+      CornerVertex corner = {vert, float3(0.0f), float2(0.0f, 0.0f), Color4b(0, 0, 0, 0)};
+      if (export_params.export_normals) {
+        if (mpoly.flag & ME_SMOOTH) {
+          normal_short_to_float_v3(corner.normal, mesh->mvert[vert].no);
+        }
+        else {
+          corner.normal = poly_normal;
+        }
+      }
+      if (mloopuv) {
+        corner.uv = float2(mloopuv[loop_index].uv);
+      }
+      if (mloopcol) {
+        const MLoopCol &col = mloopcol[loop_index];
+        corner.color = Color4b(col.r, col.g, col.b, col.a);
+      }
+      const int ply_vert = corner_vertices.lookup_or_add_cb(corner, [&]() {
+        r_ply_mesh.positions.append(export_mesh.world_matrix * float3(mesh->mvert[vert].co));
+        if (export_params.export_normals) {
+          float3 normal = corner.normal;
+          mul_mat3_m4_v3(normal_matrix.values, normal);
+          r_ply_mesh.normals.append(normal.normalized());
+        }
+        if (mloopuv) {
+          r_ply_mesh.uvs.append(corner.uv);
+        }
+        if (mloopcol) {
+          r_ply_mesh.colors.append(corner.color);
+        }
+        return (int)r_ply_mesh.positions.size() - 1;
+      });
+      r_ply_mesh.face_verts.append(ply_vert);
+    }
+  }
+  r_ply_mesh.face_offsets.append((int)r_ply_mesh.face_verts.size());
+}
+
+static void format_vertices(const PlyExportMesh &ply_mesh,
+                            const PLYExportParams &export_params,
+                            const bool has_uvs,
+                            const bool has_colors,
+                            const IndexRange range,
+                            std::string &r_data)
+{
+  const float2 no_uv(0.0f, 0.0f);
+  const Color4b no_color(255, 255, 255, 255);
+  for (const int64_t i : range) {
+    const float3 &co = ply_mesh.positions[i];
+    const float2 &uv = ply_mesh.uvs.is_empty() ? no_uv : ply_mesh.uvs[i];
+    const Color4b &color = ply_mesh.colors.is_empty() ? no_color : ply_mesh.colors[i];
+    if (export_params.ascii_format) {
+      append_format(r_data, "%.6f %.6f %.6f", co.x, co.y, co.z);
+      if (export_params.export_normals) {
+        const float3 &no = ply_mesh.normals[i];
+        append_format(r_data, " %.6f %.6f %.6f", no.x, no.y, no.z);
+      }
+      if (has_uvs) {
+        append_format(r_data, " %.6f %.6f", uv.x, uv.y);
+      }
+      if (has_colors) {
+        append_format(r_data, " %u %u %u %u", color.r, color.g, color.b, color.a);
+      }
+      r_data += '\n';
+      continue;
+    }
+    append_binary(r_data, co);
+    if (export_params.export_normals) {
+      append_binary(r_data, ply_mesh.normals[i]);
+    }
+    if (has_uvs) {
+      append_binary(r_data, uv);
+    }
+    if (has_colors) {
+      append_binary(r_data, color);
+    }
+  }
+}
+
+static void format_faces(const PlyExportMesh &ply_mesh,
+                         const bool ascii_format,
+                         const bool large_faces,
+                         const uint vert_offset,
+                         const IndexRange range,
+                         std::string &r_data)
+{
+  for (const int64_t i : range) {
+    const int start = ply_mesh.face_offsets[i];
+    const int size = ply_mesh.face_offsets[i + 1] - start;
+    if (ascii_format) {
+      append_format(r_data, "%d", size);
+      for (const int vert : ply_mesh.face_verts.as_span().slice(start, size)) {
+        append_format(r_data, " %u", vert_offset + (uint)vert);
+      }
+      r_data += '\n';
+      continue;
+    }
+    if (large_faces) {
+      append_binary(r_data, (uint)size);
+    }
+    else {
+      append_binary(r_data, (uchar)size);
+    }
+    for (const int vert : ply_mesh.face_verts.as_span().slice(start, size)) {
+      append_binary(r_data, vert_offset + (uint)vert);
+    }
+  }
+}
+
+bool write_ply_file(Span<PlyExportMesh> ply_meshes, const PLYExportParams &export_params)
+{
+  int64_t verts_num = 0;
+  int64_t faces_num = 0;
+  int max_face_size = 0;
+  bool has_uvs = false;
+  bool has_colors = false;
+  for (const PlyExportMesh &ply_mesh : ply_meshes) {
+    verts_num += ply_mesh.positions.size();
+    faces_num += ply_mesh.face_offsets.size() - 1;
+    for (const int64_t i : IndexRange(ply_mesh.face_offsets.size() - 1)) {
+      max_face_size = std::max(max_face_size,
+                               ply_mesh.face_offsets[i + 1] - ply_mesh.face_offsets[i]);
+    }
+    has_uvs |= !ply_mesh.uvs.is_empty();
+    has_colors |= !ply_mesh.colors.is_empty();
+  }
+  /* Faces with more corners than fit in the usual byte are rare, only use more when needed. */
+  const bool large_faces = max_face_size > 255;
+
+  FILE *file = BLI_fopen(export_params.filepath, "wb");
+  if (file == nullptr) {
+    fprintf(stderr, "PLY export: cannot open '%s' for writing\n", export_params.filepath);
+    return false;
+  }
+
+  const char *binary_format = ENDIAN_ORDER == L_ENDIAN ? "binary_little_endian" :
+                                                         "binary_big_endian";
+  fprintf(file,
+          "ply\n"
+          "format %s 1.0\n"
+          "comment Created by Blender %s - www.blender.org\n",
+          export_params.ascii_format ? "ascii" : binary_format,
+          BKE_blender_version_string());
+  fprintf(file, "element vertex %lld\n", (long long)verts_num);
+  fprintf(file, "property float x\nproperty float y\nproperty float z\n");
+  if (export_params.export_normals) {
+    fprintf(file, "property float nx\nproperty float ny\nproperty float nz\n");
+  }
+  if (has_uvs) {
+    fprintf(file, "property float s\nproperty float t\n");
+  }
+  if (has_colors) {
+    fprintf(file,
+            "property uchar red\nproperty uchar green\nproperty uchar blue\n"
+            "property uchar alpha\n");
+  }
+  fprintf(file, "element face %lld\n", (long long)faces_num);
+  fprintf(file, "property list %s uint vertex_indices\n", large_faces ? "uint" : "uchar");
+  fprintf(file, "end_header\n");
+
+  Vector<FormatBlockFn> blocks;
+  for (const PlyExportMesh &ply_mesh : ply_meshes) {
+    add_blocks(
+        ply_mesh.positions.size(),
+        elements_per_block,
+        [&ply_mesh, &export_params, has_uvs, has_colors](IndexRange range, std::string &r_data) {
+          format_vertices(ply_mesh, export_params, has_uvs, has_colors, range, r_data);
+        },
+        blocks);
+  }
+  uint vert_offset = 0;
+  for (const PlyExportMesh &ply_mesh : ply_meshes) {
+    const bool ascii_format = export_params.ascii_format;
+    add_blocks(
+        ply_mesh.face_offsets.size() - 1,
+        elements_per_block,
+        [&ply_mesh, ascii_format, large_faces, vert_offset](IndexRange range,
+                                                            std::string &r_data) {
+          format_faces(ply_mesh, ascii_format, large_faces, vert_offset, range, r_data);
+        },
+        blocks);
+    vert_offset += (uint)ply_mesh.positions.size();
+  }
+  write_blocks(file, blocks);
+
+  const bool ok = !ferror(file);
+  fclose(file);
+  if (!ok) {
+    fprintf(stderr, "PLY export: error writing '%s'\n", export_params.filepath);
+  }
+  return ok;
+}
+
+bool exporter_main(Depsgraph *depsgraph, const PLYExportParams &export_params)
+{
+  Vector<ExportMesh> export_meshes = gather_export_meshes(
+      depsgraph, export_params.export_selected_objects, export_params.apply_modifiers);
+  if (export_meshes.is_empty()) {
+    fprintf(stderr, "PLY export: no mesh objects to export\n");
+    return false;
+  }
+  const float4x4 axes_mat = axis_conversion_matrix(IO_AXIS_Y,
+                                                   IO_AXIS_Z,
+                                                   export_params.forward_axis,
+                                                   export_params.up_axis,
+                                                   export_params.global_scale);
+
+  Array<PlyExportMesh> ply_meshes(export_meshes.size());
+  parallel_for(export_meshes.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      export_meshes[i].world_matrix = axes_mat * export_meshes[i].world_matrix;
+      ply_mesh_prepare(export_meshes[i], export_params, ply_meshes[i]);
+    }
+  });
+  return write_ply_file(ply_meshes, export_params);
+}
+
+}  // namespace blender::io::ply
@@ -0,0 +1,61 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup ply
+ */
+
+#pragma once
+
+#include "BLI_color.hh"
+#include "BLI_float2.hh"
+#include "BLI_float3.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+#include "IO_mesh_utils.hh"
+#include "IO_ply.h"
+
+struct Depsgraph;
+
+namespace blender::io::ply {
+
+/**
+ * The data of a mesh as written to a PLY file. PLY only has vertex attributes, so there is a
+ * vertex for every distinct combination of a mesh vertex with the normal, UV and color of its
+ * face corners.
+ */
+struct PlyExportMesh {
+  Vector<float3> positions;
+  Vector<float3> normals;
+  Vector<float2> uvs;
+  Vector<Color4b> colors;
+  /** Faces as offsets into #face_verts, with one more offset for the end. */
+  Vector<int> face_offsets;
+  Vector<int> face_verts;
+};
+
+/** Compute the exported data of \a export_mesh, transformed by its world matrix. */
+void ply_mesh_prepare(const ExportMesh &export_mesh,
+                      const PLYExportParams &export_params,
+                      PlyExportMesh &r_ply_mesh);
+
+/** Write the \a ply_meshes to the PLY file of \a export_params as one mesh. */
+bool write_ply_file(Span<PlyExportMesh> ply_meshes, const PLYExportParams &export_params);
+
+bool exporter_main(Depsgraph *depsgraph, const PLYExportParams &export_params);
+
+}  // namespace blender::io::ply
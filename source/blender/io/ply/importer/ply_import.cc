@@ -0,0 +1,680 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "BLI_array.hh"
+#include "BLI_endian_switch.h"
+#include "BLI_math_base.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_task.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_global.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "IO_mapped_file.hh"
+#include "IO_mesh_utils.hh"
+#include "IO_string_utils.hh"
+
+#include "ply_import.hh"
+
+namespace blender::io::ply {
+
+/* -------------------------------------------------------------------- */
+/** \name Header
+ * \{ */
+
+static bool parse_type(StringRef str, PlyType &r_type)
+{
+  static const struct {
+    const char *name;
+    PlyType type;
+  } types[] = {
+      {"char", PlyType::Char},     {"int8", PlyType::Char},      {"uchar", PlyType::UChar},
+      {"uint8", PlyType::UChar},   {"short", PlyType::Short},    {"int16", PlyType::Short},
+      {"ushort", PlyType::UShort}, {"uint16", PlyType::UShort},  {"int", PlyType::Int},
+      {"int32", PlyType::Int},     {"uint", PlyType::UInt},      {"uint32", PlyType::UInt},
+      {"float", PlyType::Float},   {"float32", PlyType::Float},  {"double", PlyType::Double},
+      {"float64", PlyType::Double},
+  };
+  for (const auto &item : types) {
+    if (str == item.name) {
+      r_type = item.type;
+      return true;
+    }
+  }
+  return false;
+}
+
+static int64_t type_size(const PlyType type)
+{
+  switch (type) {
+    case PlyType::Char:
+    case PlyType::UChar:
+      return 1;
+    case PlyType::Short:
+    case PlyType::UShort:
+      return 2;
+    case PlyType::Int:
+    case PlyType::UInt:
+    case PlyType::Float:
+      return 4;
+    case PlyType::Double:
+      return 8;
+  }
+  return 0;
+}
+
+/** Split the next whitespace separated word of \a str off. */
+static StringRef next_word(StringRef &str)
+{
+  str = drop_whitespace(str);
+  const StringRef rest = drop_non_whitespace(str);
+  const StringRef word = str.substr(0, str.size() - rest.size());
+  str = rest;
+  return word;
+}
+
+bool read_ply_header(StringRef data, PlyHeader &r_header)
+{
+  StringRef buffer = data;
+  if (strip_whitespace(read_next_line(buffer)) != "ply") {
+    return false;
+  }
+  bool has_format = false;
+  while (!buffer.is_empty()) {
+    StringRef line = read_next_line(buffer);
+    const StringRef keyword = next_word(line);
+    if (keyword == "format") {
+      const StringRef format = next_word(line);
+      if (format == "ascii") {
+        r_header.format = PlyFormat::Ascii;
+      }
+      else if (format == "binary_little_endian") {
+        r_header.format = PlyFormat::BinaryLittleEndian;
+      }
+      else if (format == "binary_big_endian") {
+        r_header.format = PlyFormat::BinaryBigEndian;
+      }
+      else {
+        return false;
+      }
+      has_format = true;
+    }
+    else if (keyword == "element") {
+      PlyElement element;
+      element.name = next_word(line);
+      int count;
+      parse_int(line, -1, count);
+      if (count < 0) {
+        return false;
+      }
+      element.count = count;
+      r_header.elements.append(std::move(element));
+    }
+    else if (keyword == "property") {
+      if (r_header.elements.is_empty()) {
+        return false;
+      }
+      PlyProperty property;
+      StringRef type = next_word(line);
+      if (type == "list") {
+        property.is_list = true;
+        if (!parse_type(next_word(line), property.count_type)) {
+          return false;
+        }
+        type = next_word(line);
+      }
+      if (!parse_type(type, property.type)) {
+        return false;
+      }
+      property.name = next_word(line);
+      r_header.elements.last().properties.append(std::move(property));
+    }
+    else if (keyword == "end_header") {
+      r_header.data_offset = data.size() - buffer.size();
+      return has_format;
+    }
+    /* Comments and `obj_info` lines are ignored. */
+  }
+  return false;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Element Data
+ * \{ */
+
+/* The generic version is used for the 4 byte types. */
+template<typename T> static T read_binary(const char *data, const bool swap)
+{
+  static_assert(sizeof(T) == 4);
+  T value;
+  memcpy(&value, data, sizeof(T));
+  if (swap) {
+    BLI_endian_switch_uint32((uint *)&value);
+  }
+  return value;
+}
+
+template<> int8_t read_binary<int8_t>(const char *data, const bool /*swap*/)
+{
+  return (int8_t)*data;
+}
+
+template<> uint8_t read_binary<uint8_t>(const char *data, const bool /*swap*/)
+{
+  return (uint8_t)*data;
+}
+
+template<> int16_t read_binary<int16_t>(const char *data, const bool swap)
+{
+  int16_t value;
+  memcpy(&value, data, sizeof(value));
+  if (swap) {
+    BLI_endian_switch_int16(&value);
+  }
+  return value;
+}
+
+template<> uint16_t read_binary<uint16_t>(const char *data, const bool swap)
+{
+  uint16_t value;
+  memcpy(&value, data, sizeof(value));
+  if (swap) {
+    BLI_endian_switch_uint16(&value);
+  }
+  return value;
+}
+
+template<> double read_binary<double>(const char *data, const bool swap)
+{
+  double value;
+  memcpy(&value, data, sizeof(value));
+  if (swap) {
+    BLI_endian_switch_double(&value);
+  }
+  return value;
+}
+
+/**
+ * Reads the values of the element data one after another, in any format. Errors (e.g. a
+ * truncated file) are remembered, and zero is returned from then on.
+ */
+class ValueReader {
+ private:
+  StringRef data_;
+  PlyFormat format_;
+  bool swap_;
+  bool error_ = false;
+
+ public:
+  ValueReader(StringRef data, const PlyFormat format)
+      : data_(data),
+        format_(format),
+        swap_(format == (ENDIAN_ORDER == L_ENDIAN ? PlyFormat::BinaryBigEndian :
+                                                    PlyFormat::BinaryLittleEndian))
+  {
+  }
+
+  double read(const PlyType type)
+  {
+    if (format_ == PlyFormat::Ascii) {
+      return read_ascii(type);
+    }
+    const int64_t size = type_size(type);
+    if (error_ || data_.size() < size) {
+      error_ = true;
+      return 0.0;
+    }
+    const char *ptr = data_.data();
+    data_ = data_.drop_prefix(size);
+    switch (type) {
+      case PlyType::Char:
+        return read_binary<int8_t>(ptr, swap_);
+      case PlyType::UChar:
+        return read_binary<uint8_t>(ptr, swap_);
+      case PlyType::Short:
+        return read_binary<int16_t>(ptr, swap_);
+      case PlyType::UShort:
+        return read_binary<uint16_t>(ptr, swap_);
+      case PlyType::Int:
+        return read_binary<int32_t>(ptr, swap_);
+      case PlyType::UInt:
+        return read_binary<uint32_t>(ptr, swap_);
+      case PlyType::Float:
+        return read_binary<float>(ptr, swap_);
+      case PlyType::Double:
+        return read_binary<double>(ptr, swap_);
+    }
+    return 0.0;
+  }
+
+  void skip(const int64_t size)
+  {
+    if (data_.size() < size) {
+      error_ = true;
+    }
+    data_ = data_.drop_prefix(std::min(size, data_.size()));
+  }
+
+  bool has_error() const
+  {
+    return error_;
+  }
+
+  int64_t remaining_size() const
+  {
+    return data_.size();
+  }
+
+ private:
+  double read_ascii(const PlyType type)
+  {
+    const StringRef str = drop_whitespace(data_);
+    if (error_ || str.is_empty()) {
+      error_ = true;
+      return 0.0;
+    }
+    if (ELEM(type, PlyType::Float, PlyType::Double)) {
+      float value;
+      data_ = parse_float(str, 0.0f, value, false);
+      return value;
+    }
+    int value;
+    data_ = parse_int(str, 0, value, false);
+    return value;
+  }
+};
+
+static int64_t find_property(const PlyElement &element, Span<const char *> names)
+{
+  for (const int64_t i : element.properties.index_range()) {
+    for (const char *name : names) {
+      if (element.properties[i].name == name) {
+        return i;
+      }
+    }
+  }
+  return -1;
+}
+
+/** The size of an element in binary formats, or -1 when it contains lists. */
+static int64_t element_fixed_size(const PlyElement &element)
+{
+  int64_t size = 0;
+  for (const PlyProperty &property : element.properties) {
+    if (property.is_list) {
+      return -1;
+    }
+    size += type_size(property.type);
+  }
+  return size;
+}
+
+/**
+ * Read the values of one element into \a r_values, by property. The values of lists are read
+ * into \a r_list when it is the property \a list_index, and skipped otherwise.
+ */
+static void read_element_values(ValueReader &reader,
+                                const PlyElement &element,
+                                MutableSpan<double> r_values,
+                                const int64_t list_index = -1,
+                                Vector<int> *r_list = nullptr)
+{
+  for (const int64_t i : element.properties.index_range()) {
+    const PlyProperty &property = element.properties[i];
+    if (!property.is_list) {
+      r_values[i] = reader.read(property.type);
+      continue;
+    }
+    const int count = (int)reader.read(property.count_type);
+    for (int j = 0; j < count && !reader.has_error(); j++) {
+      const double value = reader.read(property.type);
+      if (i == list_index) {
+        r_list->append((int)value);
+      }
+    }
+  }
+}
+
+static uint8_t color_value_to_uchar(const double value, const PlyType type)
+{
+  switch (type) {
+    case PlyType::Float:
+    case PlyType::Double:
+      return unit_float_to_uchar_clamp((float)value);
+    case PlyType::UShort:
+      return (uint8_t)(value / 257.0);
+    default:
+      return (uint8_t)clamp_i((int)value, 0, 255);
+  }
+}
+
+static void read_vertices(ValueReader &reader,
+                          StringRef data,
+                          const PlyFormat format,
+                          const PlyElement &element,
+                          PlyMeshData &r_data)
+{
+  const int64_t position_props[3] = {find_property(element, {"x"}),
+                                     find_property(element, {"y"}),
+                                     find_property(element, {"z"})};
+  const int64_t normal_props[3] = {find_property(element, {"nx"}),
+                                   find_property(element, {"ny"}),
+                                   find_property(element, {"nz"})};
+  const int64_t uv_props[2] = {find_property(element, {"s", "u", "texture_u", "texture_s"}),
+                               find_property(element, {"t", "v", "texture_v", "texture_t"})};
+  const int64_t color_props[4] = {find_property(element, {"red", "diffuse_red"}),
+                                  find_property(element, {"green", "diffuse_green"}),
+                                  find_property(element, {"blue", "diffuse_blue"}),
+                                  find_property(element, {"alpha"})};
+  const bool has_normals = normal_props[0] >= 0 && normal_props[1] >= 0 && normal_props[2] >= 0;
+  const bool has_uvs = uv_props[0] >= 0 && uv_props[1] >= 0;
+  const bool has_colors = color_props[0] >= 0 && color_props[1] >= 0 && color_props[2] >= 0;
+
+  const int64_t count = element.count;
+  r_data.positions.resize(count, float3(0.0f));
+  if (has_normals) {
+    r_data.normals.resize(count);
+  }
+  if (has_uvs) {
+    r_data.uvs.resize(count);
+  }
+  if (has_colors) {
+    r_data.colors.resize(count);
+  }
+
+  auto store_vertex = [&](const int64_t i, Span<double> values) {
+    for (const int axis : IndexRange(3)) {
+      if (position_props[axis] >= 0) {
+        r_data.positions[i][axis] = (float)values[position_props[axis]];
+      }
+    }
+    if (has_normals) {
+      for (const int axis : IndexRange(3)) {
+        r_data.normals[i][axis] = (float)values[normal_props[axis]];
+      }
+    }
+    if (has_uvs) {
+      r_data.uvs[i] = float2((float)values[uv_props[0]], (float)values[uv_props[1]]);
+    }
+    if (has_colors) {
+      uint8_t rgba[4] = {0, 0, 0, 255};
+      for (const int channel : IndexRange(4)) {
+        const int64_t prop = color_props[channel];
+        if (prop >= 0) {
+          rgba[channel] = color_value_to_uchar(values[prop], element.properties[prop].type);
+        }
+      }
+      r_data.colors[i] = Color4b(rgba[0], rgba[1], rgba[2], rgba[3]);
+    }
+  };
+
+  const int64_t props_num = element.properties.size();
+  const int64_t vertex_size = element_fixed_size(element);
+  if (format != PlyFormat::Ascii && vertex_size >= 0) {
+    /* Vertices of binary files are usually the bulk of the data, with a fixed size they can be
+     * read in parallel. */
+    reader.skip(vertex_size * count);
+    if (reader.has_error()) {
+      return;
+    }
+    parallel_for(IndexRange(count), 4096, [&](const IndexRange range) {
+      Array<double> values(props_num);
+      for (const int64_t i : range) {
+        ValueReader vertex_reader(data.substr(vertex_size * i, vertex_size), format);
+        read_element_values(vertex_reader, element, values);
+        store_vertex(i, values);
+      }
+    });
+    return;
+  }
+
+  Array<double> values(props_num);
+  for (const int64_t i : IndexRange(count)) {
+    read_element_values(reader, element, values);
+    store_vertex(i, values);
+  }
+}
+
+static void read_faces(ValueReader &reader, const PlyElement &element, PlyMeshData &r_data)
+{
+  const int64_t indices_prop = find_property(element, {"vertex_indices", "vertex_index"});
+  Array<double> values(element.properties.size());
+  r_data.face_sizes.reserve(element.count);
+  r_data.face_verts.reserve(element.count * 3);
+  for (int64_t i = 0; i < element.count && !reader.has_error(); i++) {
+    const int64_t verts_start = r_data.face_verts.size();
+    read_element_values(reader, element, values, indices_prop, &r_data.face_verts);
+    r_data.face_sizes.append((int)(r_data.face_verts.size() - verts_start));
+  }
+}
+
+static void read_edges(ValueReader &reader, const PlyElement &element, PlyMeshData &r_data)
+{
+  const int64_t v1_prop = find_property(element, {"vertex1"});
+  const int64_t v2_prop = find_property(element, {"vertex2"});
+  Array<double> values(element.properties.size());
+  for (int64_t i = 0; i < element.count && !reader.has_error(); i++) {
+    read_element_values(reader, element, values);
+    if (v1_prop >= 0 && v2_prop >= 0) {
+      r_data.edges.append({(int)values[v1_prop], (int)values[v2_prop]});
+    }
+  }
+}
+
+bool read_ply_mesh(StringRef data, PlyMeshData &r_data)
+{
+  PlyHeader header;
+  if (!read_ply_header(data, header)) {
+    return false;
+  }
+
+  StringRef element_data = data.drop_prefix(header.data_offset);
+  ValueReader reader(element_data, header.format);
+  for (const PlyElement &element : header.elements) {
+    const int64_t offset = element_data.size() - reader.remaining_size();
+    if (element.name == "vertex") {
+      read_vertices(reader, element_data.drop_prefix(offset), header.format, element, r_data);
+    }
+    else if (element.name == "face") {
+      read_faces(reader, element, r_data);
+    }
+    else if (element.name == "edge") {
+      read_edges(reader, element, r_data);
+    }
+    else {
+      const int64_t size = element_fixed_size(element);
+      if (header.format != PlyFormat::Ascii && size >= 0) {
+        reader.skip(size * element.count);
+      }
+      else {
+        Array<double> values(element.properties.size());
+        for (int64_t i = 0; i < element.count && !reader.has_error(); i++) {
+          read_element_values(reader, element, values);
+        }
+      }
+    }
+    if (reader.has_error()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh Creation
+ * \{ */
+
+void fill_mesh_from_ply(Mesh *mesh, const PlyMeshData &data, const float4x4 &transform)
+{
+  const int64_t verts_num = data.positions.size();
+  auto vert_is_valid = [&](const int vert) { return vert >= 0 && vert < verts_num; };
+
+  /* The ranges of the valid faces in #PlyMeshData.face_verts. */
+  Vector<IndexRange> valid_faces;
+  int loops_num = 0;
+  int verts_start = 0;
+  for (const int size : data.face_sizes) {
+    const IndexRange face(verts_start, size);
+    const Span<int> face_verts = data.face_verts.as_span().slice(face);
+    if (size >= 3 && std::all_of(face_verts.begin(), face_verts.end(), vert_is_valid)) {
+      valid_faces.append(face);
+      loops_num += size;
+    }
+    verts_start += size;
+  }
+  Vector<std::array<int, 2>> valid_edges;
+  for (const std::array<int, 2> &edge : data.edges) {
+    if (vert_is_valid(edge[0]) && vert_is_valid(edge[1]) && edge[0] != edge[1]) {
+      valid_edges.append(edge);
+    }
+  }
+
+  mesh->totvert = (int)verts_num;
+  mesh->totedge = (int)valid_edges.size();
+  mesh->totpoly = (int)valid_faces.size();
+  mesh->totloop = loops_num;
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+  CustomData_add_layer(&mesh->edata, CD_MEDGE, CD_CALLOC, nullptr, mesh->totedge);
+  CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+  MLoopUV *mloopuv = nullptr;
+  if (!data.uvs.is_empty()) {
+    mloopuv = (MLoopUV *)CustomData_add_layer_named(
+        &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop, "UVMap");
+  }
+  MLoopCol *mloopcol = nullptr;
+  if (!data.colors.is_empty()) {
+    mloopcol = (MLoopCol *)CustomData_add_layer_named(
+        &mesh->ldata, CD_MLOOPCOL, CD_CALLOC, nullptr, mesh->totloop, "Col");
+  }
+  BKE_mesh_update_customdata_pointers(mesh, false);
+
+  parallel_for(IndexRange(verts_num), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      copy_v3_v3(mesh->mvert[i].co, transform * data.positions[i]);
+    }
+  });
+
+  for (const int i : valid_edges.index_range()) {
+    MEdge &medge = mesh->medge[i];
+    medge.v1 = (uint)valid_edges[i][0];
+    medge.v2 = (uint)valid_edges[i][1];
+    medge.flag = ME_EDGEDRAW | ME_EDGERENDER;
+  }
+
+  int loop_index = 0;
+  for (const int i : valid_faces.index_range()) {
+    MPoly &mpoly = mesh->mpoly[i];
+    mpoly.loopstart = loop_index;
+    mpoly.totloop = (int)valid_faces[i].size();
+    for (const int vert : data.face_verts.as_span().slice(valid_faces[i])) {
+      mesh->mloop[loop_index].v = (uint)vert;
+      if (mloopuv != nullptr) {
+        copy_v2_v2(mloopuv[loop_index].uv, data.uvs[vert]);
+      }
+      if (mloopcol != nullptr) {
+        const Color4b &color = data.colors[vert];
+        mloopcol[loop_index] = {color.r, color.g, color.b, color.a};
+      }
+      loop_index++;
+    }
+  }
+
+  BKE_mesh_calc_edges(mesh, !valid_edges.is_empty(), false);
+  BKE_mesh_calc_edges_loose(mesh);
+  BKE_mesh_calc_normals(mesh);
+
+  if (!data.normals.is_empty()) {
+    Array<float3> normals(verts_num);
+    for (const int64_t i : IndexRange(verts_num)) {
+      normals[i] = data.normals[i];
+      mul_mat3_m4_v3(transform.values, normals[i]);
+      normalize_v3(normals[i]);
+    }
+    /* Custom normals only apply to smooth faces. */
+    for (int i = 0; i < mesh->totpoly; i++) {
+      mesh->mpoly[i].flag |= ME_SMOOTH;
+    }
+    mesh->flag |= ME_AUTOSMOOTH;
+    mesh->smoothresh = (float)M_PI;
+    BKE_mesh_set_custom_normals_from_vertices(mesh, (float(*)[3])normals.data());
+  }
+}
+
+/** \} */
+
+bool importer_main(Main *bmain,
+                   Scene *scene,
+                   ViewLayer *view_layer,
+                   const PLYImportParams &import_params)
+{
+  PlyMeshData data;
+  {
+    MappedFile file;
+    if (!file.open(import_params.filepath)) {
+      fprintf(stderr, "PLY import: cannot read '%s'\n", import_params.filepath);
+      return false;
+    }
+    if (!read_ply_mesh(file.data(), data) || file.has_io_error()) {
+      fprintf(stderr, "PLY import: '%s' is not a valid PLY file\n", import_params.filepath);
+      return false;
+    }
+  }
+
+  char name[FILE_MAX];
+  BLI_strncpy(name, BLI_path_basename(import_params.filepath), sizeof(name));
+  BLI_path_extension_replace(name, sizeof(name), "");
+
+  const float4x4 transform = axis_conversion_matrix(import_params.forward_axis,
+                                                    import_params.up_axis,
+                                                    IO_AXIS_Y,
+                                                    IO_AXIS_Z,
+                                                    import_params.global_scale);
+  Mesh *mesh = BKE_mesh_add(bmain, name);
+  fill_mesh_from_ply(mesh, data, transform);
+  if (import_params.validate_mesh) {
+    BKE_mesh_validate(mesh, false, false);
+  }
+
+  Object *ob = BKE_object_add_only_object(bmain, OB_MESH, name);
+  ob->data = mesh;
+  import_objects_add_to_view_layer(bmain, scene, view_layer, {ob});
+
+  return true;
+}
+
+}  // namespace blender::io::ply
@@ -0,0 +1,116 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup ply
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "BLI_color.hh"
+#include "BLI_float2.hh"
+#include "BLI_float3.hh"
+#include "BLI_float4x4.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_vector.hh"
+
+#include "IO_ply.h"
+
+struct Main;
+struct Mesh;
+struct Scene;
+struct ViewLayer;
+
+namespace blender::io::ply {
+
+enum class PlyFormat {
+  Ascii,
+  BinaryLittleEndian,
+  BinaryBigEndian,
+};
+
+enum class PlyType {
+  Char,
+  UChar,
+  Short,
+  UShort,
+  Int,
+  UInt,
+  Float,
+  Double,
+};
+
+struct PlyProperty {
+  std::string name;
+  /** The type of the value, or of the items of a list. */
+  PlyType type;
+  bool is_list = false;
+  /** The type of the item count of a list. */
+  PlyType count_type;
+};
+
+struct PlyElement {
+  std::string name;
+  int64_t count;
+  Vector<PlyProperty> properties;
+};
+
+struct PlyHeader {
+  PlyFormat format;
+  Vector<PlyElement> elements;
+  /** Offset of the element data, after the `end_header` line. */
+  int64_t data_offset;
+};
+
+/**
+ * The mesh data of a PLY file. The optional vertex attributes are empty when the file doesn't
+ * have them.
+ */
+struct PlyMeshData {
+  Vector<float3> positions;
+  Vector<float3> normals;
+  Vector<float2> uvs;
+  Vector<Color4b> colors;
+  /** Faces as vertex counts and the concatenated vertex indices. */
+  Vector<int> face_sizes;
+  Vector<int> face_verts;
+  Vector<std::array<int, 2>> edges;
+};
+
+/** Parse the header at the start of \a data, return false when it isn't a valid PLY header. */
+bool read_ply_header(StringRef data, PlyHeader &r_header);
+
+/**
+ * Read the vertices, faces and edges of a PLY file, other elements are skipped.
+ * Return false when the file is invalid or truncated.
+ */
+bool read_ply_mesh(StringRef data, PlyMeshData &r_data);
+
+/**
+ * Fill the empty \a mesh with the PLY data, transforming the positions by \a transform.
+ * Faces with invalid vertex indices are skipped.
+ */
+void fill_mesh_from_ply(Mesh *mesh, const PlyMeshData &data, const float4x4 &transform);
+
+bool importer_main(Main *bmain,
+                   Scene *scene,
+                   ViewLayer *view_layer,
+                   const PLYImportParams &import_params);
+
+}  // namespace blender::io::ply
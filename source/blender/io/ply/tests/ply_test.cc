@@ -0,0 +1,218 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "BLI_fileops.h"
+#include "BLI_math_matrix.h"
+#include "BLI_path_util.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_appdir.h"
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+
+#include "IO_mapped_file.hh"
+
+#include "ply_export.hh"
+#include "ply_import.hh"
+
+namespace blender::io::ply::tests {
+
+class ply_test : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    BKE_idtype_init();
+    BKE_tempdir_init(nullptr);
+  }
+};
+
+static float4x4 unit_matrix()
+{
+  float4x4 matrix;
+  unit_m4(matrix.values);
+  return matrix;
+}
+
+/* A quad and a triangle sharing an edge, with UVs and colors, and a loose edge. */
+static const char *ascii_file =
+    "ply\n"
+    "format ascii 1.0\n"
+    "comment a comment\n"
+    "element vertex 6\n"
+    "property float x\n"
+    "property float y\n"
+    "property float z\n"
+    "property float s\n"
+    "property float t\n"
+    "property uchar red\n"
+    "property uchar green\n"
+    "property uchar blue\n"
+    "element face 2\n"
+    "property uchar flags\n"
+    "property list uchar int vertex_indices\n"
+    "element edge 1\n"
+    "property int vertex1\n"
+    "property int vertex2\n"
+    "end_header\n"
+    "0 0 0 0 0 255 0 0\n"
+    "1 0 0 1 0 0 255 0\n"
+    "1 1 0 1 1 0 0 255\n"
+    "0 1 0 0 1 10 20 30\n"
+    "2 0.5 0 0.5 0.5 0 0 0\n"
+    "5 5 5 0 0 0 0 0\n"
+    "0 4 0 1 2 3\n"
+    "1 3 1 4 2\n"
+    "3 5\n";
+
+TEST_F(ply_test, read_header)
+{
+  PlyHeader header;
+  ASSERT_TRUE(read_ply_header(ascii_file, header));
+  EXPECT_EQ(header.format, PlyFormat::Ascii);
+  ASSERT_EQ(header.elements.size(), 3);
+  EXPECT_EQ(header.elements[0].count, 6);
+  EXPECT_EQ(header.elements[0].properties.size(), 8);
+  const PlyProperty &indices = header.elements[1].properties[1];
+  EXPECT_TRUE(indices.is_list);
+  EXPECT_EQ(indices.count_type, PlyType::UChar);
+  EXPECT_EQ(indices.type, PlyType::Int);
+  EXPECT_EQ(indices.name, "vertex_indices");
+  EXPECT_EQ(StringRef(ascii_file).substr(header.data_offset, 6), "0 0 0 ");
+
+  EXPECT_FALSE(read_ply_header("ply\nformat unknown 1.0\nend_header\n", header));
+}
+
+TEST_F(ply_test, read_ascii)
+{
+  PlyMeshData data;
+  ASSERT_TRUE(read_ply_mesh(ascii_file, data));
+  ASSERT_EQ(data.positions.size(), 6);
+  EXPECT_EQ(data.positions[4], float3(2.0f, 0.5f, 0.0f));
+  EXPECT_TRUE(data.normals.is_empty());
+  ASSERT_EQ(data.uvs.size(), 6);
+  EXPECT_EQ(data.uvs[2], float2(1.0f, 1.0f));
+  ASSERT_EQ(data.colors.size(), 6);
+  EXPECT_EQ(data.colors[3], Color4b(10, 20, 30, 255));
+  ASSERT_EQ(data.face_sizes.size(), 2);
+  EXPECT_EQ(data.face_sizes[0], 4);
+  EXPECT_EQ(data.face_sizes[1], 3);
+  EXPECT_EQ(data.face_verts.size(), 7);
+  ASSERT_EQ(data.edges.size(), 1);
+  EXPECT_EQ(data.edges[0][1], 5);
+
+  /* Truncated files are invalid. */
+  const StringRef text = ascii_file;
+  EXPECT_FALSE(read_ply_mesh(text.substr(0, text.size() - 6), data));
+}
+
+TEST_F(ply_test, read_binary_big_endian)
+{
+  std::string file =
+      "ply\n"
+      "format binary_big_endian 1.0\n"
+      "element vertex 3\n"
+      "property float x\n"
+      "property float y\n"
+      "property float z\n"
+      "element face 1\n"
+      "property list uchar uint vertex_indices\n"
+      "end_header\n";
+  auto append_big_endian = [&](const void *value, const int size) {
+    for (int i = size - 1; i >= 0; i--) {
+      file += ((const char *)value)[i];
+    }
+  };
+  const float coords[9] = {0, 0, 0, 1, 0, 0, 0, 1, 0.25f};
+  for (const float coord : coords) {
+    append_big_endian(&coord, sizeof(coord));
+  }
+  file += (char)3;
+  for (const uint32_t vert : {0u, 1u, 2u}) {
+    append_big_endian(&vert, sizeof(vert));
+  }
+
+  PlyMeshData data;
+  ASSERT_TRUE(read_ply_mesh(file, data));
+  ASSERT_EQ(data.positions.size(), 3);
+  EXPECT_EQ(data.positions[2], float3(0.0f, 1.0f, 0.25f));
+  ASSERT_EQ(data.face_verts.size(), 3);
+  EXPECT_EQ(data.face_verts[2], 2);
+}
+
+TEST_F(ply_test, round_trip)
+{
+  PlyMeshData data;
+  ASSERT_TRUE(read_ply_mesh(ascii_file, data));
+  Mesh *mesh = (Mesh *)BKE_id_new_nomain(ID_ME, nullptr);
+  fill_mesh_from_ply(mesh, data, unit_matrix());
+  ASSERT_EQ(mesh->totvert, 6);
+  ASSERT_EQ(mesh->totpoly, 2);
+  EXPECT_EQ(mesh->totedge, 7);
+  ASSERT_NE(CustomData_get_layer(&mesh->ldata, CD_MLOOPCOL), nullptr);
+
+  for (const bool ascii_format : {false, true}) {
+    PLYExportParams export_params = {};
+    BLI_join_dirfile(
+        export_params.filepath, sizeof(export_params.filepath), BKE_tempdir_session(), "mesh.ply");
+    export_params.export_normals = true;
+    export_params.export_uv = true;
+    export_params.export_colors = true;
+    export_params.ascii_format = ascii_format;
+
+    ExportMesh export_mesh;
+    export_mesh.mesh = mesh;
+    export_mesh.world_matrix = unit_matrix();
+    PlyExportMesh ply_mesh;
+    ply_mesh_prepare(export_mesh, export_params, ply_mesh);
+    /* The loose vertex isn't used by any face, the shared corners have the same attributes. */
+    EXPECT_EQ(ply_mesh.positions.size(), 5);
+    ASSERT_TRUE(write_ply_file({ply_mesh}, export_params));
+
+    PlyMeshData result;
+    {
+      MappedFile file;
+      ASSERT_TRUE(file.open(export_params.filepath));
+      ASSERT_TRUE(read_ply_mesh(file.data(), result));
+    }
+    ASSERT_EQ(result.positions.size(), 5);
+    EXPECT_EQ(result.normals.size(), 5);
+    EXPECT_EQ(result.normals[0], float3(0.0f, 0.0f, 1.0f));
+    EXPECT_EQ(result.uvs.size(), 5);
+    ASSERT_EQ(result.colors.size(), 5);
+    ASSERT_EQ(result.face_verts.size(), ply_mesh.face_verts.size());
+    EXPECT_EQ_ARRAY(
+        result.face_verts.data(), ply_mesh.face_verts.data(), result.face_verts.size());
+    for (const int i : result.face_verts.index_range()) {
+      const int vert = result.face_verts[i];
+      const int original_vert = data.face_verts[i];
+      EXPECT_EQ(result.positions[vert], data.positions[original_vert]);
+      EXPECT_EQ(result.uvs[vert], data.uvs[original_vert]);
+      EXPECT_EQ(result.colors[vert], data.colors[original_vert]);
+    }
+    BLI_delete(export_params.filepath, false, false);
+  }
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::io::ply::tests
@@ -0,0 +1,69 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup stl
+ */
+
+#pragma once
+
+#include "BLI_utildefines.h"
+
+#include "IO_orientation.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct bContext;
+
+struct STLImportParams {
+  /** Full path to the source .STL file. */
+  char filepath[1024]; /* FILE_MAX */
+
+  eIOAxis forward_axis;
+  eIOAxis up_axis;
+  float global_scale;
+  /** Corners of triangles closer than this are merged into one vertex, exact matches for 0. */
+  float merge_distance;
+  /** Check the created mesh for invalid data (e.g. duplicate faces), at some cost. */
+  bool validate_mesh;
+};
+
+struct STLExportParams {
+  /** Full path to the destination .STL file. */
+  char filepath[1024]; /* FILE_MAX */
+
+  /** Only export the selected objects. */
+  bool export_selected_objects;
+  /** Export the evaluated meshes, otherwise the meshes without modifiers. */
+  bool apply_modifiers;
+  /** Write the text format instead of the more common binary one. */
+  bool ascii_format;
+
+  eIOAxis forward_axis;
+  eIOAxis up_axis;
+  float global_scale;
+};
+
+/* Both return true on success, errors are printed to the console. */
+
+bool STL_import(struct bContext *C, const struct STLImportParams *import_params);
+bool STL_export(struct bContext *C, const struct STLExportParams *export_params);
+
+#ifdef __cplusplus
+}
+#endif
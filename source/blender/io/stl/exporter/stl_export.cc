@@ -0,0 +1,175 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup stl
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "BLI_array.hh"
+#include "BLI_fileops.h"
+#include "BLI_math_geom.h"
+#include "BLI_string.h"
+#include "BLI_task.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_blender_version.h"
+#include "BKE_mesh.h"
+
+#include "IO_block_writer.hh"
+
+#include "stl_export.hh"
+
+namespace blender::io::stl {
+
+/** Number of triangles formatted by one task. */
+static const int64_t tris_per_block = 16384;
+
+/** The triangles of a mesh, with the corners already transformed. */
+struct MeshTriangles {
+  Array<float3> positions;
+  Array<MLoopTri> looptris;
+};
+
+static void mesh_triangles_prepare(const ExportMesh &export_mesh, MeshTriangles &r_triangles)
+{
+  const Mesh *mesh = export_mesh.mesh;
+  r_triangles.positions.reinitialize(mesh->totvert);
+  for (const int i : IndexRange(mesh->totvert)) {
+    r_triangles.positions[i] = export_mesh.world_matrix * float3(mesh->mvert[i].co);
+  }
+  /* Computed here, the runtime cache of evaluated meshes can't be changed while exporting. */
+  r_triangles.looptris.reinitialize(poly_to_tri_count(mesh->totpoly, mesh->totloop));
+  BKE_mesh_recalc_looptri(mesh->mloop,
+                          mesh->mpoly,
+                          mesh->mvert,
+                          mesh->totloop,
+                          mesh->totpoly,
+                          r_triangles.looptris.data());
+}
+
+static void format_triangles(const Mesh *mesh,
+                             const MeshTriangles &triangles,
+                             const bool ascii_format,
+                             const IndexRange range,
+                             std::string &r_data)
+{
+  for (const MLoopTri &looptri : triangles.looptris.as_span().slice(range)) {
+    const float3 &co1 = triangles.positions[mesh->mloop[looptri.tri[0]].v];
+    const float3 &co2 = triangles.positions[mesh->mloop[looptri.tri[1]].v];
+    const float3 &co3 = triangles.positions[mesh->mloop[looptri.tri[2]].v];
+    float3 normal;
+    normal_tri_v3(normal, co1, co2, co3);
+
+    if (ascii_format) {
+      append_format(r_data, "facet normal %e %e %e\n", normal.x, normal.y, normal.z);
+      r_data += "  outer loop\n";
+      for (const float3 &co : {co1, co2, co3}) {
+        append_format(r_data, "    vertex %e %e %e\n", co.x, co.y, co.z);
+      }
+      r_data += "  endloop\nendfacet\n";
+    }
+    else {
+      for (const float3 &vec : {normal, co1, co2, co3}) {
+        append_binary(r_data, vec);
+      }
+      append_binary(r_data, (uint16_t)0);
+    }
+  }
+}
+
+bool write_stl_file(Span<ExportMesh> export_meshes, const STLExportParams &export_params)
+{
+  Array<MeshTriangles> triangles(export_meshes.size());
+  parallel_for(export_meshes.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      mesh_triangles_prepare(export_meshes[i], triangles[i]);
+    }
+  });
+
+  FILE *file = BLI_fopen(export_params.filepath, "wb");
+  if (file == nullptr) {
+    fprintf(stderr, "STL export: cannot open '%s' for writing\n", export_params.filepath);
+    return false;
+  }
+
+  char solid_name[80];
+  BLI_snprintf(solid_name, sizeof(solid_name), "Blender %s", BKE_blender_version_string());
+  if (export_params.ascii_format) {
+    fprintf(file, "solid %s\n", solid_name);
+  }
+  else {
+    char header[80] = {0};
+    /* Binary files must not start with "solid", which is used to detect ASCII files. */
+    BLI_snprintf(header, sizeof(header), "Binary STL written by %s", solid_name);
+    uint32_t tris_num = 0;
+    for (const MeshTriangles &mesh_triangles : triangles) {
+      tris_num += (uint32_t)mesh_triangles.looptris.size();
+    }
+    fwrite(header, 1, sizeof(header), file);
+    fwrite(&tris_num, sizeof(tris_num), 1, file);
+  }
+
+  Vector<FormatBlockFn> blocks;
+  for (const int64_t i : export_meshes.index_range()) {
+    const Mesh *mesh = export_meshes[i].mesh;
+    const MeshTriangles &mesh_triangles = triangles[i];
+    const bool ascii_format = export_params.ascii_format;
+    add_blocks(
+        mesh_triangles.looptris.size(),
+        tris_per_block,
+        [mesh, &mesh_triangles, ascii_format](IndexRange range, std::string &r_data) {
+          format_triangles(mesh, mesh_triangles, ascii_format, range, r_data);
+        },
+        blocks);
+  }
+  write_blocks(file, blocks);
+
+  if (export_params.ascii_format) {
+    fprintf(file, "endsolid %s\n", solid_name);
+  }
+  const bool ok = !ferror(file);
+  fclose(file);
+  if (!ok) {
+    fprintf(stderr, "STL export: error writing '%s'\n", export_params.filepath);
+  }
+  return ok;
+}
+
+bool exporter_main(Depsgraph *depsgraph, const STLExportParams &export_params)
+{
+  Vector<ExportMesh> export_meshes = gather_export_meshes(
+      depsgraph, export_params.export_selected_objects, export_params.apply_modifiers);
+  if (export_meshes.is_empty()) {
+    fprintf(stderr, "STL export: no mesh objects to export\n");
+    return false;
+  }
+  const float4x4 axes_mat = axis_conversion_matrix(IO_AXIS_Y,
+                                                   IO_AXIS_Z,
+                                                   export_params.forward_axis,
+                                                   export_params.up_axis,
+                                                   export_params.global_scale);
+  for (ExportMesh &export_mesh : export_meshes) {
+    export_mesh.world_matrix = axes_mat * export_mesh.world_matrix;
+  }
+  return write_stl_file(export_meshes, export_params);
+}
+
+}  // namespace blender::io::stl
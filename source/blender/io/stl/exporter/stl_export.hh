@@ -0,0 +1,44 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup stl
+ */
+
+#pragma once
+
+#include "BLI_span.hh"
+
+#include "IO_mesh_utils.hh"
+#include "IO_stl.h"
+
+struct Depsgraph;
+
+namespace blender::io::stl {
+
+/**
+ * Write the triangulated faces of \a export_meshes, transformed by their world matrices, to the
+ * STL file of \a export_params. The triangles are formatted by multiple threads.
+ */
+bool write_stl_file(Span<ExportMesh> export_meshes, const STLExportParams &export_params);
+
+/**
+ * Export the visible (or selected) mesh objects of the evaluated \a depsgraph, including
+ * instances, into a single STL file.
+ */
+bool exporter_main(Depsgraph *depsgraph, const STLExportParams &export_params);
+
+}  // namespace blender::io::stl
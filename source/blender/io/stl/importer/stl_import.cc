@@ -0,0 +1,195 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup stl
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "BLI_array.hh"
+#include "BLI_math_vector.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_task.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "IO_mapped_file.hh"
+#include "IO_mesh_utils.hh"
+#include "IO_string_utils.hh"
+#include "IO_vertex_weld.hh"
+
+#include "stl_import.hh"
+
+namespace blender::io::stl {
+
+/* Binary files start with an 80 byte header and the number of triangles. */
+static const int64_t binary_header_size = 84;
+/* A normal, three corners and an unused attribute of two bytes. */
+static const int64_t binary_triangle_size = 50;
+
+static bool is_binary_stl(StringRef data)
+{
+  if (data.size() < binary_header_size) {
+    return false;
+  }
+  uint32_t tris_num;
+  memcpy(&tris_num, data.data() + 80, sizeof(tris_num));
+  /* Some ASCII files start with "solid" too, only trust the size. */
+  return data.size() == binary_header_size + binary_triangle_size * (int64_t)tris_num;
+}
+
+static void read_binary_triangles(StringRef data, Vector<float3> &r_corners)
+{
+  const int64_t tris_num = (data.size() - binary_header_size) / binary_triangle_size;
+  r_corners.resize(tris_num * 3);
+  parallel_for(IndexRange(tris_num), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      /* Skip the normal, it is computed from the corners. */
+      const char *corners = data.data() + binary_header_size + binary_triangle_size * i +
+                            sizeof(float[3]);
+      memcpy(&r_corners[i * 3], corners, sizeof(float[3][3]));
+    }
+  });
+}
+
+static void read_ascii_triangles(StringRef data, Vector<float3> &r_corners)
+{
+  while (!data.is_empty()) {
+    const StringRef line = drop_whitespace(read_next_line(data));
+    if (line.startswith("vertex")) {
+      float3 corner;
+      parse_floats(line.drop_prefix(6), 0.0f, corner, 3);
+      r_corners.append(corner);
+    }
+  }
+  /* Ignore an incomplete last triangle. */
+  r_corners.resize(r_corners.size() - r_corners.size() % 3);
+}
+
+bool read_stl_triangles(StringRef data, Vector<float3> &r_corners)
+{
+  if (is_binary_stl(data)) {
+    read_binary_triangles(data, r_corners);
+    return true;
+  }
+  if (drop_whitespace(data).startswith("solid")) {
+    read_ascii_triangles(data, r_corners);
+    return true;
+  }
+  return false;
+}
+
+void fill_mesh_from_triangles(Mesh *mesh,
+                              Span<float3> corners,
+                              const float merge_distance,
+                              const float4x4 &transform)
+{
+  Vector<float3> positions;
+  const Array<int> corner_verts = weld_positions(corners, merge_distance, positions);
+
+  Vector<int> valid_tris;
+  for (const int64_t i : IndexRange(corners.size() / 3)) {
+    const int v1 = corner_verts[i * 3];
+    const int v2 = corner_verts[i * 3 + 1];
+    const int v3 = corner_verts[i * 3 + 2];
+    if (v1 != v2 && v2 != v3 && v1 != v3) {
+      valid_tris.append((int)i);
+    }
+  }
+
+  mesh->totvert = (int)positions.size();
+  mesh->totpoly = (int)valid_tris.size();
+  mesh->totloop = mesh->totpoly * 3;
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+  CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+  BKE_mesh_update_customdata_pointers(mesh, false);
+
+  parallel_for(positions.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      copy_v3_v3(mesh->mvert[i].co, transform * positions[i]);
+    }
+  });
+  parallel_for(valid_tris.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      MPoly &mpoly = mesh->mpoly[i];
+      mpoly.loopstart = (int)i * 3;
+      mpoly.totloop = 3;
+      for (const int corner : IndexRange(3)) {
+        mesh->mloop[i * 3 + corner].v = (uint)corner_verts[valid_tris[i] * 3 + corner];
+      }
+    }
+  });
+
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+}
+
+bool importer_main(Main *bmain,
+                   Scene *scene,
+                   ViewLayer *view_layer,
+                   const STLImportParams &import_params)
+{
+  Vector<float3> corners;
+  {
+    MappedFile file;
+    if (!file.open(import_params.filepath)) {
+      fprintf(stderr, "STL import: cannot read '%s'\n", import_params.filepath);
+      return false;
+    }
+    if (!read_stl_triangles(file.data(), corners)) {
+      fprintf(stderr, "STL import: '%s' is not an STL file\n", import_params.filepath);
+      return false;
+    }
+    if (file.has_io_error()) {
+      fprintf(stderr, "STL import: error reading '%s'\n", import_params.filepath);
+      return false;
+    }
+  }
+
+  char name[FILE_MAX];
+  BLI_strncpy(name, BLI_path_basename(import_params.filepath), sizeof(name));
+  BLI_path_extension_replace(name, sizeof(name), "");
+
+  /* Like the Python add-on, the conversion is applied to the mesh and not the object. */
+  const float4x4 transform = axis_conversion_matrix(import_params.forward_axis,
+                                                    import_params.up_axis,
+                                                    IO_AXIS_Y,
+                                                    IO_AXIS_Z,
+                                                    import_params.global_scale);
+  Mesh *mesh = BKE_mesh_add(bmain, name);
+  fill_mesh_from_triangles(mesh, corners, import_params.merge_distance, transform);
+  if (import_params.validate_mesh) {
+    BKE_mesh_validate(mesh, false, false);
+  }
+
+  Object *ob = BKE_object_add_only_object(bmain, OB_MESH, name);
+  ob->data = mesh;
+  import_objects_add_to_view_layer(bmain, scene, view_layer, {ob});
+
+  return true;
+}
+
+}  // namespace blender::io::stl
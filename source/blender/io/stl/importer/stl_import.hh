@@ -0,0 +1,58 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup stl
+ */
+
+#pragma once
+
+#include "BLI_float3.hh"
+#include "BLI_float4x4.hh"
+#include "BLI_span.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_vector.hh"
+
+#include "IO_stl.h"
+
+struct Main;
+struct Mesh;
+struct Scene;
+struct ViewLayer;
+
+namespace blender::io::stl {
+
+/**
+ * Read the corners of the triangles of a binary or ASCII STL file, three per triangle.
+ * Return false when the data is neither.
+ */
+bool read_stl_triangles(StringRef data, Vector<float3> &r_corners);
+
+/**
+ * Fill the empty \a mesh with the triangles, merging their corners into vertices which are
+ * transformed by \a transform. Triangles that become degenerate when merging are skipped.
+ */
+void fill_mesh_from_triangles(Mesh *mesh,
+                              Span<float3> corners,
+                              float merge_distance,
+                              const float4x4 &transform);
+
+bool importer_main(Main *bmain,
+                   Scene *scene,
+                   ViewLayer *view_layer,
+                   const STLImportParams &import_params);
+
+}  // namespace blender::io::stl
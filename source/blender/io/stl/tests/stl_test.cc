@@ -0,0 +1,143 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BLI_fileops.h"
+#include "BLI_math_matrix.h"
+#include "BLI_path_util.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_appdir.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+
+#include "IO_mapped_file.hh"
+
+#include "stl_export.hh"
+#include "stl_import.hh"
+
+namespace blender::io::stl::tests {
+
+class stl_test : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    BKE_idtype_init();
+    BKE_tempdir_init(nullptr);
+  }
+};
+
+static float4x4 unit_matrix()
+{
+  float4x4 matrix;
+  unit_m4(matrix.values);
+  return matrix;
+}
+
+/* A tetrahedron, as it is stored in STL files with every corner repeated. */
+static Vector<float3> tetrahedron_corners()
+{
+  const float3 verts[4] = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+  const int tris[4][3] = {{0, 2, 1}, {0, 1, 3}, {1, 2, 3}, {0, 3, 2}};
+  Vector<float3> corners;
+  for (const int i : IndexRange(4)) {
+    for (const int j : IndexRange(3)) {
+      corners.append(verts[tris[i][j]]);
+    }
+  }
+  return corners;
+}
+
+TEST_F(stl_test, read_ascii)
+{
+  const char *text =
+      "solid test\n"
+      "facet normal 0 0 1\n"
+      "  outer loop\n"
+      "    vertex 0 0 0\n"
+      "    vertex 1 0 0\n"
+      "    vertex 0 1.5 -2e1\n"
+      "  endloop\n"
+      "endfacet\n"
+      "endsolid test\n";
+  Vector<float3> corners;
+  ASSERT_TRUE(read_stl_triangles(text, corners));
+  ASSERT_EQ(corners.size(), 3);
+  EXPECT_EQ(corners[2], float3(0.0f, 1.5f, -20.0f));
+
+  EXPECT_FALSE(read_stl_triangles("not an stl file", corners));
+}
+
+TEST_F(stl_test, weld_and_skip_degenerate)
+{
+  Vector<float3> corners = tetrahedron_corners();
+  /* A triangle that collapses when merging corners closer than 0.01. */
+  corners.extend({float3(0.0f), float3(0.001f, 0.0f, 0.0f), float3(0.0f, 1.0f, 0.0f)});
+  Mesh *mesh = (Mesh *)BKE_id_new_nomain(ID_ME, nullptr);
+  fill_mesh_from_triangles(mesh, corners, 0.01f, unit_matrix());
+  EXPECT_EQ(mesh->totvert, 4);
+  EXPECT_EQ(mesh->totpoly, 4);
+  EXPECT_EQ(mesh->totedge, 6);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(stl_test, round_trip)
+{
+  Mesh *mesh = (Mesh *)BKE_id_new_nomain(ID_ME, nullptr);
+  fill_mesh_from_triangles(mesh, tetrahedron_corners(), 0.0f, unit_matrix());
+  ASSERT_EQ(mesh->totvert, 4);
+
+  for (const bool ascii_format : {false, true}) {
+    STLExportParams export_params = {};
+    BLI_join_dirfile(export_params.filepath,
+                     sizeof(export_params.filepath),
+                     BKE_tempdir_session(),
+                     "tetrahedron.stl");
+    export_params.ascii_format = ascii_format;
+
+    /* The same mesh twice, the second one moved. */
+    Vector<ExportMesh> export_meshes(2);
+    for (const int i : export_meshes.index_range()) {
+      export_meshes[i].mesh = mesh;
+      export_meshes[i].world_matrix = unit_matrix();
+      export_meshes[i].world_matrix.values[3][0] = (float)(i * 10);
+    }
+    ASSERT_TRUE(write_stl_file(export_meshes, export_params));
+
+    Vector<float3> corners;
+    {
+      MappedFile file;
+      ASSERT_TRUE(file.open(export_params.filepath));
+      ASSERT_TRUE(read_stl_triangles(file.data(), corners));
+    }
+    ASSERT_EQ(corners.size(), 24);
+    EXPECT_EQ(corners[12], tetrahedron_corners()[0] + float3(10.0f, 0.0f, 0.0f));
+
+    Mesh *result = (Mesh *)BKE_id_new_nomain(ID_ME, nullptr);
+    fill_mesh_from_triangles(result, corners, 0.0f, unit_matrix());
+    EXPECT_EQ(result->totvert, 8);
+    EXPECT_EQ(result->totpoly, 8);
+    BKE_id_free(nullptr, result);
+    BLI_delete(export_params.filepath, false, false);
+  }
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::io::stl::tests
@@ -19,6 +19,7 @@
 
 #include "usd.h"
 #include "usd_hierarchy_iterator.h"
+#include "usd_reader_stage.h"
 
 #include <pxr/base/plug/registry.h>
 #include <pxr/pxr.h>
@@ -33,10 +34,13 @@
 
 #include "DNA_scene_types.h"
 
+#include "ED_undo.h"
+
 #include "BKE_appdir.h"
 #include "BKE_blender_version.h"
 #include "BKE_context.h"
 #include "BKE_global.h"
+#include "BKE_lib_id.h"
 #include "BKE_scene.h"
 
 #include "BLI_fileops.h"
@@ -46,6 +50,8 @@
 #include "WM_api.h"
 #include "WM_types.h"
 
+#include "IO_mesh_utils.hh"
+
 namespace blender::io::usd {
 
 struct ExportJobData {
@@ -183,6 +189,94 @@ static void export_endjob(void *customdata)
   WM_set_locked_interface(data->wm, false);
 }
 
+struct ImportJobData {
+  bContext *C;
+  Main *bmain;
+  Scene *scene;
+  ViewLayer *view_layer;
+  wmWindowManager *wm;
+
+  char filename[FILE_MAX];
+  USDImportParams params;
+
+  USDStageReader *stage_reader;
+
+  bool was_cancelled;
+  /* Set when the stage was read, the objects are then created in #import_endjob. */
+  bool is_data_read;
+  bool import_ok;
+  bool is_background_job;
+};
+
+static void import_startjob(void *customdata, short *stop, short *do_update, float *progress)
+{
+  ImportJobData *data = static_cast<ImportJobData *>(customdata);
+
+  WM_set_locked_interface(data->wm, true);
+  G.is_break = false;
+
+  pxr::UsdStageRefPtr usd_stage = pxr::UsdStage::Open(data->filename);
+  if (!usd_stage) {
+    WM_reportf(RPT_ERROR, "USD Import: unable to open stage to read %s", data->filename);
+    return;
+  }
+
+  *progress = 0.05f;
+  *do_update = true;
+
+  data->stage_reader = new USDStageReader(usd_stage, data->params);
+  data->stage_reader->collect_readers();
+
+  if (G.is_break || *stop) {
+    data->was_cancelled = true;
+    return;
+  }
+  *progress = 0.1f;
+  *do_update = true;
+
+  /* Values that aren't animated are stored at the default time, the earliest time gives those or
+   * the first sample of animated values. */
+  const pxr::UsdTimeCode time = pxr::UsdTimeCode::EarliestTime();
+  data->stage_reader->read_data(time);
+
+  if (G.is_break || *stop) {
+    data->was_cancelled = true;
+    return;
+  }
+  data->is_data_read = true;
+  *progress = 1.0f;
+  *do_update = true;
+}
+
+static void import_endjob(void *customdata)
+{
+  ImportJobData *data = static_cast<ImportJobData *>(customdata);
+
+  if (data->is_data_read && !data->was_cancelled) {
+    /* Main is only changed here, the job's start callback runs in a worker thread. The time is
+     * the one the data was read at. */
+    data->stage_reader->create_objects(data->bmain, pxr::UsdTimeCode::EarliestTime());
+    import_objects_add_to_view_layer(
+        data->bmain, data->scene, data->view_layer, data->stage_reader->objects());
+    data->import_ok = true;
+    if (data->is_background_job) {
+      /* Blender already returned from the import operator, so we need to store our own extra
+       * undo step. */
+      ED_undo_push(data->C, "USD Import Finished");
+    }
+  }
+
+  WM_set_locked_interface(data->wm, false);
+  WM_main_add_notifier(NC_SCENE | ND_OB_ACTIVE, data->scene);
+}
+
+static void import_freejob(void *customdata)
+{
+  ImportJobData *data = static_cast<ImportJobData *>(customdata);
+  delete data->stage_reader;
+  delete data;
+}
+
 }  // namespace blender::io::usd
 
 bool USD_export(bContext *C,
@@ -237,6 +331,63 @@ bool USD_export(bContext *C,
   return export_ok;
 }
 
+bool USD_import(bContext *C,
+                const char *filepath,
+                const USDImportParams *params,
+                bool as_background_job)
+{
+  blender::io::usd::ensure_usd_plugin_path_registered();
+
+  /* Using new here since the stage reader needs its destructor to be called. */
+  blender::io::usd::ImportJobData *job = new blender::io::usd::ImportJobData();
+  job->C = C;
+  job->bmain = CTX_data_main(C);
+  job->scene = CTX_data_scene(C);
+  job->view_layer = CTX_data_view_layer(C);
+  job->wm = CTX_wm_manager(C);
+  BLI_strncpy(job->filename, filepath, sizeof(job->filename));
+  job->params = *params;
+  job->stage_reader = nullptr;
+  job->was_cancelled = false;
+  job->is_data_read = false;
+  job->import_ok = false;
+  job->is_background_job = as_background_job;
+
+  bool import_ok = false;
+  if (as_background_job) {
+    wmJob *wm_job = WM_jobs_get(job->wm,
+                                CTX_wm_window(C),
+                                job->scene,
+                                "USD Import",
+                                WM_JOB_PROGRESS,
+                                WM_JOB_TYPE_ALEMBIC);
+
+    /* setup job */
+    WM_jobs_customdata_set(wm_job, job, blender::io::usd::import_freejob);
+    WM_jobs_timer(wm_job, 0.1, NC_SCENE | ND_FRAME, NC_SCENE | ND_FRAME);
+    WM_jobs_callbacks(wm_job,
+                      blender::io::usd::import_startjob,
+                      nullptr,
+                      nullptr,
+                      blender::io::usd::import_endjob);
+
+    WM_jobs_start(job->wm, wm_job);
+  }
+  else {
+    /* Fake a job context, so that we don't need NULL pointer checks while importing. */
+    short stop = 0, do_update = 0;
+    float progress = 0.0f;
+
+    blender::io::usd::import_startjob(job, &stop, &do_update, &progress);
+    blender::io::usd::import_endjob(job);
+    import_ok = job->import_ok;
+
+    blender::io::usd::import_freejob(job);
+  }
+
+  return import_ok;
+}
+
 int USD_get_version(void)
 {
   /* USD 19.11 defines:
@@ -0,0 +1,111 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+#include "usd_reader_camera.h"
+
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/usd/usdGeom/camera.h>
+#include <pxr/usd/usdGeom/tokens.h>
+
+#include "DNA_camera_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_camera.h"
+
+#include "BLI_math_base.h"
+
+namespace blender::io::usd {
+
+USDCameraReader::USDCameraReader(const pxr::UsdPrim &prim, const USDImporterSettings &settings)
+    : USDPrimReader(prim, settings),
+      focal_length_(50.0f),
+      aperture_x_(36.0f),
+      aperture_y_(24.0f),
+      aperture_offset_x_(0.0f),
+      aperture_offset_y_(0.0f),
+      clip_start_(0.1f),
+      clip_end_(100.0f),
+      fstop_(0.0f),
+      focus_distance_(0.0f),
+      is_orthographic_(false)
+{
+}
+
+int USDCameraReader::object_type() const
+{
+  return OB_CAMERA;
+}
+
+void USDCameraReader::read_data(const pxr::UsdTimeCode time)
+{
+  pxr::UsdGeomCamera usd_camera(prim_);
+
+  pxr::TfToken projection;
+  usd_camera.GetProjectionAttr().Get(&projection, time);
+  is_orthographic_ = projection == pxr::UsdGeomTokens->orthographic;
+
+  /* See USDCameraWriter::do_write() for the units of these values. */
+  usd_camera.GetFocalLengthAttr().Get(&focal_length_, time);
+  usd_camera.GetHorizontalApertureAttr().Get(&aperture_x_, time);
+  usd_camera.GetVerticalApertureAttr().Get(&aperture_y_, time);
+  usd_camera.GetHorizontalApertureOffsetAttr().Get(&aperture_offset_x_, time);
+  usd_camera.GetVerticalApertureOffsetAttr().Get(&aperture_offset_y_, time);
+
+  pxr::GfVec2f clipping_range;
+  if (usd_camera.GetClippingRangeAttr().Get(&clipping_range, time)) {
+    clip_start_ = clipping_range[0] * settings_.import_params.scale;
+    clip_end_ = clipping_range[1] * settings_.import_params.scale;
+  }
+
+  usd_camera.GetFStopAttr().Get(&fstop_, time);
+  usd_camera.GetFocusDistanceAttr().Get(&focus_distance_, time);
+}
+
+ID *USDCameraReader::create_data(Main *bmain)
+{
+  Camera *camera = static_cast<Camera *>(BKE_camera_add(bmain, name_.c_str()));
+
+  camera->type = is_orthographic_ ? CAM_ORTHO : CAM_PERSP;
+  camera->lens = focal_length_;
+  camera->sensor_x = aperture_x_;
+  camera->sensor_y = aperture_y_;
+  camera->sensor_fit = aperture_x_ >= aperture_y_ ? CAMERA_SENSOR_FIT_HOR :
+                                                    CAMERA_SENSOR_FIT_VERT;
+  if (aperture_x_ > 0.0f) {
+    /* The vertical offset is written relative to the horizontal aperture. */
+    camera->shiftx = aperture_offset_x_ / aperture_x_;
+    camera->shifty = aperture_offset_y_ / aperture_x_;
+  }
+  if (is_orthographic_) {
+    /* Orthographic apertures are in tenths of scene units. */
+    camera->ortho_scale = max_ff(aperture_x_, aperture_y_) / 10.0f *
+                          settings_.import_params.scale;
+  }
+  camera->clip_start = clip_start_;
+  camera->clip_end = clip_end_;
+
+  if (fstop_ > 0.0f) {
+    camera->dof.flag |= CAM_DOF_ENABLED;
+    camera->dof.aperture_fstop = fstop_;
+    camera->dof.focus_distance = focus_distance_ * settings_.import_params.scale;
+  }
+
+  return &camera->id;
+}
+
+}  // namespace blender::io::usd
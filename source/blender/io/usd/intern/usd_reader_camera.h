@@ -0,0 +1,47 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+#include "usd_reader_prim.h"
+
+struct Camera;
+
+namespace blender::io::usd {
+
+class USDCameraReader : public USDPrimReader {
+ public:
+  USDCameraReader(const pxr::UsdPrim &prim, const USDImporterSettings &settings);
+
+  void read_data(pxr::UsdTimeCode time) override;
+  ID *create_data(Main *bmain) override;
+
+ protected:
+  int object_type() const override;
+
+ private:
+  /* The values read by read_data(), applied to the camera in create_data(). */
+  float focal_length_;
+  float aperture_x_, aperture_y_;
+  float aperture_offset_x_, aperture_offset_y_;
+  float clip_start_, clip_end_;
+  float fstop_, focus_distance_;
+  bool is_orthographic_;
+};
+
+}  // namespace blender::io::usd
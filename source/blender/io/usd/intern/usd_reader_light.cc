@@ -0,0 +1,102 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+#include "usd_reader_light.h"
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/usd/usdLux/diskLight.h>
+#include <pxr/usd/usdLux/distantLight.h>
+#include <pxr/usd/usdLux/rectLight.h>
+#include <pxr/usd/usdLux/sphereLight.h>
+
+#include "BKE_light.h"
+
+#include "BLI_math_vector.h"
+
+#include "DNA_light_types.h"
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+USDLightReader::USDLightReader(const pxr::UsdPrim &prim, const USDImporterSettings &settings)
+    : USDPrimReader(prim, settings),
+      type_(LA_LOCAL),
+      area_shape_(LA_AREA_SQUARE),
+      size_x_(0.0f),
+      size_y_(0.0f),
+      intensity_(1.0f),
+      color_{1.0f, 1.0f, 1.0f},
+      specular_(1.0f)
+{
+}
+
+int USDLightReader::object_type() const
+{
+  return OB_LAMP;
+}
+
+void USDLightReader::read_data(const pxr::UsdTimeCode time)
+{
+  if (prim_.IsA<pxr::UsdLuxDiskLight>()) {
+    type_ = LA_AREA;
+    area_shape_ = LA_AREA_DISK;
+    pxr::UsdLuxDiskLight(prim_).GetRadiusAttr().Get(&size_x_, time);
+  }
+  else if (prim_.IsA<pxr::UsdLuxRectLight>()) {
+    type_ = LA_AREA;
+    area_shape_ = LA_AREA_RECT;
+    pxr::UsdLuxRectLight rect_light(prim_);
+    rect_light.GetWidthAttr().Get(&size_x_, time);
+    rect_light.GetHeightAttr().Get(&size_y_, time);
+  }
+  else if (prim_.IsA<pxr::UsdLuxSphereLight>()) {
+    type_ = LA_LOCAL;
+    pxr::UsdLuxSphereLight(prim_).GetRadiusAttr().Get(&size_x_, time);
+  }
+  else if (prim_.IsA<pxr::UsdLuxDistantLight>()) {
+    type_ = LA_SUN;
+  }
+  size_x_ *= settings_.import_params.scale;
+  size_y_ *= settings_.import_params.scale;
+
+  pxr::UsdLuxLight usd_light(prim_);
+  usd_light.GetIntensityAttr().Get(&intensity_, time);
+  pxr::GfVec3f color;
+  if (usd_light.GetColorAttr().Get(&color, time)) {
+    copy_v3_v3(color_, color.data());
+  }
+  usd_light.GetSpecularAttr().Get(&specular_, time);
+}
+
+ID *USDLightReader::create_data(Main *bmain)
+{
+  Light *light = BKE_light_add(bmain, name_.c_str());
+
+  light->type = type_;
+  light->area_shape = area_shape_;
+  light->area_size = size_x_;
+  light->area_sizey = size_y_;
+  /* The reverse of the intensity conversion in USDLightWriter::do_write(). */
+  light->energy = type_ == LA_SUN ? intensity_ : intensity_ * 100.0f;
+  copy_v3_v3(&light->r, color_);
+  light->spec_fac = specular_;
+
+  return &light->id;
+}
+
+}  // namespace blender::io::usd
@@ -0,0 +1,260 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+#include "usd_reader_mesh.h"
+
+#include <iostream>
+
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/usd/sdf/types.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/primvarsAPI.h>
+#include <pxr/usd/usdGeom/tokens.h>
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "BLI_array.hh"
+#include "BLI_float3.hh"
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_span.hh"
+#include "BLI_task.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+USDMeshReader::USDMeshReader(const pxr::UsdPrim &prim, const USDImporterSettings &settings)
+    : USDPrimReader(prim, settings), mesh_(nullptr), has_custom_normals_(false)
+{
+}
+
+USDMeshReader::~USDMeshReader()
+{
+  if (mesh_ != nullptr) {
+    BKE_id_free(nullptr, mesh_);
+  }
+}
+
+int USDMeshReader::object_type() const
+{
+  return OB_MESH;
+}
+
+bool USDMeshReader::valid() const
+{
+  return mesh_ != nullptr;
+}
+
+static bool topology_is_valid(const pxr::VtIntArray &face_counts,
+                              const pxr::VtIntArray &face_indices,
+                              const size_t verts_num)
+{
+  size_t loops_num = 0;
+  for (const int count : face_counts) {
+    if (count < 3) {
+      return false;
+    }
+    loops_num += static_cast<size_t>(count);
+  }
+  if (loops_num != face_indices.size()) {
+    return false;
+  }
+  for (const int index : face_indices) {
+    if (index < 0 || static_cast<size_t>(index) >= verts_num) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Face-varying USD data of a face corner, taking left-handed faces into account. */
+static int usd_corner_index(const MPoly &mpoly, const int loop_index, const bool left_handed)
+{
+  return left_handed ? mpoly.loopstart + mpoly.totloop - 1 - (loop_index - mpoly.loopstart) :
+                       loop_index;
+}
+
+static void read_uv_maps(Mesh *mesh,
+                         const pxr::UsdGeomMesh &usd_mesh,
+                         const pxr::UsdTimeCode time,
+                         const bool left_handed)
+{
+  const pxr::UsdGeomPrimvarsAPI primvars_api(usd_mesh);
+  for (const pxr::UsdGeomPrimvar &primvar : primvars_api.GetPrimvars()) {
+    const pxr::SdfValueTypeName type = primvar.GetTypeName();
+    const pxr::TfToken name = primvar.GetPrimvarName();
+    /* Older files store UVs as plain float pairs, recognize those by their usual names. */
+    if (type != pxr::SdfValueTypeNames->TexCoord2fArray &&
+        !(type == pxr::SdfValueTypeNames->Float2Array && ELEM(name.GetString(), "st", "uv"))) {
+      continue;
+    }
+    const pxr::TfToken interpolation = primvar.GetInterpolation();
+    const bool face_varying = interpolation == pxr::UsdGeomTokens->faceVarying;
+    if (!face_varying && interpolation != pxr::UsdGeomTokens->vertex) {
+      continue;
+    }
+    pxr::VtVec2fArray usd_uvs;
+    if (!primvar.ComputeFlattened(&usd_uvs, time)) {
+      continue;
+    }
+    if (usd_uvs.size() != static_cast<size_t>(face_varying ? mesh->totloop : mesh->totvert)) {
+      continue;
+    }
+
+    MLoopUV *mloopuv = static_cast<MLoopUV *>(CustomData_add_layer_named(
+        &mesh->ldata, CD_MLOOPUV, CD_DEFAULT, nullptr, mesh->totloop, name.GetText()));
+    parallel_for(IndexRange(mesh->totpoly), 1024, [&](IndexRange range) {
+      for (const int64_t poly_index : range) {
+        const MPoly &mpoly = mesh->mpoly[poly_index];
+        for (int loop_index = mpoly.loopstart; loop_index < mpoly.loopstart + mpoly.totloop;
+             loop_index++) {
+          const int usd_index = face_varying ? usd_corner_index(mpoly, loop_index, left_handed) :
+                                               mesh->mloop[loop_index].v;
+          copy_v2_v2(mloopuv[loop_index].uv, usd_uvs[usd_index].data());
+        }
+      }
+    });
+  }
+}
+
+static bool read_normals(Mesh *mesh,
+                         const pxr::UsdGeomMesh &usd_mesh,
+                         const pxr::UsdTimeCode time,
+                         const bool left_handed)
+{
+  pxr::VtVec3fArray usd_normals;
+  if (!usd_mesh.GetNormalsAttr().Get(&usd_normals, time) || usd_normals.empty()) {
+    return false;
+  }
+  const pxr::TfToken interpolation = usd_mesh.GetNormalsInterpolation();
+  const bool face_varying = interpolation == pxr::UsdGeomTokens->faceVarying;
+  const bool per_vertex = ELEM(
+      interpolation, pxr::UsdGeomTokens->vertex, pxr::UsdGeomTokens->varying);
+  if (!(face_varying && usd_normals.size() == static_cast<size_t>(mesh->totloop)) &&
+      !(per_vertex && usd_normals.size() == static_cast<size_t>(mesh->totvert))) {
+    return false;
+  }
+
+  Array<float3> loop_normals(mesh->totloop);
+  parallel_for(IndexRange(mesh->totpoly), 1024, [&](IndexRange range) {
+    for (const int64_t poly_index : range) {
+      MPoly &mpoly = mesh->mpoly[poly_index];
+      /* Custom normals only apply to smooth faces. */
+      mpoly.flag |= ME_SMOOTH;
+      for (int loop_index = mpoly.loopstart; loop_index < mpoly.loopstart + mpoly.totloop;
+           loop_index++) {
+        const int usd_index = face_varying ? usd_corner_index(mpoly, loop_index, left_handed) :
+                                             mesh->mloop[loop_index].v;
+        copy_v3_v3(loop_normals[loop_index], usd_normals[usd_index].data());
+        normalize_v3(loop_normals[loop_index]);
+      }
+    }
+  });
+
+  mesh->flag |= ME_AUTOSMOOTH;
+  BKE_mesh_set_custom_normals(mesh, reinterpret_cast<float(*)[3]>(loop_normals.data()));
+  return true;
+}
+
+void USDMeshReader::read_data(const pxr::UsdTimeCode time)
+{
+  pxr::UsdGeomMesh usd_mesh(prim_);
+
+  pxr::VtVec3fArray positions;
+  pxr::VtIntArray face_counts;
+  pxr::VtIntArray face_indices;
+  usd_mesh.GetPointsAttr().Get(&positions, time);
+  usd_mesh.GetFaceVertexCountsAttr().Get(&face_counts, time);
+  usd_mesh.GetFaceVertexIndicesAttr().Get(&face_indices, time);
+  if (!topology_is_valid(face_counts, face_indices, positions.size())) {
+    std::cerr << "USD import: mesh " << prim_.GetPath() << " has invalid topology, skipping\n";
+    return;
+  }
+
+  pxr::TfToken orientation;
+  usd_mesh.GetOrientationAttr().Get(&orientation);
+  const bool left_handed = orientation == pxr::UsdGeomTokens->leftHanded;
+
+  mesh_ = BKE_mesh_new_nomain(static_cast<int>(positions.size()),
+                              0,
+                              0,
+                              static_cast<int>(face_indices.size()),
+                              static_cast<int>(face_counts.size()));
+
+  parallel_for(IndexRange(mesh_->totvert), 4096, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      copy_v3_v3(mesh_->mvert[i].co, positions[i].data());
+    }
+  });
+
+  int loopstart = 0;
+  for (const int poly_index : IndexRange(mesh_->totpoly)) {
+    MPoly &mpoly = mesh_->mpoly[poly_index];
+    mpoly.loopstart = loopstart;
+    mpoly.totloop = face_counts[poly_index];
+    loopstart += mpoly.totloop;
+  }
+  parallel_for(IndexRange(mesh_->totpoly), 1024, [&](IndexRange range) {
+    for (const int64_t poly_index : range) {
+      const MPoly &mpoly = mesh_->mpoly[poly_index];
+      for (int loop_index = mpoly.loopstart; loop_index < mpoly.loopstart + mpoly.totloop;
+           loop_index++) {
+        mesh_->mloop[loop_index].v = static_cast<unsigned int>(
+            face_indices[usd_corner_index(mpoly, loop_index, left_handed)]);
+      }
+    }
+  });
+
+  BKE_mesh_calc_edges(mesh_, false, false);
+  BKE_mesh_calc_normals(mesh_);
+
+  if (settings_.import_params.import_uvmaps) {
+    read_uv_maps(mesh_, usd_mesh, time, left_handed);
+  }
+  if (settings_.import_params.import_normals) {
+    has_custom_normals_ = read_normals(mesh_, usd_mesh, time, left_handed);
+  }
+}
+
+ID *USDMeshReader::create_data(Main *bmain)
+{
+  if (mesh_ == nullptr) {
+    return nullptr;
+  }
+
+  Mesh *mesh = BKE_mesh_add(bmain, name_.c_str());
+  BKE_mesh_nomain_to_mesh(mesh_, mesh, nullptr, &CD_MASK_MESH, true);
+  mesh_ = nullptr;
+
+  if (has_custom_normals_) {
+    mesh->flag |= ME_AUTOSMOOTH;
+    mesh->smoothresh = static_cast<float>(M_PI);
+  }
+  if (settings_.import_params.validate_meshes) {
+    BKE_mesh_validate(mesh, false, false);
+  }
+  return &mesh->id;
+}
+
+}  // namespace blender::io::usd
@@ -0,0 +1,112 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+#include "usd_reader_prim.h"
+
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/matrix4f.h>
+#include <pxr/usd/usdGeom/xformable.h>
+
+#include "BKE_object.h"
+
+#include "BLI_math_matrix.h"
+
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+USDPrimReader::USDPrimReader(const pxr::UsdPrim &prim, const USDImporterSettings &settings)
+    : prim_(prim),
+      settings_(settings),
+      name_(prim.GetName().GetString()),
+      object_(nullptr),
+      parent_reader_(nullptr)
+{
+}
+
+USDPrimReader::~USDPrimReader() = default;
+
+const pxr::UsdPrim &USDPrimReader::prim() const
+{
+  return prim_;
+}
+
+const std::string &USDPrimReader::name() const
+{
+  return name_;
+}
+
+Object *USDPrimReader::object() const
+{
+  return object_;
+}
+
+USDPrimReader *USDPrimReader::parent_reader() const
+{
+  return parent_reader_;
+}
+
+void USDPrimReader::set_parent_reader(USDPrimReader *parent_reader)
+{
+  parent_reader_ = parent_reader;
+}
+
+bool USDPrimReader::valid() const
+{
+  return prim_.IsValid();
+}
+
+void USDPrimReader::read_data(pxr::UsdTimeCode /*time*/)
+{
+}
+
+ID *USDPrimReader::create_data(Main * /*bmain*/)
+{
+  return nullptr;
+}
+
+Object *USDPrimReader::create_object(Main *bmain, ID *data)
+{
+  /* Prims with invalid data become empties, to keep the transform of their children. */
+  object_ = BKE_object_add_only_object(
+      bmain, data != nullptr ? object_type() : OB_EMPTY, name_.c_str());
+  object_->data = data;
+  return object_;
+}
+
+void USDPrimReader::read_matrix(float r_mat[4][4],
+                                const pxr::UsdTimeCode time,
+                                const bool is_root) const
+{
+  unit_m4(r_mat);
+
+  pxr::UsdGeomXformable xformable(prim_);
+  if (xformable) {
+    pxr::GfMatrix4d usd_local_xf;
+    bool reset_xform_stack;
+    xformable.GetLocalTransformation(&usd_local_xf, &reset_xform_stack, time);
+    /* USD and Blender matrices both transform row vectors in this memory layout. */
+    pxr::GfMatrix4f(usd_local_xf).Get(r_mat);
+  }
+
+  if (is_root) {
+    mul_m4_m4m4(r_mat, settings_.conversion_mat, r_mat);
+  }
+}
+
+}  // namespace blender::io::usd
@@ -0,0 +1,88 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+#include "usd.h"
+
+#include <pxr/usd/usd/prim.h>
+
+#include <string>
+
+struct ID;
+struct Main;
+struct Object;
+
+namespace blender::io::usd {
+
+struct USDImporterSettings {
+  const USDImportParams &import_params;
+  /* Applied to the transforms of root prims, to convert Y-up stages and the stage units. */
+  float conversion_mat[4][4];
+};
+
+/* Reads one prim into a Blender object and its data.
+ *
+ * Importing happens in two phases: read_data() converts the prim data into Blender data that
+ * isn't part of Main yet, and is called for many readers in parallel. The objects and ID data
+ * blocks are then created one reader after another from the main thread. */
+class USDPrimReader {
+ protected:
+  const pxr::UsdPrim prim_;
+  const USDImporterSettings &settings_;
+  const std::string name_;
+  Object *object_;
+  /* The reader of the closest ancestor prim that has an object, if any. */
+  USDPrimReader *parent_reader_;
+
+ public:
+  USDPrimReader(const pxr::UsdPrim &prim, const USDImporterSettings &settings);
+  virtual ~USDPrimReader();
+
+  const pxr::UsdPrim &prim() const;
+  const std::string &name() const;
+  Object *object() const;
+  USDPrimReader *parent_reader() const;
+  void set_parent_reader(USDPrimReader *parent_reader);
+
+  /* Returns false when the prim data is invalid, e.g. a mesh with out of range indices. Only
+   * meaningful after read_data(). */
+  virtual bool valid() const;
+
+  /* Convert the prim data at the given time. Must not touch Main, since it is called for
+   * multiple readers at the same time. */
+  virtual void read_data(pxr::UsdTimeCode time);
+
+  /* Add the object data read by read_data() to Main. Returns null for empties. The data is
+   * owned by Main and may be shared by the objects of multiple instances. */
+  virtual ID *create_data(Main *bmain);
+
+  /* Create an object for this prim, using `data` as its object data, or an empty when it is
+   * null. Prims inside instance prototypes get an object for every instance, object() returns
+   * the last one. */
+  Object *create_object(Main *bmain, ID *data);
+
+  /* The transform of the prim relative to its parent prim. Root prims also get the conversion
+   * matrix of the importer settings. */
+  void read_matrix(float r_mat[4][4], pxr::UsdTimeCode time, bool is_root) const;
+
+ protected:
+  virtual int object_type() const = 0;
+};
+
+}  // namespace blender::io::usd
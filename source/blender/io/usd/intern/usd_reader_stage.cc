@@ -0,0 +1,216 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+#include "usd_reader_stage.h"
+#include "usd_reader_camera.h"
+#include "usd_reader_light.h"
+#include "usd_reader_mesh.h"
+#include "usd_reader_xform.h"
+
+#include <iostream>
+
+#include <pxr/usd/usdGeom/camera.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/metrics.h>
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/usd/usdGeom/xformable.h>
+#include <pxr/usd/usdLux/light.h>
+
+#include "BKE_lib_id.h"
+#include "BKE_object.h"
+
+#include "BLI_index_range.hh"
+#include "BLI_math_base.h"
+#include "BLI_math_matrix.h"
+#include "BLI_task.hh"
+
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+USDStageReader::USDStageReader(pxr::UsdStageRefPtr stage, const USDImportParams &import_params)
+    : stage_(stage), settings_{import_params, {{0.0f}}}
+{
+  /* Blender is Z-up, and its units are treated as meters. */
+  unit_m4(settings_.conversion_mat);
+  if (pxr::UsdGeomGetStageUpAxis(stage_) == pxr::UsdGeomTokens->y) {
+    rotate_m4(settings_.conversion_mat, 'X', static_cast<float>(M_PI_2));
+  }
+  const float scale = import_params.scale *
+                      static_cast<float>(pxr::UsdGeomGetStageMetersPerUnit(stage_));
+  float scale_mat[4][4];
+  scale_m4_fl(scale_mat, scale);
+  mul_m4_m4m4(settings_.conversion_mat, scale_mat, settings_.conversion_mat);
+}
+
+USDStageReader::~USDStageReader()
+{
+  for (USDPrimReader *reader : readers_) {
+    delete reader;
+  }
+  for (const auto &item : prototype_readers_) {
+    for (USDPrimReader *reader : item.second) {
+      delete reader;
+    }
+  }
+}
+
+const std::vector<Object *> &USDStageReader::objects() const
+{
+  return objects_;
+}
+
+USDPrimReader *USDStageReader::create_reader(const pxr::UsdPrim &prim)
+{
+  const USDImportParams &params = settings_.import_params;
+  if (params.import_meshes && prim.IsA<pxr::UsdGeomMesh>()) {
+    return new USDMeshReader(prim, settings_);
+  }
+  if (params.import_cameras && prim.IsA<pxr::UsdGeomCamera>()) {
+    return new USDCameraReader(prim, settings_);
+  }
+  if (params.import_lights && prim.IsA<pxr::UsdLuxLight>()) {
+    return new USDLightReader(prim, settings_);
+  }
+  /* Instances need an object to parent the objects of the prototype to. */
+  if (prim.IsA<pxr::UsdGeomXformable>() || prim.IsInstance()) {
+    return new USDXformReader(prim, settings_);
+  }
+  /* Other prims (e.g. scopes) don't get an object, their children are parented to the closest
+   * ancestor with an object. */
+  return nullptr;
+}
+
+void USDStageReader::collect_readers(const pxr::UsdPrim &prim,
+                                     USDPrimReader *parent_reader,
+                                     std::vector<USDPrimReader *> &r_readers)
+{
+  for (const pxr::UsdPrim &child : prim.GetChildren()) {
+    USDPrimReader *reader = create_reader(child);
+    if (reader != nullptr) {
+      reader->set_parent_reader(parent_reader);
+      r_readers.push_back(reader);
+    }
+    /* The children of instances are in their prototype, which is read separately. */
+    if (!child.IsInstance()) {
+      collect_readers(child, reader != nullptr ? reader : parent_reader, r_readers);
+    }
+  }
+}
+
+void USDStageReader::collect_readers()
+{
+  collect_readers(stage_->GetPseudoRoot(), nullptr, readers_);
+  for (const pxr::UsdPrim &prototype : stage_->GetMasters()) {
+    collect_readers(prototype, nullptr, prototype_readers_[prototype.GetPath()]);
+  }
+}
+
+void USDStageReader::read_data(const pxr::UsdTimeCode time)
+{
+  std::vector<USDPrimReader *> all_readers = readers_;
+  for (const auto &item : prototype_readers_) {
+    all_readers.insert(all_readers.end(), item.second.begin(), item.second.end());
+  }
+
+  /* Reading a stage from multiple threads is supported by USD, and the readers don't touch Main
+   * here. Prototypes are only read once, no matter how often they are instanced. */
+  parallel_for(IndexRange(all_readers.size()), 1, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      all_readers[i]->read_data(time);
+    }
+  });
+}
+
+void USDStageReader::set_object_parent_and_transform(Object *ob,
+                                                     const USDPrimReader *reader,
+                                                     Object *parent,
+                                                     const pxr::UsdTimeCode time,
+                                                     const bool is_root)
+{
+  ob->parent = parent;
+
+  float local_mat[4][4];
+  reader->read_matrix(local_mat, time, is_root);
+  BKE_object_apply_mat4(ob, local_mat, false, false);
+
+  objects_.push_back(ob);
+}
+
+void USDStageReader::instantiate_prototype(Main *bmain,
+                                           const pxr::UsdPrim &prototype,
+                                           Object *instance_object,
+                                           const pxr::UsdTimeCode time)
+{
+  const auto readers = prototype_readers_.find(prototype.GetPath());
+  if (readers == prototype_readers_.end()) {
+    return;
+  }
+
+  /* The objects created for this instance, the readers are shared by all instances. */
+  std::map<const USDPrimReader *, Object *> instance_objects;
+  for (USDPrimReader *reader : readers->second) {
+    ID *data;
+    const auto existing_data = prototype_data_.find(reader);
+    if (existing_data == prototype_data_.end()) {
+      data = reader->create_data(bmain);
+      prototype_data_.emplace(reader, data);
+    }
+    else {
+      data = existing_data->second;
+      if (data != nullptr) {
+        id_us_plus(data);
+      }
+    }
+
+    Object *ob = reader->create_object(bmain, data);
+    Object *parent = reader->parent_reader() != nullptr ?
+                         instance_objects.at(reader->parent_reader()) :
+                         instance_object;
+    set_object_parent_and_transform(ob, reader, parent, time, false);
+    instance_objects.emplace(reader, ob);
+
+    if (reader->prim().IsInstance()) {
+      instantiate_prototype(bmain, reader->prim().GetMaster(), ob, time);
+    }
+  }
+}
+
+void USDStageReader::create_objects(Main *bmain, const pxr::UsdTimeCode time)
+{
+  for (USDPrimReader *reader : readers_) {
+    if (!reader->valid()) {
+      std::cerr << "USD import: invalid data in " << reader->prim().GetPath()
+                << ", importing it as an empty\n";
+    }
+    ID *data = reader->create_data(bmain);
+    Object *ob = reader->create_object(bmain, data);
+    const USDPrimReader *parent_reader = reader->parent_reader();
+    set_object_parent_and_transform(ob,
+                                    reader,
+                                    parent_reader != nullptr ? parent_reader->object() : nullptr,
+                                    time,
+                                    parent_reader == nullptr);
+
+    if (reader->prim().IsInstance()) {
+      instantiate_prototype(bmain, reader->prim().GetMaster(), ob, time);
+    }
+  }
+}
+
+}  // namespace blender::io::usd
@@ -0,0 +1,86 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+#include "usd.h"
+#include "usd_reader_prim.h"
+
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/stage.h>
+
+#include <map>
+#include <vector>
+
+struct ID;
+struct Main;
+struct Object;
+
+namespace blender::io::usd {
+
+/* Creates the readers for the prims of a stage, and the objects of those readers.
+ *
+ * Instanced prims share the prims below their prototype (called "master" in USD). These are
+ * read once, and their object data is shared by the objects created for every instance. */
+class USDStageReader {
+ private:
+  pxr::UsdStageRefPtr stage_;
+  USDImporterSettings settings_;
+
+  /* Readers of the prims in the scene hierarchy, parents before children. */
+  std::vector<USDPrimReader *> readers_;
+  /* Readers of the prims below the instance prototypes, by prototype path. */
+  std::map<pxr::SdfPath, std::vector<USDPrimReader *>> prototype_readers_;
+  /* The object data of prototype prims, shared by all instances. */
+  std::map<const USDPrimReader *, ID *> prototype_data_;
+
+  /* All created objects, parents before children. */
+  std::vector<Object *> objects_;
+
+ public:
+  USDStageReader(pxr::UsdStageRefPtr stage, const USDImportParams &import_params);
+  ~USDStageReader();
+
+  /* Create the readers for the prims of the stage and its instance prototypes. */
+  void collect_readers();
+
+  /* Convert the data of all prims, using multiple threads. */
+  void read_data(pxr::UsdTimeCode time);
+
+  /* Create the objects of all prims in Main, including the objects below instances. */
+  void create_objects(Main *bmain, pxr::UsdTimeCode time);
+
+  const std::vector<Object *> &objects() const;
+
+ private:
+  USDPrimReader *create_reader(const pxr::UsdPrim &prim);
+  void collect_readers(const pxr::UsdPrim &prim,
+                       USDPrimReader *parent_reader,
+                       std::vector<USDPrimReader *> &r_readers);
+  void instantiate_prototype(Main *bmain,
+                             const pxr::UsdPrim &prototype,
+                             Object *instance_object,
+                             pxr::UsdTimeCode time);
+  void set_object_parent_and_transform(Object *ob,
+                                       const USDPrimReader *reader,
+                                       Object *parent,
+                                       pxr::UsdTimeCode time,
+                                       bool is_root);
+};
+
+}  // namespace blender::io::usd
@@ -0,0 +1,161 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#include "testing/testing.h"
+
+#include <pxr/base/plug/registry.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/metrics.h>
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/usd/usdGeom/xform.h>
+
+#include "intern/usd_reader_stage.h"
+
+#include "BLI_float3.hh"
+#include "BLI_listbase.h"
+#include "BLI_path_util.h"
+
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+class USDImportTest : public testing::Test {
+ protected:
+  Main *bmain;
+  USDImportParams params;
+  pxr::UsdStageRefPtr stage;
+
+  void SetUp() override
+  {
+    const std::string &release_dir = blender::tests::flags_test_release_dir();
+    ASSERT_FALSE(release_dir.empty());
+
+    char usd_datafiles_dir[FILE_MAX];
+    BLI_path_join(usd_datafiles_dir,
+                  sizeof(usd_datafiles_dir),
+                  release_dir.c_str(),
+                  "datafiles",
+                  "usd",
+                  nullptr);
+    /* The trailing slash indicates to the USD library that the path is a directory. */
+    pxr::PlugRegistry::GetInstance().RegisterPlugins(std::string(usd_datafiles_dir) + "/");
+
+    BKE_idtype_init();
+    bmain = BKE_main_new();
+
+    params = USDImportParams{};
+    params.scale = 1.0f;
+    params.import_cameras = true;
+    params.import_lights = true;
+    params.import_meshes = true;
+    params.import_uvmaps = true;
+    params.import_normals = true;
+    params.validate_meshes = false;
+
+    stage = pxr::UsdStage::CreateInMemory();
+    pxr::UsdGeomSetStageUpAxis(stage, pxr::UsdGeomTokens->z);
+    pxr::UsdGeomSetStageMetersPerUnit(stage, 1.0);
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+  }
+
+  void define_quad(const pxr::SdfPath &path)
+  {
+    pxr::UsdGeomMesh mesh = pxr::UsdGeomMesh::Define(stage, path);
+    mesh.CreatePointsAttr().Set(pxr::VtVec3fArray{
+        {0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}});
+    mesh.CreateFaceVertexCountsAttr().Set(pxr::VtIntArray{4});
+    mesh.CreateFaceVertexIndicesAttr().Set(pxr::VtIntArray{0, 1, 2, 3});
+  }
+
+  /* Import the stage like #USD_import does, without adding the objects to a scene. */
+  std::vector<Object *> import_stage()
+  {
+    USDStageReader reader(stage, params);
+    reader.collect_readers();
+    reader.read_data(pxr::UsdTimeCode::EarliestTime());
+    reader.create_objects(bmain, pxr::UsdTimeCode::EarliestTime());
+    return reader.objects();
+  }
+};
+
+TEST_F(USDImportTest, mesh_with_parent)
+{
+  pxr::UsdGeomXform xform = pxr::UsdGeomXform::Define(stage, pxr::SdfPath("/root"));
+  xform.AddTranslateOp().Set(pxr::GfVec3d(1.0, 2.0, 3.0));
+  define_quad(pxr::SdfPath("/root/quad"));
+
+  const std::vector<Object *> objects = import_stage();
+  ASSERT_EQ(objects.size(), 2);
+
+  Object *ob_root = objects[0];
+  Object *ob_quad = objects[1];
+  EXPECT_STREQ(ob_root->id.name + 2, "root");
+  EXPECT_EQ(ob_root->type, OB_EMPTY);
+  EXPECT_V3_NEAR(ob_root->loc, float3(1.0f, 2.0f, 3.0f), 1e-6f);
+
+  EXPECT_STREQ(ob_quad->id.name + 2, "quad");
+  EXPECT_EQ(ob_quad->type, OB_MESH);
+  EXPECT_EQ(ob_quad->parent, ob_root);
+  EXPECT_V3_NEAR(ob_quad->loc, float3(0.0f, 0.0f, 0.0f), 1e-6f);
+
+  const Mesh *mesh = static_cast<const Mesh *>(ob_quad->data);
+  ASSERT_NE(mesh, nullptr);
+  EXPECT_EQ(mesh->totvert, 4);
+  EXPECT_EQ(mesh->totedge, 4);
+  EXPECT_EQ(mesh->totpoly, 1);
+  EXPECT_EQ(mesh->totloop, 4);
+  EXPECT_V3_NEAR(mesh->mvert[2].co, float3(1.0f, 1.0f, 0.0f), 1e-6f);
+  EXPECT_EQ(BLI_listbase_count(&bmain->meshes), 1);
+}
+
+TEST_F(USDImportTest, instances_share_data)
+{
+  /* A class prim is not part of the scene itself, only of the instances referencing it. */
+  stage->CreateClassPrim(pxr::SdfPath("/proto"));
+  define_quad(pxr::SdfPath("/proto/quad"));
+  for (const char *path : {"/instance_a", "/instance_b"}) {
+    pxr::UsdPrim prim = pxr::UsdGeomXform::Define(stage, pxr::SdfPath(path)).GetPrim();
+    prim.GetReferences().AddInternalReference(pxr::SdfPath("/proto"));
+    prim.SetInstanceable(true);
+  }
+
+  const std::vector<Object *> objects = import_stage();
+  ASSERT_EQ(objects.size(), 4);
+
+  /* Every instance gets its own objects, the mesh is only read once. */
+  Object *ob_quad_a = objects[1];
+  Object *ob_quad_b = objects[3];
+  EXPECT_EQ(ob_quad_a->parent, objects[0]);
+  EXPECT_EQ(ob_quad_b->parent, objects[2]);
+  EXPECT_EQ(ob_quad_a->type, OB_MESH);
+  EXPECT_EQ(ob_quad_a->data, ob_quad_b->data);
+  EXPECT_EQ(BLI_listbase_count(&bmain->meshes), 1);
+  EXPECT_EQ(static_cast<ID *>(ob_quad_a->data)->us, 2);
+}
+
+}  // namespace blender::io::usd
@@ -39,13 +39,24 @@ struct USDExportParams {
   enum eEvaluationMode evaluation_mode;
 };
 
-/* The USD_export takes a as_background_job parameter, and returns a boolean.
+struct USDImportParams {
+  float scale;
+  bool import_cameras;
+  bool import_lights;
+  bool import_meshes;
+  bool import_uvmaps;
+  bool import_normals;
+  bool validate_meshes;
+};
+
+/* The USD_export and USD_import functions take a as_background_job parameter, and return a
+ * boolean.
  *
  * When as_background_job=true, returns false immediately after scheduling
  * a background job.
  *
- * When as_background_job=false, performs the export synchronously, and returns
- * true when the export was ok, and false if there were any errors.
+ * When as_background_job=false, performs the export or import synchronously, and returns
+ * true when it was ok, and false if there were any errors.
  */
 
 bool USD_export(struct bContext *C,
@@ -53,6 +64,11 @@ bool USD_export(struct bContext *C,
                 const struct USDExportParams *params,
                 bool as_background_job);
 
+bool USD_import(struct bContext *C,
+                const char *filepath,
+                const struct USDImportParams *params,
+                bool as_background_job);
+
 int USD_get_version(void);
 
 #ifdef __cplusplus
@@ -0,0 +1,44 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include "BKE_context.h"
+
+#include "DEG_depsgraph.h"
+
+#include "IO_wavefront_obj.h"
+
+#include "exporter/obj_exporter.hh"
+#include "importer/obj_importer.hh"
+
+using namespace blender::io::obj;
+
+bool OBJ_import(bContext *C, const OBJImportParams *import_params)
+{
+  Main *bmain = CTX_data_main(C);
+  Scene *scene = CTX_data_scene(C);
+  ViewLayer *view_layer = CTX_data_view_layer(C);
+  return importer_main(bmain, scene, view_layer, *import_params);
+}
+
+bool OBJ_export(bContext *C, const OBJExportParams *export_params)
+{
+  Depsgraph *depsgraph = CTX_data_ensure_evaluated_depsgraph(C);
+  return exporter_main(depsgraph, *export_params);
+}
@@ -0,0 +1,68 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#pragma once
+
+#include "BLI_utildefines.h"
+
+#include "IO_orientation.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct bContext;
+
+struct OBJExportParams {
+  /** Full path to the destination .OBJ file. */
+  char filepath[1024]; /* FILE_MAX */
+
+  /** Only export the selected objects. */
+  bool export_selected_objects;
+  /** Export the evaluated meshes, otherwise the meshes without modifiers. */
+  bool apply_modifiers;
+  bool export_uv;
+  bool export_normals;
+  /** Write material assignments, and the materials in a .MTL file next to the .OBJ file. */
+  bool export_materials;
+
+  eIOAxis forward_axis;
+  eIOAxis up_axis;
+  float scaling_factor;
+};
+
+struct OBJImportParams {
+  /** Full path to the source .OBJ file. */
+  char filepath[1024]; /* FILE_MAX */
+
+  eIOAxis forward_axis;
+  eIOAxis up_axis;
+  /** Check the created meshes for invalid data (e.g. from broken files), at some cost. */
+  bool validate_meshes;
+};
+
+/* Both return true on success, errors are printed to the console. */
+
+bool OBJ_import(struct bContext *C, const struct OBJImportParams *import_params);
+bool OBJ_export(struct bContext *C, const struct OBJExportParams *export_params);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,243 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <algorithm>
+#include <cstdio>
+
+#include "BLI_fileops.h"
+#include "BLI_math_base.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_vector_set.hh"
+
+#include "DNA_material_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_blender_version.h"
+
+#include "IO_block_writer.hh"
+
+#include "obj_export_file_writer.hh"
+
+namespace blender::io::obj {
+
+/** Number of lines formatted by one task. */
+static const int64_t lines_per_block = 32768;
+/** Offsets of the (zero based) indices of a mesh into the elements of the whole file. */
+struct MeshOffsets {
+  int vert;
+  int uv;
+  int normal;
+};
+
+/** Names are written up to the end of the line, but most readers stop at white-space. */
+static std::string name_for_obj(const char *name)
+{
+  std::string result = name;
+  std::replace(result.begin(), result.end(), ' ', '_');
+  return result;
+}
+
+static std::string material_name(const Material *ma)
+{
+  return (ma != nullptr) ? name_for_obj(ma->id.name + 2) : "None";
+}
+
+static void format_faces(const OBJMesh &obj_mesh,
+                         const MeshOffsets &offsets,
+                         const bool export_materials,
+                         const IndexRange poly_range,
+                         std::string &r_text)
+{
+  const Mesh *mesh = obj_mesh.mesh;
+  const bool has_uvs = !obj_mesh.loop_uv_indices.is_empty();
+  const bool has_normals = !obj_mesh.loop_normal_indices.is_empty();
+  const bool write_materials = export_materials && !obj_mesh.materials.is_empty();
+
+  for (const int poly_index : poly_range) {
+    const MPoly &mpoly = mesh->mpoly[poly_index];
+    /* State changes are detected from the previous face, also at the start of a block. */
+    const MPoly *mpoly_prev = (poly_index > 0) ? &mesh->mpoly[poly_index - 1] : nullptr;
+
+    const bool smooth = mpoly.flag & ME_SMOOTH;
+    if (mpoly_prev == nullptr || smooth != (bool)(mpoly_prev->flag & ME_SMOOTH)) {
+      r_text += smooth ? "s 1\n" : "s off\n";
+    }
+    if (write_materials && (mpoly_prev == nullptr || mpoly_prev->mat_nr != mpoly.mat_nr)) {
+      const int slot = std::min((int)mpoly.mat_nr, (int)obj_mesh.materials.size() - 1);
+      r_text += "usemtl " + material_name(obj_mesh.materials[slot]) + "\n";
+    }
+
+    r_text += 'f';
+    for (const int loop_index : IndexRange(mpoly.loopstart, mpoly.totloop)) {
+      const int vert = offsets.vert + (int)mesh->mloop[loop_index].v + 1;
+      if (has_uvs && has_normals) {
+        append_format(r_text,
+                      " %d/%d/%d",
+                      vert,
+                      offsets.uv + obj_mesh.loop_uv_indices[loop_index] + 1,
+                      offsets.normal + obj_mesh.loop_normal_indices[loop_index] + 1);
+      }
+      else if (has_uvs) {
+        append_format(
+            r_text, " %d/%d", vert, offsets.uv + obj_mesh.loop_uv_indices[loop_index] + 1);
+      }
+      else if (has_normals) {
+        append_format(
+            r_text, " %d//%d", vert, offsets.normal + obj_mesh.loop_normal_indices[loop_index] + 1);
+      }
+      else {
+        append_format(r_text, " %d", vert);
+      }
+    }
+    r_text += '\n';
+  }
+}
+
+static void add_mesh_blocks(const OBJMesh &obj_mesh,
+                            const MeshOffsets &offsets,
+                            const OBJExportParams &export_params,
+                            Vector<FormatBlockFn> &r_blocks)
+{
+  r_blocks.append(
+      [&](std::string &r_text) { r_text += "o " + name_for_obj(obj_mesh.name.c_str()) + "\n"; });
+
+  add_blocks(
+      obj_mesh.positions.size(),
+      lines_per_block,
+      [&](IndexRange range, std::string &r_text) {
+        for (const float3 &co : obj_mesh.positions.as_span().slice(range)) {
+          append_format(r_text, "v %.6f %.6f %.6f\n", co.x, co.y, co.z);
+        }
+      },
+      r_blocks);
+  add_blocks(
+      obj_mesh.uvs.size(),
+      lines_per_block,
+      [&](IndexRange range, std::string &r_text) {
+        for (const float2 &uv : obj_mesh.uvs.as_span().slice(range)) {
+          append_format(r_text, "vt %.6f %.6f\n", uv.x, uv.y);
+        }
+      },
+      r_blocks);
+  add_blocks(
+      obj_mesh.normals.size(),
+      lines_per_block,
+      [&](IndexRange range, std::string &r_text) {
+        for (const float3 &normal : obj_mesh.normals.as_span().slice(range)) {
+          append_format(r_text, "vn %.4f %.4f %.4f\n", normal.x, normal.y, normal.z);
+        }
+      },
+      r_blocks);
+
+  const bool export_materials = export_params.export_materials;
+  add_blocks(
+      obj_mesh.mesh->totpoly,
+      lines_per_block,
+      [&, offsets, export_materials](IndexRange range, std::string &r_text) {
+        format_faces(obj_mesh, offsets, export_materials, range, r_text);
+      },
+      r_blocks);
+
+  if (!obj_mesh.loose_edges.is_empty()) {
+    r_blocks.append([&, offsets](std::string &r_text) {
+      for (const std::array<int, 2> &edge : obj_mesh.loose_edges) {
+        append_format(
+            r_text, "l %d %d\n", offsets.vert + edge[0] + 1, offsets.vert + edge[1] + 1);
+      }
+    });
+  }
+}
+
+static bool write_mtl_file(const char *filepath, Span<const Material *> materials)
+{
+  FILE *file = BLI_fopen(filepath, "wb");
+  if (file == nullptr) {
+    fprintf(stderr, "OBJ export: cannot open '%s' for writing\n", filepath);
+    return false;
+  }
+  fprintf(file, "# Blender %s MTL File\n", BKE_blender_version_string());
+  for (const Material *ma : materials) {
+    /* Inverse of the mapping used on import. */
+    const float Ns = square_f(1.0f - ma->roughness) * 1000.0f;
+    fprintf(file, "\nnewmtl %s\n", material_name(ma).c_str());
+    fprintf(file, "Ns %.6f\n", Ns);
+    fprintf(file, "Kd %.6f %.6f %.6f\n", ma->r, ma->g, ma->b);
+    fprintf(file, "Ks %.6f %.6f %.6f\n", ma->specr, ma->specg, ma->specb);
+    fprintf(file, "d %.6f\n", ma->a);
+    fprintf(file, "illum 2\n");
+  }
+  const bool ok = !ferror(file);
+  fclose(file);
+  return ok;
+}
+
+bool write_obj_file(Span<OBJMesh> obj_meshes, const OBJExportParams &export_params)
+{
+  VectorSet<const Material *> materials;
+  if (export_params.export_materials) {
+    for (const OBJMesh &obj_mesh : obj_meshes) {
+      for (const Material *ma : obj_mesh.materials) {
+        if (ma != nullptr) {
+          materials.add(ma);
+        }
+      }
+    }
+  }
+
+  FILE *file = BLI_fopen(export_params.filepath, "wb");
+  if (file == nullptr) {
+    fprintf(stderr, "OBJ export: cannot open '%s' for writing\n", export_params.filepath);
+    return false;
+  }
+  fprintf(file, "# Blender %s\n# www.blender.org\n", BKE_blender_version_string());
+
+  char mtl_filepath[FILE_MAX];
+  if (!materials.is_empty()) {
+    BLI_strncpy(mtl_filepath, export_params.filepath, sizeof(mtl_filepath));
+    BLI_path_extension_replace(mtl_filepath, sizeof(mtl_filepath), ".mtl");
+    fprintf(file, "mtllib %s\n", BLI_path_basename(mtl_filepath));
+  }
+
+  Vector<FormatBlockFn> blocks;
+  MeshOffsets offsets = {0, 0, 0};
+  for (const OBJMesh &obj_mesh : obj_meshes) {
+    add_mesh_blocks(obj_mesh, offsets, export_params, blocks);
+    offsets.vert += (int)obj_mesh.positions.size();
+    offsets.uv += (int)obj_mesh.uvs.size();
+    offsets.normal += (int)obj_mesh.normals.size();
+  }
+
+  write_blocks(file, blocks);
+
+  bool ok = !ferror(file);
+  fclose(file);
+  if (!ok) {
+    fprintf(stderr, "OBJ export: error writing '%s'\n", export_params.filepath);
+    return false;
+  }
+  if (!materials.is_empty()) {
+    ok = write_mtl_file(mtl_filepath, materials);
+  }
+  return ok;
+}
+
+}  // namespace blender::io::obj
@@ -0,0 +1,35 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#pragma once
+
+#include "BLI_span.hh"
+
+#include "obj_export_mesh.hh"
+
+namespace blender::io::obj {
+
+/**
+ * Write the prepared meshes to the OBJ file of \a export_params, and their materials to an MTL
+ * file next to it. The text is formatted by multiple threads in blocks that are written in order.
+ */
+bool write_obj_file(Span<OBJMesh> obj_meshes, const OBJExportParams &export_params);
+
+}  // namespace blender::io::obj
@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include "BLI_map.hh"
+#include "BLI_math_vector.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_mesh.h"
+
+#include "obj_export_mesh.hh"
+
+namespace blender::io::obj {
+
+static void prepare_positions(OBJMesh &obj_mesh)
+{
+  const Mesh *mesh = obj_mesh.mesh;
+  obj_mesh.positions.resize(mesh->totvert);
+  for (const int i : IndexRange(mesh->totvert)) {
+    obj_mesh.positions[i] = obj_mesh.matrix * float3(mesh->mvert[i].co);
+  }
+}
+
+/** UV coordinates are shared by the loops of a vertex that use the same coordinates. */
+struct VertUV {
+  int vert;
+  float2 uv;
+
+  uint64_t hash() const
+  {
+    return uv.hash() ^ (uint64_t)vert;
+  }
+
+  friend bool operator==(const VertUV &a, const VertUV &b)
+  {
+    return a.vert == b.vert && a.uv == b.uv;
+  }
+};
+
+static void prepare_uvs(OBJMesh &obj_mesh)
+{
+  const Mesh *mesh = obj_mesh.mesh;
+  const MLoopUV *mloopuv = (const MLoopUV *)CustomData_get_layer(&mesh->ldata, CD_MLOOPUV);
+  if (mloopuv == nullptr) {
+    return;
+  }
+  obj_mesh.loop_uv_indices.reinitialize(mesh->totloop);
+  Map<VertUV, int> uv_indices;
+  for (const int i : IndexRange(mesh->totloop)) {
+    const VertUV key = {(int)mesh->mloop[i].v, mloopuv[i].uv};
+    obj_mesh.loop_uv_indices[i] = uv_indices.lookup_or_add_cb(key, [&]() {
+      obj_mesh.uvs.append(key.uv);
+      return (int)obj_mesh.uvs.size() - 1;
+    });
+  }
+}
+
+/**
+ * Use the custom normals of the mesh when it has them (e.g. from auto smooth), otherwise the
+ * vertex normals for smooth faces and the face normals for flat ones.
+ */
+static void prepare_normals(OBJMesh &obj_mesh)
+{
+  const Mesh *mesh = obj_mesh.mesh;
+  const float(*loop_normals)[3] = (const float(*)[3])CustomData_get_layer(&mesh->ldata,
+                                                                            CD_NORMAL);
+  const float4x4 normal_matrix = obj_mesh.matrix.inverted_transposed_affine();
+  obj_mesh.loop_normal_indices.reinitialize(mesh->totloop);
+  Map<float3, int> normal_indices;
+  for (const int poly_index : IndexRange(mesh->totpoly)) {
+    const MPoly &mpoly = mesh->mpoly[poly_index];
+    float3 poly_normal(0.0f);
+    if (loop_normals == nullptr && !(mpoly.flag & ME_SMOOTH)) {
+      BKE_mesh_calc_poly_normal(&mpoly, &mesh->mloop[mpoly.loopstart], mesh->mvert, poly_normal);
+    }
+    for (const int loop_index : IndexRange(mpoly.loopstart, mpoly.totloop)) {
+      float3 normal;
+      if (loop_normals != nullptr) {
+        normal = loop_normals[loop_index];
+      }
+      else if (mpoly.flag & ME_SMOOTH) {
+        normal_short_to_float_v3(normal, mesh->mvert[mesh->mloop[loop_index].v].no);
+      }
+      else {
+        normal = poly_normal;
+      }
+      normal = (normal_matrix.ref_3x3() * normal).normalized();
+      obj_mesh.loop_normal_indices[loop_index] = normal_indices.lookup_or_add_cb(normal, [&]() {
+        obj_mesh.normals.append(normal);
+        return (int)obj_mesh.normals.size() - 1;
+      });
+    }
+  }
+}
+
+static void prepare_loose_edges(OBJMesh &obj_mesh)
+{
+  const Mesh *mesh = obj_mesh.mesh;
+  Array<bool> edge_used(mesh->totedge, false);
+  for (const int i : IndexRange(mesh->totloop)) {
+    edge_used[mesh->mloop[i].e] = true;
+  }
+  for (const int i : IndexRange(mesh->totedge)) {
+    if (!edge_used[i]) {
+      obj_mesh.loose_edges.append({(int)mesh->medge[i].v1, (int)mesh->medge[i].v2});
+    }
+  }
+}
+
+void obj_mesh_prepare(OBJMesh &obj_mesh, const OBJExportParams &export_params)
+{
+  prepare_positions(obj_mesh);
+  if (export_params.export_uv) {
+    prepare_uvs(obj_mesh);
+  }
+  if (export_params.export_normals) {
+    prepare_normals(obj_mesh);
+  }
+  prepare_loose_edges(obj_mesh);
+}
+
+}  // namespace blender::io::obj
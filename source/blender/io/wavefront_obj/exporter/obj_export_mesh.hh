@@ -0,0 +1,67 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "BLI_array.hh"
+#include "BLI_float2.hh"
+#include "BLI_float3.hh"
+#include "BLI_float4x4.hh"
+#include "BLI_vector.hh"
+
+#include "IO_wavefront_obj.h"
+
+struct Material;
+struct Mesh;
+
+namespace blender::io::obj {
+
+/** A mesh to export, with its data in the layout of the OBJ format once it is prepared. */
+struct OBJMesh {
+  std::string name;
+  const Mesh *mesh;
+  /** World matrix of the object, including the axis conversion and scale of the export. */
+  float4x4 matrix;
+  /** Materials by slot, null for empty slots. */
+  Vector<const Material *> materials;
+
+  /* Filled by #obj_mesh_prepare. */
+
+  Vector<float3> positions;
+  /** Unique UV coordinates per vertex and the index into them for every loop. */
+  Vector<float2> uvs;
+  Array<int> loop_uv_indices;
+  /** Unique normals and the index into them for every loop. */
+  Vector<float3> normals;
+  Array<int> loop_normal_indices;
+  /** Edges that are not used by faces, as vertex indices. */
+  Vector<std::array<int, 2>> loose_edges;
+};
+
+/**
+ * Compute the transformed positions, de-duplicated UVs and normals and the loose edges of
+ * \a obj_mesh. Only reads the mesh, so multiple meshes can be prepared in parallel.
+ */
+void obj_mesh_prepare(OBJMesh &obj_mesh, const OBJExportParams &export_params);
+
+}  // namespace blender::io::obj
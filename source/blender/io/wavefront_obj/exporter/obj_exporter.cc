@@ -0,0 +1,69 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <cstdio>
+
+#include "BLI_task.hh"
+
+#include "IO_mesh_utils.hh"
+
+#include "obj_export_file_writer.hh"
+#include "obj_export_mesh.hh"
+#include "obj_exporter.hh"
+
+namespace blender::io::obj {
+
+static Vector<OBJMesh> collect_obj_meshes(Depsgraph *depsgraph,
+                                          const OBJExportParams &export_params)
+{
+  const float4x4 axes_mat = axis_conversion_matrix(IO_AXIS_Y,
+                                                   IO_AXIS_Z,
+                                                   export_params.forward_axis,
+                                                   export_params.up_axis,
+                                                   export_params.scaling_factor);
+  Vector<OBJMesh> obj_meshes;
+  for (ExportMesh &export_mesh : gather_export_meshes(
+           depsgraph, export_params.export_selected_objects, export_params.apply_modifiers)) {
+    OBJMesh obj_mesh;
+    obj_mesh.name = std::move(export_mesh.name);
+    obj_mesh.mesh = export_mesh.mesh;
+    obj_mesh.matrix = axes_mat * export_mesh.world_matrix;
+    obj_mesh.materials = std::move(export_mesh.materials);
+    obj_meshes.append(std::move(obj_mesh));
+  }
+  return obj_meshes;
+}
+
+bool exporter_main(Depsgraph *depsgraph, const OBJExportParams &export_params)
+{
+  Vector<OBJMesh> obj_meshes = collect_obj_meshes(depsgraph, export_params);
+  if (obj_meshes.is_empty()) {
+    fprintf(stderr, "OBJ export: no mesh objects to export\n");
+    return false;
+  }
+  parallel_for(obj_meshes.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      obj_mesh_prepare(obj_meshes[i], export_params);
+    }
+  });
+  return write_obj_file(obj_meshes, export_params);
+}
+
+}  // namespace blender::io::obj
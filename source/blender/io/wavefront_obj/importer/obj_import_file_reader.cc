@@ -0,0 +1,447 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include "BLI_array.hh"
+#include "BLI_index_range.hh"
+#include "BLI_task.hh"
+
+#include "obj_import_file_reader.hh"
+#include "IO_string_utils.hh"
+
+namespace blender::io::obj {
+
+/** Text size parsed by one thread. */
+static const int64_t chunk_size = 256 * 1024;
+
+enum class ElementType {
+  Vertex,
+  UV,
+  Normal,
+  Face,
+  Line,
+  Object,
+  UseMaterial,
+  Smooth,
+  MaterialLibrary,
+  /** Comments, groups and statements that are not supported. */
+  Other,
+};
+
+static ElementType parse_element_type(StringRef line, StringRef &r_rest)
+{
+  line = drop_whitespace(line);
+  const StringRef rest = drop_non_whitespace(line);
+  const StringRef keyword = line.substr(0, rest.data() - line.data());
+  r_rest = rest;
+  if (keyword == "v") {
+    return ElementType::Vertex;
+  }
+  if (keyword == "vt") {
+    return ElementType::UV;
+  }
+  if (keyword == "vn") {
+    return ElementType::Normal;
+  }
+  if (keyword == "f") {
+    return ElementType::Face;
+  }
+  if (keyword == "l") {
+    return ElementType::Line;
+  }
+  if (keyword == "o") {
+    return ElementType::Object;
+  }
+  if (keyword == "usemtl") {
+    return ElementType::UseMaterial;
+  }
+  if (keyword == "s") {
+    return ElementType::Smooth;
+  }
+  if (keyword == "mtllib") {
+    return ElementType::MaterialLibrary;
+  }
+  return ElementType::Other;
+}
+
+/**
+ * A change of the state that applies to the following faces. Chunks don't know the state at
+ * their start, so changes are only resolved when merging the chunks in order.
+ */
+struct StateChange {
+  bool new_object = false;
+  std::string object_name;
+  bool set_material = false;
+  std::string material_name;
+  /** -1 when unchanged. */
+  int smooth = -1;
+};
+
+struct ChunkFace {
+  int corner_start;
+  int corner_count;
+  /** Index of the last #StateChange before the face, -1 when there is none in the chunk. */
+  int state_index;
+};
+
+struct ChunkEdge {
+  std::array<int, 2> verts;
+  int state_index;
+};
+
+struct Chunk {
+  StringRef text;
+
+  /* Number of vertex elements in the chunk, and in all previous chunks. */
+  int vert_count = 0;
+  int uv_count = 0;
+  int normal_count = 0;
+  int vert_start = 0;
+  int uv_start = 0;
+  int normal_start = 0;
+
+  Vector<StateChange> state_changes;
+  Vector<ChunkFace> faces;
+  Vector<FaceCorner> corners;
+  Vector<ChunkEdge> edges;
+  Vector<std::string> mtl_libraries;
+};
+
+static Vector<Chunk> split_in_chunks(const StringRef text)
+{
+  Vector<Chunk> chunks;
+  int64_t start = 0;
+  while (start < text.size()) {
+    int64_t end = start + chunk_size;
+    end = (end >= text.size()) ? text.size() : find_line_end(text, end);
+    Chunk chunk;
+    chunk.text = text.substr(start, end - start);
+    chunks.append(std::move(chunk));
+    start = end;
+  }
+  return chunks;
+}
+
+static void count_vertex_elements(Chunk &chunk)
+{
+  StringRef buffer = chunk.text;
+  while (!buffer.is_empty()) {
+    const StringRef line = read_next_line(buffer);
+    StringRef rest;
+    switch (parse_element_type(line, rest)) {
+      case ElementType::Vertex:
+        chunk.vert_count++;
+        break;
+      case ElementType::UV:
+        chunk.uv_count++;
+        break;
+      case ElementType::Normal:
+        chunk.normal_count++;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+/**
+ * Convert a one-based or negative (relative to the \a count elements read so far) index of the
+ * file to a zero-based index, -1 when it is invalid.
+ */
+static int resolve_index(const int index, const int count)
+{
+  if (index > 0) {
+    return index - 1;
+  }
+  if (index < 0 && count + index >= 0) {
+    return count + index;
+  }
+  return -1;
+}
+
+static void parse_face(StringRef rest,
+                       const int vert_count,
+                       const int uv_count,
+                       const int normal_count,
+                       Chunk &chunk)
+{
+  ChunkFace face;
+  face.corner_start = (int)chunk.corners.size();
+  face.state_index = (int)chunk.state_changes.size() - 1;
+
+  while (true) {
+    rest = drop_whitespace(rest);
+    if (rest.is_empty()) {
+      break;
+    }
+    int index;
+    const StringRef after_vert = parse_int(rest, 0, index, false);
+    if (after_vert.data() == rest.data()) {
+      /* Not an index, skip it. */
+      rest = drop_non_whitespace(rest);
+      continue;
+    }
+    rest = after_vert;
+    FaceCorner corner = {resolve_index(index, vert_count), -1, -1};
+    if (!rest.is_empty() && rest[0] == '/') {
+      rest = rest.drop_prefix(1);
+      if (!rest.is_empty() && rest[0] != '/') {
+        rest = parse_int(rest, 0, index, false);
+        corner.uv_index = resolve_index(index, uv_count);
+      }
+      if (!rest.is_empty() && rest[0] == '/') {
+        rest = parse_int(rest.drop_prefix(1), 0, index, false);
+        corner.normal_index = resolve_index(index, normal_count);
+      }
+    }
+    chunk.corners.append(corner);
+  }
+
+  face.corner_count = (int)chunk.corners.size() - face.corner_start;
+  if (face.corner_count > 0) {
+    chunk.faces.append(face);
+  }
+}
+
+static void parse_line_element(StringRef rest, const int vert_count, Chunk &chunk)
+{
+  const int state_index = (int)chunk.state_changes.size() - 1;
+  int prev_vert = -1;
+  while (true) {
+    rest = drop_whitespace(rest);
+    if (rest.is_empty()) {
+      break;
+    }
+    int index;
+    const bool is_index = parse_int(rest, 0, index, false).data() != rest.data();
+    /* Skip the UV index of the vertex as well. */
+    rest = drop_non_whitespace(rest);
+    if (!is_index) {
+      continue;
+    }
+    const int vert = resolve_index(index, vert_count);
+    if (prev_vert != -1 && vert != -1 && vert != prev_vert) {
+      chunk.edges.append({{prev_vert, vert}, state_index});
+    }
+    prev_vert = vert;
+  }
+}
+
+static void parse_chunk(Chunk &chunk, GlobalVertices &vertices)
+{
+  int vert_count = chunk.vert_start;
+  int uv_count = chunk.uv_start;
+  int normal_count = chunk.normal_start;
+
+  StringRef buffer = chunk.text;
+  while (!buffer.is_empty()) {
+    const StringRef line = read_next_line(buffer);
+    StringRef rest;
+    switch (parse_element_type(line, rest)) {
+      case ElementType::Vertex: {
+        parse_floats(rest, 0.0f, vertices.positions[vert_count++], 3);
+        break;
+      }
+      case ElementType::UV: {
+        parse_floats(rest, 0.0f, vertices.uvs[uv_count++], 2);
+        break;
+      }
+      case ElementType::Normal: {
+        parse_floats(rest, 0.0f, vertices.normals[normal_count++], 3);
+        break;
+      }
+      case ElementType::Face: {
+        parse_face(rest, vert_count, uv_count, normal_count, chunk);
+        break;
+      }
+      case ElementType::Line: {
+        parse_line_element(rest, vert_count, chunk);
+        break;
+      }
+      case ElementType::Object: {
+        StateChange change;
+        change.new_object = true;
+        change.object_name = strip_whitespace(rest);
+        chunk.state_changes.append(std::move(change));
+        break;
+      }
+      case ElementType::UseMaterial: {
+        StateChange change;
+        change.set_material = true;
+        change.material_name = strip_whitespace(rest);
+        chunk.state_changes.append(std::move(change));
+        break;
+      }
+      case ElementType::Smooth: {
+        const StringRef value = strip_whitespace(rest);
+        StateChange change;
+        change.smooth = (value == "off" || value == "0") ? 0 : 1;
+        chunk.state_changes.append(std::move(change));
+        break;
+      }
+      case ElementType::MaterialLibrary: {
+        chunk.mtl_libraries.append(strip_whitespace(rest));
+        break;
+      }
+      case ElementType::Other:
+        break;
+    }
+  }
+}
+
+/** State of the faces while merging the chunks. */
+struct MergeState {
+  Geometry *geometry = nullptr;
+  std::string material_name;
+  bool smooth = false;
+};
+
+static void merge_chunk(const Chunk &chunk, MergeState &state, OBJData &r_data)
+{
+  /* The state at the start of the chunk, followed by the state after each of its changes. */
+  Array<MergeState> states(chunk.state_changes.size() + 1);
+  states[0] = state;
+  for (const int i : chunk.state_changes.index_range()) {
+    const StateChange &change = chunk.state_changes[i];
+    if (change.new_object) {
+      r_data.geometries.append(std::make_unique<Geometry>());
+      state.geometry = r_data.geometries.last().get();
+      state.geometry->name = change.object_name;
+    }
+    if (change.set_material) {
+      state.material_name = change.material_name;
+    }
+    if (change.smooth != -1) {
+      state.smooth = change.smooth == 1;
+    }
+    states[i + 1] = state;
+  }
+
+  for (const ChunkFace &chunk_face : chunk.faces) {
+    const MergeState &face_state = states[chunk_face.state_index + 1];
+    Geometry &geometry = *face_state.geometry;
+    FaceElem face;
+    face.corner_start = (int)geometry.face_corners.size();
+    face.corner_count = chunk_face.corner_count;
+    face.material_index = -1;
+    if (!face_state.material_name.empty()) {
+      geometry.material_names.add(face_state.material_name);
+      face.material_index = (int)geometry.material_names.index_of(face_state.material_name);
+    }
+    face.shaded_smooth = face_state.smooth;
+    geometry.faces.append(face);
+    geometry.face_corners.extend(
+        chunk.corners.as_span().slice(chunk_face.corner_start, chunk_face.corner_count));
+  }
+  for (const ChunkEdge &chunk_edge : chunk.edges) {
+    Geometry &geometry = *states[chunk_edge.state_index + 1].geometry;
+    geometry.edges.append(chunk_edge.verts);
+  }
+  for (const std::string &library : chunk.mtl_libraries) {
+    r_data.mtl_libraries.append(library);
+  }
+}
+
+void parse_obj(const StringRef text, OBJData &r_data)
+{
+  Vector<Chunk> chunks = split_in_chunks(text);
+
+  parallel_for(chunks.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      count_vertex_elements(chunks[i]);
+    }
+  });
+
+  int vert_count = 0;
+  int uv_count = 0;
+  int normal_count = 0;
+  for (Chunk &chunk : chunks) {
+    chunk.vert_start = vert_count;
+    chunk.uv_start = uv_count;
+    chunk.normal_start = normal_count;
+    vert_count += chunk.vert_count;
+    uv_count += chunk.uv_count;
+    normal_count += chunk.normal_count;
+  }
+  GlobalVertices &vertices = r_data.vertices;
+  vertices.positions.resize(vert_count);
+  vertices.uvs.resize(uv_count);
+  vertices.normals.resize(normal_count);
+
+  parallel_for(chunks.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      parse_chunk(chunks[i], vertices);
+    }
+  });
+
+  /* Elements before the first `o` statement go to an unnamed geometry. */
+  r_data.geometries.append(std::make_unique<Geometry>());
+  MergeState state;
+  state.geometry = r_data.geometries.last().get();
+  for (const Chunk &chunk : chunks) {
+    merge_chunk(chunk, state, r_data);
+  }
+
+  Vector<std::unique_ptr<Geometry>> geometries;
+  for (std::unique_ptr<Geometry> &geometry : r_data.geometries) {
+    if (!geometry->faces.is_empty() || !geometry->edges.is_empty()) {
+      geometries.append(std::move(geometry));
+    }
+  }
+  /* Keep the vertices of files without faces or edges, as a mesh of loose vertices. */
+  if (geometries.is_empty() && vert_count > 0) {
+    geometries.append(std::move(r_data.geometries[0]));
+  }
+  r_data.geometries = std::move(geometries);
+}
+
+void parse_mtl(StringRef text, Map<std::string, MTLMaterial> &r_materials)
+{
+  MTLMaterial *material = nullptr;
+  while (!text.is_empty()) {
+    StringRef line = drop_whitespace(read_next_line(text));
+    const StringRef rest = drop_non_whitespace(line);
+    const StringRef keyword = line.substr(0, rest.data() - line.data());
+    if (keyword == "newmtl") {
+      material = &r_materials.lookup_or_add_default_as(strip_whitespace(rest));
+    }
+    else if (material == nullptr) {
+      continue;
+    }
+    else if (keyword == "Kd") {
+      parse_floats(rest, 0.8f, material->Kd, 3);
+    }
+    else if (keyword == "Ks") {
+      parse_floats(rest, 0.5f, material->Ks, 3);
+    }
+    else if (keyword == "Ns") {
+      parse_float(rest, 250.0f, material->Ns);
+    }
+    else if (keyword == "d") {
+      parse_float(rest, 1.0f, material->d);
+    }
+    else if (keyword == "Tr") {
+      float transparency;
+      parse_float(rest, 0.0f, transparency);
+      material->d = 1.0f - transparency;
+    }
+  }
+}
+
+}  // namespace blender::io::obj
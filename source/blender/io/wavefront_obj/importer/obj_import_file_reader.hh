@@ -0,0 +1,40 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#pragma once
+
+#include "BLI_string_ref.hh"
+
+#include "obj_import_objects.hh"
+
+namespace blender::io::obj {
+
+/**
+ * Parse the text of an OBJ file. Large files are split in chunks of lines that are parsed by
+ * multiple threads, writing the vertex data directly into the final arrays.
+ */
+void parse_obj(StringRef text, OBJData &r_data);
+
+/**
+ * Parse the text of an MTL file, adding its materials to \a r_materials.
+ */
+void parse_mtl(StringRef text, Map<std::string, MTLMaterial> &r_materials);
+
+}  // namespace blender::io::obj
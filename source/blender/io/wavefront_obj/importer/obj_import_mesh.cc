@@ -0,0 +1,192 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_mesh.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_base.h"
+
+#include "obj_import_mesh.hh"
+
+namespace blender::io::obj {
+
+static bool face_is_valid(const FaceElem &face,
+                          const Span<FaceCorner> corners,
+                          const int64_t verts_num)
+{
+  if (face.corner_count < 3) {
+    return false;
+  }
+  for (const FaceCorner &corner : corners.slice(face.corner_start, face.corner_count)) {
+    if (corner.vert_index < 0 || corner.vert_index >= verts_num) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void fill_mesh_from_geometry(Mesh *mesh,
+                             const Geometry &geometry,
+                             const GlobalVertices &vertices,
+                             const bool validate)
+{
+  const int64_t global_verts_num = vertices.positions.size();
+  const Span<FaceCorner> corners = geometry.face_corners;
+
+  Vector<int> valid_faces;
+  int loops_num = 0;
+  for (const int i : geometry.faces.index_range()) {
+    const FaceElem &face = geometry.faces[i];
+    if (face_is_valid(face, corners, global_verts_num)) {
+      valid_faces.append(i);
+      loops_num += face.corner_count;
+    }
+  }
+  Vector<std::array<int, 2>> valid_edges;
+  for (const std::array<int, 2> &edge : geometry.edges) {
+    if (edge[0] >= 0 && edge[0] < global_verts_num && edge[1] >= 0 &&
+        edge[1] < global_verts_num) {
+      valid_edges.append(edge);
+    }
+  }
+
+  /* Only use the vertices of the file that are used by this geometry. */
+  Map<int, int> global_to_local_vert;
+  Vector<int> local_to_global_vert;
+  auto add_vert = [&](const int global_vert) {
+    return global_to_local_vert.lookup_or_add_cb(global_vert, [&]() {
+      local_to_global_vert.append(global_vert);
+      return (int)local_to_global_vert.size() - 1;
+    });
+  };
+  if (valid_faces.is_empty() && valid_edges.is_empty()) {
+    for (const int i : vertices.positions.index_range()) {
+      local_to_global_vert.append(i);
+    }
+  }
+  else {
+    global_to_local_vert.reserve(loops_num);
+    for (const int face_index : valid_faces) {
+      const FaceElem &face = geometry.faces[face_index];
+      for (const FaceCorner &corner : corners.slice(face.corner_start, face.corner_count)) {
+        add_vert(corner.vert_index);
+      }
+    }
+    for (const std::array<int, 2> &edge : valid_edges) {
+      add_vert(edge[0]);
+      add_vert(edge[1]);
+    }
+  }
+
+  mesh->totvert = (int)local_to_global_vert.size();
+  mesh->totedge = (int)valid_edges.size();
+  mesh->totpoly = (int)valid_faces.size();
+  mesh->totloop = loops_num;
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+  CustomData_add_layer(&mesh->edata, CD_MEDGE, CD_CALLOC, nullptr, mesh->totedge);
+  CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+  BKE_mesh_update_customdata_pointers(mesh, false);
+
+  for (const int i : local_to_global_vert.index_range()) {
+    copy_v3_v3(mesh->mvert[i].co, vertices.positions[local_to_global_vert[i]]);
+  }
+
+  for (const int i : valid_edges.index_range()) {
+    MEdge &medge = mesh->medge[i];
+    medge.v1 = (uint)global_to_local_vert.lookup(valid_edges[i][0]);
+    medge.v2 = (uint)global_to_local_vert.lookup(valid_edges[i][1]);
+    medge.flag = ME_EDGEDRAW | ME_EDGERENDER;
+  }
+
+  bool has_uvs = false;
+  bool has_normals = false;
+  int loop_index = 0;
+  for (const int i : valid_faces.index_range()) {
+    const FaceElem &face = geometry.faces[valid_faces[i]];
+    MPoly &mpoly = mesh->mpoly[i];
+    mpoly.loopstart = loop_index;
+    mpoly.totloop = face.corner_count;
+    mpoly.mat_nr = (short)max_ii(face.material_index, 0);
+    if (face.shaded_smooth) {
+      mpoly.flag |= ME_SMOOTH;
+    }
+    for (const FaceCorner &corner : corners.slice(face.corner_start, face.corner_count)) {
+      mesh->mloop[loop_index++].v = (uint)global_to_local_vert.lookup(corner.vert_index);
+      has_uvs |= corner.uv_index >= 0 && corner.uv_index < vertices.uvs.size();
+      has_normals |= corner.normal_index >= 0 && corner.normal_index < vertices.normals.size();
+    }
+  }
+
+  BKE_mesh_calc_edges(mesh, true, false);
+  BKE_mesh_calc_edges_loose(mesh);
+
+  if (has_uvs) {
+    MLoopUV *mloopuv = (MLoopUV *)CustomData_add_layer_named(
+        &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop, "UVMap");
+    loop_index = 0;
+    for (const int face_index : valid_faces) {
+      const FaceElem &face = geometry.faces[face_index];
+      for (const FaceCorner &corner : corners.slice(face.corner_start, face.corner_count)) {
+        if (corner.uv_index >= 0 && corner.uv_index < vertices.uvs.size()) {
+          copy_v2_v2(mloopuv[loop_index].uv, vertices.uvs[corner.uv_index]);
+        }
+        loop_index++;
+      }
+    }
+    BKE_mesh_update_customdata_pointers(mesh, false);
+  }
+
+  BKE_mesh_calc_normals(mesh);
+
+  if (has_normals) {
+    /* Zero normals are replaced by the automatically computed ones. */
+    Array<float3> loop_normals(mesh->totloop, float3(0.0f));
+    loop_index = 0;
+    for (const int face_index : valid_faces) {
+      const FaceElem &face = geometry.faces[face_index];
+      for (const FaceCorner &corner : corners.slice(face.corner_start, face.corner_count)) {
+        if (corner.normal_index >= 0 && corner.normal_index < vertices.normals.size()) {
+          loop_normals[loop_index] = vertices.normals[corner.normal_index];
+        }
+        loop_index++;
+      }
+    }
+    /* Custom normals only apply to smooth faces. */
+    for (int i = 0; i < mesh->totpoly; i++) {
+      mesh->mpoly[i].flag |= ME_SMOOTH;
+    }
+    mesh->flag |= ME_AUTOSMOOTH;
+    mesh->smoothresh = (float)M_PI;
+    BKE_mesh_set_custom_normals(mesh, (float(*)[3])loop_normals.data());
+  }
+
+  if (validate) {
+    BKE_mesh_validate(mesh, false, true);
+  }
+}
+
+}  // namespace blender::io::obj
@@ -0,0 +1,38 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#pragma once
+
+#include "obj_import_objects.hh"
+
+struct Mesh;
+
+namespace blender::io::obj {
+
+/**
+ * Fill the empty \a mesh with the faces, edges and used vertices of \a geometry.
+ * Doesn't access Main, so meshes can be filled from multiple threads.
+ */
+void fill_mesh_from_geometry(Mesh *mesh,
+                             const Geometry &geometry,
+                             const GlobalVertices &vertices,
+                             bool validate);
+
+}  // namespace blender::io::obj
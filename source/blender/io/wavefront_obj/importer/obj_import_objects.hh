@@ -0,0 +1,85 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ *
+ * Data read from OBJ and MTL files, before it is turned into Blender data.
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+
+#include "BLI_float2.hh"
+#include "BLI_float3.hh"
+#include "BLI_map.hh"
+#include "BLI_vector.hh"
+#include "BLI_vector_set.hh"
+
+namespace blender::io::obj {
+
+/** Vertex data, shared by all objects of a file. */
+struct GlobalVertices {
+  Vector<float3> positions;
+  Vector<float2> uvs;
+  Vector<float3> normals;
+};
+
+/** Indices into #GlobalVertices of a face corner, -1 when the file doesn't define them. */
+struct FaceCorner {
+  int vert_index;
+  int uv_index;
+  int normal_index;
+};
+
+struct FaceElem {
+  int corner_start;
+  int corner_count;
+  /** Index into #Geometry.material_names, -1 when there is no material. */
+  int material_index;
+  bool shaded_smooth;
+};
+
+/** An object of the file (started with an `o` statement). */
+struct Geometry {
+  std::string name;
+  Vector<FaceElem> faces;
+  Vector<FaceCorner> face_corners;
+  /** Edges from `l` statements, as vertex indices. */
+  Vector<std::array<int, 2>> edges;
+  /** Materials in the order they are used first. */
+  VectorSet<std::string> material_names;
+};
+
+struct OBJData {
+  GlobalVertices vertices;
+  Vector<std::unique_ptr<Geometry>> geometries;
+  /** Relative paths of the MTL files given by `mtllib` statements. */
+  Vector<std::string> mtl_libraries;
+};
+
+/** A material of an MTL file, with the defaults of the format. */
+struct MTLMaterial {
+  float3 Kd = {0.8f, 0.8f, 0.8f};
+  float3 Ks = {0.5f, 0.5f, 0.5f};
+  float Ns = 250.0f;
+  float d = 1.0f;
+};
+
+}  // namespace blender::io::obj
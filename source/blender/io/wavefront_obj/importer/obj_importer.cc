@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <cstdio>
+
+#include "BLI_array.hh"
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_task.hh"
+
+#include "DNA_material_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_material.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "IO_mapped_file.hh"
+#include "IO_mesh_utils.hh"
+
+#include "obj_import_file_reader.hh"
+#include "obj_import_mesh.hh"
+#include "obj_importer.hh"
+
+namespace blender::io::obj {
+
+static void read_mtl_libraries(const char *obj_filepath,
+                               Span<std::string> mtl_libraries,
+                               Map<std::string, MTLMaterial> &r_materials)
+{
+  char obj_dir[FILE_MAX];
+  BLI_split_dir_part(obj_filepath, obj_dir, sizeof(obj_dir));
+  for (const std::string &mtl_library : mtl_libraries) {
+    char mtl_filepath[FILE_MAX];
+    BLI_join_dirfile(mtl_filepath, sizeof(mtl_filepath), obj_dir, mtl_library.c_str());
+    MappedFile file;
+    if (!file.open(mtl_filepath)) {
+      fprintf(stderr, "OBJ import: cannot read material library '%s'\n", mtl_filepath);
+      continue;
+    }
+    parse_mtl(file.data(), r_materials);
+  }
+}
+
+static Material *material_get_or_create(Main *bmain,
+                                        const std::string &name,
+                                        const Map<std::string, MTLMaterial> &mtl_materials,
+                                        Map<std::string, Material *> &created_materials)
+{
+  return created_materials.lookup_or_add_cb(name, [&]() {
+    Material *ma = BKE_material_add(bmain, name.c_str());
+    const MTLMaterial *mtl = mtl_materials.lookup_ptr(name);
+    if (mtl != nullptr) {
+      copy_v3_v3(&ma->r, mtl->Kd);
+      ma->a = mtl->d;
+      copy_v3_v3(&ma->specr, mtl->Ks);
+      ma->spec = (mtl->Ks.x + mtl->Ks.y + mtl->Ks.z) / 3.0f;
+      /* Same mapping of the specular exponent as the Python add-on. */
+      ma->roughness = 1.0f - sqrtf(clamp_f(mtl->Ns, 0.0f, 1000.0f) / 1000.0f);
+    }
+    return ma;
+  });
+}
+
+static void assign_materials(Main *bmain,
+                             Object *ob,
+                             const Geometry &geometry,
+                             const Map<std::string, MTLMaterial> &mtl_materials,
+                             Map<std::string, Material *> &created_materials)
+{
+  for (const int i : IndexRange(geometry.material_names.size())) {
+    if (!BKE_object_material_slot_add(bmain, ob)) {
+      return;
+    }
+    Material *ma = material_get_or_create(
+        bmain, geometry.material_names[i], mtl_materials, created_materials);
+    BKE_object_material_assign(bmain, ob, ma, i + 1, BKE_MAT_ASSIGN_OBDATA);
+  }
+}
+
+bool importer_main(Main *bmain,
+                   Scene *scene,
+                   ViewLayer *view_layer,
+                   const OBJImportParams &import_params)
+{
+  OBJData data;
+  {
+    MappedFile file;
+    if (!file.open(import_params.filepath)) {
+      fprintf(stderr, "OBJ import: cannot read '%s'\n", import_params.filepath);
+      return false;
+    }
+    parse_obj(file.data(), data);
+    if (file.has_io_error()) {
+      fprintf(stderr, "OBJ import: error reading '%s'\n", import_params.filepath);
+      return false;
+    }
+  }
+
+  Map<std::string, MTLMaterial> mtl_materials;
+  read_mtl_libraries(import_params.filepath, data.mtl_libraries, mtl_materials);
+
+  char file_name[FILE_MAX];
+  BLI_strncpy(file_name, BLI_path_basename(import_params.filepath), sizeof(file_name));
+  BLI_path_extension_replace(file_name, sizeof(file_name), "");
+
+  /* Adding IDs to Main is not thread-safe, only filling the meshes is done in parallel. */
+  Array<Mesh *> meshes(data.geometries.size());
+  for (const int i : data.geometries.index_range()) {
+    const std::string &name = data.geometries[i]->name;
+    meshes[i] = BKE_mesh_add(bmain, name.empty() ? file_name : name.c_str());
+  }
+  parallel_for(data.geometries.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      fill_mesh_from_geometry(
+          meshes[i], *data.geometries[i], data.vertices, import_params.validate_meshes);
+    }
+  });
+
+  const float4x4 axes_mat = axis_conversion_matrix(
+      import_params.forward_axis, import_params.up_axis, IO_AXIS_Y, IO_AXIS_Z, 1.0f);
+  Map<std::string, Material *> created_materials;
+  Vector<Object *> objects;
+  for (const int i : data.geometries.index_range()) {
+    Mesh *mesh = meshes[i];
+    Object *ob = BKE_object_add_only_object(bmain, OB_MESH, mesh->id.name + 2);
+    ob->data = mesh;
+    assign_materials(bmain, ob, *data.geometries[i], mtl_materials, created_materials);
+    BKE_object_apply_mat4(ob, axes_mat.values, true, false);
+    objects.append(ob);
+  }
+  import_objects_add_to_view_layer(bmain, scene, view_layer, objects);
+
+  return true;
+}
+
+}  // namespace blender::io::obj
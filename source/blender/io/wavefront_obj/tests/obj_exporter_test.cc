@@ -0,0 +1,119 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_math_matrix.h"
+#include "BLI_path_util.h"
+
+#include "DNA_mesh_types.h"
+
+#include "BKE_appdir.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+
+#include "obj_export_file_writer.hh"
+#include "obj_export_mesh.hh"
+#include "obj_import_file_reader.hh"
+#include "obj_import_mesh.hh"
+
+namespace blender::io::obj::tests {
+
+class obj_exporter_test : public testing::Test {
+ protected:
+  void SetUp() override
+  {
+    BKE_idtype_init();
+    BKE_tempdir_init(nullptr);
+  }
+
+  static Mesh *mesh_from_obj_text(StringRef text)
+  {
+    OBJData data;
+    parse_obj(text, data);
+    Mesh *mesh = (Mesh *)BKE_id_new_nomain(ID_ME, nullptr);
+    fill_mesh_from_geometry(mesh, *data.geometries[0], data.vertices, true);
+    return mesh;
+  }
+};
+
+TEST_F(obj_exporter_test, round_trip)
+{
+  /* A cube with UVs and flat faces, and a loose edge. */
+  const char *text =
+      "v -1 -1 -1\nv 1 -1 -1\nv 1 1 -1\nv -1 1 -1\n"
+      "v -1 -1 1\nv 1 -1 1\nv 1 1 1\nv -1 1 1\nv 0 0 5\n"
+      "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+      "f 1/1 4/4 3/3 2/2\nf 5/1 6/2 7/3 8/4\nf 1/1 2/2 6/3 5/4\n"
+      "f 2/1 3/2 7/3 6/4\nf 3/1 4/2 8/3 7/4\nf 4/1 1/2 5/3 8/4\n"
+      "l 7 9\n";
+  Mesh *mesh = mesh_from_obj_text(text);
+  ASSERT_EQ(mesh->totvert, 9);
+  ASSERT_EQ(mesh->totpoly, 6);
+
+  OBJExportParams export_params = {};
+  BLI_join_dirfile(
+      export_params.filepath, sizeof(export_params.filepath), BKE_tempdir_session(), "cube.obj");
+  export_params.export_uv = true;
+  export_params.export_normals = true;
+
+  /* The same mesh twice, so the indices of the second one are offset. */
+  Vector<OBJMesh> obj_meshes(2);
+  for (const int i : obj_meshes.index_range()) {
+    obj_meshes[i].name = "Cube " + std::to_string(i);
+    obj_meshes[i].mesh = mesh;
+    unit_m4(obj_meshes[i].matrix.values);
+    obj_meshes[i].matrix.values[3][0] = (float)(i * 10);
+    obj_mesh_prepare(obj_meshes[i], export_params);
+  }
+  /* UVs are de-duplicated per vertex, normals over the whole mesh. */
+  EXPECT_EQ(obj_meshes[0].normals.size(), 6);
+  EXPECT_EQ(obj_meshes[0].loose_edges.size(), 1);
+  ASSERT_TRUE(write_obj_file(obj_meshes, export_params));
+
+  size_t size;
+  char *file_text = (char *)BLI_file_read_text_as_mem(export_params.filepath, 0, &size);
+  ASSERT_NE(file_text, nullptr);
+  OBJData data;
+  parse_obj(StringRef(file_text, (int64_t)size), data);
+  MEM_freeN(file_text);
+
+  EXPECT_EQ(data.vertices.positions.size(), 18);
+  EXPECT_EQ(data.vertices.normals.size(), 12);
+  EXPECT_EQ(data.vertices.positions[9], float3(9.0f, -1.0f, -1.0f));
+  ASSERT_EQ(data.geometries.size(), 2);
+  const Geometry &second = *data.geometries[1];
+  EXPECT_EQ(second.name, "Cube_1");
+  ASSERT_EQ(second.faces.size(), 6);
+  ASSERT_EQ(second.edges.size(), 1);
+  EXPECT_EQ(second.edges[0][0], 9 + 6);
+  EXPECT_FALSE(second.faces[0].shaded_smooth);
+  for (const int i : IndexRange(4)) {
+    const FaceCorner &corner = second.face_corners[i];
+    EXPECT_GE(corner.vert_index, 9);
+    EXPECT_GE(corner.uv_index, obj_meshes[0].uvs.size());
+    EXPECT_EQ(data.vertices.normals[corner.normal_index], float3(0.0f, 0.0f, -1.0f));
+  }
+
+  BKE_id_free(nullptr, mesh);
+  BLI_delete(export_params.filepath, false, false);
+}
+
+}  // namespace blender::io::obj::tests
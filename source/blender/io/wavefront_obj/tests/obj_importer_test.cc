@@ -0,0 +1,121 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <string>
+
+#include "obj_import_file_reader.hh"
+
+namespace blender::io::obj::tests {
+
+TEST(obj_import_file_reader, objects_and_materials)
+{
+  const char *text =
+      "# comment\n"
+      "mtllib materials.mtl\n"
+      "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+      "vt 0 0\nvt 1 0\nvt 1 1\n"
+      "vn 0 0 1\n"
+      "o First\n"
+      "usemtl Red\n"
+      "s 1\n"
+      "f 1/1/1 2/2/1 3/3/1\n"
+      "usemtl Blue\n"
+      "f -4//1 -2//1 -1//1\n"
+      "o Second\n"
+      "s off\n"
+      "f 1 2 3 4\n"
+      "l 1 3\n"
+      "o Empty\n";
+  OBJData data;
+  parse_obj(text, data);
+
+  ASSERT_EQ(data.mtl_libraries.size(), 1);
+  EXPECT_EQ(data.mtl_libraries[0], "materials.mtl");
+  EXPECT_EQ(data.vertices.positions.size(), 4);
+  EXPECT_EQ(data.vertices.uvs.size(), 3);
+  EXPECT_EQ(data.vertices.normals.size(), 1);
+
+  /* Objects without faces or edges are skipped. */
+  ASSERT_EQ(data.geometries.size(), 2);
+  const Geometry &first = *data.geometries[0];
+  EXPECT_EQ(first.name, "First");
+  ASSERT_EQ(first.faces.size(), 2);
+  ASSERT_EQ(first.material_names.size(), 2);
+  EXPECT_EQ(first.material_names[first.faces[0].material_index], "Red");
+  EXPECT_EQ(first.material_names[first.faces[1].material_index], "Blue");
+  EXPECT_TRUE(first.faces[1].shaded_smooth);
+  const FaceCorner &corner = first.face_corners[first.faces[1].corner_start];
+  EXPECT_EQ(corner.vert_index, 0);
+  EXPECT_EQ(corner.uv_index, -1);
+  EXPECT_EQ(corner.normal_index, 0);
+
+  const Geometry &second = *data.geometries[1];
+  EXPECT_EQ(second.name, "Second");
+  ASSERT_EQ(second.faces.size(), 1);
+  EXPECT_EQ(second.faces[0].corner_count, 4);
+  EXPECT_FALSE(second.faces[0].shaded_smooth);
+  ASSERT_EQ(second.edges.size(), 1);
+  EXPECT_EQ(second.edges[0][1], 2);
+}
+
+TEST(obj_import_file_reader, multiple_chunks)
+{
+  /* Large enough to be split into several chunks parsed in parallel, with relative indices and
+   * state that has to be carried over from one chunk to the next. */
+  const int quads_num = 40000;
+  std::string text = "o Grid\nusemtl Mat\n";
+  for (int i = 0; i < quads_num; i++) {
+    text += "v " + std::to_string(i) + " 0 0\nv " + std::to_string(i) + " 1 0\n";
+    if (i > 0) {
+      text += "f -4 -2 -1 -3\n";
+    }
+  }
+  OBJData data;
+  parse_obj(text, data);
+
+  ASSERT_EQ(data.vertices.positions.size(), quads_num * 2);
+  EXPECT_EQ(data.vertices.positions.last().x, (float)(quads_num - 1));
+  ASSERT_EQ(data.geometries.size(), 1);
+  const Geometry &geometry = *data.geometries[0];
+  ASSERT_EQ(geometry.faces.size(), quads_num - 1);
+  for (const int i : geometry.faces.index_range()) {
+    const FaceElem &face = geometry.faces[i];
+    EXPECT_EQ(face.material_index, 0);
+    EXPECT_EQ(geometry.face_corners[face.corner_start].vert_index, i * 2);
+    EXPECT_EQ(geometry.face_corners[face.corner_start + 2].vert_index, i * 2 + 3);
+  }
+}
+
+TEST(obj_import_file_reader, mtl)
+{
+  const char *text =
+      "newmtl Red\n"
+      "Kd 1 0 0\n"
+      "Ns 100\n"
+      "newmtl Glass\n"
+      "Tr 0.75\n";
+  Map<std::string, MTLMaterial> materials;
+  parse_mtl(text, materials);
+  ASSERT_EQ(materials.size(), 2);
+  EXPECT_EQ(materials.lookup("Red").Kd, float3(1.0f, 0.0f, 0.0f));
+  EXPECT_EQ(materials.lookup("Red").Ns, 100.0f);
+  EXPECT_FLOAT_EQ(materials.lookup("Glass").d, 0.25f);
+}
+
+}  // namespace blender::io::obj::tests
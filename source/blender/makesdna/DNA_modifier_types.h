@@ -2245,6 +2245,12 @@ typedef struct NodesModifierData {
   ModifierData modifier;
   struct bNodeTree *node_group;
   struct NodesModifierSettings settings;
+  /**
+   * Memory in megabytes used to keep node results between evaluations, zero (the default)
+   * disables it. Comparing the input mesh has a cost too, so the cache is opt-in.
+   */
+  int cache_memory_limit;
+  char _pad[4];
 } NodesModifierData;
 
 typedef struct MeshToVolumeModifierData {
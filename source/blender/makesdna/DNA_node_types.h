@@ -450,7 +450,6 @@ typedef struct bNodeTree {
   short is_updating;
   /** Generic temporary flag for recursion check (DFS/BFS). */
   short done;
-  char _pad2[4];
 
   /** Specific node type this tree is used for. */
   int nodetype DNA_DEPRECATED;
@@ -461,6 +460,8 @@ typedef struct bNodeTree {
   short render_quality;
   /** Tile size for compositor engine. */
   int chunksize;
+  /** Memory in megabytes used to keep compositor buffers between executions, zero disables it. */
+  int cache_memory_limit;
 
   rctf viewer_border;
 
@@ -516,6 +517,7 @@ typedef struct bNodeTree {
 #define NTREE_TWO_PASS (1 << 2)             /* two pass */
 #define NTREE_COM_GROUPNODE_BUFFER (1 << 3) /* use groupnode buffers */
 #define NTREE_VIEWER_BORDER (1 << 4)        /* use a border for viewer nodes */
+#define NTREE_COM_FULL_FRAME (1 << 6)       /* execute whole buffers instead of tiles */
 /* NOTE: DEPRECATED, use (id->tag & LIB_TAG_LOCALIZED) instead. */
 
 /* tree is localized copy, free when deleting node groups */
@@ -1084,6 +1086,12 @@ typedef struct NodeAttributeMix {
   uint8_t input_type_b;
 } NodeAttributeMix;
 
+typedef struct NodeAttributeRandomize {
+  /* GeometryNodeAttributeRandomizeFlag */
+  uint8_t flag;
+  char _pad[3];
+} NodeAttributeRandomize;
+
 /* script node mode */
 #define NODE_SCRIPT_INTERNAL 0
 #define NODE_SCRIPT_EXTERNAL 1
@@ -1506,6 +1514,12 @@ typedef enum GeometryNodePointDistributeMethod {
   GEO_NODE_POINT_DISTRIBUTE_POISSON = 1,
 } GeometryNodePointDistributeMethod;
 
+typedef enum GeometryNodeAttributeRandomizeFlag {
+  /* Draw the values from a sequential random number generator, like files from before the values
+   * were computed from the element index. */
+  GEO_NODE_ATTRIBUTE_RANDOMIZE_LEGACY_RNG = (1 << 0),
+} GeometryNodeAttributeRandomizeFlag;
+
 #ifdef __cplusplus
 }
 #endif
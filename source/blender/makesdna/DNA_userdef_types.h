@@ -773,7 +773,8 @@ typedef struct UserDef {
   int prefetchframes;
   /** Control the rotation step of the view when PAD2, PAD4, PAD6&PAD8 is use. */
   float pad_rot_angle;
-  char _pad12[4];
+  /** Memory limit of deferred packed data in megabytes, zero for no limit. */
+  int packed_data_memory_limit;
   /** Rotating view icon size. */
   short rvisize;
   /** Rotating view icon brightness. */
@@ -961,7 +962,8 @@ typedef enum eUserPref_SpaceData_Flag {
 typedef enum eUserPref_Flag {
   USER_AUTOSAVE = (1 << 0),
   USER_FLAG_NUMINPUT_ADVANCED = (1 << 1),
-  USER_FLAG_UNUSED_2 = (1 << 2), /* cleared */
+  /** Read packed files when they are used, see #BLO_READ_DEFER_PACKED_DATA. */
+  USER_DEFER_PACKED_DATA = (1 << 2),
   USER_FLAG_UNUSED_3 = (1 << 3), /* cleared */
   USER_FLAG_UNUSED_4 = (1 << 4), /* cleared */
   USER_TRACKBALL = (1 << 5),
@@ -149,9 +149,10 @@ int rna_ID_name_length(PointerRNA *ptr)
 void rna_ID_name_set(PointerRNA *ptr, const char *value)
 {
   ID *id = (ID *)ptr->data;
-  BLI_strncpy_utf8(id->name + 2, value, sizeof(id->name) - 2);
+  char name[MAX_ID_NAME - 2];
+  BLI_strncpy_utf8(name, value, sizeof(name));
   BLI_assert(BKE_id_is_in_global_main(id));
-  BLI_libblock_ensure_unique_name(G_MAIN, id->name);
+  BKE_libblock_rename(G_MAIN, id, name);
 
   if (GS(id->name) == ID_OB) {
     Object *ob = (Object *)id;
@@ -6995,6 +6995,17 @@ static void rna_def_modifier_nodes(BlenderRNA *brna)
   RNA_def_property_flag(prop, PROP_NEVER_NULL);
   RNA_def_property_ui_text(prop, "Settings", "Settings that are passed into the node group");
 
+  prop = RNA_def_property(srna, "cache_memory_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_range(prop, 0, INT_MAX);
+  RNA_def_property_ui_range(prop, 0, 4096, 64, -1);
+  RNA_def_property_ui_text(
+      prop,
+      "Cache Limit",
+      "Memory used to keep node results between evaluations, in megabytes (0 disables the "
+      "cache). The input mesh is compared on every evaluation, which only pays off for node "
+      "trees that are slow to evaluate");
+  RNA_def_property_update(prop, 0, "rna_Modifier_update");
+
   RNA_define_lib_overridable(false);
 
   rna_def_modifier_nodes_settings(brna);
@@ -8404,9 +8404,21 @@ static void def_geo_attribute_create_common(StructRNA *srna,
 
 static void def_geo_attribute_randomize(StructRNA *srna)
 {
+  PropertyRNA *prop;
+
   def_geo_attribute_create_common(srna,
                                   "rna_GeometryNodeAttributeRandom_type_itemf",
                                   "rna_GeometryNodeAttributeRandom_domain_itemf");
+
+  RNA_def_struct_sdna_from(srna, "NodeAttributeRandomize", "storage");
+
+  prop = RNA_def_property(srna, "use_legacy_random", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", GEO_NODE_ATTRIBUTE_RANDOMIZE_LEGACY_RNG);
+  RNA_def_property_ui_text(prop,
+                           "Legacy Random",
+                           "Generate the values in sequence like older versions did, instead of "
+                           "from the element index, which is faster on multiple threads");
+  RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_Node_update");
 }
 
 static void def_geo_attribute_fill(StructRNA *srna)
@@ -10196,6 +10208,15 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
                            "Max size of a tile (smaller values gives better distribution "
                            "of multiple threads, but more overhead)");
 
+  prop = RNA_def_property(srna, "cache_memory_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_range(prop, 0, INT_MAX);
+  RNA_def_property_ui_range(prop, 0, 16384, 256, -1);
+  RNA_def_property_ui_text(prop,
+                           "Cache Limit",
+                           "Memory used to keep intermediate buffers between executions, so only "
+                           "nodes affected by a change are executed again, in megabytes (0 "
+                           "disables the cache)");
+
   prop = RNA_def_property(srna, "use_opencl", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_OPENCL);
   RNA_def_property_ui_text(prop, "OpenCL", "Enable GPU calculations");
@@ -10211,6 +10232,13 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
                            "Use two pass execution during editing: first calculate fast nodes, "
                            "second pass calculate all nodes");
 
+  prop = RNA_def_property(srna, "use_full_frame", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_FULL_FRAME);
+  RNA_def_property_ui_text(prop,
+                           "Full Frame",
+                           "Compute the whole needed area of every buffer in dependency order, "
+                           "split into row bands, instead of scheduling tiles");
+
   prop = RNA_def_property(srna, "use_viewer_border", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_VIEWER_BORDER);
   RNA_def_property_ui_text(
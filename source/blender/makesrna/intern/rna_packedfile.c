@@ -45,7 +45,13 @@ const EnumPropertyItem rna_enum_unpack_method_items[] = {
 static void rna_PackedImage_data_get(PointerRNA *ptr, char *value)
 {
   PackedFile *pf = (PackedFile *)ptr->data;
-  memcpy(value, pf->data, (size_t)pf->size);
+  if (BKE_packedfile_data_acquire(pf)) {
+    memcpy(value, pf->data, (size_t)pf->size);
+    BKE_packedfile_data_release(pf);
+  }
+  else {
+    memset(value, 0, (size_t)pf->size);
+  }
   value[pf->size] = '\0';
 }
 
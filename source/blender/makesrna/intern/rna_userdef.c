@@ -182,6 +182,7 @@ static const EnumPropertyItem rna_enum_userdef_viewport_aa_items[] = {
 #  include "BKE_image.h"
 #  include "BKE_main.h"
 #  include "BKE_mesh_runtime.h"
+#  include "BKE_packedFile.h"
 #  include "BKE_paint.h"
 #  include "BKE_pbvh.h"
 #  include "BKE_preferences.h"
@@ -571,6 +572,14 @@ static void rna_Userdef_memcache_update(Main *UNUSED(bmain),
   USERDEF_TAG_DIRTY;
 }
 
+static void rna_Userdef_packed_data_memory_update(Main *UNUSED(bmain),
+                                                  Scene *UNUSED(scene),
+                                                  PointerRNA *UNUSED(ptr))
+{
+  BKE_packedfile_deferred_budget_set(((size_t)U.packed_data_memory_limit) * 1024 * 1024);
+  USERDEF_TAG_DIRTY;
+}
+
 static void rna_Userdef_disk_cache_dir_update(Main *UNUSED(bmain),
                                               Scene *UNUSED(scene),
                                               PointerRNA *UNUSED(ptr))
@@ -5378,6 +5387,15 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "packed_data_memory_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "packed_data_memory_limit");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Packed Data Limit",
+                           "Memory limit for packed files that are read when used (in megabytes), "
+                           "zero for no limit");
+  RNA_def_property_update(prop, 0, "rna_Userdef_packed_data_memory_update");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
@@ -6057,6 +6075,13 @@ static void rna_def_userdef_filepaths(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Load UI", "Load user interface setup when loading .blend files");
   RNA_def_property_update(prop, 0, "rna_userdef_load_ui_update");
 
+  prop = RNA_def_property(srna, "use_defer_packed_data", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", USER_DEFER_PACKED_DATA);
+  RNA_def_property_ui_text(prop,
+                           "Defer Packed Data",
+                           "Read the contents of packed files when they are used instead of when "
+                           "loading uncompressed .blend files");
+
   prop = RNA_def_property(srna, "use_scripts_auto_execute", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_negative_sdna(prop, NULL, "flag", USER_SCRIPT_AUTOEXEC_DISABLE);
   RNA_def_property_ui_text(prop,
@@ -21,16 +21,19 @@
  * \ingroup modifiers
  */
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 #include <string>
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_float3.hh"
 #include "BLI_listbase.h"
 #include "BLI_set.hh"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_collection_types.h"
@@ -66,6 +69,7 @@
 
 #include "MOD_modifiertypes.h"
 #include "MOD_nodes.h"
+#include "MOD_nodes_cache.hh"
 #include "MOD_ui_common.h"
 
 #include "NOD_derived_node_tree.hh"
@@ -83,6 +87,7 @@ using blender::StringRef;
 using blender::Vector;
 using blender::fn::GMutablePointer;
 using blender::fn::GValueMap;
+using blender::modifiers::NodeResultCache;
 using blender::nodes::GeoNodeExecParams;
 using namespace blender::nodes::derived_node_tree_types;
 using namespace blender::fn::multi_function_types;
@@ -191,113 +196,291 @@ static bool isDisabled(const struct Scene *UNUSED(scene),
   return false;
 }
 
+/**
+ * Evaluates the nodes that contribute to the group outputs. Every node is executed once, as soon
+ * as all of its inputs have been computed. Nodes are executed in a task pool, so that independent
+ * parts of the node tree are evaluated in parallel.
+ */
 class GeometryNodesEvaluator {
  private:
+  struct NodeState {
+    /* True when the node has to be executed to compute the group outputs. */
+    bool is_required = false;
+    /* Number of inputs that still wait for a value computed by another node. The node is scheduled
+     * when this becomes zero. */
+    std::atomic<int> missing_inputs = 0;
+    /* Allocates the values created while executing the node. Every node has its own allocator, so
+     * that nodes can be executed in parallel without synchronization. */
+    blender::LinearAllocator<> allocator;
+  };
+
   blender::LinearAllocator<> allocator_;
+  /* Contains an entry for every input whose value is used. All entries are added before the
+   * evaluation starts, afterwards only the values are changed. Every value is written by a single
+   * node before the node that owns the input is scheduled. */
   Map<const DInputSocket *, GMutablePointer> value_by_input_;
+  blender::Array<NodeState> node_states_;
+  TaskPool *task_pool_ = nullptr;
+  const DerivedNodeTree &tree_;
+  const Map<const DOutputSocket *, GMutablePointer> &group_input_data_;
   Vector<const DInputSocket *> group_outputs_;
   blender::nodes::MultiFunctionByNode &mf_by_node_;
   const blender::nodes::DataTypeConversions &conversions_;
   const blender::bke::PersistentDataHandleMap &handle_map_;
   const Object *self_object_;
+  /* Results of previous evaluations, may be null. */
+  NodeResultCache *cache_;
 
  public:
-  GeometryNodesEvaluator(const Map<const DOutputSocket *, GMutablePointer> &group_input_data,
+  GeometryNodesEvaluator(const DerivedNodeTree &tree,
+                         const Map<const DOutputSocket *, GMutablePointer> &group_input_data,
                          Vector<const DInputSocket *> group_outputs,
                          blender::nodes::MultiFunctionByNode &mf_by_node,
                          const blender::bke::PersistentDataHandleMap &handle_map,
-                         const Object *self_object)
-      : group_outputs_(std::move(group_outputs)),
+                         const Object *self_object,
+                         NodeResultCache *cache)
+      : node_states_(tree.nodes().size()),
+        tree_(tree),
+        group_input_data_(group_input_data),
+        group_outputs_(std::move(group_outputs)),
         mf_by_node_(mf_by_node),
         conversions_(blender::nodes::get_implicit_type_conversions()),
         handle_map_(handle_map),
-        self_object_(self_object)
+        self_object_(self_object),
+        cache_(cache)
   {
-    for (auto item : group_input_data.items()) {
-      this->forward_to_inputs(*item.key, item.value);
-    }
   }
 
   Vector<GMutablePointer> execute()
   {
+    this->find_required_inputs();
+    this->initialize_known_inputs();
+
+    /* Find the nodes that can be executed right away. The counters of all nodes have to be set
+     * before the first node is scheduled, because it might be executed immediately. */
+    Vector<const DNode *> ready_nodes;
+    for (const DNode *node : tree_.nodes()) {
+      NodeState &state = node_states_[node->id()];
+      if (!state.is_required) {
+        continue;
+      }
+      int missing_inputs = 0;
+      for (const DInputSocket *input_socket : node->inputs()) {
+        if (input_socket->is_available() && this->get_origin_socket(*input_socket) != nullptr) {
+          missing_inputs++;
+        }
+      }
+      state.missing_inputs = missing_inputs;
+      if (missing_inputs == 0) {
+        ready_nodes.append(node);
+      }
+    }
+
+    task_pool_ = BLI_task_pool_create(this, TASK_PRIORITY_HIGH);
+    for (const DNode *node : ready_nodes) {
+      this->schedule_node(*node);
+    }
+    BLI_task_pool_work_and_wait(task_pool_);
+    BLI_task_pool_free(task_pool_);
+    task_pool_ = nullptr;
+
     Vector<GMutablePointer> results;
     for (const DInputSocket *group_output : group_outputs_) {
-      GMutablePointer result = this->get_input_value(*group_output);
-      results.append(result);
+      GMutablePointer &value = value_by_input_.lookup(group_output);
+      results.append(value);
+      value = {};
     }
     for (GMutablePointer value : value_by_input_.values()) {
-      value.destruct();
+      if (value.get() != nullptr) {
+        value.destruct();
+      }
     }
     return results;
   }
 
  private:
-  GMutablePointer get_input_value(const DInputSocket &socket_to_compute)
+  /**
+   * Returns the output socket that has to be computed by another node to get the value of the
+   * given input. Null is returned when the value is known before any node is executed.
+   */
+  const DOutputSocket *get_origin_socket(const DInputSocket &socket) const
   {
-    std::optional<GMutablePointer> value = value_by_input_.pop_try(&socket_to_compute);
-    if (value.has_value()) {
-      /* This input has been computed before, return it directly. */
-      return *value;
+    Span<const DOutputSocket *> from_sockets = socket.linked_sockets();
+    BLI_assert(from_sockets.size() + socket.linked_group_inputs().size() <= 1);
+
+    if (from_sockets.size() == 0) {
+      return nullptr;
+    }
+    const DOutputSocket *from_socket = from_sockets[0];
+    if (!from_socket->is_available() || group_input_data_.contains(from_socket)) {
+      return nullptr;
     }
+    return from_socket;
+  }
 
-    Span<const DOutputSocket *> from_sockets = socket_to_compute.linked_sockets();
-    Span<const DGroupInput *> from_group_inputs = socket_to_compute.linked_group_inputs();
-    const int total_inputs = from_sockets.size() + from_group_inputs.size();
-    BLI_assert(total_inputs <= 1);
+  /**
+   * Walk backwards from the group outputs to find the nodes that have to be executed. Nodes that
+   * do not contribute to the outputs are skipped.
+   */
+  void find_required_inputs()
+  {
+    Vector<const DInputSocket *> sockets_to_check = group_outputs_;
+    while (!sockets_to_check.is_empty()) {
+      const DInputSocket &socket = *sockets_to_check.pop_last();
+      if (!value_by_input_.add(&socket, {})) {
+        continue;
+      }
+      const DOutputSocket *from_socket = this->get_origin_socket(socket);
+      if (from_socket == nullptr) {
+        continue;
+      }
+      const DNode &node = from_socket->node();
+      NodeState &state = node_states_[node.id()];
+      if (state.is_required) {
+        continue;
+      }
+      state.is_required = true;
+      for (const DInputSocket *input_socket : node.inputs()) {
+        if (input_socket->is_available()) {
+          sockets_to_check.append(input_socket);
+        }
+      }
+    }
+  }
 
-    if (total_inputs == 0) {
-      /* The input is not connected, use the value from the socket itself. */
-      return get_unlinked_input_value(socket_to_compute);
+  /* Set the values of all inputs that do not depend on another node. */
+  void initialize_known_inputs()
+  {
+    for (auto item : group_input_data_.items()) {
+      this->forward_to_inputs(*item.key, item.value, allocator_);
     }
-    if (from_group_inputs.size() == 1) {
-      /* The input gets its value from the input of a group that is not further connected. */
-      return get_unlinked_input_value(socket_to_compute);
+
+    for (auto item : value_by_input_.items()) {
+      const DInputSocket &socket = *item.key;
+      if (item.value.get() != nullptr) {
+        /* The value has been forwarded from a group input already. */
+        continue;
+      }
+      Span<const DOutputSocket *> from_sockets = socket.linked_sockets();
+      if (from_sockets.size() == 0) {
+        /* The input is not connected or is connected to the input of a group that is not further
+         * connected. Use the value from the socket itself. */
+        item.value = this->get_unlinked_input_value(socket);
+        continue;
+      }
+      const DOutputSocket &from_socket = *from_sockets[0];
+      if (!from_socket.is_available()) {
+        /* If the output is not available, use a default value. This also sets the value of all
+         * other inputs linked to the same output. */
+        const CPPType &type = *blender::nodes::socket_cpp_type_get(*from_socket.typeinfo());
+        void *buffer = allocator_.allocate(type.size(), type.alignment());
+        type.copy_to_uninitialized(type.default_value(), buffer);
+        this->forward_to_inputs(from_socket, {type, buffer}, allocator_);
+      }
     }
+  }
 
-    /* Compute the socket now. */
-    const DOutputSocket &from_socket = *from_sockets[0];
-    this->compute_output_and_forward(from_socket);
-    return value_by_input_.pop(&socket_to_compute);
+  void schedule_node(const DNode &node)
+  {
+    BLI_task_pool_push(task_pool_, run_node_task, (void *)&node, false, nullptr);
   }
 
-  void compute_output_and_forward(const DOutputSocket &socket_to_compute)
+  static void run_node_task(TaskPool *__restrict pool, void *taskdata)
   {
-    const DNode &node = socket_to_compute.node();
-    const bNode &bnode = *node.bnode();
+    GeometryNodesEvaluator &evaluator = *(GeometryNodesEvaluator *)BLI_task_pool_user_data(pool);
+    const DNode &node = *(const DNode *)taskdata;
+    evaluator.compute_outputs_and_forward(node);
+  }
 
-    if (!socket_to_compute.is_available()) {
-      /* If the output is not available, use a default value. */
-      const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket_to_compute.typeinfo());
-      void *buffer = allocator_.allocate(type.size(), type.alignment());
-      type.copy_to_uninitialized(type.default_value(), buffer);
-      this->forward_to_inputs(socket_to_compute, {type, buffer});
-      return;
-    }
+  void compute_outputs_and_forward(const DNode &node)
+  {
+    NodeState &state = node_states_[node.id()];
+    const bNode &bnode = *node.bnode();
 
-    /* Prepare inputs required to execute the node. */
-    GValueMap<StringRef> node_inputs_map{allocator_};
+    /* Prepare inputs required to execute the node. All of them have been computed already. */
+    GValueMap<StringRef> node_inputs_map{state.allocator};
+    Vector<GMutablePointer> input_values;
     for (const DInputSocket *input_socket : node.inputs()) {
       if (input_socket->is_available()) {
-        GMutablePointer value = this->get_input_value(*input_socket);
+        GMutablePointer &value = value_by_input_.lookup(input_socket);
         node_inputs_map.add_new_direct(input_socket->identifier(), value);
+        input_values.append(value);
+        value = {};
       }
     }
 
-    /* Execute the node. */
-    GValueMap<StringRef> node_outputs_map{allocator_};
-    GeoNodeExecParams params{bnode, node_inputs_map, node_outputs_map, handle_map_, self_object_};
-    this->execute_node(node, params);
+    const bool use_cache = cache_ != nullptr && NodeResultCache::node_supports_caching(node);
+
+    Vector<GMutablePointer> output_values;
+    if (!use_cache || !cache_->lookup(node, input_values, state.allocator, output_values)) {
+      /* The node may modify its inputs, so they have to be copied for the cache beforehand. */
+      Vector<GMutablePointer> input_copies;
+      if (use_cache) {
+        for (GMutablePointer value : input_values) {
+          const CPPType &type = *value.type();
+          void *buffer = state.allocator.allocate(type.size(), type.alignment());
+          type.copy_to_uninitialized(value.get(), buffer);
+          input_copies.append({type, buffer});
+        }
+      }
+
+      /* Execute the node. */
+      GValueMap<StringRef> node_outputs_map{state.allocator};
+      GeoNodeExecParams params{
+          bnode, node_inputs_map, node_outputs_map, handle_map_, self_object_};
+      this->execute_node(node, params, state.allocator);
+
+      for (const DOutputSocket *output_socket : node.outputs()) {
+        if (output_socket->is_available()) {
+          output_values.append(node_outputs_map.extract(output_socket->identifier()));
+        }
+      }
+
+      if (use_cache) {
+        cache_->add(node, input_copies, output_values);
+        for (GMutablePointer value : input_copies) {
+          value.destruct();
+        }
+      }
+    }
 
     /* Forward computed outputs to linked input sockets. */
+    int output_index = 0;
     for (const DOutputSocket *output_socket : node.outputs()) {
       if (output_socket->is_available()) {
-        GMutablePointer value = node_outputs_map.extract(output_socket->identifier());
-        this->forward_to_inputs(*output_socket, value);
+        this->forward_to_inputs(*output_socket, output_values[output_index], state.allocator);
+        output_index++;
+      }
+    }
+
+    /* Notify the nodes using the outputs only after all values have been forwarded. */
+    for (const DOutputSocket *output_socket : node.outputs()) {
+      if (output_socket->is_available()) {
+        for (const DInputSocket *to_socket : output_socket->linked_sockets()) {
+          if (value_by_input_.contains(to_socket)) {
+            this->input_computed(*to_socket);
+          }
+        }
       }
     }
   }
 
-  void execute_node(const DNode &node, GeoNodeExecParams params)
+  void input_computed(const DInputSocket &socket)
+  {
+    const DNode &node = socket.node();
+    NodeState &state = node_states_[node.id()];
+    if (!state.is_required) {
+      /* The input belongs to a group output. */
+      return;
+    }
+    if (state.missing_inputs.fetch_sub(1) == 1) {
+      this->schedule_node(node);
+    }
+  }
+
+  void execute_node(const DNode &node,
+                    GeoNodeExecParams params,
+                    blender::LinearAllocator<> &allocator)
   {
     const bNode &bnode = params.node();
     if (bnode.typeinfo->geometry_node_execute != nullptr) {
@@ -321,7 +504,7 @@ class GeometryNodesEvaluator {
     for (const DOutputSocket *dsocket : node.outputs()) {
       if (dsocket->is_available()) {
         const CPPType &type = *blender::nodes::socket_cpp_type_get(*dsocket->typeinfo());
-        void *buffer = allocator_.allocate(type.size(), type.alignment());
+        void *buffer = allocator.allocate(type.size(), type.alignment());
         fn_params.add_uninitialized_single_output(GMutableSpan(type, buffer, 1));
         output_data.append(GMutablePointer(type, buffer));
       }
@@ -341,50 +524,52 @@ class GeometryNodesEvaluator {
     }
   }
 
-  void forward_to_inputs(const DOutputSocket &from_socket, GMutablePointer value_to_forward)
+  void forward_to_inputs(const DOutputSocket &from_socket,
+                         GMutablePointer value_to_forward,
+                         blender::LinearAllocator<> &allocator)
   {
     Span<const DInputSocket *> to_sockets_all = from_socket.linked_sockets();
 
     const CPPType &from_type = *value_to_forward.type();
 
-    Vector<const DInputSocket *> to_sockets_same_type;
+    Vector<GMutablePointer *> to_values_same_type;
     for (const DInputSocket *to_socket : to_sockets_all) {
+      GMutablePointer *to_value = value_by_input_.lookup_ptr(to_socket);
+      if (to_value == nullptr) {
+        /* The value of this input is not used. */
+        continue;
+      }
       const CPPType &to_type = *blender::nodes::socket_cpp_type_get(*to_socket->typeinfo());
       if (from_type == to_type) {
-        to_sockets_same_type.append(to_socket);
+        to_values_same_type.append(to_value);
       }
       else {
-        void *buffer = allocator_.allocate(to_type.size(), to_type.alignment());
+        void *buffer = allocator.allocate(to_type.size(), to_type.alignment());
         if (conversions_.is_convertible(from_type, to_type)) {
           conversions_.convert(from_type, to_type, value_to_forward.get(), buffer);
         }
         else {
           to_type.copy_to_uninitialized(to_type.default_value(), buffer);
         }
-        value_by_input_.add_new(to_socket, GMutablePointer{to_type, buffer});
+        *to_value = GMutablePointer{to_type, buffer};
       }
     }
 
-    if (to_sockets_same_type.size() == 0) {
+    if (to_values_same_type.size() == 0) {
       /* This value is not further used, so destruct it. */
       value_to_forward.destruct();
     }
-    else if (to_sockets_same_type.size() == 1) {
+    else if (to_values_same_type.size() == 1) {
       /* This value is only used on one input socket, no need to copy it. */
-      const DInputSocket *to_socket = to_sockets_same_type[0];
-      value_by_input_.add_new(to_socket, value_to_forward);
+      *to_values_same_type[0] = value_to_forward;
     }
     else {
       /* Multiple inputs use the value, make a copy for every input except for one. */
-      const DInputSocket *first_to_socket = to_sockets_same_type[0];
-      Span<const DInputSocket *> other_to_sockets = to_sockets_same_type.as_span().drop_front(1);
-      const CPPType &type = *value_to_forward.type();
-
-      value_by_input_.add_new(first_to_socket, value_to_forward);
-      for (const DInputSocket *to_socket : other_to_sockets) {
-        void *buffer = allocator_.allocate(type.size(), type.alignment());
-        type.copy_to_uninitialized(value_to_forward.get(), buffer);
-        value_by_input_.add_new(to_socket, GMutablePointer{type, buffer});
+      *to_values_same_type[0] = value_to_forward;
+      for (GMutablePointer *to_value : to_values_same_type.as_span().drop_front(1)) {
+        void *buffer = allocator.allocate(from_type.size(), from_type.alignment());
+        from_type.copy_to_uninitialized(value_to_forward.get(), buffer);
+        *to_value = GMutablePointer{from_type, buffer};
       }
     }
   }
@@ -782,15 +967,14 @@ static void fill_data_handle_map(const DerivedNodeTree &tree,
 
 /**
  * Evaluate a node group to compute the output geometry.
- * Currently, this uses a fairly basic and inefficient algorithm that might compute things more
- * often than necessary. It's going to be replaced soon.
  */
 static GeometrySet compute_geometry(const DerivedNodeTree &tree,
                                     Span<const DOutputSocket *> group_input_sockets,
                                     const DInputSocket &socket_to_compute,
                                     GeometrySet input_geometry_set,
                                     NodesModifierData *nmd,
-                                    const ModifierEvalContext *ctx)
+                                    const ModifierEvalContext *ctx,
+                                    NodeResultCache *cache)
 {
   blender::ResourceCollector resources;
   blender::LinearAllocator<> &allocator = resources.linear_allocator();
@@ -805,6 +989,9 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
      * modifier. */
     const DOutputSocket *first_input_socket = group_input_sockets[0];
     if (first_input_socket->bsocket()->type == SOCK_GEOMETRY) {
+      if (cache != nullptr) {
+        cache->reuse_input_geometry(input_geometry_set, *ctx->object);
+      }
       GeometrySet *geometry_set_in = allocator.construct<GeometrySet>(
           std::move(input_geometry_set));
       group_inputs.add_new(first_input_socket, geometry_set_in);
@@ -827,7 +1014,7 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   fill_data_handle_map(tree, handle_map);
 
   GeometryNodesEvaluator evaluator{
-      group_inputs, group_outputs, mf_by_node, handle_map, ctx->object};
+      tree, group_inputs, group_outputs, mf_by_node, handle_map, ctx->object, cache};
   Vector<GMutablePointer> results = evaluator.execute();
   BLI_assert(results.size() == 1);
   GMutablePointer result = results[0];
@@ -891,6 +1078,33 @@ static void check_property_socket_sync(const Object *ob, ModifierData *md)
   }
 }
 
+static void freeRuntimeData(void *runtime_data)
+{
+  if (runtime_data == nullptr) {
+    return;
+  }
+  NodeResultCache *cache = static_cast<NodeResultCache *>(runtime_data);
+  OBJECT_GUARDED_DELETE(cache, NodeResultCache);
+}
+
+/* The cache is stored in the runtime data of the evaluated modifier, which is kept when the
+ * modifier is copied for evaluation again. */
+static NodeResultCache *ensure_result_cache(NodesModifierData *nmd)
+{
+  if (nmd->cache_memory_limit <= 0) {
+    freeRuntimeData(nmd->modifier.runtime);
+    nmd->modifier.runtime = nullptr;
+    return nullptr;
+  }
+  NodeResultCache *cache = static_cast<NodeResultCache *>(nmd->modifier.runtime);
+  if (cache == nullptr) {
+    cache = OBJECT_GUARDED_NEW(NodeResultCache);
+    nmd->modifier.runtime = cache;
+  }
+  cache->set_memory_limit((int64_t)nmd->cache_memory_limit * 1024 * 1024);
+  return cache;
+}
+
 static void modifyGeometry(ModifierData *md,
                            const ModifierEvalContext *ctx,
                            GeometrySet &geometry_set)
@@ -934,8 +1148,10 @@ static void modifyGeometry(ModifierData *md,
     return;
   }
 
+  NodeResultCache *cache = ensure_result_cache(nmd);
+
   geometry_set = compute_geometry(
-      tree, group_inputs, *group_outputs[0], std::move(geometry_set), nmd, ctx);
+      tree, group_inputs, *group_outputs[0], std::move(geometry_set), nmd, ctx, cache);
 }
 
 static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *mesh)
@@ -1018,6 +1234,8 @@ static void panel_draw(const bContext *C, Panel *panel)
     }
   }
 
+  uiItemR(layout, ptr, "cache_memory_limit", 0, nullptr, ICON_NONE);
+
   modifier_panel_end(layout, ptr);
 }
 
@@ -1062,6 +1280,8 @@ static void freeData(ModifierData *md)
     IDP_FreeProperty_ex(nmd->settings.properties, false);
     nmd->settings.properties = nullptr;
   }
+  freeRuntimeData(nmd->modifier.runtime);
+  nmd->modifier.runtime = nullptr;
 }
 
 static void requiredDataMask(Object *UNUSED(ob),
@@ -1105,7 +1325,7 @@ ModifierTypeInfo modifierType_Nodes = {
     /* dependsOnNormals */ nullptr,
     /* foreachIDLink */ foreachIDLink,
     /* foreachTexLink */ nullptr,
-    /* freeRuntimeData */ nullptr,
+    /* freeRuntimeData */ freeRuntimeData,
     /* panelRegister */ panelRegister,
     /* blendWrite */ blendWrite,
     /* blendRead */ blendRead,
@@ -0,0 +1,497 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup modifiers
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_node_types.h"
+#include "DNA_object_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_mesh.h"
+
+#include "MOD_nodes_cache.hh"
+
+namespace blender::modifiers {
+
+using fn::CPPType;
+using nodes::DParentNode;
+
+static const GeometryComponentType component_types[] = {
+    GeometryComponentType::Mesh,
+    GeometryComponentType::PointCloud,
+    GeometryComponentType::Instances,
+};
+
+struct NodeResultCache::Entry {
+  /* Node settings that are not stored in sockets. */
+  Vector<uint8_t> settings;
+  uint64_t inputs_hash;
+  Vector<GMutablePointer> inputs;
+  Vector<GMutablePointer> outputs;
+  uint64_t last_access;
+  LinearAllocator<> allocator;
+
+  ~Entry()
+  {
+    for (GMutablePointer value : inputs) {
+      value.destruct();
+    }
+    for (GMutablePointer value : outputs) {
+      value.destruct();
+    }
+  }
+
+  Vector<const GeometryComponent *> components() const
+  {
+    Vector<const GeometryComponent *> components;
+    for (Span<GMutablePointer> values : {inputs.as_span(), outputs.as_span()}) {
+      for (GMutablePointer value : values) {
+        if (*value.type() != CPPType::get<GeometrySet>()) {
+          continue;
+        }
+        const GeometrySet &geometry_set = *(const GeometrySet *)value.get();
+        for (const GeometryComponentType type : component_types) {
+          const GeometryComponent *component = geometry_set.get_component_for_read(type);
+          if (component != nullptr) {
+            components.append(component);
+          }
+        }
+      }
+    }
+    return components;
+  }
+};
+
+/* -------------------------------------------------------------------- */
+/** \name Comparing Values
+ * \{ */
+
+static std::string node_key(const DNode &node)
+{
+  std::string key = node.name();
+  for (const DParentNode *parent = node.parent(); parent != nullptr; parent = parent->parent()) {
+    key = parent->node_ref().name() + "/" + key;
+  }
+  return key + ":" + std::string(node.idname());
+}
+
+static Vector<uint8_t> node_settings(const bNode &bnode)
+{
+  Vector<uint8_t> settings;
+  auto append = [&](const void *data, const size_t size) {
+    settings.extend(Span<uint8_t>((const uint8_t *)data, (int64_t)size));
+  };
+  append(&bnode.custom1, sizeof(bnode.custom1));
+  append(&bnode.custom2, sizeof(bnode.custom2));
+  append(&bnode.custom3, sizeof(bnode.custom3));
+  append(&bnode.custom4, sizeof(bnode.custom4));
+  if (bnode.storage != nullptr) {
+    append(bnode.storage, MEM_allocN_len(bnode.storage));
+  }
+  return settings;
+}
+
+static bool settings_equal(Span<uint8_t> a, Span<uint8_t> b)
+{
+  return a.size() == b.size() && memcmp(a.data(), b.data(), (size_t)a.size()) == 0;
+}
+
+/* Geometries are identified by their components. A component that is referenced by the cache is
+ * shared and can't be modified anymore, so its content stays the same. */
+static bool geometries_equal(const GeometrySet &a, const GeometrySet &b)
+{
+  for (const GeometryComponentType type : component_types) {
+    if (a.get_component_for_read(type) != b.get_component_for_read(type)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static uint64_t values_hash(Span<GMutablePointer> values)
+{
+  uint64_t hash = 0;
+  for (GMutablePointer value : values) {
+    const CPPType &type = *value.type();
+    if (type == CPPType::get<GeometrySet>()) {
+      const GeometrySet &geometry_set = *(const GeometrySet *)value.get();
+      for (const GeometryComponentType component_type : component_types) {
+        const GeometryComponent *component = geometry_set.get_component_for_read(component_type);
+        hash = hash * 33 ^ DefaultHash<const GeometryComponent *>{}(component);
+      }
+    }
+    else {
+      hash = hash * 33 ^ type.hash(value.get());
+    }
+  }
+  return hash;
+}
+
+static bool values_equal(Span<GMutablePointer> a, Span<GMutablePointer> b)
+{
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (const int i : a.index_range()) {
+    const CPPType &type = *a[i].type();
+    if (type != *b[i].type()) {
+      return false;
+    }
+    if (type == CPPType::get<GeometrySet>()) {
+      if (!geometries_equal(*(const GeometrySet *)a[i].get(), *(const GeometrySet *)b[i].get())) {
+        return false;
+      }
+    }
+    else if (!type.is_equal(a[i].get(), b[i].get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void copy_values(Span<GMutablePointer> values,
+                        LinearAllocator<> &allocator,
+                        Vector<GMutablePointer> &r_copies)
+{
+  for (GMutablePointer value : values) {
+    const CPPType &type = *value.type();
+    void *buffer = allocator.allocate(type.size(), type.alignment());
+    type.copy_to_uninitialized(value.get(), buffer);
+    r_copies.append({type, buffer});
+  }
+}
+
+static bool deform_verts_equal(const MDeformVert *a, const MDeformVert *b, const int size)
+{
+  for (const int i : IndexRange(size)) {
+    if (a[i].totweight != b[i].totweight) {
+      return false;
+    }
+    if (a[i].totweight > 0 &&
+        memcmp(a[i].dw, b[i].dw, sizeof(MDeformWeight) * (size_t)a[i].totweight) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool custom_data_equal(const CustomData &a, const CustomData &b, const int size)
+{
+  if (a.totlayer != b.totlayer) {
+    return false;
+  }
+  for (const int i : IndexRange(a.totlayer)) {
+    const CustomDataLayer &layer_a = a.layers[i];
+    const CustomDataLayer &layer_b = b.layers[i];
+    if (layer_a.type != layer_b.type || !STREQ(layer_a.name, layer_b.name)) {
+      return false;
+    }
+    /* Nodes read the active layers, e.g. the active UV map. */
+    if (layer_a.active != layer_b.active || layer_a.active_rnd != layer_b.active_rnd ||
+        layer_a.active_clone != layer_b.active_clone ||
+        layer_a.active_mask != layer_b.active_mask) {
+      return false;
+    }
+    if (layer_a.data == nullptr || layer_b.data == nullptr) {
+      if (layer_a.data != layer_b.data) {
+        return false;
+      }
+      continue;
+    }
+    if (layer_a.type == CD_MDEFORMVERT) {
+      if (!deform_verts_equal(
+              (const MDeformVert *)layer_a.data, (const MDeformVert *)layer_b.data, size)) {
+        return false;
+      }
+    }
+    else if (ELEM(layer_a.type, CD_MDISPS, CD_GRID_PAINT_MASK)) {
+      /* These layers reference other arrays, just assume that they changed. */
+      return false;
+    }
+    else if (memcmp(layer_a.data, layer_b.data, (size_t)CustomData_sizeof(layer_a.type) * size) !=
+             0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool meshes_equal(const Mesh &a, const Mesh &b)
+{
+  if (a.totvert != b.totvert || a.totedge != b.totedge || a.totpoly != b.totpoly ||
+      a.totloop != b.totloop) {
+    return false;
+  }
+  if (a.flag != b.flag || a.smoothresh != b.smoothresh || a.totcol != b.totcol) {
+    return false;
+  }
+  if (a.totcol > 0 && memcmp(a.mat, b.mat, sizeof(*a.mat) * (size_t)a.totcol) != 0) {
+    return false;
+  }
+  return custom_data_equal(a.vdata, b.vdata, a.totvert) &&
+         custom_data_equal(a.edata, b.edata, a.totedge) &&
+         custom_data_equal(a.pdata, b.pdata, a.totpoly) &&
+         custom_data_equal(a.ldata, b.ldata, a.totloop);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Memory Usage
+ * \{ */
+
+static int64_t custom_data_memory_size(const CustomData &data, const int size)
+{
+  int64_t memory_size = 0;
+  for (const int i : IndexRange(data.totlayer)) {
+    memory_size += (int64_t)CustomData_sizeof(data.layers[i].type) * size;
+  }
+  return memory_size;
+}
+
+static int64_t component_memory_size(const GeometryComponent &component)
+{
+  switch (component.type()) {
+    case GeometryComponentType::Mesh: {
+      const Mesh *mesh = static_cast<const MeshComponent &>(component).get_for_read();
+      if (mesh == nullptr) {
+        return 0;
+      }
+      return custom_data_memory_size(mesh->vdata, mesh->totvert) +
+             custom_data_memory_size(mesh->edata, mesh->totedge) +
+             custom_data_memory_size(mesh->pdata, mesh->totpoly) +
+             custom_data_memory_size(mesh->ldata, mesh->totloop);
+    }
+    case GeometryComponentType::PointCloud: {
+      const PointCloud *pointcloud =
+          static_cast<const PointCloudComponent &>(component).get_for_read();
+      if (pointcloud == nullptr) {
+        return 0;
+      }
+      return custom_data_memory_size(pointcloud->pdata, pointcloud->totpoint);
+    }
+    case GeometryComponentType::Instances: {
+      const int instances_amount =
+          static_cast<const InstancesComponent &>(component).instances_amount();
+      return (int64_t)instances_amount * (3 * sizeof(float3) + sizeof(InstancedData));
+    }
+  }
+  return 0;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Node Result Cache
+ * \{ */
+
+NodeResultCache::NodeResultCache() = default;
+
+NodeResultCache::~NodeResultCache() = default;
+
+void NodeResultCache::set_memory_limit(const int64_t limit)
+{
+  std::lock_guard lock{mutex_};
+  memory_limit_ = limit;
+  this->evict_until_below_limit();
+}
+
+void NodeResultCache::reuse_input_geometry(GeometrySet &geometry_set, const Object &object)
+{
+  const Mesh *mesh = geometry_set.get_mesh_for_read();
+  if (mesh == nullptr || geometry_set.has_pointcloud() || geometry_set.has_instances()) {
+    return;
+  }
+
+  Vector<std::string> vertex_group_names;
+  LISTBASE_FOREACH (const bDeformGroup *, group, &object.defbase) {
+    vertex_group_names.append(group->name);
+  }
+
+  std::lock_guard lock{mutex_};
+
+  const Mesh *cached_mesh = input_geometry_.get_mesh_for_read();
+  if (cached_mesh != nullptr && meshes_equal(*mesh, *cached_mesh) &&
+      std::equal(vertex_group_names.begin(),
+                 vertex_group_names.end(),
+                 input_vertex_group_names_.begin(),
+                 input_vertex_group_names_.end())) {
+    geometry_set = input_geometry_;
+    return;
+  }
+
+  /* Keep a copy of the mesh, because the mesh passed to the modifier is freed after the
+   * evaluation. */
+  this->remove_component_users(input_geometry_);
+  input_geometry_ = GeometrySet();
+  MeshComponent &mesh_component = input_geometry_.get_component_for_write<MeshComponent>();
+  mesh_component.replace(BKE_mesh_copy_for_eval(const_cast<Mesh *>(mesh), false));
+  mesh_component.copy_vertex_group_names_from_object(object);
+  input_vertex_group_names_ = std::move(vertex_group_names);
+  this->add_component_users(input_geometry_);
+
+  geometry_set = input_geometry_;
+  this->evict_until_below_limit();
+}
+
+bool NodeResultCache::node_supports_caching(const DNode &node)
+{
+  const bNode &bnode = *node.bnode();
+  if (bnode.typeinfo->geometry_node_execute == nullptr) {
+    /* Nodes implemented as multi-function are cheap to execute. */
+    return false;
+  }
+  LISTBASE_FOREACH (const bNodeSocket *, socket, &bnode.inputs) {
+    if (ELEM(socket->type, SOCK_OBJECT, SOCK_COLLECTION)) {
+      /* The result depends on data that is not passed in through the inputs. */
+      return false;
+    }
+  }
+  LISTBASE_FOREACH (const bNodeSocket *, socket, &bnode.outputs) {
+    if (socket->type == SOCK_GEOMETRY) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool NodeResultCache::lookup(const DNode &node,
+                             Span<GMutablePointer> inputs,
+                             LinearAllocator<> &allocator,
+                             Vector<GMutablePointer> &r_outputs)
+{
+  const std::string key = node_key(node);
+  const Vector<uint8_t> settings = node_settings(*node.bnode());
+  const uint64_t inputs_hash = values_hash(inputs);
+
+  std::lock_guard lock{mutex_};
+
+  Vector<std::unique_ptr<Entry>> *entries = entries_by_node_.lookup_ptr(key);
+  if (entries == nullptr) {
+    return false;
+  }
+  for (std::unique_ptr<Entry> &entry : *entries) {
+    if (entry->inputs_hash == inputs_hash && settings_equal(entry->settings, settings) &&
+        values_equal(entry->inputs, inputs)) {
+      entry->last_access = ++access_counter_;
+      copy_values(entry->outputs, allocator, r_outputs);
+      return true;
+    }
+  }
+  return false;
+}
+
+void NodeResultCache::add(const DNode &node,
+                          Span<GMutablePointer> inputs,
+                          Span<GMutablePointer> outputs)
+{
+  std::unique_ptr<Entry> entry = std::make_unique<Entry>();
+  entry->settings = node_settings(*node.bnode());
+  entry->inputs_hash = values_hash(inputs);
+  copy_values(inputs, entry->allocator, entry->inputs);
+  copy_values(outputs, entry->allocator, entry->outputs);
+
+  std::lock_guard lock{mutex_};
+
+  entry->last_access = ++access_counter_;
+  this->add_component_users(entry->components());
+  entries_by_node_.lookup_or_add_default(node_key(node)).append(std::move(entry));
+  this->evict_until_below_limit();
+}
+
+void NodeResultCache::add_component_users(Span<const GeometryComponent *> components)
+{
+  for (const GeometryComponent *component : components) {
+    int &users = component_users_.lookup_or_add(component, 0);
+    if (users == 0) {
+      memory_usage_ += component_memory_size(*component);
+    }
+    users++;
+  }
+}
+
+void NodeResultCache::remove_component_users(Span<const GeometryComponent *> components)
+{
+  for (const GeometryComponent *component : components) {
+    int &users = component_users_.lookup(component);
+    users--;
+    if (users == 0) {
+      memory_usage_ -= component_memory_size(*component);
+      component_users_.remove(component);
+    }
+  }
+}
+
+void NodeResultCache::add_component_users(const GeometrySet &geometry_set)
+{
+  for (const GeometryComponentType type : component_types) {
+    const GeometryComponent *component = geometry_set.get_component_for_read(type);
+    if (component != nullptr) {
+      this->add_component_users(Span<const GeometryComponent *>(&component, 1));
+    }
+  }
+}
+
+void NodeResultCache::remove_component_users(const GeometrySet &geometry_set)
+{
+  for (const GeometryComponentType type : component_types) {
+    const GeometryComponent *component = geometry_set.get_component_for_read(type);
+    if (component != nullptr) {
+      this->remove_component_users(Span<const GeometryComponent *>(&component, 1));
+    }
+  }
+}
+
+/* Remove the least recently used entries until the memory limit is respected. */
+void NodeResultCache::evict_until_below_limit()
+{
+  while (memory_usage_ > memory_limit_) {
+    Vector<std::unique_ptr<Entry>> *oldest_entries = nullptr;
+    int oldest_index = -1;
+    for (Vector<std::unique_ptr<Entry>> &entries : entries_by_node_.values()) {
+      for (const int i : entries.index_range()) {
+        if (oldest_entries == nullptr ||
+            entries[i]->last_access < (*oldest_entries)[oldest_index]->last_access) {
+          oldest_entries = &entries;
+          oldest_index = i;
+        }
+      }
+    }
+    if (oldest_entries == nullptr) {
+      /* Only the input geometry is left. */
+      break;
+    }
+    this->remove_component_users((*oldest_entries)[oldest_index]->components());
+    oldest_entries->remove_and_reorder(oldest_index);
+  }
+}
+
+/** \} */
+
+}  // namespace blender::modifiers
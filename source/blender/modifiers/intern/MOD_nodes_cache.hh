@@ -0,0 +1,113 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup modifiers
+ */
+
+#include <mutex>
+
+#include "BLI_linear_allocator.hh"
+#include "BLI_map.hh"
+#include "BLI_vector.hh"
+
+#include "FN_generic_pointer.hh"
+
+#include "BKE_geometry_set.hh"
+
+#include "NOD_derived_node_tree.hh"
+
+struct Object;
+
+namespace blender::modifiers {
+
+using fn::GMutablePointer;
+using nodes::DNode;
+
+/**
+ * Keeps the outputs of geometry nodes computed during previous evaluations of a Geometry Nodes
+ * modifier. When a node is evaluated again with inputs and settings that did not change, the
+ * cached outputs are used instead of executing the node.
+ *
+ * Geometry inputs are compared by the identity of their components. Cached geometries are
+ * shared and never modified, so the outputs of a cached node have the same components every
+ * time they are reused. Nodes further down the tree will find their cached results as well.
+ *
+ * The cache is stored in the runtime data of the evaluated modifier, so it persists between
+ * depsgraph evaluations. It is used by multiple threads at the same time.
+ */
+class NodeResultCache {
+ private:
+  struct Entry;
+
+  std::mutex mutex_;
+  Map<std::string, Vector<std::unique_ptr<Entry>>> entries_by_node_;
+  /* Number of cache entries using each geometry component. Components are only counted once in
+   * the memory usage, even when they are shared by multiple entries. */
+  Map<const GeometryComponent *, int> component_users_;
+  int64_t memory_usage_ = 0;
+  int64_t memory_limit_ = 0;
+  /* Incremented for every access, used to find the least recently used entry. */
+  uint64_t access_counter_ = 0;
+
+  /* Copy of the geometry passed into the modifier during the last evaluation. */
+  GeometrySet input_geometry_;
+  Vector<std::string> input_vertex_group_names_;
+
+ public:
+  NodeResultCache();
+  ~NodeResultCache();
+
+  /* Entries are removed until the memory used by the cache is below the limit. */
+  void set_memory_limit(int64_t limit);
+
+  /**
+   * Replace the modifier input geometry with the copy from the previous evaluation when its
+   * content did not change. That way the input geometry has the same components as before and
+   * the results of nodes depending on it can be reused.
+   */
+  void reuse_input_geometry(GeometrySet &geometry_set, const Object &object);
+
+  static bool node_supports_caching(const DNode &node);
+
+  /**
+   * Look up the outputs computed when the node was executed with equal inputs. The cached values
+   * are copied into buffers allocated with the given allocator.
+   * \return False when no matching entry exists.
+   */
+  bool lookup(const DNode &node,
+              Span<GMutablePointer> inputs,
+              LinearAllocator<> &allocator,
+              Vector<GMutablePointer> &r_outputs);
+
+  /**
+   * Remember the outputs of the node for the given inputs. The inputs have to be copied before
+   * the node is executed, because nodes may modify their inputs. Inputs and outputs are copied
+   * into the cache, the caller remains responsible for destructing them.
+   */
+  void add(const DNode &node, Span<GMutablePointer> inputs, Span<GMutablePointer> outputs);
+
+ private:
+  void add_component_users(Span<const GeometryComponent *> components);
+  void remove_component_users(Span<const GeometryComponent *> components);
+  void add_component_users(const GeometrySet &geometry_set);
+  void remove_component_users(const GeometrySet &geometry_set);
+  void evict_until_below_limit();
+};
+
+}  // namespace blender::modifiers
@@ -17,6 +17,8 @@
 #include "node_geometry_util.hh"
 #include "node_util.h"
 
+#include "FN_multi_function_parallel.hh"
+
 namespace blender::nodes {
 
 void update_attribute_input_socket_availabilities(bNode &node,
@@ -36,6 +38,31 @@ void update_attribute_input_socket_availabilities(bNode &node,
   }
 }
 
+/* The kernels of attribute nodes are cheap per element, so every task should process many. */
+static constexpr int64_t AttributeFunctionGrainSize = 4096;
+
+/**
+ * Evaluate a multi-function with only single value inputs and one single value output for every
+ * element of the output span. Large attributes are split into chunks that are processed in
+ * parallel.
+ */
+void evaluate_attribute_function(const fn::MultiFunction &fn,
+                                 Span<fn::GVSpan> inputs,
+                                 fn::GMutableSpan output)
+{
+  const int64_t size = output.size();
+  fn::ParallelMultiFunction parallel_fn{fn, AttributeFunctionGrainSize};
+
+  fn::MFParamsBuilder params{parallel_fn, size};
+  for (const fn::GVSpan &input : inputs) {
+    params.add_readonly_single_input(input);
+  }
+  params.add_uninitialized_single_output(output);
+
+  fn::MFContextBuilder context;
+  parallel_fn.call(IndexRange(size), params, context);
+}
+
 }  // namespace blender::nodes
 
 bool geo_node_poll_default(bNodeType *UNUSED(ntype), bNodeTree *ntree)
@@ -29,6 +29,8 @@
 
 #include "BLT_translation.h"
 
+#include "FN_multi_function.hh"
+
 #include "NOD_geometry.h"
 #include "NOD_geometry_exec.hh"
 
@@ -43,6 +45,10 @@ void update_attribute_input_socket_availabilities(bNode &node,
                                                   const StringRef name,
                                                   const GeometryNodeAttributeInputMode mode);
 
+void evaluate_attribute_function(const fn::MultiFunction &fn,
+                                 Span<fn::GVSpan> inputs,
+                                 fn::GMutableSpan output);
+
 void poisson_disk_point_elimination(Vector<float3> const *input_points,
                                     Vector<float3> *output_points,
                                     float maximum_distance,
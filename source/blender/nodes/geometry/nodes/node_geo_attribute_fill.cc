@@ -122,6 +122,9 @@ static void geo_node_attribute_fill_exec(GeoNodeExecParams params)
   if (geometry_set.has<PointCloudComponent>()) {
     fill_attribute(geometry_set.get_component_for_write<PointCloudComponent>(), params);
   }
+  if (geometry_set.has<InstancesComponent>()) {
+    fill_attribute(geometry_set.get_component_for_write<InstancesComponent>(), params);
+  }
 
   params.set_output("Geometry", geometry_set);
 }
@@ -26,6 +26,8 @@
 #include "DNA_mesh_types.h"
 #include "DNA_pointcloud_types.h"
 
+#include "FN_multi_function_builder.hh"
+
 #include "NOD_math_functions.hh"
 
 static bNodeSocketTemplate geo_node_attribute_math_in[] = {
@@ -71,20 +73,14 @@ static void do_math_operation(const FloatReadAttribute &input_a,
                               FloatWriteAttribute result,
                               const int operation)
 {
-  const int size = input_a.size();
-
-  Span<float> span_a = input_a.get_span();
-  Span<float> span_b = input_b.get_span();
+  fn::VSpan<float> span_a = input_a.get_virtual_span();
+  fn::VSpan<float> span_b = input_b.get_virtual_span();
   MutableSpan<float> span_result = result.get_span();
 
   bool success = try_dispatch_float_math_fl_fl_to_fl(
-      operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        for (const int i : IndexRange(size)) {
-          const float in1 = span_a[i];
-          const float in2 = span_b[i];
-          const float out = math_function(in1, in2);
-          span_result[i] = out;
-        }
+      operation, [&](auto math_function, const FloatMathOperationInfo &info) {
+        fn::CustomMF_SI_SI_SO<float, float, float> fn{info.title_case_name, math_function};
+        evaluate_attribute_function(fn, {span_a, span_b}, span_result);
       });
 
   result.apply_span();
@@ -148,6 +144,9 @@ static void geo_node_attribute_math_exec(GeoNodeExecParams params)
   if (geometry_set.has<PointCloudComponent>()) {
     attribute_math_calc(geometry_set.get_component_for_write<PointCloudComponent>(), params);
   }
+  if (geometry_set.has<InstancesComponent>()) {
+    attribute_math_calc(geometry_set.get_component_for_write<InstancesComponent>(), params);
+  }
 
   params.set_output("Geometry", geometry_set);
 }
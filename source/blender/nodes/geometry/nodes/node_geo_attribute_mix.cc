@@ -18,6 +18,8 @@
 
 #include "DNA_material_types.h"
 
+#include "FN_multi_function_builder.hh"
+
 #include "node_geometry_util.hh"
 
 static bNodeSocketTemplate geo_node_attribute_mix_in[] = {
@@ -43,21 +45,34 @@ static bNodeSocketTemplate geo_node_mix_attribute_out[] = {
 
 namespace blender::nodes {
 
+template<typename T, typename MixFuncT>
+static void do_mix_operation(const FloatReadAttribute &factors,
+                             const bke::TypedReadAttribute<T> &inputs_a,
+                             const bke::TypedReadAttribute<T> &inputs_b,
+                             bke::TypedWriteAttribute<T> &results,
+                             const MixFuncT &mix_function)
+{
+  fn::CustomMF_SI_SI_SI_SO<float, T, T, T> fn{"Mix", mix_function};
+  evaluate_attribute_function(
+      fn,
+      {factors.get_virtual_span(), inputs_a.get_virtual_span(), inputs_b.get_virtual_span()},
+      results.get_span());
+  results.apply_span();
+}
+
 static void do_mix_operation_float(const int blend_mode,
                                    const FloatReadAttribute &factors,
                                    const FloatReadAttribute &inputs_a,
                                    const FloatReadAttribute &inputs_b,
                                    FloatWriteAttribute &results)
 {
-  const int size = results.size();
-  for (const int i : IndexRange(size)) {
-    const float factor = factors[i];
-    float3 a{inputs_a[i]};
-    const float3 b{inputs_b[i]};
-    ramp_blend(blend_mode, a, factor, b);
-    const float result = a.length();
-    results.set(i, result);
-  }
+  do_mix_operation<float>(
+      factors, inputs_a, inputs_b, results, [blend_mode](float factor, float in_a, float in_b) {
+        float3 a{in_a};
+        const float3 b{in_b};
+        ramp_blend(blend_mode, a, factor, b);
+        return a.length();
+      });
 }
 
 static void do_mix_operation_float3(const int blend_mode,
@@ -66,14 +81,11 @@ static void do_mix_operation_float3(const int blend_mode,
                                     const Float3ReadAttribute &inputs_b,
                                     Float3WriteAttribute &results)
 {
-  const int size = results.size();
-  for (const int i : IndexRange(size)) {
-    const float factor = factors[i];
-    float3 a = inputs_a[i];
-    const float3 b = inputs_b[i];
-    ramp_blend(blend_mode, a, factor, b);
-    results.set(i, a);
-  }
+  do_mix_operation<float3>(
+      factors, inputs_a, inputs_b, results, [blend_mode](float factor, float3 a, float3 b) {
+        ramp_blend(blend_mode, a, factor, b);
+        return a;
+      });
 }
 
 static void do_mix_operation_color4f(const int blend_mode,
@@ -82,14 +94,11 @@ static void do_mix_operation_color4f(const int blend_mode,
                                      const Color4fReadAttribute &inputs_b,
                                      Color4fWriteAttribute &results)
 {
-  const int size = results.size();
-  for (const int i : IndexRange(size)) {
-    const float factor = factors[i];
-    Color4f a = inputs_a[i];
-    const Color4f b = inputs_b[i];
-    ramp_blend(blend_mode, a, factor, b);
-    results.set(i, a);
-  }
+  do_mix_operation<Color4f>(
+      factors, inputs_a, inputs_b, results, [blend_mode](float factor, Color4f a, Color4f b) {
+        ramp_blend(blend_mode, a, factor, b);
+        return a;
+      });
 }
 
 static void do_mix_operation(const CustomDataType result_type,
@@ -178,6 +187,9 @@ static void geo_node_attribute_mix_exec(GeoNodeExecParams params)
   if (geometry_set.has<PointCloudComponent>()) {
     attribute_mix_calc(geometry_set.get_component_for_write<PointCloudComponent>(), params);
   }
+  if (geometry_set.has<InstancesComponent>()) {
+    attribute_mix_calc(geometry_set.get_component_for_write<InstancesComponent>(), params);
+  }
 
   params.set_output("Geometry", geometry_set);
 }
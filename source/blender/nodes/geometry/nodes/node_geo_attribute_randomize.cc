@@ -16,8 +16,11 @@
 
 #include "node_geometry_util.hh"
 
+#include "BLI_hash.h"
 #include "BLI_rand.hh"
 
+#include "FN_multi_function.hh"
+
 #include "DNA_mesh_types.h"
 #include "DNA_pointcloud_types.h"
 
@@ -39,7 +42,10 @@ static bNodeSocketTemplate geo_node_attribute_randomize_out[] = {
 
 static void geo_node_attribute_randomize_init(bNodeTree *UNUSED(tree), bNode *node)
 {
+  NodeAttributeRandomize *data = (NodeAttributeRandomize *)MEM_callocN(
+      sizeof(NodeAttributeRandomize), "attribute randomize node");
   node->custom1 = CD_PROP_FLOAT;
+  node->storage = data;
 }
 
 static void geo_node_attribute_randomize_update(bNodeTree *UNUSED(ntree), bNode *node)
@@ -59,50 +65,66 @@ static void geo_node_attribute_randomize_update(bNodeTree *UNUSED(ntree), bNode
 
 namespace blender::nodes {
 
-static void randomize_attribute(BooleanWriteAttribute &attribute, RandomNumberGenerator &rng)
+/**
+ * The random values only depend on the seed and the element index, so that they don't change
+ * when the attribute is processed in chunks on multiple threads.
+ */
+static float random_float(const uint32_t seed, const int64_t index, const uint32_t component)
 {
-  MutableSpan<bool> attribute_span = attribute.get_span();
-  for (const int i : IndexRange(attribute.size())) {
-    const bool value = rng.get_float() > 0.5f;
-    attribute_span[i] = value;
-  }
-  attribute.apply_span();
+  return BLI_hash_int_01(BLI_hash_int_2d(BLI_hash_int_2d((uint32_t)index, seed), component));
 }
 
-static void randomize_attribute(FloatWriteAttribute &attribute,
-                                float min,
-                                float max,
-                                RandomNumberGenerator &rng)
-{
-  MutableSpan<float> attribute_span = attribute.get_span();
-  for (const int i : IndexRange(attribute.size())) {
-    const float value = rng.get_float() * (max - min) + min;
-    attribute_span[i] = value;
+template<typename T, typename RandomFuncT>
+class RandomAttributeFunction : public fn::MultiFunction {
+ private:
+  RandomFuncT random_function_;
+
+ public:
+  RandomAttributeFunction(RandomFuncT random_function) : random_function_(random_function)
+  {
+    fn::MFSignatureBuilder signature = this->get_builder("Random Attribute");
+    signature.single_output<T>("Value");
+  }
+
+  void call(IndexMask mask, fn::MFParams params, fn::MFContext UNUSED(context)) const override
+  {
+    MutableSpan<T> values = params.uninitialized_single_output<T>(0, "Value");
+    mask.foreach_index([&](const int64_t i) { new (&values[i]) T(random_function_(i)); });
   }
+};
+
+template<typename T, typename RandomFuncT>
+static void randomize_attribute(bke::TypedWriteAttribute<T> &attribute,
+                                const RandomFuncT &random_function)
+{
+  RandomAttributeFunction<T, RandomFuncT> fn{random_function};
+  evaluate_attribute_function(fn, {}, attribute.get_span());
   attribute.apply_span();
 }
 
-static void randomize_attribute(Float3WriteAttribute &attribute,
-                                float3 min,
-                                float3 max,
-                                RandomNumberGenerator &rng)
+/**
+ * Nodes from older files draw the values from a sequential random number generator, so that
+ * their result doesn't change. The values depend on the order, so they are not computed in
+ * parallel.
+ */
+template<typename T, typename RandomFuncT>
+static void randomize_attribute_legacy(bke::TypedWriteAttribute<T> &attribute,
+                                       const RandomFuncT &random_function)
 {
-  MutableSpan<float3> attribute_span = attribute.get_span();
-  for (const int i : IndexRange(attribute.size())) {
-    const float x = rng.get_float();
-    const float y = rng.get_float();
-    const float z = rng.get_float();
-    const float3 value = float3(x, y, z) * (max - min) + min;
-    attribute_span[i] = value;
+  MutableSpan<T> values = attribute.get_span();
+  for (const int64_t i : values.index_range()) {
+    values[i] = random_function();
   }
   attribute.apply_span();
 }
 
 static void randomize_attribute(GeometryComponent &component,
                                 const GeoNodeExecParams &params,
-                                RandomNumberGenerator &rng)
+                                const uint32_t seed)
 {
   const bNode &node = params.node();
+  const NodeAttributeRandomize &node_storage = *(const NodeAttributeRandomize *)node.storage;
+  const bool use_legacy_rng = node_storage.flag & GEO_NODE_ATTRIBUTE_RANDOMIZE_LEGACY_RNG;
   const CustomDataType data_type = static_cast<CustomDataType>(node.custom1);
   const AttributeDomain domain = static_cast<AttributeDomain>(node.custom2);
   const std::string attribute_name = params.get_input<std::string>("Attribute");
@@ -116,24 +138,55 @@ static void randomize_attribute(GeometryComponent &component,
     return;
   }
 
+  RandomNumberGenerator rng;
+  rng.seed_random(seed);
+
   switch (data_type) {
     case CD_PROP_FLOAT: {
       FloatWriteAttribute float_attribute = std::move(attribute);
       const float min_value = params.get_input<float>("Min_001");
       const float max_value = params.get_input<float>("Max_001");
-      randomize_attribute(float_attribute, min_value, max_value, rng);
+      if (use_legacy_rng) {
+        randomize_attribute_legacy(float_attribute, [&]() {
+          return rng.get_float() * (max_value - min_value) + min_value;
+        });
+        break;
+      }
+      randomize_attribute(float_attribute, [&](const int64_t index) {
+        return random_float(seed, index, 0) * (max_value - min_value) + min_value;
+      });
       break;
     }
     case CD_PROP_FLOAT3: {
       Float3WriteAttribute float3_attribute = std::move(attribute);
       const float3 min_value = params.get_input<float3>("Min");
       const float3 max_value = params.get_input<float3>("Max");
-      randomize_attribute(float3_attribute, min_value, max_value, rng);
+      if (use_legacy_rng) {
+        randomize_attribute_legacy(float3_attribute, [&]() {
+          const float x = rng.get_float();
+          const float y = rng.get_float();
+          const float z = rng.get_float();
+          return float3(x, y, z) * (max_value - min_value) + min_value;
+        });
+        break;
+      }
+      randomize_attribute(float3_attribute, [&](const int64_t index) {
+        const float x = random_float(seed, index, 0);
+        const float y = random_float(seed, index, 1);
+        const float z = random_float(seed, index, 2);
+        return float3(x, y, z) * (max_value - min_value) + min_value;
+      });
       break;
     }
     case CD_PROP_BOOL: {
       BooleanWriteAttribute boolean_attribute = std::move(attribute);
-      randomize_attribute(boolean_attribute, rng);
+      if (use_legacy_rng) {
+        randomize_attribute_legacy(boolean_attribute, [&]() { return rng.get_float() > 0.5f; });
+        break;
+      }
+      randomize_attribute(boolean_attribute, [&](const int64_t index) {
+        return random_float(seed, index, 0) > 0.5f;
+      });
       break;
     }
     default:
@@ -147,14 +200,18 @@ static void geo_node_random_attribute_exec(GeoNodeExecParams params)
   const int seed = params.get_input<int>("Seed");
 
   if (geometry_set.has<MeshComponent>()) {
-    RandomNumberGenerator rng;
-    rng.seed_random(seed);
-    randomize_attribute(geometry_set.get_component_for_write<MeshComponent>(), params, rng);
+    randomize_attribute(
+        geometry_set.get_component_for_write<MeshComponent>(), params, (uint32_t)seed);
   }
   if (geometry_set.has<PointCloudComponent>()) {
-    RandomNumberGenerator rng;
-    rng.seed_random(seed + 3245231);
-    randomize_attribute(geometry_set.get_component_for_write<PointCloudComponent>(), params, rng);
+    randomize_attribute(geometry_set.get_component_for_write<PointCloudComponent>(),
+                        params,
+                        (uint32_t)(seed + 3245231));
+  }
+  if (geometry_set.has<InstancesComponent>()) {
+    randomize_attribute(geometry_set.get_component_for_write<InstancesComponent>(),
+                        params,
+                        (uint32_t)(seed + 8741239));
   }
 
   params.set_output("Geometry", geometry_set);
@@ -172,6 +229,8 @@ void register_node_type_geo_attribute_randomize()
       &ntype, geo_node_attribute_randomize_in, geo_node_attribute_randomize_out);
   node_type_init(&ntype, geo_node_attribute_randomize_init);
   node_type_update(&ntype, geo_node_attribute_randomize_update);
+  node_type_storage(
+      &ntype, "NodeAttributeRandomize", node_free_standard_storage, node_copy_standard_storage);
   ntype.geometry_node_execute = blender::nodes::geo_node_random_attribute_exec;
   nodeRegisterType(&ntype);
 }
@@ -14,12 +14,9 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
-#include "BKE_mesh.h"
-#include "BKE_mesh_runtime.h"
-#include "BKE_pointcloud.h"
+#include "BKE_geometry_set_instances.hh"
 
-#include "DNA_mesh_types.h"
-#include "DNA_meshdata_types.h"
+#include "BLI_math_matrix.h"
 
 #include "node_geometry_util.hh"
 
@@ -36,186 +33,50 @@ static bNodeSocketTemplate geo_node_join_geometry_out[] = {
 
 namespace blender::nodes {
 
-static Mesh *join_mesh_topology_and_builtin_attributes(Span<const MeshComponent *> src_components)
-{
-  int totverts = 0;
-  int totloops = 0;
-  int totedges = 0;
-  int totpolys = 0;
-
-  for (const MeshComponent *mesh_component : src_components) {
-    const Mesh *mesh = mesh_component->get_for_read();
-    totverts += mesh->totvert;
-    totloops += mesh->totloop;
-    totedges += mesh->totedge;
-    totpolys += mesh->totpoly;
-  }
-
-  const Mesh *first_input_mesh = src_components[0]->get_for_read();
-  Mesh *new_mesh = BKE_mesh_new_nomain(totverts, totedges, 0, totloops, totpolys);
-  BKE_mesh_copy_settings(new_mesh, first_input_mesh);
-
-  int vert_offset = 0;
-  int loop_offset = 0;
-  int edge_offset = 0;
-  int poly_offset = 0;
-  for (const MeshComponent *mesh_component : src_components) {
-    const Mesh *mesh = mesh_component->get_for_read();
-    if (mesh == nullptr) {
-      continue;
-    }
-
-    for (const int i : IndexRange(mesh->totvert)) {
-      const MVert &old_vert = mesh->mvert[i];
-      MVert &new_vert = new_mesh->mvert[vert_offset + i];
-      new_vert = old_vert;
-    }
-
-    for (const int i : IndexRange(mesh->totedge)) {
-      const MEdge &old_edge = mesh->medge[i];
-      MEdge &new_edge = new_mesh->medge[edge_offset + i];
-      new_edge = old_edge;
-      new_edge.v1 += vert_offset;
-      new_edge.v2 += vert_offset;
-    }
-    for (const int i : IndexRange(mesh->totloop)) {
-      const MLoop &old_loop = mesh->mloop[i];
-      MLoop &new_loop = new_mesh->mloop[loop_offset + i];
-      new_loop = old_loop;
-      new_loop.v += vert_offset;
-      new_loop.e += edge_offset;
-    }
-    for (const int i : IndexRange(mesh->totpoly)) {
-      const MPoly &old_poly = mesh->mpoly[i];
-      MPoly &new_poly = new_mesh->mpoly[poly_offset + i];
-      new_poly = old_poly;
-      new_poly.loopstart += loop_offset;
-    }
-
-    vert_offset += mesh->totvert;
-    loop_offset += mesh->totloop;
-    edge_offset += mesh->totedge;
-    poly_offset += mesh->totpoly;
-  }
-
-  return new_mesh;
-}
-
 template<typename Component>
 static Array<const GeometryComponent *> to_base_components(Span<const Component *> components)
 {
   return components;
 }
 
-static Set<std::string> find_all_attribute_names(Span<const GeometryComponent *> components)
-{
-  Set<std::string> attribute_names;
-  for (const GeometryComponent *component : components) {
-    Set<std::string> names = component->attribute_names();
-    for (const std::string &name : names) {
-      attribute_names.add(name);
-    }
-  }
-  return attribute_names;
-}
-
-static void determine_final_data_type_and_domain(Span<const GeometryComponent *> components,
-                                                 StringRef attribute_name,
-                                                 CustomDataType *r_type,
-                                                 AttributeDomain *r_domain)
-{
-  for (const GeometryComponent *component : components) {
-    ReadAttributePtr attribute = component->attribute_try_get_for_read(attribute_name);
-    if (attribute) {
-      /* TODO: Use data type with most information. */
-      *r_type = bke::cpp_type_to_custom_data_type(attribute->cpp_type());
-      /* TODO: Use highest priority domain. */
-      *r_domain = attribute->domain();
-      return;
-    }
-  }
-  BLI_assert(false);
-}
-
-static void fill_new_attribute(Span<const GeometryComponent *> src_components,
-                               StringRef attribute_name,
-                               const CustomDataType data_type,
-                               const AttributeDomain domain,
-                               fn::GMutableSpan dst_span)
+/**
+ * Meshes and point clouds are joined by realizing them without a transform, which shares the
+ * copying of topology, vertex groups and attributes with #bke::geometry_set_realize_instances.
+ */
+static GeometrySet join_by_realizing(Span<const GeometryComponent *> src_components)
 {
-  const CPPType *cpp_type = bke::custom_data_type_to_cpp_type(data_type);
-  BLI_assert(cpp_type != nullptr);
+  float4x4 identity;
+  unit_m4(identity.values);
 
-  int offset = 0;
+  Vector<bke::GeometryInstanceGroup> groups;
   for (const GeometryComponent *component : src_components) {
-    const int domain_size = component->attribute_domain_size(domain);
-    ReadAttributePtr read_attribute = component->attribute_get_for_read(
-        attribute_name, domain, data_type, nullptr);
-
-    fn::GSpan src_span = read_attribute->get_span();
-    const void *src_buffer = src_span.data();
-    void *dst_buffer = dst_span[offset];
-    cpp_type->copy_to_initialized_n(src_buffer, dst_buffer, domain_size);
-
-    offset += domain_size;
-  }
-}
-
-static void join_attributes(Span<const GeometryComponent *> src_components,
-                            GeometryComponent &result,
-                            Span<StringRef> ignored_attributes = {})
-{
-  Set<std::string> attribute_names = find_all_attribute_names(src_components);
-  for (StringRef name : ignored_attributes) {
-    attribute_names.remove(name);
-  }
-
-  for (const std::string &attribute_name : attribute_names) {
-    CustomDataType data_type;
-    AttributeDomain domain;
-    determine_final_data_type_and_domain(src_components, attribute_name, &data_type, &domain);
-
-    result.attribute_try_create(attribute_name, domain, data_type);
-    WriteAttributePtr write_attribute = result.attribute_try_get_for_write(attribute_name);
-    if (!write_attribute ||
-        &write_attribute->cpp_type() != bke::custom_data_type_to_cpp_type(data_type) ||
-        write_attribute->domain() != domain) {
-      continue;
-    }
-    fn::GMutableSpan dst_span = write_attribute->get_span();
-    fill_new_attribute(src_components, attribute_name, data_type, domain, dst_span);
-    write_attribute->apply_span();
+    GeometrySet geometry_set;
+    geometry_set.add(*component);
+    groups.append({std::move(geometry_set), {identity}});
   }
+  return bke::geometry_set_realize_instance_groups(groups);
 }
 
 static void join_components(Span<const MeshComponent *> src_components, GeometrySet &result)
 {
-  Mesh *new_mesh = join_mesh_topology_and_builtin_attributes(src_components);
-
-  MeshComponent &dst_component = result.get_component_for_write<MeshComponent>();
-  dst_component.replace(new_mesh);
-
-  /* The position attribute is handled above already. */
-  join_attributes(to_base_components(src_components), dst_component, {"position"});
+  const GeometrySet joined = join_by_realizing(to_base_components(src_components));
+  result.add(*joined.get_component_for_read<MeshComponent>());
 }
 
 static void join_components(Span<const PointCloudComponent *> src_components, GeometrySet &result)
 {
-  int totpoints = 0;
-  for (const PointCloudComponent *pointcloud_component : src_components) {
-    totpoints += pointcloud_component->attribute_domain_size(ATTR_DOMAIN_POINT);
-  }
-
-  PointCloudComponent &dst_component = result.get_component_for_write<PointCloudComponent>();
-  PointCloud *pointcloud = BKE_pointcloud_new_nomain(totpoints);
-  dst_component.replace(pointcloud);
-
-  join_attributes(to_base_components(src_components), dst_component);
+  const GeometrySet joined = join_by_realizing(to_base_components(src_components));
+  result.add(*joined.get_component_for_read<PointCloudComponent>());
 }
 
 static void join_components(Span<const InstancesComponent *> src_components, GeometrySet &result)
 {
   InstancesComponent &dst_component = result.get_component_for_write<InstancesComponent>();
+  int tot_instances = 0;
+  for (const InstancesComponent *component : src_components) {
+    tot_instances += component->instances_amount();
+  }
+  dst_component.reserve(tot_instances);
   for (const InstancesComponent *component : src_components) {
     const int size = component->instances_amount();
     Span<InstancedData> instanced_data = component->instanced_data();
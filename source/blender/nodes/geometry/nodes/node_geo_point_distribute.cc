@@ -14,11 +14,13 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include "BLI_array.hh"
 #include "BLI_float3.hh"
 #include "BLI_hash.h"
 #include "BLI_math_vector.h"
 #include "BLI_rand.hh"
 #include "BLI_span.hh"
+#include "BLI_task.hh"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -26,6 +28,7 @@
 
 #include "BKE_bvhutils.h"
 #include "BKE_deform.h"
+#include "BKE_geometry_set_instances.hh"
 #include "BKE_mesh.h"
 #include "BKE_mesh_runtime.h"
 #include "BKE_pointcloud.h"
@@ -55,6 +58,46 @@ static void node_point_distribute_update(bNodeTree *UNUSED(ntree), bNode *node)
 
 namespace blender::nodes {
 
+/* Number of triangles that are processed by one task when scattering points in parallel. */
+static constexpr int64_t ScatterGrainSize = 512;
+
+/**
+ * Every triangle uses its own random number generator that is seeded based on its index. That
+ * makes the result independent of the order in which triangles are processed.
+ */
+static RandomNumberGenerator looptri_rng_create(const int looptri_index, const int seed)
+{
+  return RandomNumberGenerator(BLI_hash_int(looptri_index + seed));
+}
+
+/**
+ * Returns the number of points that are scattered on the triangle. The random number generator
+ * is advanced, so that it can be used to generate the point positions afterwards.
+ */
+static int looptri_point_amount(const Mesh &mesh,
+                                const MLoopTri &looptri,
+                                const float density,
+                                const Span<float> density_factors,
+                                RandomNumberGenerator &looptri_rng)
+{
+  const int v0_index = mesh.mloop[looptri.tri[0]].v;
+  const int v1_index = mesh.mloop[looptri.tri[1]].v;
+  const int v2_index = mesh.mloop[looptri.tri[2]].v;
+  const float v0_density_factor = std::max(0.0f, density_factors[v0_index]);
+  const float v1_density_factor = std::max(0.0f, density_factors[v1_index]);
+  const float v2_density_factor = std::max(0.0f, density_factors[v2_index]);
+  const float looptri_density_factor = (v0_density_factor + v1_density_factor +
+                                        v2_density_factor) /
+                                       3.0f;
+  const float area = area_tri_v3(
+      mesh.mvert[v0_index].co, mesh.mvert[v1_index].co, mesh.mvert[v2_index].co);
+
+  const float points_amount_fl = area * density * looptri_density_factor;
+  const float add_point_probability = fractf(points_amount_fl);
+  const bool add_point = add_point_probability > looptri_rng.get_float();
+  return (int)points_amount_fl + (int)add_point;
+}
+
 static Vector<float3> random_scatter_points_from_mesh(const Mesh *mesh,
                                                       const float density,
                                                       const FloatReadAttribute &density_factors,
@@ -63,40 +106,47 @@ static Vector<float3> random_scatter_points_from_mesh(const Mesh *mesh,
   /* This only updates a cache and can be considered to be logically const. */
   const MLoopTri *looptris = BKE_mesh_runtime_looptri_ensure(const_cast<Mesh *>(mesh));
   const int looptris_len = BKE_mesh_runtime_looptri_len(mesh);
-
-  Vector<float3> points;
-
-  for (const int looptri_index : IndexRange(looptris_len)) {
-    const MLoopTri &looptri = looptris[looptri_index];
-    const int v0_index = mesh->mloop[looptri.tri[0]].v;
-    const int v1_index = mesh->mloop[looptri.tri[1]].v;
-    const int v2_index = mesh->mloop[looptri.tri[2]].v;
-    const float3 v0_pos = mesh->mvert[v0_index].co;
-    const float3 v1_pos = mesh->mvert[v1_index].co;
-    const float3 v2_pos = mesh->mvert[v2_index].co;
-    const float v0_density_factor = std::max(0.0f, density_factors[v0_index]);
-    const float v1_density_factor = std::max(0.0f, density_factors[v1_index]);
-    const float v2_density_factor = std::max(0.0f, density_factors[v2_index]);
-    const float looptri_density_factor = (v0_density_factor + v1_density_factor +
-                                          v2_density_factor) /
-                                         3.0f;
-    const float area = area_tri_v3(v0_pos, v1_pos, v2_pos);
-
-    const int looptri_seed = BLI_hash_int(looptri_index + seed);
-    RandomNumberGenerator looptri_rng(looptri_seed);
-
-    const float points_amount_fl = area * density * looptri_density_factor;
-    const float add_point_probability = fractf(points_amount_fl);
-    const bool add_point = add_point_probability > looptri_rng.get_float();
-    const int point_amount = (int)points_amount_fl + (int)add_point;
-
-    for (int i = 0; i < point_amount; i++) {
-      const float3 bary_coords = looptri_rng.get_barycentric_coordinates();
-      float3 point_pos;
-      interp_v3_v3v3v3(point_pos, v0_pos, v1_pos, v2_pos, bary_coords);
-      points.append(point_pos);
+  const Span<float> density_factors_span = density_factors.get_span();
+
+  /* Count the points on every triangle first, so that every triangle knows where its points
+   * start in the output array. */
+  Array<int> point_offsets(looptris_len + 1);
+  parallel_for(IndexRange(looptris_len), ScatterGrainSize, [&](const IndexRange range) {
+    for (const int looptri_index : range) {
+      RandomNumberGenerator looptri_rng = looptri_rng_create(looptri_index, seed);
+      point_offsets[looptri_index] = looptri_point_amount(
+          *mesh, looptris[looptri_index], density, density_factors_span, looptri_rng);
     }
+  });
+  int points_len = 0;
+  for (const int looptri_index : IndexRange(looptris_len)) {
+    const int point_amount = point_offsets[looptri_index];
+    point_offsets[looptri_index] = points_len;
+    points_len += point_amount;
   }
+  point_offsets[looptris_len] = points_len;
+
+  Vector<float3> points(points_len);
+  parallel_for(IndexRange(looptris_len), ScatterGrainSize, [&](const IndexRange range) {
+    for (const int looptri_index : range) {
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 v0_pos = mesh->mvert[mesh->mloop[looptri.tri[0]].v].co;
+      const float3 v1_pos = mesh->mvert[mesh->mloop[looptri.tri[1]].v].co;
+      const float3 v2_pos = mesh->mvert[mesh->mloop[looptri.tri[2]].v].co;
+
+      /* Consume the same random numbers as when counting the points. */
+      RandomNumberGenerator looptri_rng = looptri_rng_create(looptri_index, seed);
+      looptri_point_amount(*mesh, looptri, density, density_factors_span, looptri_rng);
+
+      const IndexRange point_range(point_offsets[looptri_index],
+                                   point_offsets[looptri_index + 1] -
+                                       point_offsets[looptri_index]);
+      for (const int point_index : point_range) {
+        const float3 bary_coords = looptri_rng.get_barycentric_coordinates();
+        interp_v3_v3v3v3(points[point_index], v0_pos, v1_pos, v2_pos, bary_coords);
+      }
+    }
+  });
 
   return points;
 }
@@ -107,8 +157,9 @@ struct RayCastAll_Data {
   BVHTree_RayCastCallback raycast_callback;
 
   const Mesh *mesh;
+  const MLoopTri *looptris;
   float base_weight;
-  FloatReadAttribute *density_factors;
+  Span<float> density_factors;
   Vector<float3> *projected_points;
   float cur_point_weight;
 };
@@ -121,12 +172,10 @@ static void project_2d_bvh_callback(void *userdata,
   struct RayCastAll_Data *data = (RayCastAll_Data *)userdata;
   data->raycast_callback(data->bvhdata, index, ray, hit);
   if (hit->index != -1) {
-    /* This only updates a cache and can be considered to be logically const. */
-    const MLoopTri *looptris = BKE_mesh_runtime_looptri_ensure(const_cast<Mesh *>(data->mesh));
     const MVert *mvert = data->mesh->mvert;
 
-    const MLoopTri &looptri = looptris[index];
-    const FloatReadAttribute &density_factors = data->density_factors[0];
+    const MLoopTri &looptri = data->looptris[index];
+    const Span<float> density_factors = data->density_factors;
 
     const int v0_index = data->mesh->mloop[looptri.tri[0]].v;
     const int v1_index = data->mesh->mloop[looptri.tri[1]].v;
@@ -204,15 +253,15 @@ static Vector<float3> poisson_scatter_points_from_mesh(const Mesh *mesh,
   data.bvhdata = &treedata;
   data.raycast_callback = treedata.raycast_callback;
   data.mesh = mesh;
-  data.projected_points = &final_points;
-  data.density_factors = const_cast<FloatReadAttribute *>(&density_factors);
+  /* This only updates a cache and can be considered to be logically const. */
+  data.looptris = BKE_mesh_runtime_looptri_ensure(const_cast<Mesh *>(mesh));
+  data.projected_points = nullptr;
+  data.density_factors = density_factors.get_span();
   data.base_weight = std::min(
       1.0f, density / (output_points.size() / (point_scale_multiplier * point_scale_multiplier)));
 
   const float max_dist = bb_max[2] - bb_min[2] + 2.0f;
   const float3 dir = float3(0, 0, -1);
-  float3 raystart;
-  raystart.z = bb_max[2] + 1.0f;
 
   float tile_start_x_coord = bb_min[0];
   int tile_repeat_x = ceilf((bb_max[0] - bb_min[0]) / point_scale_multiplier);
@@ -220,20 +269,35 @@ static Vector<float3> poisson_scatter_points_from_mesh(const Mesh *mesh,
   float tile_start_y_coord = bb_min[1];
   int tile_repeat_y = ceilf((bb_max[1] - bb_min[1]) / point_scale_multiplier);
 
-  for (int x = 0; x < tile_repeat_x; x++) {
-    float tile_curr_x_coord = x * point_scale_multiplier + tile_start_x_coord;
-    for (int y = 0; y < tile_repeat_y; y++) {
-      float tile_curr_y_coord = y * point_scale_multiplier + tile_start_y_coord;
+  /* Project the tiles in parallel. Every tile collects its points separately, so that they can be
+   * joined in a deterministic order afterwards. */
+  Array<Vector<float3>> tile_points(tile_repeat_x * tile_repeat_y);
+  parallel_for(tile_points.index_range(), 1, [&](const IndexRange range) {
+    for (const int tile_index : range) {
+      const int x = tile_index / tile_repeat_y;
+      const int y = tile_index % tile_repeat_y;
+      const float tile_curr_x_coord = x * point_scale_multiplier + tile_start_x_coord;
+      const float tile_curr_y_coord = y * point_scale_multiplier + tile_start_y_coord;
+
+      RayCastAll_Data tile_data = data;
+      tile_data.projected_points = &tile_points[tile_index];
+
+      float3 raystart;
+      raystart.z = bb_max[2] + 1.0f;
       for (int idx = 0; idx < output_points.size(); idx++) {
         raystart.x = output_points[idx].x + tile_curr_x_coord;
         raystart.y = output_points[idx].y + tile_curr_y_coord;
 
-        data.cur_point_weight = (float)idx / (float)output_points.size();
+        tile_data.cur_point_weight = (float)idx / (float)output_points.size();
 
         BLI_bvhtree_ray_cast_all(
-            treedata.tree, raystart, dir, 0.0f, max_dist, project_2d_bvh_callback, &data);
+            treedata.tree, raystart, dir, 0.0f, max_dist, project_2d_bvh_callback, &tile_data);
       }
     }
+  });
+
+  for (const Vector<float3> &points_in_tile : tile_points) {
+    final_points.extend(points_in_tile);
   }
 
   return final_points;
@@ -244,6 +308,9 @@ static void geo_node_point_distribute_exec(GeoNodeExecParams params)
   GeometrySet geometry_set = params.extract_input<GeometrySet>("Geometry");
   GeometrySet geometry_set_out;
 
+  /* Points are distributed on the surface of instanced meshes as well. */
+  geometry_set = bke::geometry_set_realize_instances(geometry_set);
+
   GeometryNodePointDistributeMethod distribute_method =
       static_cast<GeometryNodePointDistributeMethod>(params.node().custom1);
 
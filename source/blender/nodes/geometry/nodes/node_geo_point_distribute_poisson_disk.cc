@@ -24,6 +24,7 @@
 
 #include "BLI_inplace_priority_queue.hh"
 #include "BLI_kdtree.h"
+#include "BLI_task.hh"
 
 #include "node_geometry_util.hh"
 
@@ -195,12 +196,20 @@ static void weighted_sample_elimination(const float3 *input_points,
   void *kd_tree = nullptr;
   points_tiling(input_points, input_size, &kd_tree, maximum_distance, boundbox);
 
-  /* Assign weights to each sample. */
+  /* Assign weights to each sample. Every point only changes its own weight in this pass, so the
+   * points can be processed in parallel. */
   Vector<float> weights(input_size, 0.0f);
-  for (size_t point_id = 0; point_id < weights.size(); point_id++) {
-    points_distance_weight_calculate(
-        &weights, point_id, input_points, kd_tree, minimum_distance, maximum_distance, nullptr);
-  }
+  parallel_for(weights.index_range(), 256, [&](const IndexRange range) {
+    for (const int64_t point_id : range) {
+      points_distance_weight_calculate(&weights,
+                                       (size_t)point_id,
+                                       input_points,
+                                       kd_tree,
+                                       minimum_distance,
+                                       maximum_distance,
+                                       nullptr);
+    }
+  });
 
   /* Remove the points based on their weight. */
   InplacePriorityQueue<float> heap(weights);
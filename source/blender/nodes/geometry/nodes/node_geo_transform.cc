@@ -15,6 +15,8 @@
  */
 
 #include "BLI_math_matrix.h"
+#include "BLI_math_rotation.h"
+#include "BLI_task.hh"
 
 #include "DNA_pointcloud_types.h"
 
@@ -92,6 +94,8 @@ static void transform_instances(InstancesComponent &instances,
                                 const float3 scale)
 {
   MutableSpan<float3> positions = instances.positions();
+  MutableSpan<float3> rotations = instances.rotations();
+  MutableSpan<float3> scales = instances.scales();
 
   /* Use only translation if rotation and scale don't apply. */
   if (use_translate(rotation, scale)) {
@@ -102,9 +106,19 @@ static void transform_instances(InstancesComponent &instances,
   else {
     float mat[4][4];
     loc_eul_size_to_mat4(mat, translation, rotation, scale);
-    for (float3 &position : positions) {
-      mul_m4_v3(mat, position);
-    }
+    /* Every instance is rotated and scaled as well, so that it moves with the geometry. */
+    parallel_for(positions.index_range(), 1024, [&](const IndexRange range) {
+      for (const int i : range) {
+        float instance_mat[4][4];
+        loc_eul_size_to_mat4(instance_mat, positions[i], rotations[i], scales[i]);
+        mul_m4_m4_pre(instance_mat, mat);
+
+        float rotation_mat[3][3];
+        mat4_to_loc_rot_size(positions[i], rotation_mat, scales[i], instance_mat);
+        const float3 old_rotation = rotations[i];
+        mat3_normalized_to_compatible_eul(rotations[i], old_rotation, rotation_mat);
+      }
+    });
   }
 }
 
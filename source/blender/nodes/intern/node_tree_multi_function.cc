@@ -17,10 +17,13 @@
 #include "NOD_node_tree_multi_function.hh"
 
 #include "FN_multi_function_network_evaluation.hh"
+#include "FN_multi_function_network_optimization.hh"
 
 #include "BLI_color.hh"
 #include "BLI_float3.hh"
 
+#include "BKE_global.h"
+
 namespace blender::nodes {
 
 const fn::MultiFunction &NodeMFNetworkBuilder::get_default_fn(StringRef name)
@@ -494,6 +497,17 @@ MultiFunctionByNode get_multi_function_per_node(const DerivedNodeTree &tree,
     }
   }
 
+  /* The functions created for nodes that expand into multiple functions only reference the dummy
+   * nodes of the network, which are never removed, so the network can still be simplified now. */
+  fn::mf_network_optimization::OptimizationStats stats;
+  fn::mf_network_optimization::optimize(network, resources, &stats);
+  if (G.debug & G_DEBUG) {
+    std::cout << "Multi-function network optimization: " << stats.function_nodes_before << " -> "
+              << stats.function_nodes_after << " function nodes (" << stats.folded_sockets
+              << " folded sockets, " << stats.deduplicated_nodes << " deduplicated nodes, "
+              << stats.removed_nodes << " removed nodes)\n";
+  }
+
   return functions_by_node;
 }
 
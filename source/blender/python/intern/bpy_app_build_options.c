@@ -59,6 +59,9 @@ static PyStructSequence_Field app_builtopts_info_fields[] = {
     {"openvdb", NULL},
     {"alembic", NULL},
     {"usd", NULL},
+    {"io_wavefront_obj", NULL},
+    {"io_stl", NULL},
+    {"io_ply", NULL},
     {"fluid", NULL},
     {"xr_openxr", NULL},
     {"potrace", NULL},
@@ -271,6 +274,24 @@ static PyObject *make_builtopts_info(void)
   SetObjIncref(Py_False);
 #endif
 
+#ifdef WITH_IO_WAVEFRONT_OBJ
+  SetObjIncref(Py_True);
+#else
+  SetObjIncref(Py_False);
+#endif
+
+#ifdef WITH_IO_STL
+  SetObjIncref(Py_True);
+#else
+  SetObjIncref(Py_False);
+#endif
+
+#ifdef WITH_IO_PLY
+  SetObjIncref(Py_True);
+#else
+  SetObjIncref(Py_False);
+#endif
+
 #ifdef WITH_FLUID
   SetObjIncref(Py_True);
 #else
@@ -142,6 +142,7 @@ static RecentFile *wm_file_history_find(const char *filepath);
 static void wm_history_file_free(RecentFile *recent);
 static void wm_history_file_update(void);
 static void wm_history_file_write(void);
+static void wm_autosave_job_kill(wmWindowManager *wm);
 
 /* -------------------------------------------------------------------- */
 /** \name Misc Utility Functions
@@ -408,6 +409,7 @@ static void wm_init_userdef(Main *bmain)
   }
 
   MEM_CacheLimiter_set_maximum(((size_t)U.memcachelimit) * 1024 * 1024);
+  BKE_packedfile_deferred_budget_set(((size_t)U.packed_data_memory_limit) * 1024 * 1024);
   BKE_sound_init(bmain);
 
   /* Update the temporary directory from the preferences or fallback to the system default. */
@@ -657,6 +659,7 @@ static void wm_file_read_post(bContext *C,
       else {
         BKE_undosys_stack_clear(wm->undo_stack);
       }
+      BKE_packedfile_deferred_undo_free();
       BKE_undosys_stack_init_from_main(wm->undo_stack, bmain);
       BKE_undosys_stack_init_from_context(wm->undo_stack, C);
     }
@@ -722,7 +725,8 @@ bool WM_file_read(bContext *C, const char *filepath, ReportList *reports)
          * Further it's just confusing if a user loads a file and various preferences change. */
         &(const struct BlendFileReadParams){
             .is_startup = false,
-            .skip_flags = BLO_READ_SKIP_USERDEF,
+            .skip_flags = BLO_READ_SKIP_USERDEF |
+                          ((U.flag & USER_DEFER_PACKED_DATA) ? BLO_READ_DEFER_PACKED_DATA : 0),
         },
         reports);
 
@@ -1481,6 +1485,10 @@ static bool wm_file_write(bContext *C,
   /* don't forget not to return without! */
   WM_cursor_wait(1);
 
+  /* Don't let an autosave of an older state finish after saving, the next autosave writes the
+   * current state. */
+  wm_autosave_job_kill(CTX_wm_manager(C));
+
   ED_editors_flush_edits(bmain);
 
   /* first time saving */
@@ -1597,10 +1605,88 @@ void WM_autosave_init(wmWindowManager *wm)
   }
 }
 
-void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
-{
+typedef struct AutosaveJob {
   char filepath[FILE_MAX];
+  /** Snapshot of the data to write, sharing the memory of the undo step it was made from. */
+  MemFile memfile;
+} AutosaveJob;
+
+static void wm_autosave_job_startjob(void *customdata,
+                                     short *stop,
+                                     short *UNUSED(do_update),
+                                     float *UNUSED(progress))
+{
+  AutosaveJob *job = customdata;
+
+  /* Write to a temporary file first, so a previous autosave stays valid until this one is
+   * complete. */
+  char filepath_tmp[FILE_MAX + 1];
+  BLI_snprintf(filepath_tmp, sizeof(filepath_tmp), "%s@", job->filepath);
+  if (BLO_memfile_write_file(&job->memfile, filepath_tmp)) {
+    if (*stop) {
+      /* Cancelled by #wm_autosave_job_kill, the autosave may have been deleted meanwhile. */
+      BLI_delete(filepath_tmp, false, false);
+    }
+    else if (BLI_rename(filepath_tmp, job->filepath) != 0) {
+      fprintf(stderr, "Unable to save '%s': cannot rename temporary file\n", job->filepath);
+    }
+  }
+}
+
+static void wm_autosave_job_free(void *customdata)
+{
+  AutosaveJob *job = customdata;
+  BLO_memfile_free(&job->memfile);
+  MEM_freeN(job);
+}
+
+/** Cancel an autosave that is being written, and wait for it to end. */
+static void wm_autosave_job_kill(wmWindowManager *wm)
+{
+  WM_jobs_kill_type(wm, wm, WM_JOB_TYPE_AUTOSAVE);
+}
 
+/**
+ * Take a snapshot of the current state on the main thread (the last undo step, or the file written
+ * in memory), the slow part of writing it to disk is done by a job.
+ */
+static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
+{
+  AutosaveJob *job = MEM_callocN(sizeof(*job), __func__);
+  wm_autosave_location(job->filepath);
+
+  bool use_memfile = false;
+  if (U.uiflag & USER_GLOBALUNDO) {
+    /* fast save of last undobuffer, now with UI */
+    struct MemFile *memfile = ED_undosys_stack_memfile_get_active(wm->undo_stack);
+    if (memfile) {
+      BLO_memfile_share(memfile, &job->memfile);
+      use_memfile = true;
+    }
+  }
+  else {
+    /* Save as regular blend file, written to memory. */
+    const int fileflags = G.fileflags & ~G_FILE_COMPRESS;
+
+    ED_editors_flush_edits(bmain);
+
+    use_memfile = BLO_write_file_to_memfile(bmain, &job->memfile, fileflags);
+  }
+
+  if (!use_memfile) {
+    wm_autosave_job_free(job);
+    return;
+  }
+
+  wmJob *wm_job = WM_jobs_get(wm, wm->winactive, wm, "Autosave", 0, WM_JOB_TYPE_AUTOSAVE);
+  WM_jobs_customdata_set(wm_job, job, wm_autosave_job_free);
+  WM_jobs_timer(wm_job, 0.5, 0, 0);
+  WM_jobs_callbacks(wm_job, wm_autosave_job_startjob, NULL, NULL, NULL);
+  WM_jobs_start(wm, wm_job);
+}
+
+void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
+{
   WM_event_remove_timer(wm, NULL, wm->autosavetimer);
 
   /* If a modal operator is running, don't autosave because we might not be in
@@ -1617,25 +1703,11 @@ void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
     }
   }
 
-  wm_autosave_location(filepath);
-
-  if (U.uiflag & USER_GLOBALUNDO) {
-    /* fast save of last undobuffer, now with UI */
-    struct MemFile *memfile = ED_undosys_stack_memfile_get_active(wm->undo_stack);
-    if (memfile) {
-      BLO_memfile_write_file(memfile, filepath);
-    }
+  /* Skip this autosave if the previous one is still being written. */
+  if (!WM_jobs_test(wm, wm, WM_JOB_TYPE_AUTOSAVE)) {
+    wm_autosave_write(bmain, wm);
   }
-  else {
-    /* Save as regular blend file. */
-    const int fileflags = G.fileflags & ~G_FILE_COMPRESS;
 
-    ED_editors_flush_edits(bmain);
-
-    /* Error reporting into console. */
-    BLO_write_file(bmain, filepath, fileflags, &(const struct BlendFileWriteParams){0}, NULL);
-  }
-  /* do timer after file write, just in case file write takes a long time */
   wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
 }
 
@@ -1647,10 +1719,18 @@ void wm_autosave_timer_ended(wmWindowManager *wm)
   }
 }
 
-void wm_autosave_delete(void)
+/**
+ * \param wm: Used to cancel an autosave that is being written, which would bring the file back.
+ * May be NULL once all jobs have ended.
+ */
+void wm_autosave_delete(wmWindowManager *wm)
 {
   char filename[FILE_MAX];
 
+  if (wm != NULL) {
+    wm_autosave_job_kill(wm);
+  }
+
   wm_autosave_location(filename);
 
   if (BLI_exists(filename)) {
@@ -53,6 +53,7 @@
 #include "BKE_key.h"
 #include "BKE_layer.h"
 #include "BKE_lib_id.h"
+#include "BKE_main_namemap.h"
 #include "BKE_lib_override.h"
 #include "BKE_lib_remap.h"
 #include "BKE_main.h"
@@ -845,6 +846,9 @@ static void lib_relocate_do(Main *bmain,
     }
   }
 
+  /* IDs were removed from Main directly. */
+  BKE_main_namemap_clear(bmain);
+
   if (lapp_data->num_items == 0) {
     /* Early out in case there is nothing to do. */
     return;
@@ -874,6 +878,7 @@ static void lib_relocate_do(Main *bmain,
       BLI_addtail(which_libbase(bmain, GS(old_key->id.name)), &old_key->id);
     }
   }
+  BKE_main_namemap_clear(bmain);
 
   /* Since our (old) reloaded IDs were removed from main, the user count done for them in linking
    * code is wrong, we need to redo it here after adding them back to main. */
@@ -659,7 +659,8 @@ void WM_exit_ex(bContext *C, const bool do_python)
 
   BKE_blender_atexit();
 
-  wm_autosave_delete();
+  /* Jobs were killed with the window manager. */
+  wm_autosave_delete(NULL);
 
   BKE_tempdir_session_purge();
 }
@@ -76,7 +76,7 @@ void wm_jobs_timer_ended(wmWindowManager *wm, wmTimer *wt);
 /* wm_files.c */
 void wm_autosave_timer(struct Main *bmain, wmWindowManager *wm, wmTimer *wt);
 void wm_autosave_timer_ended(wmWindowManager *wm);
-void wm_autosave_delete(void);
+void wm_autosave_delete(wmWindowManager *wm);
 void wm_autosave_read(bContext *C, struct ReportList *reports);
 void wm_autosave_location(char *filepath);
 